@@ -10,23 +10,31 @@
 #include "..\..\poro\source\game_utils\actionscript\sprite.cpp"
 #include "..\..\poro\source\game_utils\actionscript\tests\displayobjectcontainer_test.cpp"
 #include "..\..\poro\source\game_utils\actionscript\tests\eventdispatcher_test.cpp"
+#include "..\..\poro\source\game_utils\actionscript\tests\sprite_childtransform_test.cpp"
+#include "..\..\poro\source\game_utils\actionscript\tests\sprite_hitindex_test.cpp"
 #include "..\..\poro\source\game_utils\actionscript\tests\vector_test.cpp"
 #include "..\..\poro\source\game_utils\actionscript\textsprite.cpp"
 #include "..\..\poro\source\game_utils\camera\ccamera_zoom.cpp"
 #include "..\..\poro\source\game_utils\drawlines\drawlines.cpp"
+#include "..\..\poro\source\game_utils\drawlines\tests\drawlines_test.cpp"
 #include "..\..\poro\source\game_utils\font\cfont.cpp"
 #include "..\..\poro\source\game_utils\font\ifontalign.cpp"
 #include "..\..\poro\source\game_utils\tween\gtween.cpp"
+#include "..\..\poro\source\game_utils\tween\gtween_engine.cpp"
 #include "..\..\poro\source\game_utils\tween\gtween_listener.cpp"
 #include "..\..\poro\source\game_utils\tween\tests\cinterpolator_test.cpp"
+#include "..\..\poro\source\game_utils\tween\tests\gtween_benchmark.cpp"
 #include "..\..\poro\source\game_utils\tween\tests\gtween_tester.cpp"
 #include "..\..\poro\source\game_utils\tween\tween_utils.cpp"
 #include "..\..\poro\source\poro\default_application.cpp"
 #include "..\..\poro\source\poro\desktop\event_playback_impl.cpp"
+#include "..\..\poro\source\poro\desktop\event_record_format.cpp"
+#include "..\..\poro\source\poro\tests\event_record_format_test.cpp"
 #include "..\..\poro\source\poro\desktop\event_recorder_impl.cpp"
 #include "..\..\poro\source\poro\desktop\graphics_buffer_opengl.cpp"
 #include "..\..\poro\source\poro\desktop\graphics_opengl.cpp"
 #include "..\..\poro\source\poro\desktop\joystick_impl.cpp"
+#include "..\..\poro\source\poro\desktop\mesh_opengl.cpp"
 #include "..\..\poro\source\poro\desktop\mouse_impl.cpp"
 #include "..\..\poro\source\poro\desktop\platform_desktop.cpp"
 #include "..\..\poro\source\poro\desktop\render_texture_opengl.cpp"
@@ -46,20 +54,37 @@
 #include "..\..\poro\source\tester\ctester_numeric.cpp"
 #include "..\..\poro\source\tester\float_compare.cpp"
 #include "..\..\poro\source\tester\tester_console.cpp"
+#include "..\..\poro\source\utils\blur\blur.cpp"
+#include "..\..\poro\source\utils\blur\tests\blur_benchmark.cpp"
+#include "..\..\poro\source\utils\blur\tests\blur_test.cpp"
+#include "..\..\poro\source\utils\color\cclut_baker.cpp"
+#include "..\..\poro\source\utils\color\tests\cclut_baker_benchmark.cpp"
+#include "..\..\poro\source\utils\color\tests\cclut_baker_test.cpp"
 #include "..\..\poro\source\utils\color\ccolor.cpp"
+#include "..\..\poro\source\utils\color\ccolor_lut.cpp"
+#include "..\..\poro\source\utils\color\tests\ccolor_lut_test.cpp"
 #include "..\..\poro\source\utils\color\color_utils.cpp"
+#include "..\..\poro\source\utils\color\cpalette_index.cpp"
+#include "..\..\poro\source\utils\color\tests\cpalette_index_test.cpp"
 #include "..\..\poro\source\utils\config_macro\tests\config_macro_test.cpp"
 #include "..\..\poro\source\utils\easing\easing.cpp"
 #include "..\..\poro\source\utils\easing\tests\easing_test.cpp"
 #include "..\..\poro\source\utils\filesystem\filesystem.cpp"
 #include "..\..\poro\source\utils\functionptr\tests\cfunctionptr_test.cpp"
+#include "..\..\poro\source\utils\hotloader\tests\chotloader_test.cpp"
 #include "..\..\poro\source\utils\imagetoarray\imagetoarray.cpp"
+#include "..\..\poro\source\utils\imagetoarray\tests\imagetoarray_test.cpp"
 #include "..\..\poro\source\utils\logger\clog.cpp"
 #include "..\..\poro\source\utils\logger\cloglistenerforfile.cpp"
 #include "..\..\poro\source\utils\logger\logger.cpp"
 #include "..\..\poro\source\utils\math\point_inside.cpp"
 #include "..\..\poro\source\utils\memcpy\memcpy.c"
 #include "..\..\poro\source\utils\network\network_utils.cpp"
+#include "..\..\poro\source\utils\pngreader\pngreader.cpp"
+#include "..\..\poro\source\utils\pngreader\tests\pngreader_test.cpp"
+#include "..\..\poro\source\utils\pngwriter\pngwriter.cpp"
+#include "..\..\poro\source\utils\pngwriter\tests\pngwriter_benchmark.cpp"
+#include "..\..\poro\source\utils\pngwriter\tests\pngwriter_test.cpp"
 #include "..\..\poro\source\utils\pow2assert\pow2assert.cpp"
 #include "..\..\poro\source\utils\random\random.cpp"
 #include "..\..\poro\source\utils\rect\crect.cpp"
@@ -67,13 +92,19 @@
 #include "..\..\poro\source\utils\safearray\tests\csafearray_test.cpp"
 #include "..\..\poro\source\utils\singleton\csingleton.cpp"
 #include "..\..\poro\source\utils\string\string.cpp"
+#include "..\..\poro\source\utils\threadpool\cthreadpool.cpp"
+#include "..\..\poro\source\utils\threadpool\tests\cthreadpool_test.cpp"
 #include "..\..\poro\source\utils\timer\ctimer.cpp"
 #include "..\..\poro\source\utils\timer\ctimer_impl.cpp"
 #include "..\..\poro\source\utils\xml\canycontainer.cpp"
 #include "..\..\poro\source\utils\xml\cxml.cpp"
+#include "..\..\poro\source\utils\xml\cxmlbinary.cpp"
+#include "..\..\poro\source\utils\xml\tests\cxmlbinary_test.cpp"
 #include "..\..\poro\source\utils\xml\cxmlcast.cpp"
 #include "..\..\poro\source\utils\xml\cxmlnode.cpp"
 #include "..\..\poro\source\utils\xml\cxmlparser.cpp"
+#include "..\..\poro\source\utils\xml\tests\cxmlparser_benchmark.cpp"
+#include "..\..\poro\source\utils\xml\tests\cxmlparser_test.cpp"
 #include "..\..\Source\component_framework\Component.cpp"
 #include "..\..\Source\component_framework\ComponentFactory.cpp"
 #include "..\..\Source\component_framework\Entity.cpp"
@@ -89,9 +120,14 @@
 #include "..\..\Source\misc_utils\config_sliders.cpp"
 #include "..\..\Source\misc_utils\debug_layer.cpp"
 #include "..\..\Source\misc_utils\metadata.cpp"
+#include "..\..\Source\misc_utils\polygon_buffer.cpp"
 #include "..\..\Source\misc_utils\screenshotter.cpp"
 #include "..\..\Source\misc_utils\simple_profiler.cpp"
 #include "..\..\Source\misc_utils\simple_profiler_viewer.cpp"
 #include "..\..\Source\misc_utils\simple_ui.cpp"
+#include "..\..\Source\misc_utils\soft_rasterizer.cpp"
+#include "..\..\Source\misc_utils\tests\soft_rasterizer_test.cpp"
+#include "..\..\Source\misc_utils\vector_export.cpp"
+#include "..\..\Source\misc_utils\tests\vector_export_test.cpp"
 
 #include "..\..\Source\misc_utils\file_dialog.cpp"
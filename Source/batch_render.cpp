@@ -0,0 +1,413 @@
+#include "batch_render.h"
+
+#include <map>
+#include <algorithm>
+#include <iostream>
+
+#include <poro/igraphics.h>
+#include <game_utils/drawlines/drawlines.h>
+#include <utils/color/ccolor.h>
+#include <utils/color/ccolor_lut.h>
+#include <utils/blur/blur.h>
+#include <utils/string/string.h>
+#include <utils/xml/cxml.h>
+#include <utils/imagetoarray/imagetoarray.h>
+#include <utils/threadpool/cthreadpool.h>
+
+#include "card_generators.h"
+#include "misc_utils/soft_rasterizer.h"
+#include "misc_utils/vector_export.h"
+
+namespace {
+
+struct BatchJob
+{
+	BatchJob() :
+		generator( "stripes" ),
+		config(),
+		palette( "data/colors/gradientish.png" ),
+		palette_size( 0 ),
+		overlay( "data/overlay.png" ),
+		clut(),
+		clut_next(),
+		clut_interpolation( 0 ),
+		glow_sigma( 0 ),
+		glow_strength( 1 ),
+		glow_threshold( 0.5f ),
+		output(),
+		seed( -1 ),
+		seed_count( 1 ),
+		width( 1280 ),
+		height( 1125 ),
+		antialias( 1 )
+	{ }
+
+	std::string generator;
+	std::string config;
+	std::string palette;
+	int palette_size;
+	std::string overlay;
+	std::string clut;
+	std::string clut_next;
+	float clut_interpolation;
+	float glow_sigma;
+	float glow_strength;
+	float glow_threshold;
+	std::string output;
+	double seed;
+	int seed_count;
+	int width;
+	int height;
+	int antialias;
+
+	void Serialize( ceng::CXmlFileSys* filesys )
+	{
+		XML_BindAttribute( filesys, generator );
+		XML_BindAttribute( filesys, config );
+		XML_BindAttribute( filesys, palette );
+		XML_BindAttribute( filesys, palette_size );
+		XML_BindAttribute( filesys, overlay );
+		XML_BindAttribute( filesys, clut );
+		XML_BindAttribute( filesys, clut_next );
+		XML_BindAttribute( filesys, clut_interpolation );
+		XML_BindAttribute( filesys, glow_sigma );
+		XML_BindAttribute( filesys, glow_strength );
+		XML_BindAttribute( filesys, glow_threshold );
+		XML_BindAttribute( filesys, output );
+		XML_BindAttribute( filesys, seed );
+		XML_BindAttribute( filesys, seed_count );
+		XML_BindAttribute( filesys, width );
+		XML_BindAttribute( filesys, height );
+		XML_BindAttribute( filesys, antialias );
+	}
+};
+
+std::vector< BatchJob > LoadBatchJobs( const std::string& filename )
+{
+	std::vector< BatchJob > result;
+
+	ceng::CXmlParser parser;
+	ceng::CXmlHandler handler;
+	parser.SetHandler( &handler );
+	parser.ParseFile( filename.c_str() );
+
+	ceng::CXmlNode* root = handler.GetRootElement();
+	if( root == NULL )
+		return result;
+
+	// every job starts from the defaults, so that the attributes don't leak
+	// from one job to the next
+	for( int i = 0; i < root->GetChildCount(); ++i )
+	{
+		if( root->GetChild( i )->GetName() != "Job" )
+			continue;
+
+		BatchJob job;
+		ceng::XmlConvertTo( root->GetChild( i ), job );
+		result.push_back( job );
+	}
+
+	ceng::CXmlNode::FreeNode( root );
+	return result;
+}
+
+bool LoadBatchSettings( const BatchJob& job, CardBackSettings& settings )
+{
+	settings.generator = job.generator;
+
+	if( job.config.empty() == false )
+	{
+		if( job.generator == "lines" )			ceng::XmlLoadFromFile( settings.lines, job.config );
+		else if( job.generator == "rooms" )		ceng::XmlLoadFromFile( settings.rooms, job.config );
+		else if( job.generator == "stripes" )	ceng::XmlLoadFromFile( settings.stripes, job.config );
+		else return false;
+	}
+
+	if( job.seed >= 0 )
+		settings.SetSeed( job.seed );
+
+	return true;
+}
+
+// out/rooms.png -> out/rooms_123.png
+std::string AddSeedToFilename( const std::string& filename, double seed )
+{
+	const std::string seed_str = "_" + ceng::CastToString( (long)seed );
+	const std::size_t dot = filename.find_last_of( '.' );
+	const std::size_t slash = filename.find_last_of( "/\\" );
+	if( dot == std::string::npos || ( slash != std::string::npos && dot < slash ) )
+		return filename + seed_str;
+
+	return filename.substr( 0, dot ) + seed_str + filename.substr( dot );
+}
+
+// returns NULL if filename is empty or isn't a color lookup image. Each file
+// is loaded once
+const ceng::CColorLut* LoadBatchClut( const std::string& filename, std::map< std::string, ceng::CColorLut* >& cluts )
+{
+	if( filename.empty() )
+		return NULL;
+
+	std::map< std::string, ceng::CColorLut* >::iterator i = cluts.find( filename );
+	if( i != cluts.end() )
+		return i->second;
+
+	ceng::CColorLut* result = new ceng::CColorLut;
+	if( result->Load( filename ) == false )
+	{
+		std::cout << "RunBatchRender() - couldn't load color lookup: " << filename << std::endl;
+		delete result;
+		result = NULL;
+	}
+
+	cluts[ filename ] = result;
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+
+// one image, everything it needs is set up before it's handed to the pool
+struct BatchImage
+{
+	BatchImage() : settings(), output(), width( 0 ), height( 0 ), antialias( 1 ), overlay( NULL ), clut( NULL ), clut_next( NULL ), clut_interpolation( 0 ), glow(), ok( false ) { }
+
+	CardBackSettings settings;
+	std::string output;
+	int width;
+	int height;
+	int antialias;
+	const imagetoarray::TempTexture* overlay;
+	const ceng::CColorLut* clut;
+	const ceng::CColorLut* clut_next;
+	float clut_interpolation;
+	ceng::GlowSettings glow;
+	bool ok;
+};
+
+// the outlines come from the config of the generator that was used
+void GetLineSettings( const CardBackSettings& settings, bool& white_lines, float& line_width, float& line_alpha )
+{
+	white_lines = false;
+	line_width = 0;
+	line_alpha = 0;
+	if( settings.generator == "lines" )
+	{
+		white_lines = settings.lines.white_lines;
+		line_width = settings.lines.line_width;
+		line_alpha = settings.lines.line_alpha;
+	}
+	else if( settings.generator == "rooms" )
+	{
+		white_lines = settings.rooms.white_lines;
+		line_width = settings.rooms.line_width;
+		line_alpha = settings.rooms.line_alpha;
+	}
+}
+
+void RasterizeTriangles( const CardBackSettings& settings, const PolygonBuffer& triangles, SoftRasterizer& raster )
+{
+	raster.SetDrawFillMode( poro::IGraphics::DRAWFILL_MODE_TRIANGLE_STRIP );
+	if( triangles.Empty() == false )
+	{
+		raster.DrawFillBatch( &triangles.GetAllVertices()[ 0 ], &triangles.GetAllOffsets()[ 0 ], 
+			&triangles.GetAllCounts()[ 0 ], &triangles.GetAllColors()[ 0 ], triangles.GetPolygonCount() );
+	}
+
+	bool white_lines = false;
+	float line_width = 0;
+	float line_alpha = 0;
+	GetLineSettings( settings, white_lines, line_width, line_alpha );
+
+	// shared edges only once, the same as DrawLineBatch() in the editor
+	if( white_lines && triangles.Empty() == false )
+	{
+		std::vector< poro::types::vec2 > edges;
+		GetUniqueEdges( &triangles.GetAllVertices()[ 0 ], &triangles.GetAllOffsets()[ 0 ], 
+			&triangles.GetAllCounts()[ 0 ], triangles.GetPolygonCount(), edges );
+
+		poro::types::fcolor color = poro::GetFColor( 1.f,1.f,1.f, line_alpha );
+		for( std::size_t i = 0; i + 1 < edges.size(); i += 2 )
+			raster.DrawLine( edges[ i ], edges[ i + 1 ], color, line_width );
+	}
+}
+
+// svg and pdf outputs are written straight from the polygons. The overlay,
+// glow and color lookup only exist as pixels, so they're left out.
+bool SaveVectorImage( const BatchImage& image, const PolygonBuffer& triangles )
+{
+	VectorExportSettings settings;
+	settings.width = image.width;
+	settings.height = image.height;
+	GetLineSettings( image.settings, settings.white_lines, settings.line_width, settings.line_alpha );
+
+	return SaveVector( image.output, triangles, settings );
+}
+
+struct BatchRenderBody
+{
+	std::vector< BatchImage >* images;
+
+	// threads for the rasterizer, glow, color lookup and png encode of each
+	// image, so that they don't fight over the cores that the pool is 
+	// already using. One pool per image is shared by all of them, the outer
+	// pool can't be used here because this runs as one of its tasks.
+	int image_threads;
+
+	void operator()( int i )
+	{
+		BatchImage& image = (*images)[ i ];
+
+		PolygonBuffer triangles;
+		if( GenerateCardBack( image.settings, triangles ) == false )
+			return;
+
+		if( IsVectorFilename( image.output ) )
+		{
+			image.ok = SaveVectorImage( image, triangles );
+			return;
+		}
+
+		ceng::CThreadPool pool( image_threads );
+
+		SoftRasterizer raster( image.width, image.height );
+		raster.SetAntialias( image.antialias );
+		raster.SetThreadPool( &pool );
+		raster.Clear( poro::GetFColor( 0, 0, 0, 1 ) );
+		RasterizeTriangles( image.settings, triangles, raster );
+
+		if( image.overlay && image.overlay->data )
+			raster.DrawImage( image.overlay->data, image.overlay->width, image.overlay->height, 0, 0 );
+
+		if( image.glow.sigma > 0 )
+		{
+			ceng::GlowSettings glow = image.glow;
+			glow.pool = &pool;
+			ceng::ApplyGlow( raster.GetPixels(), raster.GetWidth(), raster.GetHeight(), raster.GetWidth() * 4, glow );
+		}
+
+		// the same color grading the post fx shader does
+		if( image.clut && image.clut_next )
+			ceng::ApplyColorLut( raster.GetPixels(), raster.GetWidth(), raster.GetHeight(), raster.GetWidth() * 4, *image.clut, *image.clut_next, image.clut_interpolation, pool );
+		else if( image.clut )
+			ceng::ApplyColorLut( raster.GetPixels(), raster.GetWidth(), raster.GetHeight(), raster.GetWidth() * 4, *image.clut, pool );
+
+		image.ok = raster.SaveImage( image.output );
+	}
+};
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+
+int RunBatchRender( const std::string& job_file, int thread_count )
+{
+	std::vector< BatchJob > jobs = LoadBatchJobs( job_file );
+	if( jobs.empty() )
+	{
+		std::cout << "RunBatchRender() - no jobs found in: " << job_file << std::endl;
+		return 1;
+	}
+
+	// everything that touches files or shared state is done here, before
+	// the pool gets the images
+	int failed = 0;
+	std::map< std::string, ColorPalette > palettes;
+	std::map< std::string, imagetoarray::TempTexture* > overlays;
+	std::map< std::string, ceng::CColorLut* > cluts;
+	std::vector< BatchImage > images;
+
+	for( std::size_t i = 0; i < jobs.size(); ++i )
+	{
+		const BatchJob& job = jobs[ i ];
+
+		// the same image can be used with different palette sizes
+		const std::string palette_key = job.palette + "#" + ceng::CastToString( job.palette_size );
+		if( palettes.find( palette_key ) == palettes.end() )
+			LoadColors( job.palette, palettes[ palette_key ], job.palette_size );
+
+		if( job.overlay.empty() == false && overlays.find( job.overlay ) == overlays.end() )
+			overlays[ job.overlay ] = imagetoarray::GetTexture( job.overlay );
+
+		const ceng::CColorLut* clut = LoadBatchClut( job.clut, cluts );
+		const ceng::CColorLut* clut_next = LoadBatchClut( job.clut_next, cluts );
+
+		BatchImage image;
+		image.width = job.width;
+		image.height = job.height;
+		image.antialias = job.antialias;
+		image.overlay = job.overlay.empty() ? NULL : overlays[ job.overlay ];
+		image.settings.palette = &palettes[ palette_key ];
+		image.clut = clut ? clut : clut_next;
+		image.clut_next = clut ? clut_next : NULL;
+		image.clut_interpolation = clut ? job.clut_interpolation : 0;
+		image.glow.sigma = job.glow_sigma;
+		image.glow.strength = job.glow_strength;
+		image.glow.threshold = job.glow_threshold;
+
+		if( image.settings.palette->colors.empty() || LoadBatchSettings( job, image.settings ) == false 
+			|| ( job.clut.empty() == false && clut == NULL ) || ( job.clut_next.empty() == false && clut_next == NULL ) )
+		{
+			std::cout << "RunBatchRender() - couldn't generate job " << i << " (" << job.generator << ")" << std::endl;
+			++failed;
+			continue;
+		}
+
+		std::string output = job.output;
+		if( output.empty() )
+			output = job.generator + "_" + ceng::CastToString( i ) + ".png";
+
+		const int seed_count = ( job.seed_count > 1 ) ? job.seed_count : 1;
+		const double first_seed = image.settings.GetSeed();
+		for( int j = 0; j < seed_count; ++j )
+		{
+			if( seed_count > 1 )
+			{
+				image.settings.SetSeed( first_seed + j );
+				image.output = AddSeedToFilename( output, first_seed + j );
+			}
+			else
+			{
+				image.output = output;
+			}
+
+			images.push_back( image );
+		}
+	}
+
+	// CColorFloat sets up its masks the first time one is created, that
+	// needs to happen before there's more than one thread
+	ceng::CColorFloat init_color_masks;
+
+	{
+		ceng::CThreadPool pool( thread_count );
+		std::cout << "RunBatchRender() - rendering " << images.size() << " images with " << pool.GetThreadCount() << " threads" << std::endl;
+
+		BatchRenderBody body;
+		body.images = &images;
+		body.image_threads = std::max( 1, pool.GetThreadCount() / std::max( 1, (int)images.size() ) );
+		ceng::ParallelFor( pool, (int)images.size(), body );
+	}
+
+	for( std::size_t i = 0; i < images.size(); ++i )
+	{
+		if( images[ i ].ok )
+		{
+			std::cout << "RunBatchRender() - " << images[ i ].output << std::endl;
+		}
+		else
+		{
+			std::cout << "RunBatchRender() - couldn't write file: " << images[ i ].output << std::endl;
+			++failed;
+		}
+	}
+
+	for( std::map< std::string, imagetoarray::TempTexture* >::iterator i = overlays.begin(); i != overlays.end(); ++i )
+		delete i->second;
+
+	for( std::map< std::string, ceng::CColorLut* >::iterator i = cluts.begin(); i != cluts.end(); ++i )
+		delete i->second;
+
+	return failed;
+}
+
+//-----------------------------------------------------------------------------
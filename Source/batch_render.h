@@ -0,0 +1,47 @@
+//-----------------------------------------------------------------------------
+// Batch rendering
+// ===============
+//
+// Renders card backs to png, svg or pdf files without a window. Jobs are read from an
+// xml file like:
+//
+// <BatchJobs>
+//   <Job generator="stripes" config="presets/stripes.xml" seed="12" output="out/stripes_12.png" />
+//   <Job generator="rooms" seed="100" seed_count="500" output="out/rooms.png" />
+// </BatchJobs>
+//
+// generator is one of "lines", "rooms" or "stripes". seed overrides the seed
+// in the config, unless it's negative. seed_count renders that many seeds
+// starting from seed, and appends the seed to the output filename
+// (out/rooms_100.png, out/rooms_101.png ...). palette_size > 0 reduces the
+// palette image to that many colors.
+//
+// clut is a color lookup image in the format post fx uses
+// (data/weather_gfx/clut_day.png), it's applied after the overlay. If
+// clut_next is given too, the result is blended towards it by
+// clut_interpolation (0 - 1), like the post fx shader does between two times
+// of the day.
+//
+// antialias takes n x n samples per pixel, 1 - 4. The default is 1, no
+// antialiasing.
+//
+// glow_sigma > 0 adds a glow before the color lookup: the parts brighter than
+// glow_threshold (0 - 1) are blurred that much and added back, multiplied by
+// glow_strength.
+//
+// If output ends in .svg or .pdf, the polygons are written as vector paths
+// instead (see misc_utils/vector_export.h). The overlay, clut and glow are
+// skipped for those.
+//
+// Every image is generated, rasterized and saved on its own, so they're
+// spread over a thread pool. thread_count <= 0 uses all the cores.
+//-----------------------------------------------------------------------------
+#ifndef INC_BATCH_RENDER_H
+#define INC_BATCH_RENDER_H
+
+#include <string>
+
+// Returns the number of images that failed.
+int RunBatchRender( const std::string& job_file, int thread_count = 0 );
+
+#endif
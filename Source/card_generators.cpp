@@ -0,0 +1,419 @@
+#include "card_generators.h"
+
+#include <utils/color/color_utils.h>
+#include <utils/math/math_utils.h>
+#include <utils/random/random.h>
+#include <utils/imagetoarray/imagetoarray.h>
+
+// --- colors -----
+
+void LoadColors( const std::string& filename, ColorPalette& palette, int max_colors )
+{
+	std::vector< poro::types::Uint32 >& colors = palette.colors;
+	colors.clear();
+	palette.closest.Clear();
+	palette.version++;
+	using namespace imagetoarray;
+	const TempTexture* t = GetImageCache().Acquire( filename );
+	if( t == NULL )
+		return;
+
+	GetUniqueColors( t, colors );
+	if( max_colors > 0 && (int)colors.size() > max_colors )
+		QuantizeColors( t, max_colors, colors );
+
+	GetImageCache().Release( t );
+	palette.closest.Build( colors );
+}
+
+namespace {
+
+poro::types::fcolor GetRandomColor( const ColorPalette& palette, ceng::CLGMRandom* randomizer )
+{
+	int i = 0;
+	if( randomizer && palette.colors.empty() == false )
+	{
+		i = randomizer->Random( 0, (int)palette.colors.size() - 1 );
+	}
+
+	ceng::CColorFloat cf;
+	cf.Set32( palette.colors[i] );
+	return poro::GetFColor( cf.GetB(), cf.GetG(), cf.GetR(), 1.f );
+}
+
+poro::types::fcolor FindClosestColor( const ColorPalette& palette, ceng::CColorFloat o_color )
+{
+	const int closest_i = palette.closest.FindClosest( o_color );
+
+	ceng::CColorFloat cf;
+	cf.Set32( palette.colors[closest_i] );
+	return poro::GetFColor( cf.GetB(), cf.GetG(), cf.GetR(), 1.f );
+}
+
+poro::types::fcolor CycleColors( const ColorPalette& palette, int index, ceng::CLGMRandom* randomizer )
+{
+	if( randomizer ) index += randomizer->Random( 0, 3 );
+
+	ceng::CColorFloat cf;
+	cf.Set32( palette.colors[index % palette.colors.size()] );
+	return poro::GetFColor( cf.GetB(), cf.GetG(), cf.GetR(), 1.f );
+}
+
+void AddTriangle( PolygonBuffer& result, const types::vector2& a, const types::vector2& b, const types::vector2& c, const poro::types::fcolor& color )
+{
+	const int p = result.AddPolygon( 3 );
+	poro::types::vec2* vert = result.GetVertices( p );
+	vert[0] = poro::types::vec2( a.x, a.y );
+	vert[1] = poro::types::vec2( b.x, b.y );
+	vert[2] = poro::types::vec2( c.x, c.y );
+	result.SetColor( p, color );
+}
+
+// the vertices are in triangle strip order
+void AddQuad( PolygonBuffer& result, const types::vector2& a, const types::vector2& b, const types::vector2& c, const types::vector2& d, const poro::types::fcolor& color )
+{
+	const int p = result.AddPolygon( 4 );
+	poro::types::vec2* vert = result.GetVertices( p );
+	vert[0] = poro::types::vec2( a.x, a.y );
+	vert[1] = poro::types::vec2( b.x, b.y );
+	vert[2] = poro::types::vec2( c.x, c.y );
+	vert[3] = poro::types::vec2( d.x, d.y );
+	result.SetColor( p, color );
+}
+
+} // end of anonymous namespace
+
+// ----------------------------------------------------------------------------
+
+void TrianglesLine( const ConfigTriangle& config, const ColorPalette& palette, PolygonBuffer& triangles )
+{
+	triangles.Clear();
+	if( palette.colors.empty() ) return;
+
+	const float height = config.height;
+	const float width = config.width_percent * height;
+	const float SCREEN_WIDTH = 850;
+	const float SCREEN_HEIGHT = 1125;
+
+	ceng::CLGMRandom randomizer;
+	randomizer.SetSeed( config.seed );
+
+	bool random_colors = false;
+	const float color_random = config.color_random;
+
+	const int count_height = SCREEN_HEIGHT / height;
+	const int count_width = SCREEN_WIDTH / width;
+
+	const float color_width = config.screen_width / width;
+	const float color_height = config.screen_height / height;
+
+	triangles.Reserve( 2 * ( count_height + 1 ) * ( count_width + 2 ), 6 * ( count_height + 1 ) * ( count_width + 2 ) );
+
+	for( int iy = 0; iy < count_height + 1; iy++ )
+	{
+		for( int ix = -1; ix < count_width + 1; ix++ )
+		{
+			float x = ((float)ix) * width;
+			float y = ((float)iy) * height;
+
+			if( config.offsetted && iy % 2 == 0 )
+			{
+				x += 0.5f * width;
+			}
+
+			// 2 at a time
+			poro::types::fcolor color;
+			if( random_colors )
+			{
+				color = GetRandomColor( palette, &randomizer );
+			}
+			else
+			{
+				types::fcolor fc;
+				fc.r = ceng::math::Clamp( 1.f - ( (float)ix / (float)color_width ), 0.f, 1.f );
+				fc.g = ceng::math::Clamp( ( (float)iy / (float)color_height ), 0.f, 1.f );
+				fc.b = ceng::math::Clamp( ( (float)ix / (float)color_width ), 0.f, 1.f );
+
+				fc.g *= ( 2.f + fc.r ) / 3.f;
+
+				fc.r += randomizer( -color_random, color_random );
+				fc.g += randomizer( -color_random, color_random );
+				fc.b += randomizer( -color_random, color_random );
+				color = FindClosestColor( palette, fc );
+			}
+
+			AddTriangle( triangles,
+				types::vector2( x, y + height ),
+				types::vector2( x + width * 0.5f, y ),
+				types::vector2( x + width, y + height ),
+				color );
+
+			if( random_colors )
+			{
+				color = GetRandomColor( palette, &randomizer );
+			}
+			else
+			{
+				types::fcolor fc;
+				fc.r = ceng::math::Clamp( 1.f - ( (float)ix / (float)color_width ), 0.f, 1.f );
+				fc.g = ceng::math::Clamp( ( (float)iy / (float)color_height ), 0.f, 1.f );
+				fc.b = ceng::math::Clamp( ( (float)ix / (float)color_width ), 0.f, 1.f );
+
+				fc.g *= ( 2.f + fc.r ) / 3.f;
+
+				fc.r += randomizer( -color_random, color_random );
+				fc.g += randomizer( -color_random, color_random );
+				fc.b += randomizer( -color_random, color_random );
+				color = FindClosestColor( palette, fc );
+			}
+
+			AddTriangle( triangles,
+				types::vector2( x + width * 0.5f, y ),
+				types::vector2( x + width, y + height ),
+				types::vector2( x + width * 1.5f, y ),
+				color );
+		}
+	}
+
+	triangles.Translate( config.offset_x, config.offset_y );
+}
+
+// ----------------------------------------------------------------------------
+
+void TriangleRooms( const ConfigRoom& room_config, const ColorPalette& palette, PolygonBuffer& triangles )
+{
+	triangles.Clear();
+	if( palette.colors.empty() ) return;
+
+	const types::vector2 offset( room_config.offset_x, room_config.offset_y );
+	const types::vector2 size( room_config.screen_width, room_config.screen_height );
+
+	const types::vector2 center_p = 0.5f * size;
+
+	ceng::CLGMRandom randomizer;
+	randomizer.SetSeed( room_config.seed );
+
+	std::vector< types::vector2 > corners(4);
+
+	// add the center box
+	types::vector2 center_top = center_p;
+	types::vector2 center_bottom = center_p;
+	center_top.y -= room_config.box_height_p * size.y;
+	center_bottom.y += room_config.box_height_p * size.y;
+
+	// GetRandomColor() results are overwritten by CycleColors(), but the calls
+	// are kept so that the same seed still gives the same card
+	{
+
+		corners[0].Set( center_top.x - size.x * room_config.box_width_p, center_top.y );
+		corners[1].Set( center_top.x + size.x * room_config.box_width_p, center_top.y );
+		corners[2].Set( center_top.x + size.x * room_config.box_width_p, center_bottom.y );
+		corners[3].Set( center_top.x - size.x * room_config.box_width_p, center_bottom.y );
+
+		// left box
+		GetRandomColor( palette, &randomizer );
+		AddQuad( triangles,
+			types::vector2( center_top.x - size.x * room_config.box_width_p, center_top.y ),
+			types::vector2( center_top.x , center_top.y ),
+			types::vector2( center_top.x - size.x * room_config.box_width_p, center_bottom.y ),
+			types::vector2( center_top.x , center_bottom.y ),
+			CycleColors( palette, 0, NULL ) );
+
+		// right box
+		GetRandomColor( palette, &randomizer );
+		AddQuad( triangles,
+			types::vector2( center_top.x + size.x * room_config.box_width_p, center_top.y ),
+			types::vector2( center_top.x , center_top.y ),
+			types::vector2( center_top.x + size.x * room_config.box_width_p, center_bottom.y ),
+			types::vector2( center_top.x , center_bottom.y ),
+			CycleColors( palette, 1, NULL ) );
+
+		// left triangle
+		GetRandomColor( palette, &randomizer );
+		AddTriangle( triangles,
+			types::vector2( center_top.x - size.x * room_config.box_width_p, center_p.y ),
+			types::vector2( center_top.x , center_p.y - 0.5f * size.x * room_config.box_width_p ),
+			types::vector2( center_top.x , center_p.y + 0.5f * size.x * room_config.box_width_p ),
+			CycleColors( palette, 1, NULL ) );
+
+		// right triangle
+		GetRandomColor( palette, &randomizer );
+		AddTriangle( triangles,
+			types::vector2( center_top.x + size.x * room_config.box_width_p, center_p.y ),
+			types::vector2( center_top.x , center_p.y - 0.5f * size.x * room_config.box_width_p ),
+			types::vector2( center_top.x , center_p.y + 0.5f * size.x * room_config.box_width_p ),
+			CycleColors( palette, 2, NULL ) );
+	}
+
+	// generate the thing
+	{
+		using namespace ceng::math;
+
+
+		const types::vector2 top_left( 0, 0 );
+		const types::vector2 top_right( room_config.screen_width, 0 );
+		const types::vector2 bottom_right( room_config.screen_width, room_config.screen_height );
+		const types::vector2 bottom_left( 0, room_config.screen_height );
+
+		poro::types::fcolor color;
+
+		for( int i = 0; i < room_config.n_boxes; ++i )
+		{
+			float low = ( (float)i / (float)room_config.n_boxes );
+			float high = ( ((float)i+1) / (float)room_config.n_boxes );
+
+			if( room_config.normalized_boxes )
+			{
+				low = 1.f - low;
+				low = low * low;
+				low = 1.f - low;
+
+				high = 1.f - high;
+				high = high * high;
+				high = 1.f - high;
+			}
+
+			// top box
+			GetRandomColor( palette, &randomizer );
+			color = CycleColors( palette, i + room_config.color_offset2, &randomizer );
+			AddQuad( triangles,
+				Lerp( top_left, corners[0], low ),
+				Lerp( top_right, corners[1], low ),
+				Lerp( top_left, corners[0], high ),
+				Lerp( top_right, corners[1], high ),
+				color );
+
+			// right box
+			GetRandomColor( palette, &randomizer );
+			color = CycleColors( palette, i + room_config.color_offset3, &randomizer );
+			AddQuad( triangles,
+				Lerp( top_right, corners[1], low ),
+				Lerp( top_right, corners[1], high ),
+				Lerp( bottom_right, corners[2], low ),
+				Lerp( bottom_right, corners[2], high ),
+				color );
+
+			// bottom box
+			GetRandomColor( palette, &randomizer );
+			color = CycleColors( palette, i + room_config.color_offset4, &randomizer );
+			AddQuad( triangles,
+				Lerp( bottom_left, corners[3], low ),
+				Lerp( bottom_right, corners[2], low ),
+				Lerp( bottom_left, corners[3], high ),
+				Lerp( bottom_right, corners[2], high ),
+				color );
+
+			// left box
+			GetRandomColor( palette, &randomizer );
+			color = CycleColors( palette, i + room_config.color_offset1, &randomizer );
+			AddQuad( triangles,
+				Lerp( top_left, corners[0], low ),
+				Lerp( top_left, corners[0], high ),
+				Lerp( bottom_left, corners[3], low ),
+				Lerp( bottom_left, corners[3], high ),
+				color );
+		}
+	}
+
+	triangles.Translate( offset.x, offset.y );
+}
+
+// ----------------------------------------------------------------------------
+
+void DoStripes( const ConfigStripes& stripes_config, const ColorPalette& palette, PolygonBuffer& triangles )
+{
+
+	triangles.Clear();
+	if( palette.colors.empty() ) return;
+
+	const types::vector2 offset( stripes_config.offset_x, stripes_config.offset_y );
+	const types::vector2 size( stripes_config.screen_width, stripes_config.screen_height );
+
+	ceng::CLGMRandom randomizer;
+	randomizer.SetSeed( stripes_config.seed );
+
+	float lengths[10] = { 0 };
+	lengths[1] = stripes_config.stripe_l1;
+	lengths[2] = stripes_config.stripe_l2;
+	lengths[3] = stripes_config.stripe_l3;
+	lengths[4] = stripes_config.stripe_l4;
+	lengths[5] = stripes_config.stripe_l5;
+	lengths[6] = stripes_config.stripe_l6;
+	lengths[7] = stripes_config.stripe_l7;
+	lengths[8] = stripes_config.stripe_l8;
+	lengths[9] = stripes_config.stripe_l9;
+
+	int stripe_colors[10] = { 0 };
+	stripe_colors[1] = stripes_config.stripe_c1;
+	stripe_colors[2] = stripes_config.stripe_c2;
+	stripe_colors[3] = stripes_config.stripe_c3;
+	stripe_colors[4] = stripes_config.stripe_c4;
+	stripe_colors[5] = stripes_config.stripe_c5;
+	stripe_colors[6] = stripes_config.stripe_c6;
+	stripe_colors[7] = stripes_config.stripe_c7;
+	stripe_colors[8] = stripes_config.stripe_c8;
+	stripe_colors[9] = stripes_config.stripe_c9;
+
+	// add the center box
+	float pos_x = 0;
+	while( pos_x < stripes_config.screen_width )
+	{
+		for( int i = 1; i <= stripes_config.stripe_count; ++i )
+		{
+			float width = lengths[i];
+			int color = stripe_colors[i];
+
+			width *= stripes_config.scale_x;
+
+			AddQuad( triangles,
+				types::vector2( pos_x, 0 ),
+				types::vector2( pos_x + width, 0 ),
+				types::vector2( pos_x, stripes_config.screen_height ),
+				types::vector2( pos_x + width, stripes_config.screen_height ),
+				CycleColors( palette, color, NULL ) );
+
+			pos_x += width;
+
+			if( pos_x >= stripes_config.screen_width )
+				break;
+		}
+	}
+
+	triangles.Translate( offset.x, offset.y );
+}
+
+// ----------------------------------------------------------------------------
+
+double CardBackSettings::GetSeed() const
+{
+	if( generator == "lines" )	return lines.seed;
+	if( generator == "rooms" )	return rooms.seed;
+	return stripes.seed;
+}
+
+void CardBackSettings::SetSeed( double seed )
+{
+	lines.seed = seed;
+	rooms.seed = seed;
+	stripes.seed = seed;
+}
+
+bool GenerateCardBack( const CardBackSettings& settings, PolygonBuffer& result )
+{
+	result.Clear();
+	if( settings.palette == NULL || settings.palette->colors.empty() )
+		return false;
+
+	if( settings.generator == "lines" )
+		TrianglesLine( settings.lines, *settings.palette, result );
+	else if( settings.generator == "rooms" )
+		TriangleRooms( settings.rooms, *settings.palette, result );
+	else if( settings.generator == "stripes" )
+		DoStripes( settings.stripes, *settings.palette, result );
+	else
+		return false;
+
+	return true;
+}
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,153 @@
+//-----------------------------------------------------------------------------
+// Card back generators
+// ====================
+//
+// TrianglesLine(), TriangleRooms() and DoStripes() build the polygons of one
+// card back into a PolygonBuffer. Triangles are 3 vertex polygons and the
+// quads are 4 vertices in triangle strip order. The generators only read
+// the config and the palette they're given and write into result, so
+// several of them can run at the same time on different threads (the batch
+// renderer does that).
+//
+// The palette is loaded with LoadColors().
+//-----------------------------------------------------------------------------
+#ifndef INC_CARD_GENERATORS_H
+#define INC_CARD_GENERATORS_H
+
+#include <vector>
+#include <string>
+#include <poro/poro_types.h>
+#include <utils/math/cvector2.h>
+#include <utils/color/cpalette_index.h>
+
+#include "misc_utils/config_ui.h"
+#include "misc_utils/polygon_buffer.h"
+
+//-----------------------------------------------------------------------------
+
+// The colors are 0xRRGGBB. closest is built by LoadColors() and finds the
+// closest palette color for FindClosestColor(). version goes up every time
+// LoadColors() changes the palette.
+struct ColorPalette
+{
+	ColorPalette() : colors(), closest(), version( 0 ) { }
+
+	std::vector< poro::types::Uint32 >	colors;
+	ceng::CPaletteIndex					closest;
+	int									version;
+};
+
+//-----------------------------------------------------------------------------
+
+#define CONFIG_TRIANGLE_LINES(list_) \
+	list_(float,			height,					138.4f,			MetaData( 10.f, 512.f ) ) \
+	list_(float,			width_percent,			0.9588f,		MetaData( 0.01f, 1.f ) ) \
+	list_(bool,				offsetted,				true,			NULL ) \
+	list_(float,			color_random,			0.1f,			MetaData( 0.f, 1.f ) ) \
+	list_(bool,				non_random_colors,		true,			NULL ) \
+	list_(float,			offset_x,				82.f,			MetaData( 0.f, 512.f ) ) \
+	list_(float,			offset_y,				78.f,			MetaData( 0.f, 512.f ) ) \
+	list_(float,			screen_width,			640.f,			MetaData( 0.f, 2048.f ) ) \
+	list_(float,			screen_height,			1419,			MetaData( 0.f, 1596.f ) ) \
+	list_(bool,				white_lines,			false,			NULL ) \
+	list_(float,			line_width,				1.5f,			MetaData( 0.f, 5.f ) ) \
+	list_(float,			line_alpha,				1.0f,			MetaData( 0.f, 1.f ) ) \
+	list_(double,			seed,					1234,			MetaData( 0, 10000 ) ) \
+
+
+DEFINE_CONFIG_UI( ConfigTriangle, CONFIG_TRIANGLE_LINES );
+#undef CONFIG_TRIANGLE_LINES
+
+// ----------------------------------------------------------------------------
+
+#define CONFIG_ROOM(list_) \
+	list_(float,			offset_x,				82.f,			MetaData( 0.f, 512.f ) ) \
+	list_(float,			offset_y,				78.f,			MetaData( 0.f, 512.f ) ) \
+	list_(float,			screen_width,			662.f,			MetaData( 1.f, 2048.f ) ) \
+	list_(float,			screen_height,			968.f,			MetaData( 1.f, 1596.f ) ) \
+	list_(float,			box_width_p,			0.077f,			MetaData( 0.f, 1.f ) ) \
+	list_(float,			box_height_p,			0.23f,			MetaData( 0.f, 1.f ) ) \
+	list_(float,			color_random,			0.1f,			MetaData( 0.f, 1.f ) ) \
+	list_(int,				n_boxes,				5,				MetaData( 1, 20 ) ) \
+	list_(int,				color_offset1,			0,				MetaData( 0, 10 ) ) \
+	list_(int,				color_offset2,			1,				MetaData( 0, 10 ) ) \
+	list_(int,				color_offset3,			2,				MetaData( 0, 10 ) ) \
+	list_(int,				color_offset4,			3,				MetaData( 0, 10 ) ) \
+	list_(bool,				normalized_boxes,		false,			NULL  ) \
+	list_(bool,				white_lines,			false,			NULL ) \
+	list_(float,			line_width,				1.5f,			MetaData( 0.f, 5.f ) ) \
+	list_(float,			line_alpha,				1.0f,			MetaData( 0.f, 1.f ) ) \
+	list_(double,			seed,					1234,			MetaData( 0, 10000 ) ) \
+
+
+DEFINE_CONFIG_UI( ConfigRoom, CONFIG_ROOM );
+#undef CONFIG_ROOM
+
+// ----------------------------------------------------------------------------
+
+#define CONFIG_STRIPES(list_) \
+	list_(float,			offset_x,				82.f,			MetaData( 0.f, 512.f ) ) \
+	list_(float,			offset_y,				78.f,			MetaData( 0.f, 512.f ) ) \
+	list_(float,			screen_width,			662.f,			MetaData( 1.f, 2048.f ) ) \
+	list_(float,			screen_height,			968.f,			MetaData( 1.f, 1596.f ) ) \
+	list_(float,			scale_x,				1.f,			MetaData( 0.0001f, 3.f ) ) \
+	list_(int,				stripe_count,			4,				MetaData( 0, 10 ) ) \
+	list_(float,			stripe_l1,				100.f,			MetaData( 0.f, 1024.f ) ) \
+	list_(float,			stripe_l2,				100.f,			MetaData( 0.f, 1024.f ) ) \
+	list_(float,			stripe_l3,				100.f,			MetaData( 0.f, 1024.f ) ) \
+	list_(float,			stripe_l4,				100.f,			MetaData( 0.f, 1024.f ) ) \
+	list_(float,			stripe_l5,				100.f,			MetaData( 0.f, 1024.f ) ) \
+	list_(float,			stripe_l6,				100.f,			MetaData( 0.f, 1024.f ) ) \
+	list_(float,			stripe_l7,				100.f,			MetaData( 0.f, 1024.f ) ) \
+	list_(float,			stripe_l8,				100.f,			MetaData( 0.f, 1024.f ) ) \
+	list_(float,			stripe_l9,				100.f,			MetaData( 0.f, 1024.f ) ) \
+	list_(int,				stripe_c1,				0,				MetaData( 0, 10 ) ) \
+	list_(int,				stripe_c2,				1,				MetaData( 0, 10 ) ) \
+	list_(int,				stripe_c3,				2,				MetaData( 0, 10 ) ) \
+	list_(int,				stripe_c4,				3,				MetaData( 0, 10 ) ) \
+	list_(int,				stripe_c5,				4,				MetaData( 0, 10 ) ) \
+	list_(int,				stripe_c6,				5,				MetaData( 0, 10 ) ) \
+	list_(int,				stripe_c7,				6,				MetaData( 0, 10 ) ) \
+	list_(int,				stripe_c8,				7,				MetaData( 0, 10 ) ) \
+	list_(int,				stripe_c9,				8,				MetaData( 0, 10 ) ) \
+	list_(double,			seed,					1234,			MetaData( 0, 10000 ) ) \
+
+
+DEFINE_CONFIG_UI( ConfigStripes, CONFIG_STRIPES );
+#undef CONFIG_STRIPES
+
+// ----------------------------------------------------------------------------
+
+// Every distinct color of the image, in the order they appear. If max_colors
+// is set and the image has more colors than that, it's reduced to 
+// max_colors with median cut.
+void LoadColors( const std::string& filename, ColorPalette& result, int max_colors = 0 );
+
+void TrianglesLine( const ConfigTriangle& config, const ColorPalette& colors, PolygonBuffer& result );
+void TriangleRooms( const ConfigRoom& config, const ColorPalette& colors, PolygonBuffer& result );
+void DoStripes( const ConfigStripes& config, const ColorPalette& colors, PolygonBuffer& result );
+
+// ----------------------------------------------------------------------------
+
+// Everything that's needed to generate one card back. generator is one of
+// "lines", "rooms" or "stripes" and picks which one of the configs is used.
+struct CardBackSettings
+{
+	CardBackSettings() : generator( "stripes" ), palette( NULL ) { }
+
+	std::string			generator;
+	ConfigTriangle		lines;
+	ConfigRoom			rooms;
+	ConfigStripes		stripes;
+	const ColorPalette*	palette;
+
+	double GetSeed() const;
+	void SetSeed( double seed );
+};
+
+// returns false if the generator is unknown or there's no palette
+bool GenerateCardBack( const CardBackSettings& settings, PolygonBuffer& result );
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -6,26 +6,24 @@
 
 void GTweenClearEntityOfTweens( SGF::Entity* e )
 {
-	std::list< GTween* >& list_of_gtweens = ceng::CAutoList< GTween >::GetList();
+	const std::vector< GTween* >& list_of_gtweens = GetGTweens();
 
-	for( std::list< GTween* >::iterator i = list_of_gtweens.begin();
-		i != list_of_gtweens.end(); ++i )
+	for( std::size_t i = 0; i < list_of_gtweens.size(); ++i )
 	{
-		GTween* tween = *i;
-		if( tween->HasPointer( e ) )
+		GTween* tween = list_of_gtweens[ i ];
+		if( tween && tween->HasPointer( e ) )
 			tween->Kill();
 	}
 }
 
 GTween* GetGTween( void* uses_pointer, const std::string& name )
 {
-	std::list< GTween* >& list_of_gtweens = ceng::CAutoList< GTween >::GetList();
+	const std::vector< GTween* >& list_of_gtweens = GetGTweens();
 
-	for( std::list< GTween* >::iterator i = list_of_gtweens.begin();
-		i != list_of_gtweens.end(); ++i )
+	for( std::size_t i = 0; i < list_of_gtweens.size(); ++i )
 	{
-		GTween* tween = *i;
-		if( tween->IsDead() == false && tween->GetName() == name && tween->HasPointer( uses_pointer ) )
+		GTween* tween = list_of_gtweens[ i ];
+		if( tween && tween->IsDead() == false && tween->GetName() == name && tween->HasPointer( uses_pointer ) )
 			return tween;
 	}
 
@@ -5,7 +5,9 @@
 #include <tester/tester_console.h>
 #include <utils/vector_utils/vector_utils.h>
 #include <utils/string/string.h>
+#include <utils/xml/cxmlbinary.h>
 #include "procedural_triangles.h"
+#include "batch_render.h"
 
 //-----------------------------------------------------------------------------
 
@@ -39,6 +41,18 @@ int main(int argc, char *argv[])
 {
 	std::vector< std::string > args = ceng::ArgsToVector(argc, argv);
 	RunTests();
+
+	// headless rendering, no window or OpenGL needed
+	if( HasArgument( "-batch", args ) )
+		return RunBatchRender( GetArgumentParam( "-batch", args, "batch_jobs.xml" ), ceng::CastFromString< int >( GetArgumentParam( "-threads", args, "0" ) ) );
+
+	// converts a xml data file to the binary format, loading reads both
+	if( HasArgument( "-xml2bin", args ) )
+	{
+		const std::string input = GetArgumentParam( "-xml2bin", args );
+		return ceng::XmlConvertFileToBinary( input, GetArgumentParam( "-out", args, input + ".bin" ) ) ? 0 : 1;
+	}
+
 	// no need to save anything...
 	// ceng::XmlSaveToFile( GD.mConfigDo, config_file, "Config" );
 
@@ -69,11 +83,27 @@ int main(int argc, char *argv[])
 		appconf.framerate = 60;
 
 		appconf.SetRandomSeed = ceng::SetRandomSeeds;
+
+		// the slider ui is lots of small sprites, this way most of it is
+		// drawn with a few draw calls
+		appconf.graphics_settings.textures_atlas = true;
+		appconf.graphics_settings.buffered_textures = true;
+		appconf.graphics_settings.buffered_textures_sort = true;
 		appconf.record_events = true;
 
 		/*appconf.do_a_playback = true;
 		appconf.playback_file = "playbacks/140214-175946-playback-8384.poro_plbk";*/
 
+		// -playback file [-fast], with -fast the recording is played back as
+		// fast as possible and the timings are printed at the end
+		if( HasArgument( "-playback", args ) )
+		{
+			appconf.record_events = false;
+			appconf.do_a_playback = true;
+			appconf.playback_file = GetArgumentParam( "-playback", args );
+			appconf.playback_fast = HasArgument( "-fast", args );
+		}
+
 		// poro::RunPoro< DeckViewerApp >( appconf );
 		// poro::RunPoro< LuaUITest >(appconf);
 		poro::RunPoro< ProceduralTriangles >(appconf);
@@ -17,6 +17,7 @@ DEFINE_CONFIG_UI( Biome, CONFIG_BIOME );
 #include <map>
 #include <string>
 #include <utils/xml/canycontainer.h>
+#include <utils/string/string.h>
 
 #include "metadata.h"
 #include "config_sliders.h"
@@ -43,6 +44,11 @@ public:
 	
 	virtual IConfigBase*							GetMetaObject( const std::string& member_name ) = 0;
 
+	//----- change tracking -------
+	// hash of all the values, if this is the same as last time nothing has
+	// changed
+	virtual unsigned int							GetHash() const = 0;
+
 	template< class T >
 	T GetValueAs( const std::string& n ) const {
 		return ceng::CAnyContainerCast< T >( GetValue( n ) );
@@ -100,6 +106,52 @@ ceng::IConfigBase* TEMPLATE_HACK_GET_AS_META_OBJECT( T& variable, const int& nul
 	return NULL;
 }
 
+// -- hash helpers --
+// FNV-1a
+
+inline unsigned int ConfigUIHashBytes( unsigned int hash, const void* data, std::size_t size )
+{
+	const unsigned char* bytes = static_cast< const unsigned char* >( data );
+	for( std::size_t i = 0; i < size; ++i )
+	{
+		hash ^= bytes[ i ];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+inline unsigned int ConfigUIHashValue( unsigned int hash, bool value )			{ return ConfigUIHashBytes( hash, &value, sizeof( value ) ); }
+inline unsigned int ConfigUIHashValue( unsigned int hash, int value )			{ return ConfigUIHashBytes( hash, &value, sizeof( value ) ); }
+inline unsigned int ConfigUIHashValue( unsigned int hash, unsigned int value )	{ return ConfigUIHashBytes( hash, &value, sizeof( value ) ); }
+inline unsigned int ConfigUIHashValue( unsigned int hash, float value )			{ return ConfigUIHashBytes( hash, &value, sizeof( value ) ); }
+inline unsigned int ConfigUIHashValue( unsigned int hash, double value )		{ return ConfigUIHashBytes( hash, &value, sizeof( value ) ); }
+
+inline unsigned int ConfigUIHashValue( unsigned int hash, const std::string& value )
+{
+	hash = ConfigUIHashValue( hash, (unsigned int)value.size() );
+	return ConfigUIHashBytes( hash, value.c_str(), value.size() );
+}
+
+// MetaObjects hash their own members, anything else goes through 
+// CastToString()
+template< class T >
+unsigned int ConfigUIHashOther( unsigned int hash, const T& value, const IConfigBase* meta_object )
+{
+	return ConfigUIHashValue( hash, meta_object->GetHash() );
+}
+
+template< class T >
+unsigned int ConfigUIHashOther( unsigned int hash, const T& value, const void* other )
+{
+	return ConfigUIHashValue( hash, ceng::CastToString( value ) );
+}
+
+template< class T >
+unsigned int ConfigUIHashValue( unsigned int hash, const T& value )
+{
+	return ConfigUIHashOther( hash, value, &value );
+}
+
 // -- Serialize helper --
 
 template< class T > 
@@ -203,6 +255,9 @@ void TEMPLATE_HACK_FOR_XML_Bind( ceng::CXmlFileSys* filesys, T& variable, const
 #define CONFIG_UI_GET_CONFIGSLIDERS(type, name, value, meta_data) \
 	AddToConfigSlidersImpl( _temp_configsliders_result, name, #name, meta_data );
 
+#define CONFIG_UI_HASH(type, name, value, meta_data) \
+	_temp_hash = ceng::ConfigUIHashValue( _temp_hash, name );
+
 #define CONFIG_UI_GET_META_OBJECT(type, name, value, meta_data) \
 	if( #name == member_name && ceng::SerializeIsMetaObject( meta_data ) ) return ceng::TEMPLATE_HACK_GET_AS_META_OBJECT( name, meta_data );
 
@@ -293,6 +348,13 @@ void TEMPLATE_HACK_FOR_XML_Bind( ceng::CXmlFileSys* filesys, T& variable, const
 			return static_cast< ceng::IConfigBase* >( _temp_configsliders_result ); \
 		} \
 		\
+		unsigned int GetHash() const \
+		{ \
+			unsigned int _temp_hash = 2166136261u; \
+			list(CONFIG_UI_HASH) \
+			return _temp_hash; \
+		} \
+		\
 	};
 
 
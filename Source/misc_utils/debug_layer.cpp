@@ -188,6 +188,8 @@ void DebugLayer::Exit()
 
 void DebugLayer::Update( float dt )
 {
+	SPROFILE_VALUE( "Draw calls", Poro()->GetGraphics()->GetDrawCallCount() );
+
 	if( mScreenshotter.get() ) mScreenshotter->Update( dt );
 	if( mProfilerViewer.get() ) mProfilerViewer->Update( dt );
 	if( mProfilerBars.get() )	mProfilerBars->Update( dt );
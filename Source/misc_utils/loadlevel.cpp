@@ -142,88 +142,66 @@ std::vector< RectData > LoadImageRectSimple( const std::string& filename )
 
 //-----------------------------------------------------------------------------
 
-// template< class TileType, class Converter >
 ceng::CArray2D< TileType > LoadGameDataFromImage( const std::string& filename, TileConverter* converter )
 {
-	TempTexture* surface = GetTexture( filename );
-	// SDL_Surface* temp = SDL_LoadBMP( filename.c_str() );
-
-	if( surface == NULL || surface->data == NULL )
+	// the pixels come from the image cache, the tiles go through converter
+	ceng::CArray2D< Uint32 > pixels;
+	if( LoadImage( filename, pixels, false ) == false )
 	{
 		std::cout << "GenerateMapFromImage() - Failed to load image: " << filename << std::endl;
 		return ceng::CArray2D< TileType >();
 	}
-	
 
-	ceng::CArray2D< TileType > wall_grid( surface->w, surface->h );
+	ceng::CArray2D< TileType > wall_grid( pixels.GetWidth(), pixels.GetHeight() );
 
-	if( surface )
+	for( int y = 0; y < pixels.GetHeight(); ++y )
 	{
-		for( int y = 0; y < surface->h; ++y )
+		for( int x = 0; x < pixels.GetWidth(); ++x )
 		{
-			for( int x = 0; x < surface->w; ++x )
-			{
-				Uint32 p = GetPixel( surface, x, y );
-				
-				wall_grid[ x ][ y ] = TileType();
+			const Uint32 p = pixels.At( x, y );
 
-				if( p == 0 ) 
-					continue;
+			wall_grid[ x ][ y ] = TileType();
 
-				TileType type = p;
-				if( converter ) 
-					type = converter->GetTypeForColor( p );
-				wall_grid[ x ][ y ] = type;
-			}
+			if( p == 0 ) 
+				continue;
+
+			TileType type = p;
+			if( converter ) 
+				type = converter->GetTypeForColor( p );
+			wall_grid[ x ][ y ] = type;
 		}
 	}
 
-	delete surface;
-	// SDL_FreeSurface( surface );
 	return wall_grid;
 }
 
 
 //-----------------------------------------------------------------------------
 
-// this is just a copy of the above thing, templates, should work with headers!!!
 ceng::CArray2D< Uint32 > LoadDataFromImage( const std::string& filename, ImageLevelReader< Uint32, Uint32Cmpr >* converter )
 {
-	TempTexture* surface = GetTexture( filename );
-
-	if( surface == NULL || surface->data == NULL )
+	// the image goes through the image cache, so loading the same file again
+	// doesn't decode it again
+	ceng::CArray2D< Uint32 > wall_grid;
+	if( LoadImage( filename, wall_grid, false ) == false )
 	{
 		std::cout << "GenerateMapFromImage() - Failed to load image: " << filename << std::endl;
 		return ceng::CArray2D< Uint32 >();
 	}
 
-	ceng::CArray2D< Uint32 > wall_grid( surface->w, surface->h );
-
-	if( surface )
+	if( converter )
 	{
-		for( int y = 0; y < surface->h; ++y )
+		for( int y = 0; y < wall_grid.GetHeight(); ++y )
 		{
-			for( int x = 0; x < surface->w; ++x )
+			for( int x = 0; x < wall_grid.GetWidth(); ++x )
 			{
-				Uint32 p = GetPixel( surface, x, y );
-				
-				wall_grid[ x ][ y ] = Uint32();
-
-				if( p == 0 ) 
-					continue;
-
-				Uint32 type = p;
-				if( converter )
-					type = converter->GetTypeForColor( p );
-
-				wall_grid[ x ][ y ] = type;
+				Uint32& p = wall_grid.Rand( x, y );
+				if( p != 0 ) 
+					p = converter->GetTypeForColor( p );
 			}
 		}
 	}
 
-	delete surface;
-	// SDL_FreeSurface( surface );
-
 	return wall_grid;
 }
 
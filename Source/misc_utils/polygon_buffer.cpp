@@ -0,0 +1,53 @@
+#include "polygon_buffer.h"
+
+//-----------------------------------------------------------------------------
+
+PolygonBuffer::PolygonBuffer() :
+	mVertices(),
+	mOffsets(),
+	mCounts(),
+	mColors()
+{
+}
+
+void PolygonBuffer::Clear()
+{
+	// clear() doesn't release the capacity
+	mVertices.clear();
+	mOffsets.clear();
+	mCounts.clear();
+	mColors.clear();
+}
+
+void PolygonBuffer::Reserve( int polygon_count, int vertex_count )
+{
+	mVertices.reserve( vertex_count );
+	mOffsets.reserve( polygon_count );
+	mCounts.reserve( polygon_count );
+	mColors.reserve( polygon_count );
+}
+
+//-----------------------------------------------------------------------------
+
+int PolygonBuffer::AddPolygon( int vertex_count )
+{
+	const int result = (int)mOffsets.size();
+
+	mOffsets.push_back( (int)mVertices.size() );
+	mCounts.push_back( vertex_count );
+	mColors.push_back( poro::types::fcolor() );
+	mVertices.resize( mVertices.size() + vertex_count );
+
+	return result;
+}
+
+void PolygonBuffer::Translate( float dx, float dy )
+{
+	for( std::size_t i = 0; i < mVertices.size(); ++i )
+	{
+		mVertices[ i ].x += dx;
+		mVertices[ i ].y += dy;
+	}
+}
+
+//-----------------------------------------------------------------------------
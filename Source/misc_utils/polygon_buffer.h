@@ -0,0 +1,96 @@
+//-----------------------------------------------------------------------------
+// PolygonBuffer
+// =============
+//
+// A flat container for a lot of small flat colored polygons. Instead of
+// every polygon owning its own vertex vector, all the vertices are in one
+// contiguous array and each polygon is an offset / count span into it, with
+// its color in a parallel array.
+//
+// Clear() keeps the memory, so a buffer that's regenerated every frame
+// stops allocating once it has grown to its working size.
+//
+// The vertices are kept as poro::types::vec2 so that the whole buffer can
+// be handed straight to IGraphics::DrawFillBatch() without copying.
+//
+// Usage:
+//	int p = buffer.AddPolygon( 3 );
+//	poro::types::vec2* v = buffer.GetVertices( p );
+//	v[0] = ...; v[1] = ...; v[2] = ...;
+//	buffer.SetColor( p, color );
+//
+// Pointers from GetVertices() are only valid until the next AddPolygon().
+//-----------------------------------------------------------------------------
+#ifndef INC_POLYGON_BUFFER_H
+#define INC_POLYGON_BUFFER_H
+
+#include <vector>
+#include <poro/poro_types.h>
+
+class PolygonBuffer
+{
+public:
+	PolygonBuffer();
+
+	// removes the polygons but keeps the memory
+	void Clear();
+	void Reserve( int polygon_count, int vertex_count );
+
+	bool Empty() const;
+	int  GetPolygonCount() const;
+	int  GetVertexCount() const;
+
+	//-------------------------------------------------------------------------
+
+	// adds a polygon with vertex_count vertices at 0,0, returns its index
+	int AddPolygon( int vertex_count );
+
+	int GetOffset( int polygon ) const;
+	int GetCount( int polygon ) const;
+
+	const poro::types::vec2*	GetVertices( int polygon ) const;
+	poro::types::vec2*			GetVertices( int polygon );
+
+	const poro::types::fcolor&	GetColor( int polygon ) const;
+	void						SetColor( int polygon, const poro::types::fcolor& color );
+
+	// moves every vertex in the buffer
+	void Translate( float dx, float dy );
+
+	//-------------------------------------------------------------------------
+
+	const std::vector< poro::types::vec2 >&		GetAllVertices() const;
+	const std::vector< int >&					GetAllOffsets() const;
+	const std::vector< int >&					GetAllCounts() const;
+	const std::vector< poro::types::fcolor >&	GetAllColors() const;
+
+private:
+	std::vector< poro::types::vec2 >	mVertices;
+	std::vector< int >					mOffsets;
+	std::vector< int >					mCounts;
+	std::vector< poro::types::fcolor >	mColors;
+};
+
+//-----------------------------------------------------------------------------
+
+inline bool PolygonBuffer::Empty() const					{ return mOffsets.empty(); }
+inline int PolygonBuffer::GetPolygonCount() const			{ return (int)mOffsets.size(); }
+inline int PolygonBuffer::GetVertexCount() const			{ return (int)mVertices.size(); }
+
+inline int PolygonBuffer::GetOffset( int polygon ) const	{ return mOffsets[ polygon ]; }
+inline int PolygonBuffer::GetCount( int polygon ) const		{ return mCounts[ polygon ]; }
+
+inline const poro::types::vec2* PolygonBuffer::GetVertices( int polygon ) const	{ return &mVertices[ mOffsets[ polygon ] ]; }
+inline poro::types::vec2* PolygonBuffer::GetVertices( int polygon )				{ return &mVertices[ mOffsets[ polygon ] ]; }
+
+inline const poro::types::fcolor& PolygonBuffer::GetColor( int polygon ) const				{ return mColors[ polygon ]; }
+inline void PolygonBuffer::SetColor( int polygon, const poro::types::fcolor& color )		{ mColors[ polygon ] = color; }
+
+inline const std::vector< poro::types::vec2 >& PolygonBuffer::GetAllVertices() const		{ return mVertices; }
+inline const std::vector< int >& PolygonBuffer::GetAllOffsets() const						{ return mOffsets; }
+inline const std::vector< int >& PolygonBuffer::GetAllCounts() const						{ return mCounts; }
+inline const std::vector< poro::types::fcolor >& PolygonBuffer::GetAllColors() const		{ return mColors; }
+
+//-----------------------------------------------------------------------------
+
+#endif
@@ -2,10 +2,12 @@
 
 #include <SDL.h>
 
-#include <map>
+#include <algorithm>
+#include <iostream>
 #include <math.h>
 #include <poro/poro.h>
 #include <utils/color/ccolor.h>
+#include <utils/color/cclut_baker.h>
 #include <utils/array2d/carray2d.h>
 #include <utils/imagetoarray/imagetoarray.h>
 #include <game_utils/actionscript/sprite.h>
@@ -37,23 +39,25 @@ namespace
 	{
 		int div = 256 / size;
 
+		// 255 / 4 rounds to 64, which would be outside of the clut
 		ceng::CColorUint8 result;
-		result.r = (ceng::CColorUint8::uint8)( ceng::math::Round( (double)( color.r ) / div ) );
-		result.g = (ceng::CColorUint8::uint8)( ceng::math::Round( (double)( color.g ) / div ) );
-		result.b = (ceng::CColorUint8::uint8)( ceng::math::Round( (double)( color.b ) / div ) );
+		result.r = (ceng::CColorUint8::uint8)( std::min< double >( size - 1, ceng::math::Round( (double)( color.r ) / div ) ) );
+		result.g = (ceng::CColorUint8::uint8)( std::min< double >( size - 1, ceng::math::Round( (double)( color.g ) / div ) ) );
+		result.b = (ceng::CColorUint8::uint8)( std::min< double >( size - 1, ceng::math::Round( (double)( color.b ) / div ) ) );
 		result.a = 0;
 
 		return result;
 	}
 
-	void GenerateCLUTFromArviFormat( TempTexture* identity_palette, ceng::CSafeArray< bool, long > defined_color_loopup, Uint32 size, std::string palette_filename )
+	// The colors of identity_palette are the cells of the clut that are
+	// defined and palette has the colors for them. The rest of the cells get
+	// the average of the closest defined cells, see ceng::CClutBaker.
+	void GenerateCLUTFromArviFormat( const std::string& identity_palette_filename, const std::string& palette_filename, Uint32 size = 64 )
 	{
 		int size_image = (int)sqrt( (double)size * size * size );
+		int div = 256 / size;
 
-		TempTexture* palette = GetTexture( palette_filename );
-		ceng::CSafeArray< Uint32, long > generated_clut( size * size * size );
-		std::map< Uint32, poro::types::vec3 > palette_hash;
-
+		ceng::CClutBaker baker( size );
 		for ( Uint32 r = 0; r < size; r++ )
 		{
 			for ( Uint32 g = 0; g < size; g++ )
@@ -61,17 +65,18 @@ namespace
 				for ( Uint32 b = 0; b < size; b++ )
 				{
 					unsigned int index = GetClut1dIndex( size, r, g, b );
-
-					generated_clut[ index ] = ceng::CColorUint8( r * 4, g * 4, b * 4 ).Get32();
-
+					baker.SetCell( index, ceng::CColorUint8( r * div, g * div, b * div ).Get32() );
 				}
 			}
 		}
 
+		TempTexture* identity_palette = GetTexture( identity_palette_filename );
+		TempTexture* palette = GetTexture( palette_filename );
+
 		// set the defined colors in the clut
-		if( identity_palette && palette 
+		if( identity_palette->data && palette->data
 			&& ( palette->w == identity_palette->w ) 
-			&& ( palette->h = identity_palette->h ))
+			&& ( palette->h == identity_palette->h ))
 		{
 			for( int y = 0; y < palette->h; ++y )
 			{
@@ -89,95 +94,22 @@ namespace
 					Uint32 blue = (0x000000ff & palette_color) << 16;
 
 					palette_color = ( palette_color & 0xff00ff00 ) | red | blue;
-					generated_clut[ index ] = palette_color;
-					
-					palette_hash.insert( std::pair< Uint32, poro::types::vec3 >( index, poro::types::vec3(identity_color.b, identity_color.g, identity_color.r) ) );
+					baker.SetDefined( index, palette_color );
 				}
 			}
 		}
-
-		// generate interpolated colors
-		for (Uint32 i = 0; i < size; i++)
+		else
 		{
-			for (Uint32 j = 0; j < size; j++)
-			{
-				for (Uint32 k = 0; k < size; k++)
-				{
-					Uint32 index = GetClut1dIndex( size, k, j, i );
-					bool is_defined_color = defined_color_loopup[ index ];
-
-					if (is_defined_color == false)
-					{
-						double r_accum = 0.0;
-						double g_accum = 0.0;
-						double b_accum = 0.0;
-						double a_accum = 0.0;
-						double weight_sum = 0.0;
-
-						double nearest_dist = std::numeric_limits<double>::max();
-
-						// interpolate the color from other colors
-						for ( std::map< Uint32, poro::types::vec3 >::iterator iter = palette_hash.begin(); iter != palette_hash.end(); ++iter )
-						{
-							Uint32 index_1d = iter->first;
-
-							if (index_1d != index)
-							{
-								Uint32 index_1d = iter->first;
-								int x2 = index_1d / ( size * size );
-								int y2 = (index_1d / size) % size;	
-								int z2 = index_1d % size;
-
-								double dist_x = x2 - i;
-								double dist_y = y2 - j;
-								double dist_z = z2 - k;
-
-								double dist = sqrt( dist_x * dist_x + dist_y * dist_y + dist_z * dist_z );
-
-								if (dist < nearest_dist)
-									nearest_dist = dist;
-							}
-						}
-						
-						// interpolate the color from other colors
-						for ( std::map< Uint32, poro::types::vec3 >::iterator iter = palette_hash.begin(); iter != palette_hash.end(); ++iter )
-						{
-							Uint32 index_1d = iter->first;
-							int x2 = index_1d / ( size * size );
-							int y2 = (index_1d / size) % size;	
-							int z2 = index_1d % size;
-
-							double dist_x = x2 - i;
-							double dist_y = y2 - j;
-							double dist_z = z2 - k;
-
-							double dist = sqrt( dist_x * dist_x + dist_y * dist_y + dist_z * dist_z );
-
-							double weight = 1 / dist;
-							
-							if (dist == nearest_dist)
-								weight = 1;
-							else
-								weight = 0;
-
-							ceng::CColorUint8 color = ceng::CColorUint8( generated_clut[ index_1d ] );
-							r_accum += color.r * weight;
-							g_accum += color.g * weight;
-							b_accum += color.b * weight;
-
-							weight_sum += weight;
-						}
-
-						generated_clut[ index ] = ceng::CColorUint8( 
-							(ceng::CColorUint8::uint8)( r_accum / weight_sum ),
-							(ceng::CColorUint8::uint8)( g_accum / weight_sum),
-							(ceng::CColorUint8::uint8)( b_accum / weight_sum) ).Get32();
-					}
-
-				}
-			}
+			std::cout << "GenerateCLUTFromArviFormat() - palettes don't match: " << identity_palette_filename << ", " << palette_filename << std::endl;
 		}
 
+		delete identity_palette;
+		delete palette;
+
+		// generate interpolated colors
+		baker.Bake();
+
+		const std::vector< ceng::CClutBaker::uint32 >& generated_clut = baker.GetCells();
 		ceng::CArray2D< Uint32 > image( size_image, size_image );
 		for( int y = 0; y < size_image; ++y )
 		{
@@ -187,33 +119,6 @@ namespace
 			}
 		}
 		SaveImage( "data/weather_gfx/palette_2_clut.png", image );
-
-		delete palette;
-	}
-
-	void GenerateCLUTFromArviFormat( std::string identity_palette_filename, std::string palette_filename, Uint32 size = 64 )
-	{
-		ceng::CSafeArray< bool, long > defined_color_lookup( size * size * size );
-		for (Uint32 i=0; i< size * size * size; i++)
-			defined_color_lookup[i] = 0;
-
-		TempTexture* identity_palette = GetTexture( identity_palette_filename );
-
-		for( int y = 0; y < identity_palette->h; ++y )
-		{
-			for( int x = 0; x < identity_palette->w; ++x )
-			{
-				Uint32 identity_color_32 = GetPixel( identity_palette, x, y, true );
-				ceng::CColorUint8 identity_color( identity_color_32 );
-				identity_color = GetNearest3dCoordInClut( size, identity_color );
-				unsigned int index = GetClut1dIndex( size, identity_color.b, identity_color.g, identity_color.r );
-				defined_color_lookup[ index ] = true;
-			}
-		}
-
-		GenerateCLUTFromArviFormat( identity_palette, defined_color_lookup, size, palette_filename );
-
-		delete identity_palette;
 	}
 
 } // end of anonymous namespace
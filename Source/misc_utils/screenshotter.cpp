@@ -289,6 +289,10 @@ void Screenshotter::Update( float dt )
 
 			if( dropbox_file.empty() == false )
 			{
+				// the screenshot is saved in the background, it has no date 
+				// before it's on the disk
+				Poro()->GetGraphics()->WaitForScreenshots();
+
 				std::string filedate_dropbox = ceng::GetDateForFile( dropbox_file );
 				std::string filedate_screenshot = ceng::GetDateForFile( filename );
 
@@ -321,8 +325,10 @@ void Screenshotter::OnKeyDown( int key, poro::types::charset unicode )
 
 		// copies the file to places
 		// if auto copy is enabled
-		if( true )
+		if( mCopyHere.empty() == false )
 		{
+			// the screenshot is written on another thread
+			Poro()->GetGraphics()->WaitForScreenshots();
 			for( std::size_t i = 0; i < mCopyHere.size(); ++i )
 				CopyScreenshotTo( filename, mCopyHere[ i ] );
 		}
@@ -363,6 +369,8 @@ void Screenshotter::OnKeyDown( int key, poro::types::charset unicode )
 		}
 		else // the end of a gif recording
 		{
+			Poro()->GetGraphics()->WaitForScreenshots();
+
 			std::stringstream ss;
 			ss << " -delay 1x30 " << mGifFilePath << "*.png " << ceng::GetParentPath( mGifFilePath ) << ".gif";
 			ExecuteProcess( PATH_TO_IMAGEMAGICK, ss.str() );
@@ -21,6 +21,9 @@
 
 #define SPROFILE_COLOR( x, color ) ::SimpleProfiler MACRO_JOIN( __profiler, __LINE__ ) ( x, __FILE__, color )
 
+// for stats that aren't times, like the number of draw calls in a frame
+#define SPROFILE_VALUE( x, value ) ::SimpleProfilerAddValue( x, value )
+
 #if 0
 #define SPROFILE_UNUSED(x) do { (void)sizeof(x); } while(0)
 #define SPROFILE(condition) \
@@ -138,4 +141,11 @@ public:
 
 //-----------------------------------------------------------------------------
 
+inline void SimpleProfilerAddValue( const std::string& name, double value )
+{
+	ceng::GetSingletonPtr< SimpleProfilerGlobal >()->GetData( name )->Add( value );
+}
+
+//-----------------------------------------------------------------------------
+
 #endif
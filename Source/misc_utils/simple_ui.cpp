@@ -52,6 +52,9 @@ SimpleBase::SimpleBase() :
 	mUserData( NULL ),
 	mListener( NULL )
 {
+	// every mouse event is hit tested against every element
+	SetHitIndex( true );
+
 	// if( Poro() && Poro()->GetMouse() ) 
 	//	Poro()->GetMouse()->AddMouseListener( this );
 }
@@ -119,6 +122,9 @@ SimpleBaseText::SimpleBaseText() :
 	mUserData( NULL ),
 	mListener( NULL )
 {
+	// every mouse event is hit tested against every element
+	SetHitIndex( true );
+
 	// if( Poro() && Poro()->GetMouse() ) 
 	//	Poro()->GetMouse()->AddMouseListener( this );
 }
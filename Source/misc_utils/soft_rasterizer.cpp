@@ -0,0 +1,634 @@
+#include "soft_rasterizer.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#include <poro/igraphics.h>
+#include <utils/pngwriter/pngwriter.h>
+#include <utils/threadpool/cthreadpool.h>
+
+//-----------------------------------------------------------------------------
+
+namespace
+{
+	enum
+	{
+		// vertices are snapped to 1 / SUBPIXEL pixels
+		SUBPIXEL_BITS = 8,
+		SUBPIXEL = 1 << SUBPIXEL_BITS,
+
+		TILE_SIZE = 64,
+
+		// smaller draws than this aren't worth waking up the threads for
+		MIN_PARALLEL_TRIANGLES = 256
+	};
+
+	// keeps the edge functions well inside 64 bits
+	const double SOFT_RASTERIZER_MAX_COORD = 1 << 20;
+
+	inline int SoftRasterizerToFixed( float f )
+	{
+		// in double, so that there's no rounding before the floor on any 
+		// compiler
+		const double d = std::max( -SOFT_RASTERIZER_MAX_COORD, std::min( SOFT_RASTERIZER_MAX_COORD, (double)f ) );
+		return (int)std::floor( d * SUBPIXEL + 0.5 );
+	}
+
+	// rounds towards negative infinity, b > 0
+	inline long long SoftRasterizerFloorDiv( long long a, long long b )
+	{
+		return ( a >= 0 ) ? a / b : -( ( -a + b - 1 ) / b );
+	}
+
+	inline long long SoftRasterizerCeilDiv( long long a, long long b )
+	{
+		return -SoftRasterizerFloorDiv( -a, b );
+	}
+
+	// When a sample lands exactly on an edge, only one of the two triangles
+	// sharing that edge gets to own it. The triangles see the shared edge in
+	// opposite directions, so picking by direction is enough.
+	inline bool SoftRasterizerOwnsEdge( int ax, int ay, int bx, int by )
+	{
+		return ( by > ay ) || ( by == ay && bx < ax );
+	}
+
+	inline unsigned char SoftRasterizerToByte( float f )
+	{
+		if( f <= 0.f ) return 0;
+		if( f >= 1.f ) return 255;
+		return (unsigned char)( f * 255.f + 0.5f );
+	}
+
+	inline void SoftRasterizerBlend( unsigned char* dest, int r, int g, int b, int a )
+	{
+		if( a >= 255 )
+		{
+			dest[ 0 ] = (unsigned char)r;
+			dest[ 1 ] = (unsigned char)g;
+			dest[ 2 ] = (unsigned char)b;
+			dest[ 3 ] = 255;
+			return;
+		}
+
+		const int inv_a = 255 - a;
+		dest[ 0 ] = (unsigned char)( ( r * a + dest[ 0 ] * inv_a + 127 ) / 255 );
+		dest[ 1 ] = (unsigned char)( ( g * a + dest[ 1 ] * inv_a + 127 ) / 255 );
+		dest[ 2 ] = (unsigned char)( ( b * a + dest[ 2 ] * inv_a + 127 ) / 255 );
+		dest[ 3 ] = (unsigned char)( a + ( dest[ 3 ] * inv_a + 127 ) / 255 );
+	}
+
+	// fills count pixels from dest with one color and blend mode
+	void SoftRasterizerSpan( unsigned char* dest, int count, const unsigned char* color, int blend_mode )
+	{
+		const int r = color[ 0 ];
+		const int g = color[ 1 ];
+		const int b = color[ 2 ];
+		const int a = color[ 3 ];
+
+		if( blend_mode == poro::IGraphics::BLEND_MODE_MULTIPLY )
+		{
+			// glBlendFunc( GL_ZERO, GL_SRC_COLOR ), alpha only comes in 
+			// through the alpha channel
+			for( int i = 0; i < count; ++i, dest += 4 )
+			{
+				dest[ 0 ] = (unsigned char)( ( dest[ 0 ] * r + 127 ) / 255 );
+				dest[ 1 ] = (unsigned char)( ( dest[ 1 ] * g + 127 ) / 255 );
+				dest[ 2 ] = (unsigned char)( ( dest[ 2 ] * b + 127 ) / 255 );
+				dest[ 3 ] = (unsigned char)( ( dest[ 3 ] * a + 127 ) / 255 );
+			}
+		}
+		else if( blend_mode == poro::IGraphics::BLEND_MODE_SCREEN )
+		{
+			const int ar = ( r * a + 127 ) / 255;
+			const int ag = ( g * a + 127 ) / 255;
+			const int ab = ( b * a + 127 ) / 255;
+			const int aa = ( a * a + 127 ) / 255;
+			for( int i = 0; i < count; ++i, dest += 4 )
+			{
+				dest[ 0 ] = (unsigned char)std::min( 255, dest[ 0 ] + ar );
+				dest[ 1 ] = (unsigned char)std::min( 255, dest[ 1 ] + ag );
+				dest[ 2 ] = (unsigned char)std::min( 255, dest[ 2 ] + ab );
+				dest[ 3 ] = (unsigned char)std::min( 255, dest[ 3 ] + aa );
+			}
+		}
+		else
+		{
+			for( int i = 0; i < count; ++i, dest += 4 )
+				SoftRasterizerBlend( dest, r, g, b, a );
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+SoftRasterizer::SoftRasterizer() :
+	mWidth( 0 ),
+	mHeight( 0 ),
+	mDrawFillMode( poro::IGraphics::DRAWFILL_MODE_FRONT_AND_BACK ),
+	mBlendMode( poro::IGraphics::BLEND_MODE_NORMAL ),
+	mAntialias( 1 ),
+	mThreadCount( 0 ),
+	mThreadPool( NULL ),
+	mPixels(),
+	mTriangles(),
+	mTileOffsets(),
+	mTileTriangles()
+{
+}
+
+SoftRasterizer::SoftRasterizer( int width, int height ) :
+	mWidth( 0 ),
+	mHeight( 0 ),
+	mDrawFillMode( poro::IGraphics::DRAWFILL_MODE_FRONT_AND_BACK ),
+	mBlendMode( poro::IGraphics::BLEND_MODE_NORMAL ),
+	mAntialias( 1 ),
+	mThreadCount( 0 ),
+	mThreadPool( NULL ),
+	mPixels(),
+	mTriangles(),
+	mTileOffsets(),
+	mTileTriangles()
+{
+	Resize( width, height );
+}
+
+void SoftRasterizer::Resize( int width, int height )
+{
+	mWidth = std::max( width, 0 );
+	mHeight = std::max( height, 0 );
+	mPixels.resize( 4 * mWidth * mHeight );
+}
+
+void SoftRasterizer::SetAntialias( int samples )
+{
+	mAntialias = std::max( 1, std::min( samples, 4 ) );
+}
+
+//-----------------------------------------------------------------------------
+
+void SoftRasterizer::Clear( const poro::types::fcolor& color )
+{
+	if( mPixels.empty() )
+		return;
+
+	const unsigned char r = SoftRasterizerToByte( color[ 0 ] );
+	const unsigned char g = SoftRasterizerToByte( color[ 1 ] );
+	const unsigned char b = SoftRasterizerToByte( color[ 2 ] );
+	const unsigned char a = SoftRasterizerToByte( color[ 3 ] );
+
+	for( std::size_t i = 0; i < mPixels.size(); i += 4 )
+	{
+		mPixels[ i + 0 ] = r;
+		mPixels[ i + 1 ] = g;
+		mPixels[ i + 2 ] = b;
+		mPixels[ i + 3 ] = a;
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+void SoftRasterizer::DrawFill( const std::vector< poro::types::vec2 >& vertices, const poro::types::fcolor& color )
+{
+	if( vertices.empty() )
+		return;
+
+	DrawFill( &vertices[ 0 ], (int)vertices.size(), color );
+}
+
+void SoftRasterizer::DrawFill( const poro::types::vec2* vertices, int count, const poro::types::fcolor& color )
+{
+	AddPolygon( vertices, count, color );
+	RasterizeTriangles();
+}
+
+void SoftRasterizer::DrawFillBatch( const poro::types::vec2* vertices, const int* offsets, const int* counts, const poro::types::fcolor* colors, int polygon_count )
+{
+	for( int i = 0; i < polygon_count; ++i )
+		AddPolygon( vertices + offsets[ i ], counts[ i ], colors[ i ] );
+
+	RasterizeTriangles();
+}
+
+//-----------------------------------------------------------------------------
+
+void SoftRasterizer::AddPolygon( const poro::types::vec2* vertices, int count, const poro::types::fcolor& color )
+{
+	if( vertices == NULL || count < 3 )
+		return;
+
+	if( mDrawFillMode == poro::IGraphics::DRAWFILL_MODE_TRIANGLE_STRIP )
+	{
+		for( int i = 0; i + 2 < count; ++i )
+			AddTriangle( vertices[ i ], vertices[ i + 1 ], vertices[ i + 2 ], color );
+	}
+	else
+	{
+		for( int i = 1; i + 1 < count; ++i )
+			AddTriangle( vertices[ 0 ], vertices[ i ], vertices[ i + 1 ], color );
+	}
+}
+
+void SoftRasterizer::AddTriangle( const poro::types::vec2& v0, const poro::types::vec2& v1, const poro::types::vec2& v2, const poro::types::fcolor& color )
+{
+	Triangle t;
+	t.color[ 0 ] = SoftRasterizerToByte( color[ 0 ] );
+	t.color[ 1 ] = SoftRasterizerToByte( color[ 1 ] );
+	t.color[ 2 ] = SoftRasterizerToByte( color[ 2 ] );
+	t.color[ 3 ] = SoftRasterizerToByte( color[ 3 ] );
+	t.blend_mode = mBlendMode;
+
+	if( t.color[ 3 ] == 0 )
+		return;
+
+	int x[ 3 ] = { SoftRasterizerToFixed( v0.x ), SoftRasterizerToFixed( v1.x ), SoftRasterizerToFixed( v2.x ) };
+	int y[ 3 ] = { SoftRasterizerToFixed( v0.y ), SoftRasterizerToFixed( v1.y ), SoftRasterizerToFixed( v2.y ) };
+
+	const long long area = (long long)( x[ 1 ] - x[ 0 ] ) * ( y[ 2 ] - y[ 0 ] ) - (long long)( y[ 1 ] - y[ 0 ] ) * ( x[ 2 ] - x[ 0 ] );
+	if( area == 0 )
+		return;
+
+	// make the winding consistent, so that inside is always >= 0
+	if( area < 0 )
+	{
+		std::swap( x[ 1 ], x[ 2 ] );
+		std::swap( y[ 1 ], y[ 2 ] );
+	}
+
+	t.min_x = std::min( x[ 0 ], std::min( x[ 1 ], x[ 2 ] ) );
+	t.max_x = std::max( x[ 0 ], std::max( x[ 1 ], x[ 2 ] ) );
+	t.min_y = std::min( y[ 0 ], std::min( y[ 1 ], y[ 2 ] ) );
+	t.max_y = std::max( y[ 0 ], std::max( y[ 1 ], y[ 2 ] ) );
+
+	if( t.max_x < 0 || t.max_y < 0 || t.min_x >= mWidth * SUBPIXEL || t.min_y >= mHeight * SUBPIXEL )
+		return;
+
+	for( int i = 0; i < 3; ++i )
+	{
+		t.x[ i ] = x[ i ];
+		t.y[ i ] = y[ i ];
+	}
+
+	mTriangles.push_back( t );
+}
+
+//-----------------------------------------------------------------------------
+
+// Draws the triangles into pixels x0, y0 - x1, y1 (exclusive). With 
+// antialiasing that part is copied into a sample buffer first and averaged
+// back at the end.
+void SoftRasterizer::RasterizeRegion( const int* triangles, int count, int px0, int py0, int px1, int py1 )
+{
+	// only the part that the triangles cover
+	int min_x = mWidth * SUBPIXEL;
+	int min_y = mHeight * SUBPIXEL;
+	int max_x = 0;
+	int max_y = 0;
+	for( int i = 0; i < count; ++i )
+	{
+		const Triangle& t = mTriangles[ triangles[ i ] ];
+		min_x = std::min( min_x, t.min_x );
+		min_y = std::min( min_y, t.min_y );
+		max_x = std::max( max_x, t.max_x );
+		max_y = std::max( max_y, t.max_y );
+	}
+
+	// the tiles on the right and bottom edges can reach past the image
+	px0 = std::max( px0, min_x / SUBPIXEL );
+	py0 = std::max( py0, min_y / SUBPIXEL );
+	px1 = std::min( std::min( px1, mWidth ), max_x / SUBPIXEL + 1 );
+	py1 = std::min( std::min( py1, mHeight ), max_y / SUBPIXEL + 1 );
+	if( px0 >= px1 || py0 >= py1 )
+		return;
+
+	const int samples = mAntialias;
+	const int width = px1 - px0;
+	const int height = py1 - py0;
+
+	unsigned char* target = &mPixels[ 0 ] + 4 * ( py0 * mWidth + px0 );
+	int target_stride = 4 * mWidth;
+
+	std::vector< unsigned char > buffer;
+	if( samples > 1 )
+	{
+		target_stride = 4 * width * samples;
+		buffer.resize( target_stride * height * samples );
+		target = &buffer[ 0 ];
+
+		for( int y = 0; y < height * samples; ++y )
+		{
+			const unsigned char* src = &mPixels[ 0 ] + 4 * ( ( py0 + y / samples ) * mWidth + px0 );
+			unsigned char* dest = target + y * target_stride;
+			for( int x = 0; x < width * samples; ++x )
+				memcpy( dest + 4 * x, src + 4 * ( x / samples ), 4 );
+		}
+	}
+
+	// Samples are at the centers of an n x n grid in the pixel. SUBPIXEL 
+	// doesn't divide by every n, so the coordinates are scaled by 2n: 
+	// sample s is then at ( 2s + 1 ) * SUBPIXEL exactly.
+	const long long scale = 2 * samples;
+	const long long step = 2 * SUBPIXEL;
+	const long long offset = SUBPIXEL;
+	const int sx0 = px0 * samples;
+	const int sy0 = py0 * samples;
+	const int sx1 = sx0 + width * samples - 1;
+	const int sy1 = sy0 + height * samples - 1;
+
+	for( int i = 0; i < count; ++i )
+	{
+		const Triangle& t = mTriangles[ triangles[ i ] ];
+
+		const int x0 = std::max( sx0, (int)SoftRasterizerCeilDiv( t.min_x * scale - offset, step ) );
+		const int x1 = std::min( sx1, (int)SoftRasterizerFloorDiv( t.max_x * scale - offset, step ) );
+		const int y0 = std::max( sy0, (int)SoftRasterizerCeilDiv( t.min_y * scale - offset, step ) );
+		const int y1 = std::min( sy1, (int)SoftRasterizerFloorDiv( t.max_y * scale - offset, step ) );
+		if( x0 > x1 || y0 > y1 )
+			continue;
+
+		const long long px = x0 * step + offset;
+		const long long py = y0 * step + offset;
+
+		// Edge e goes from vertex e to the next one. The edge functions are
+		// > 0 on the inside, or >= 0 if the triangle owns that edge. Here 
+		// they're at the first sample, with their steps to the next one. 
+		// They're 2n times the unscaled ones, which doesn't change the sign.
+		long long row_value[ 3 ];
+		long long delta_x[ 3 ];
+		long long delta_y[ 3 ];
+		for( int e = 0; e < 3; ++e )
+		{
+			const int n = ( e + 1 ) % 3;
+			const long long a = -(long long)( t.y[ n ] - t.y[ e ] );
+			const long long b = (long long)( t.x[ n ] - t.x[ e ] );
+			const int bias = SoftRasterizerOwnsEdge( t.x[ e ], t.y[ e ], t.x[ n ], t.y[ n ] ) ? 0 : -1;
+
+			row_value[ e ] = a * ( px - t.x[ e ] * scale ) + b * ( py - t.y[ e ] * scale ) + bias;
+			delta_x[ e ] = a * step;
+			delta_y[ e ] = b * step;
+		}
+
+		// narrow triangles are walked sample by sample, wide ones solve where
+		// the span starts and ends
+		const bool walk = ( x1 - x0 ) < 32;
+
+		for( int y = y0; y <= y1; ++y )
+		{
+			// the span of samples on this row that are inside all edges
+			long long first = 0;
+			long long last = x1 - x0;
+
+			if( walk )
+			{
+				long long v0 = row_value[ 0 ];
+				long long v1 = row_value[ 1 ];
+				long long v2 = row_value[ 2 ];
+				while( first <= last && ( v0 | v1 | v2 ) < 0 )
+				{
+					v0 += delta_x[ 0 ]; v1 += delta_x[ 1 ]; v2 += delta_x[ 2 ];
+					++first;
+				}
+
+				long long end = first;
+				while( end <= last && ( v0 | v1 | v2 ) >= 0 )
+				{
+					v0 += delta_x[ 0 ]; v1 += delta_x[ 1 ]; v2 += delta_x[ 2 ];
+					++end;
+				}
+				last = end - 1;
+			}
+			else
+			{
+				for( int e = 0; e < 3 && first <= last; ++e )
+				{
+					const long long value = row_value[ e ];
+					if( delta_x[ e ] > 0 )
+						first = std::max( first, SoftRasterizerCeilDiv( -value, delta_x[ e ] ) );
+					else if( delta_x[ e ] < 0 )
+						last = std::min( last, SoftRasterizerFloorDiv( value, -delta_x[ e ] ) );
+					else if( value < 0 )
+						last = -1;
+				}
+			}
+
+			for( int e = 0; e < 3; ++e )
+				row_value[ e ] += delta_y[ e ];
+
+			if( first > last )
+				continue;
+
+			unsigned char* row = target + ( y - sy0 ) * target_stride;
+			SoftRasterizerSpan( row + 4 * ( x0 - sx0 + (int)first ), (int)( last - first + 1 ), t.color, t.blend_mode );
+		}
+	}
+
+	if( samples == 1 )
+		return;
+
+	// average the samples down
+	const int sample_count = samples * samples;
+	for( int y = 0; y < height; ++y )
+	{
+		unsigned char* dest = &mPixels[ 0 ] + 4 * ( ( py0 + y ) * mWidth + px0 );
+		for( int x = 0; x < width; ++x )
+		{
+			int sum[ 4 ] = { 0, 0, 0, 0 };
+			for( int sy = 0; sy < samples; ++sy )
+			{
+				const unsigned char* src = target + ( y * samples + sy ) * target_stride + 4 * x * samples;
+				for( int sx = 0; sx < samples; ++sx, src += 4 )
+				{
+					sum[ 0 ] += src[ 0 ];
+					sum[ 1 ] += src[ 1 ];
+					sum[ 2 ] += src[ 2 ];
+					sum[ 3 ] += src[ 3 ];
+				}
+			}
+
+			for( int c = 0; c < 4; ++c )
+				dest[ 4 * x + c ] = (unsigned char)( ( sum[ c ] + sample_count / 2 ) / sample_count );
+		}
+	}
+}
+
+struct SoftRasterizer::TileBody
+{
+	SoftRasterizer* raster;
+	int tiles_x;
+
+	void operator()( int tile ) const
+	{
+		const int begin = raster->mTileOffsets[ tile ];
+		const int end = raster->mTileOffsets[ tile + 1 ];
+		if( begin == end )
+			return;
+
+		const int x = ( tile % tiles_x ) * TILE_SIZE;
+		const int y = ( tile / tiles_x ) * TILE_SIZE;
+		raster->RasterizeRegion( &raster->mTileTriangles[ begin ], end - begin, x, y, x + TILE_SIZE, y + TILE_SIZE );
+	}
+};
+
+// the tiles that the bounding box of the triangle touches
+void SoftRasterizer::GetTileRange( const Triangle& t, int& tx0, int& ty0, int& tx1, int& ty1 ) const
+{
+	const int tile_pixels = TILE_SIZE * SUBPIXEL;
+	tx0 = std::max( 0, t.min_x / tile_pixels );
+	ty0 = std::max( 0, t.min_y / tile_pixels );
+	tx1 = std::min( ( mWidth - 1 ) / TILE_SIZE, t.max_x / tile_pixels );
+	ty1 = std::min( ( mHeight - 1 ) / TILE_SIZE, t.max_y / tile_pixels );
+}
+
+void SoftRasterizer::RasterizeTriangles()
+{
+	if( mTriangles.empty() || mPixels.empty() )
+	{
+		mTriangles.clear();
+		return;
+	}
+
+	const int triangle_count = (int)mTriangles.size();
+
+	// small draws, like a single line, go straight in without binning
+	if( triangle_count < MIN_PARALLEL_TRIANGLES )
+	{
+		int min_x = mTriangles[ 0 ].min_x;
+		int min_y = mTriangles[ 0 ].min_y;
+		int max_x = mTriangles[ 0 ].max_x;
+		int max_y = mTriangles[ 0 ].max_y;
+		for( int i = 1; i < triangle_count; ++i )
+		{
+			min_x = std::min( min_x, mTriangles[ i ].min_x );
+			min_y = std::min( min_y, mTriangles[ i ].min_y );
+			max_x = std::max( max_x, mTriangles[ i ].max_x );
+			max_y = std::max( max_y, mTriangles[ i ].max_y );
+		}
+
+		const long long area = (long long)( max_x - min_x ) * ( max_y - min_y ) / ( SUBPIXEL * SUBPIXEL );
+		if( area <= TILE_SIZE * TILE_SIZE )
+		{
+			mTileTriangles.resize( triangle_count );
+			for( int i = 0; i < triangle_count; ++i )
+				mTileTriangles[ i ] = i;
+
+			RasterizeRegion( &mTileTriangles[ 0 ], triangle_count, 0, 0, mWidth, mHeight );
+			mTriangles.clear();
+			return;
+		}
+	}
+
+	const int tiles_x = ( mWidth + TILE_SIZE - 1 ) / TILE_SIZE;
+	const int tiles_y = ( mHeight + TILE_SIZE - 1 ) / TILE_SIZE;
+	const int tile_count = tiles_x * tiles_y;
+
+	// counted first, so that the triangles of a tile stay in drawing order
+	mTileOffsets.assign( tile_count + 1, 0 );
+	for( int i = 0; i < triangle_count; ++i )
+	{
+		int tx0, ty0, tx1, ty1;
+		GetTileRange( mTriangles[ i ], tx0, ty0, tx1, ty1 );
+		for( int ty = ty0; ty <= ty1; ++ty )
+			for( int tx = tx0; tx <= tx1; ++tx )
+				mTileOffsets[ ty * tiles_x + tx + 1 ]++;
+	}
+
+	for( int i = 0; i < tile_count; ++i )
+		mTileOffsets[ i + 1 ] += mTileOffsets[ i ];
+
+	mTileTriangles.resize( mTileOffsets[ tile_count ] );
+	std::vector< int > fill( mTileOffsets.begin(), mTileOffsets.end() - 1 );
+	for( int i = 0; i < triangle_count; ++i )
+	{
+		int tx0, ty0, tx1, ty1;
+		GetTileRange( mTriangles[ i ], tx0, ty0, tx1, ty1 );
+		for( int ty = ty0; ty <= ty1; ++ty )
+			for( int tx = tx0; tx <= tx1; ++tx )
+				mTileTriangles[ fill[ ty * tiles_x + tx ]++ ] = i;
+	}
+
+	TileBody body;
+	body.raster = this;
+	body.tiles_x = tiles_x;
+
+	if( tile_count == 1 || triangle_count < MIN_PARALLEL_TRIANGLES || ( mThreadPool == NULL && mThreadCount == 1 ) )
+	{
+		for( int i = 0; i < tile_count; ++i )
+			body( i );
+	}
+	else if( mThreadPool )
+	{
+		ceng::ParallelFor( *mThreadPool, tile_count, body );
+	}
+	else
+	{
+		ceng::CThreadPool pool( mThreadCount );
+		ceng::ParallelFor( pool, tile_count, body );
+	}
+
+	mTriangles.clear();
+}
+
+//-----------------------------------------------------------------------------
+
+void SoftRasterizer::DrawLine( const poro::types::vec2& p1, const poro::types::vec2& p2, const poro::types::fcolor& color, float width )
+{
+	const float dx = p2.x - p1.x;
+	const float dy = p2.y - p1.y;
+	const float length = std::sqrt( dx * dx + dy * dy );
+	if( length <= 0 || width <= 0 )
+		return;
+
+	const float nx = -dy / length * 0.5f * width;
+	const float ny = dx / length * 0.5f * width;
+
+	poro::types::vec2 quad[ 4 ];
+	quad[ 0 ] = poro::types::vec2( p1.x + nx, p1.y + ny );
+	quad[ 1 ] = poro::types::vec2( p2.x + nx, p2.y + ny );
+	quad[ 2 ] = poro::types::vec2( p2.x - nx, p2.y - ny );
+	quad[ 3 ] = poro::types::vec2( p1.x - nx, p1.y - ny );
+
+	AddTriangle( quad[ 0 ], quad[ 1 ], quad[ 2 ], color );
+	AddTriangle( quad[ 0 ], quad[ 2 ], quad[ 3 ], color );
+	RasterizeTriangles();
+}
+
+//-----------------------------------------------------------------------------
+
+void SoftRasterizer::DrawImage( const unsigned char* rgba, int width, int height, int pos_x, int pos_y )
+{
+	if( rgba == NULL )
+		return;
+
+	const int x0 = std::max( 0, pos_x );
+	const int y0 = std::max( 0, pos_y );
+	const int x1 = std::min( mWidth, pos_x + width );
+	const int y1 = std::min( mHeight, pos_y + height );
+
+	for( int y = y0; y < y1; ++y )
+	{
+		const unsigned char* src = rgba + 4 * ( ( y - pos_y ) * width + ( x0 - pos_x ) );
+		unsigned char* dest = &mPixels[ 4 * ( y * mWidth + x0 ) ];
+
+		for( int x = x0; x < x1; ++x, src += 4, dest += 4 )
+		{
+			if( src[ 3 ] == 0 ) continue;
+			SoftRasterizerBlend( dest, src[ 0 ], src[ 1 ], src[ 2 ], src[ 3 ] );
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+bool SoftRasterizer::SaveImage( const std::string& filename, int thread_count ) const
+{
+	if( mPixels.empty() )
+		return false;
+
+	ceng::PngWriterSettings settings;
+	settings.thread_count = thread_count;
+	settings.pool = mThreadPool;
+	return ceng::WritePng( filename, mWidth, mHeight, 4, &mPixels[ 0 ], mWidth * 4, settings );
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,157 @@
+//-----------------------------------------------------------------------------
+// SoftRasterizer
+// ==============
+//
+// A small CPU rasterizer for flat colored polygons. This is used by the
+// headless batch renderer so that card backs can be rendered to png without
+// a window or an OpenGL context.
+//
+// DrawFill() understands the same fill modes as poro::IGraphics::DrawFill().
+// DRAWFILL_MODE_FRONT_AND_BACK draws the vertices as a convex polygon (fan)
+// and DRAWFILL_MODE_TRIANGLE_STRIP draws them as a triangle strip.
+//
+// Pixels are stored as RGBA bytes, top row first.
+//
+// The vertices are snapped to 1/256 of a pixel and everything after that is
+// integer math, so the same calls give the same pixels on every machine and
+// with any thread count. The polygons of a call are split into triangles
+// and binned into 64x64 pixel tiles, and the tiles are rasterized in 
+// parallel. Inside a tile the triangles are drawn in the order they were
+// given.
+//
+// SetAntialias( n ) takes n x n samples per pixel. Each tile is drawn into
+// its own sample buffer and averaged down at the end, so the triangles of 
+// one DrawFillBatch() don't leave seams between them the way 
+// GL_POLYGON_SMOOTH does.
+//
+// SetBlendMode() takes the poro::IGraphics::BLEND_MODE_* values and blends
+// the way GraphicsOpenGL does:
+//	NORMAL		dest = color * alpha + dest * ( 1 - alpha )
+//	MULTIPLY	dest = dest * color
+//	SCREEN		dest = dest + color * alpha
+//-----------------------------------------------------------------------------
+#ifndef INC_SOFT_RASTERIZER_H
+#define INC_SOFT_RASTERIZER_H
+
+#include <vector>
+#include <string>
+#include <poro/poro_types.h>
+
+namespace ceng { class CThreadPool; }
+
+class SoftRasterizer
+{
+public:
+	SoftRasterizer();
+	SoftRasterizer( int width, int height );
+
+	void Resize( int width, int height );
+
+	int GetWidth() const;
+	int GetHeight() const;
+
+	//-------------------------------------------------------------------------
+
+	void Clear( const poro::types::fcolor& color );
+
+	void SetDrawFillMode( int drawfill_mode );
+	int  GetDrawFillMode() const;
+
+	void SetBlendMode( int blend_mode );
+	int  GetBlendMode() const;
+
+	// samples per pixel along each axis, 1 - 4. 1 is no antialiasing
+	void SetAntialias( int samples );
+	int  GetAntialias() const;
+
+	// threads for rasterizing the tiles, <= 0 uses one thread per core
+	void SetThreadCount( int thread_count );
+
+	// if set, the tiles and the png encode run on this pool instead of 
+	// starting threads on every draw, and the thread counts are ignored. 
+	// Must not be a pool that the caller is running a task on.
+	void SetThreadPool( ceng::CThreadPool* pool );
+
+	void DrawFill( const std::vector< poro::types::vec2 >& vertices, const poro::types::fcolor& color );
+	void DrawFill( const poro::types::vec2* vertices, int count, const poro::types::fcolor& color );
+	// same arguments as poro::IGraphics::DrawFillBatch()
+	void DrawFillBatch( const poro::types::vec2* vertices, const int* offsets, const int* counts, const poro::types::fcolor* colors, int polygon_count );
+
+	// draws a line as a quad that is width pixels wide
+	void DrawLine( const poro::types::vec2& p1, const poro::types::vec2& p2, const poro::types::fcolor& color, float width );
+
+	// draws an RGBA image with alpha blending, top left corner at x, y
+	void DrawImage( const unsigned char* rgba, int width, int height, int x, int y );
+
+	//-------------------------------------------------------------------------
+
+	// saves the pixels as a png, returns false if the write failed.
+	// thread_count is for the png encoder, <= 0 uses one thread per core
+	// and it isn't used if there's a pool from SetThreadPool()
+	bool SaveImage( const std::string& filename, int thread_count = 0 ) const;
+
+	const unsigned char*	GetPixels() const;
+	unsigned char*			GetPixels();
+
+private:
+	// a triangle in 1/256 pixels, wound so that the inside is on the left
+	struct Triangle
+	{
+		int x[ 3 ];
+		int y[ 3 ];
+
+		// bounding box
+		int min_x;
+		int min_y;
+		int max_x;
+		int max_y;
+
+		unsigned char color[ 4 ];
+		int blend_mode;
+	};
+
+	struct TileBody;
+
+	void AddTriangle( const poro::types::vec2& a, const poro::types::vec2& b, const poro::types::vec2& c, const poro::types::fcolor& color );
+	void AddPolygon( const poro::types::vec2* vertices, int count, const poro::types::fcolor& color );
+
+	void GetTileRange( const Triangle& t, int& tx0, int& ty0, int& tx1, int& ty1 ) const;
+	void RasterizeRegion( const int* triangles, int count, int x0, int y0, int x1, int y1 );
+
+	// draws the triangles that have been added and clears them
+	void RasterizeTriangles();
+
+	int mWidth;
+	int mHeight;
+	int mDrawFillMode;
+	int mBlendMode;
+	int mAntialias;
+	int mThreadCount;
+	ceng::CThreadPool* mThreadPool;
+	std::vector< unsigned char > mPixels;
+
+	std::vector< Triangle >	mTriangles;
+
+	// the triangles of each tile, mTileTriangles[ mTileOffsets[ tile ] ... ]
+	std::vector< int >		mTileOffsets;
+	std::vector< int >		mTileTriangles;
+};
+
+//-----------------------------------------------------------------------------
+
+inline int SoftRasterizer::GetWidth() const					{ return mWidth; }
+inline int SoftRasterizer::GetHeight() const				{ return mHeight; }
+inline void SoftRasterizer::SetDrawFillMode( int mode )		{ mDrawFillMode = mode; }
+inline int SoftRasterizer::GetDrawFillMode() const			{ return mDrawFillMode; }
+inline void SoftRasterizer::SetBlendMode( int mode )		{ mBlendMode = mode; }
+inline int SoftRasterizer::GetBlendMode() const				{ return mBlendMode; }
+inline int SoftRasterizer::GetAntialias() const				{ return mAntialias; }
+inline void SoftRasterizer::SetThreadCount( int count )		{ mThreadCount = count; }
+inline void SoftRasterizer::SetThreadPool( ceng::CThreadPool* pool )	{ mThreadPool = pool; }
+
+inline const unsigned char* SoftRasterizer::GetPixels() const	{ return mPixels.empty() ? NULL : &mPixels[ 0 ]; }
+inline unsigned char* SoftRasterizer::GetPixels()				{ return mPixels.empty() ? NULL : &mPixels[ 0 ]; }
+
+//-----------------------------------------------------------------------------
+
+#endif
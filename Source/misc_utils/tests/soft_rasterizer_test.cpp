@@ -0,0 +1,153 @@
+#include "../soft_rasterizer.h"
+
+#include <vector>
+
+#include <poro/igraphics.h>
+#include <utils/debug.h>
+#include <utils/random/random.h>
+#include <utils/threadpool/cthreadpool.h>
+
+#ifdef CENG_TESTER_ENABLED
+
+namespace test {
+///////////////////////////////////////////////////////////////////////////////
+namespace {
+
+// the same scene every time: batches of quads that cross the tile edges in
+// every blend mode, enough of them that the tiles are drawn in parallel
+std::vector< unsigned char > SoftRasterizerTest_Render( int antialias, int thread_count, ceng::CThreadPool* pool )
+{
+	ceng::CLGMRandom random;
+	random.SetSeed( 4321 );
+
+	SoftRasterizer raster( 300, 200 );
+	raster.SetAntialias( antialias );
+	raster.SetThreadCount( thread_count );
+	raster.SetThreadPool( pool );
+	raster.Clear( poro::GetFColor( 0.2f, 0.3f, 0.4f, 1 ) );
+	raster.SetDrawFillMode( poro::IGraphics::DRAWFILL_MODE_TRIANGLE_STRIP );
+
+	const int blend_modes[] = { 
+		poro::IGraphics::BLEND_MODE_NORMAL, 
+		poro::IGraphics::BLEND_MODE_MULTIPLY, 
+		poro::IGraphics::BLEND_MODE_SCREEN };
+
+	for( int batch = 0; batch < 3; ++batch )
+	{
+		const int quad_count = 400;
+		std::vector< poro::types::vec2 > vertices( quad_count * 4 );
+		std::vector< int > offsets( quad_count );
+		std::vector< int > counts( quad_count, 4 );
+		std::vector< poro::types::fcolor > colors( quad_count );
+
+		for( int i = 0; i < quad_count; ++i )
+		{
+			const float x = random.Randomf( -20.f, 300.f );
+			const float y = random.Randomf( -20.f, 200.f );
+			const float w = random.Randomf( 1.f, 80.f );
+			const float h = random.Randomf( 1.f, 80.f );
+			const float skew = random.Randomf( -10.f, 10.f );
+
+			offsets[ i ] = i * 4;
+			vertices[ i * 4 + 0 ] = poro::types::vec2( x, y );
+			vertices[ i * 4 + 1 ] = poro::types::vec2( x + w, y + skew );
+			vertices[ i * 4 + 2 ] = poro::types::vec2( x + skew, y + h );
+			vertices[ i * 4 + 3 ] = poro::types::vec2( x + w, y + h + skew );
+			colors[ i ] = poro::GetFColor( random.Randomf( 0, 1 ), random.Randomf( 0, 1 ), random.Randomf( 0, 1 ), random.Randomf( 0.1f, 1 ) );
+		}
+
+		raster.SetBlendMode( blend_modes[ batch ] );
+		raster.DrawFillBatch( &vertices[ 0 ], &offsets[ 0 ], &counts[ 0 ], &colors[ 0 ], quad_count );
+	}
+
+	raster.SetBlendMode( poro::IGraphics::BLEND_MODE_NORMAL );
+	raster.DrawLine( poro::types::vec2( 3, 5 ), poro::types::vec2( 290, 190 ), poro::GetFColor( 1, 1, 1, 0.5f ), 2.5f );
+
+	const unsigned char* pixels = raster.GetPixels();
+	return std::vector< unsigned char >( pixels, pixels + 300 * 200 * 4 );
+}
+
+} // end of anonymous namespace
+///////////////////////////////////////////////////////////////////////////////
+
+int SoftRasterizerTest()
+{
+	// the same bytes with any thread count, or on a pool from outside
+	{
+		ceng::CThreadPool pool( 3 );
+		for( int antialias = 1; antialias <= 3; antialias += 2 )
+		{
+			const std::vector< unsigned char > one = SoftRasterizerTest_Render( antialias, 1, NULL );
+			test_assert( one == SoftRasterizerTest_Render( antialias, 4, NULL ) );
+			test_assert( one == SoftRasterizerTest_Render( antialias, 1, &pool ) );
+		}
+	}
+
+	// multiply is dest * color like GraphicsOpenGL, the color isn't divided
+	// by alpha
+	{
+		SoftRasterizer raster( 8, 8 );
+		raster.Clear( poro::GetFColor( 1, 1, 1, 1 ) );
+		raster.SetBlendMode( poro::IGraphics::BLEND_MODE_MULTIPLY );
+
+		poro::types::vec2 quad[ 4 ];
+		quad[ 0 ] = poro::types::vec2( 0, 0 );
+		quad[ 1 ] = poro::types::vec2( 8, 0 );
+		quad[ 2 ] = poro::types::vec2( 8, 8 );
+		quad[ 3 ] = poro::types::vec2( 0, 8 );
+		raster.DrawFill( quad, 4, poro::GetFColor( 0.2f, 0.4f, 0.6f, 0.5f ) );
+
+		const float expected[] = { 0.2f, 0.4f, 0.6f, 0.5f };
+		const unsigned char* pixels = raster.GetPixels();
+		for( int i = 0; i < 8 * 8 * 4; ++i )
+		{
+			const int diff = pixels[ i ] - (int)( expected[ i % 4 ] * 255.f + 0.5f );
+			test_assert( diff >= -1 && diff <= 1 );
+		}
+
+		// nothing happens with zero alpha
+		raster.DrawFill( quad, 4, poro::GetFColor( 0, 0, 0, 0 ) );
+		for( int i = 0; i < 8 * 8 * 4; ++i )
+		{
+			const int diff = pixels[ i ] - (int)( expected[ i % 4 ] * 255.f + 0.5f );
+			test_assert( diff >= -1 && diff <= 1 );
+		}
+	}
+
+	// the samples don't drift across a wide image with any antialiasing
+	{
+		for( int antialias = 1; antialias <= 4; ++antialias )
+		{
+			SoftRasterizer raster( 1200, 4 );
+			raster.SetAntialias( antialias );
+			raster.Clear( poro::GetFColor( 0, 0, 0, 1 ) );
+
+			poro::types::vec2 quad[ 4 ];
+			quad[ 0 ] = poro::types::vec2( 900.3f, 0 );
+			quad[ 1 ] = poro::types::vec2( 1000, 0 );
+			quad[ 2 ] = poro::types::vec2( 1000, 4 );
+			quad[ 3 ] = poro::types::vec2( 900.3f, 4 );
+			raster.DrawFill( quad, 4, poro::GetFColor( 1, 1, 1, 1 ) );
+
+			const unsigned char* row = raster.GetPixels() + 4 * 1200 * 2;
+			test_assert( row[ 4 * 899 ] == 0 );
+			test_assert( row[ 4 * 901 ] == 255 );
+			test_assert( row[ 4 * 999 ] == 255 );
+			test_assert( row[ 4 * 1000 ] == 0 );
+
+			// the samples of pixel 900 are at ( 2j + 1 ) / 2n, this many
+			// columns of them are right of the edge at .3
+			const int inside[] = { 0, 1, 1, 2, 3 };
+			const int expected = ( 255 * inside[ antialias ] + antialias / 2 ) / antialias;
+			test_assert( row[ 4 * 900 ] == expected );
+		}
+	}
+
+	return 0;
+}
+
+TEST_REGISTER( SoftRasterizerTest );
+
+} // end of namespace test
+
+#endif
@@ -0,0 +1,266 @@
+#include "../vector_export.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <poro/poro_macros.h>
+#include <utils/debug.h>
+#include <utils/random/random.h>
+
+#include "../polygon_buffer.h"
+
+#ifdef CENG_TESTER_ENABLED
+
+namespace test {
+///////////////////////////////////////////////////////////////////////////////
+namespace {
+
+struct VectorExportTest_Path
+{
+	std::string fill;
+	std::vector< double > x;
+	std::vector< double > y;
+	std::vector< int > loop_ends;
+};
+
+// reads the <path> elements that SaveSvg() writes: M m l z with relative
+// coordinates after the first point
+std::vector< VectorExportTest_Path > VectorExportTest_ReadSvg( const std::string& filename )
+{
+	std::ifstream file( filename.c_str(), std::ios::in | std::ios::binary );
+	std::stringstream ss;
+	ss << file.rdbuf();
+	const std::string svg = ss.str();
+
+	std::vector< VectorExportTest_Path > paths;
+	std::size_t pos = 0;
+	while( ( pos = svg.find( "<path fill=\"", pos ) ) != std::string::npos )
+	{
+		pos += 12;
+		VectorExportTest_Path path;
+		path.fill = svg.substr( pos, 7 );
+
+		const std::size_t d = svg.find( "d=\"", pos ) + 3;
+		const std::size_t end = svg.find( '"', d );
+		const std::string data = svg.substr( d, end - d );
+		pos = end;
+
+		const char* c = data.c_str();
+		char command = 0;
+		double px = 0, py = 0;
+		double start_x = 0, start_y = 0;
+		bool first = false;
+		while( *c )
+		{
+			if( *c == ' ' ) { ++c; continue; }
+			if( *c == 'M' || *c == 'm' || *c == 'l' ) { command = *c++; first = true; continue; }
+			if( *c == 'z' )
+			{
+				path.loop_ends.push_back( (int)path.x.size() );
+				px = start_x;
+				py = start_y;
+				++c;
+				continue;
+			}
+
+			char* next = NULL;
+			const double x = strtod( c, &next );
+			const double y = strtod( next, &next );
+			c = next;
+
+			if( command == 'M' ) { px = x; py = y; }
+			else { px += x; py += y; }
+
+			if( ( command == 'M' || command == 'm' ) && first )
+			{
+				start_x = px;
+				start_y = py;
+			}
+			first = false;
+
+			path.x.push_back( px );
+			path.y.push_back( py );
+		}
+
+		paths.push_back( path );
+	}
+
+	return paths;
+}
+
+bool VectorExportTest_Inside( const VectorExportTest_Path& path, double x, double y )
+{
+	// nonzero rule, the same as SVG and PDF fill
+	int winding = 0;
+	int begin = 0;
+	for( std::size_t l = 0; l < path.loop_ends.size(); ++l )
+	{
+		const int end = path.loop_ends[ l ];
+		for( int i = begin; i < end; ++i )
+		{
+			const int j = ( i + 1 < end ) ? i + 1 : begin;
+			const double x0 = path.x[ i ], y0 = path.y[ i ];
+			const double x1 = path.x[ j ], y1 = path.y[ j ];
+			const double side = ( x1 - x0 ) * ( y - y0 ) - ( x - x0 ) * ( y1 - y0 );
+			if( y0 <= y && y1 > y && side > 0 ) winding++;
+			if( y1 <= y && y0 > y && side < 0 ) winding--;
+		}
+		begin = end;
+	}
+	return winding != 0;
+}
+
+bool VectorExportTest_InsideTriangle( const poro::types::vec2& a, const poro::types::vec2& b, const poro::types::vec2& c, double x, double y )
+{
+	const double d0 = ( b.x - a.x ) * ( y - a.y ) - ( x - a.x ) * ( b.y - a.y );
+	const double d1 = ( c.x - b.x ) * ( y - b.y ) - ( x - b.x ) * ( c.y - b.y );
+	const double d2 = ( a.x - c.x ) * ( y - c.y ) - ( x - c.x ) * ( a.y - c.y );
+	return ( d0 > 0 && d1 > 0 && d2 > 0 ) || ( d0 < 0 && d1 < 0 && d2 < 0 );
+}
+
+std::string VectorExportTest_Hex( const poro::types::fcolor& color )
+{
+	char hex[ 8 ];
+	sprintf( hex, "#%02x%02x%02x", (int)( color[ 0 ] * 255.f + 0.5f ), (int)( color[ 1 ] * 255.f + 0.5f ), (int)( color[ 2 ] * 255.f + 0.5f ) );
+	return hex;
+}
+
+// Saves the polygons and compares the paths to drawing the strips one by
+// one, at points that aren't on any edge. Returns the number of paths.
+int VectorExportTest_Compare( const PolygonBuffer& polygons, bool merge, int size )
+{
+	const char* filename = "vector_export_test.svg";
+
+	VectorExportSettings settings;
+	settings.width = size;
+	settings.height = size;
+	settings.merge = merge;
+	settings.background = poro::GetFColor( 0, 0, 0, 0 );
+	test_assert( SaveSvg( filename, polygons, settings ) );
+
+	const std::vector< VectorExportTest_Path > paths = VectorExportTest_ReadSvg( filename );
+	remove( filename );
+
+	for( int py = 0; py < size; ++py )
+	{
+		for( int px = 0; px < size; ++px )
+		{
+			const double x = px + 0.5 + 0.0137;
+			const double y = py + 0.5 + 0.0291;
+
+			std::string expected;
+			for( int i = 0; i < polygons.GetPolygonCount(); ++i )
+			{
+				const poro::types::vec2* v = polygons.GetVertices( i );
+				for( int k = 0; k + 2 < polygons.GetCount( i ); ++k )
+				{
+					if( VectorExportTest_InsideTriangle( v[ k ], v[ k + 1 ], v[ k + 2 ], x, y ) )
+					{
+						expected = VectorExportTest_Hex( polygons.GetColor( i ) );
+						break;
+					}
+				}
+			}
+
+			std::string result;
+			for( std::size_t i = 0; i < paths.size(); ++i )
+			{
+				if( VectorExportTest_Inside( paths[ i ], x, y ) )
+					result = paths[ i ].fill;
+			}
+
+			test_assert( result == expected );
+		}
+	}
+
+	return (int)paths.size();
+}
+
+void VectorExportTest_AddQuad( PolygonBuffer& polygons, float x0, float y0, float x1, float y1, const poro::types::fcolor& color )
+{
+	const int p = polygons.AddPolygon( 4 );
+	poro::types::vec2* v = polygons.GetVertices( p );
+	v[ 0 ] = poro::types::vec2( x0, y0 );
+	v[ 1 ] = poro::types::vec2( x1, y0 );
+	v[ 2 ] = poro::types::vec2( x0, y1 );
+	v[ 3 ] = poro::types::vec2( x1, y1 );
+	polygons.SetColor( p, color );
+}
+
+} // end of anonymous namespace
+///////////////////////////////////////////////////////////////////////////////
+
+int VectorExportTest()
+{
+	const poro::types::fcolor red = poro::GetFColor( 1, 0, 0, 1 );
+	const poro::types::fcolor green = poro::GetFColor( 0, 1, 0, 1 );
+	const poro::types::fcolor blue = poro::GetFColor( 0, 0, 1, 1 );
+
+	// overlapping and touching polygons of a color become one path without
+	// holes where they overlap
+	{
+		PolygonBuffer polygons;
+		VectorExportTest_AddQuad( polygons, 2, 2, 12, 12, red );
+		VectorExportTest_AddQuad( polygons, 7, 7, 17, 17, red );
+		VectorExportTest_AddQuad( polygons, 12, 2, 18, 7, red );
+		VectorExportTest_AddQuad( polygons, 4, 4, 6, 6, red );
+
+		test_assert( VectorExportTest_Compare( polygons, true, 20 ) == 1 );
+		test_assert( VectorExportTest_Compare( polygons, false, 20 ) == 1 );
+	}
+
+	// a quad that is twisted into a bow tie, on top of another polygon of
+	// the same color
+	{
+		PolygonBuffer polygons;
+		VectorExportTest_AddQuad( polygons, 2, 2, 10, 10, red );
+		const int p = polygons.AddPolygon( 4 );
+		poro::types::vec2* v = polygons.GetVertices( p );
+		v[ 0 ] = poro::types::vec2( 4, 4 );
+		v[ 1 ] = poro::types::vec2( 16, 4 );
+		v[ 2 ] = poro::types::vec2( 16, 16 );
+		v[ 3 ] = poro::types::vec2( 4, 16 );
+		polygons.SetColor( p, red );
+
+		test_assert( VectorExportTest_Compare( polygons, true, 20 ) == 1 );
+		test_assert( VectorExportTest_Compare( polygons, false, 20 ) == 1 );
+	}
+
+	// random strips in a few colors, some of them folded, stay in the order
+	// they were drawn in
+	{
+		ceng::CLGMRandom random;
+		random.SetSeed( 1234 );
+
+		const poro::types::fcolor colors[] = { red, green, blue };
+		PolygonBuffer polygons;
+		for( int i = 0; i < 80; ++i )
+		{
+			const int count = random.Random( 3, 7 );
+			const int p = polygons.AddPolygon( count );
+			poro::types::vec2* v = polygons.GetVertices( p );
+
+			const int x = random.Random( 0, 36 );
+			const int y = random.Random( 0, 36 );
+			for( int k = 0; k < count; ++k )
+				v[ k ] = poro::types::vec2( (float)( x + random.Random( 0, 12 ) ), (float)( y + random.Random( 0, 12 ) ) );
+
+			polygons.SetColor( p, colors[ random.Random( 0, 2 ) ] );
+		}
+
+		VectorExportTest_Compare( polygons, true, 48 );
+		VectorExportTest_Compare( polygons, false, 48 );
+	}
+
+	return 0;
+}
+
+TEST_REGISTER( VectorExportTest );
+
+} // end of namespace test
+
+#endif
@@ -0,0 +1,920 @@
+#include "vector_export.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#include <poro/poro_macros.h>
+#include <game_utils/drawlines/drawlines.h>
+#include <utils/filesystem/filesystem.h>
+
+#include "polygon_buffer.h"
+
+//-----------------------------------------------------------------------------
+
+namespace
+{
+	typedef unsigned int uint32;
+
+	struct VectorPoint
+	{
+		int x;
+		int y;
+
+		bool operator==( const VectorPoint& other ) const { return x == other.x && y == other.y; }
+		bool operator!=( const VectorPoint& other ) const { return !( *this == other ); }
+		bool operator<( const VectorPoint& other ) const { return ( x < other.x ) || ( x == other.x && y < other.y ); }
+	};
+
+	struct VectorEdge
+	{
+		VectorPoint a;
+		VectorPoint b;
+
+		bool operator<( const VectorEdge& other ) const { return ( a < other.a ) || ( a == other.a && b < other.b ); }
+	};
+
+	// one path: a color and closed loops of points
+	struct VectorShape
+	{
+		VectorShape() : color( 0 ), merged( false ), bounds_min(), bounds_max(), points(), loop_ends(), edges() { }
+
+		// r, g, b, a bytes from the lowest
+		uint32 color;
+		bool merged;
+
+		// of all the polygons in the shape
+		VectorPoint bounds_min;
+		VectorPoint bounds_max;
+
+		std::vector< VectorPoint >	points;
+		std::vector< int >			loop_ends;
+
+		// the outlines of the polygons while they're being merged
+		std::vector< VectorEdge >	edges;
+	};
+
+	inline long long VectorCross( const VectorPoint& a, const VectorPoint& b, const VectorPoint& c )
+	{
+		return (long long)( b.x - a.x ) * ( c.y - a.y ) - (long long)( b.y - a.y ) * ( c.x - a.x );
+	}
+
+	inline int VectorToByte( float f )
+	{
+		if( f <= 0.f ) return 0;
+		if( f >= 1.f ) return 255;
+		return (int)( f * 255.f + 0.5f );
+	}
+
+	inline uint32 VectorColor( const poro::types::fcolor& color )
+	{
+		return VectorToByte( color[ 0 ] ) | VectorToByte( color[ 1 ] ) << 8 | VectorToByte( color[ 2 ] ) << 16 | (uint32)VectorToByte( color[ 3 ] ) << 24;
+	}
+
+	inline int VectorAlpha( uint32 color ) { return ( color >> 24 ) & 0xFF; }
+
+	//-------------------------------------------------------------------------
+
+	inline VectorPoint VectorRound( const poro::types::vec2& v, float scale )
+	{
+		VectorPoint p;
+		p.x = (int)( v.x * scale + ( v.x < 0 ? -0.5f : 0.5f ) );
+		p.y = (int)( v.y * scale + ( v.y < 0 ? -0.5f : 0.5f ) );
+		return p;
+	}
+
+	// The outline of a triangle strip: the even vertices forwards and the odd
+	// ones backwards. Rounded, without repeated points and turned so that the 
+	// signed area is positive. Returns false if nothing is left.
+	//
+	// If the triangles of the strip don't all turn the same way, the strip 
+	// folds over itself and its outline crosses itself. Parts of it would 
+	// wind backwards and cancel out the other polygons of the merged path, so
+	// then every triangle is a loop of its own instead.
+	bool VectorGetLoops( const poro::types::vec2* vert, int count, float scale, std::vector< VectorPoint >& rounded, 
+		std::vector< VectorPoint >& out, std::vector< int >& loop_ends )
+	{
+		out.clear();
+		loop_ends.clear();
+		if( count < 3 )
+			return false;
+
+		rounded.resize( count );
+		for( int k = 0; k < count; ++k )
+			rounded[ k ] = VectorRound( vert[ k ], scale );
+
+		// every other triangle of a strip is wound the other way
+		bool forward = false;
+		bool backward = false;
+		for( int k = 0; k + 2 < count; ++k )
+		{
+			const long long cross = VectorCross( rounded[ k ], rounded[ k + 1 ], rounded[ k + 2 ] ) * ( ( k % 2 ) ? -1 : 1 );
+			if( cross > 0 ) forward = true;
+			if( cross < 0 ) backward = true;
+		}
+
+		if( forward == false && backward == false )
+			return false;
+
+		if( forward && backward )
+		{
+			for( int k = 0; k + 2 < count; ++k )
+			{
+				const long long cross = VectorCross( rounded[ k ], rounded[ k + 1 ], rounded[ k + 2 ] );
+				if( cross == 0 )
+					continue;
+
+				out.push_back( rounded[ k ] );
+				out.push_back( rounded[ cross > 0 ? k + 1 : k + 2 ] );
+				out.push_back( rounded[ cross > 0 ? k + 2 : k + 1 ] );
+				loop_ends.push_back( (int)out.size() );
+			}
+			return true;
+		}
+
+		const int evens = ( count + 1 ) / 2;
+		const int last_odd = ( count % 2 == 0 ) ? count - 1 : count - 2;
+		for( int k = 0; k < count; ++k )
+		{
+			const VectorPoint& p = rounded[ ( k < evens ) ? 2 * k : last_odd - 2 * ( k - evens ) ];
+			if( out.empty() || out.back() != p )
+				out.push_back( p );
+		}
+
+		while( out.size() > 1 && out.back() == out.front() )
+			out.pop_back();
+
+		if( out.size() < 3 )
+			return false;
+
+		long long area = 0;
+		for( std::size_t i = 0; i < out.size(); ++i )
+		{
+			const VectorPoint& a = out[ i ];
+			const VectorPoint& b = out[ ( i + 1 ) % out.size() ];
+			area += (long long)a.x * b.y - (long long)b.x * a.y;
+		}
+
+		if( area == 0 )
+			return false;
+
+		if( area < 0 )
+			std::reverse( out.begin(), out.end() );
+
+		loop_ends.push_back( (int)out.size() );
+		return true;
+	}
+
+	// Edges that two polygons share go in opposite directions, so they
+	// cancel out. What is left are the outlines of the merged areas, outer
+	// ones going one way and holes the other way.
+	void VectorCancelEdges( std::vector< VectorEdge >& edges )
+	{
+		// every edge with its points in order and the direction it went
+		std::vector< std::pair< VectorEdge, int > > sorted( edges.size() );
+		for( std::size_t i = 0; i < edges.size(); ++i )
+		{
+			const VectorEdge& e = edges[ i ];
+			const bool forward = e.a < e.b;
+			sorted[ i ].first.a = forward ? e.a : e.b;
+			sorted[ i ].first.b = forward ? e.b : e.a;
+			sorted[ i ].second = forward ? 1 : -1;
+		}
+
+		std::sort( sorted.begin(), sorted.end() );
+
+		edges.clear();
+		for( std::size_t i = 0; i < sorted.size(); )
+		{
+			const VectorEdge& e = sorted[ i ].first;
+			int count = 0;
+			std::size_t j = i;
+			for( ; j < sorted.size() && sorted[ j ].first.a == e.a && sorted[ j ].first.b == e.b; ++j )
+				count += sorted[ j ].second;
+
+			VectorEdge edge;
+			edge.a = ( count > 0 ) ? e.a : e.b;
+			edge.b = ( count > 0 ) ? e.b : e.a;
+			for( int k = 0; k < std::abs( count ); ++k )
+				edges.push_back( edge );
+
+			i = j;
+		}
+	}
+
+	// drops the points that are on the line between their neighbours
+	void VectorAddLoop( VectorShape& shape, const std::vector< VectorPoint >& loop )
+	{
+		std::vector< VectorPoint >& out = shape.points;
+		const std::size_t begin = out.size();
+		for( std::size_t i = 0; i < loop.size(); ++i )
+		{
+			while( out.size() >= begin + 2 && VectorCross( out[ out.size() - 2 ], out.back(), loop[ i ] ) == 0 )
+				out.pop_back();
+			out.push_back( loop[ i ] );
+		}
+
+		// the same around the start of the loop
+		std::size_t first = begin;
+		bool changed = true;
+		while( changed && out.size() - first >= 3 )
+		{
+			changed = false;
+			if( VectorCross( out[ out.size() - 2 ], out.back(), out[ first ] ) == 0 )
+			{
+				out.pop_back();
+				changed = true;
+			}
+			else if( VectorCross( out.back(), out[ first ], out[ first + 1 ] ) == 0 )
+			{
+				++first;
+				changed = true;
+			}
+		}
+
+		if( out.size() - first < 3 )
+		{
+			out.resize( begin );
+			return;
+		}
+
+		out.erase( out.begin() + begin, out.begin() + first );
+		shape.loop_ends.push_back( (int)out.size() );
+	}
+
+	// joins the edges that are left into closed loops
+	void VectorChainEdges( VectorShape& shape )
+	{
+		std::vector< VectorEdge >& edges = shape.edges;
+		std::sort( edges.begin(), edges.end() );
+		std::vector< char > used( edges.size(), 0 );
+
+		std::vector< VectorPoint > loop;
+		for( std::size_t i = 0; i < edges.size(); ++i )
+		{
+			if( used[ i ] )
+				continue;
+
+			loop.clear();
+			std::size_t current = i;
+			while( true )
+			{
+				used[ current ] = 1;
+				loop.push_back( edges[ current ].a );
+
+				const VectorPoint& end = edges[ current ].b;
+				if( end == edges[ i ].a )
+					break;
+
+				// the next unused edge that starts from end
+				VectorEdge key;
+				key.a = end;
+				key.b.x = key.b.y = -2147483647 - 1;
+				std::size_t next = std::lower_bound( edges.begin(), edges.end(), key ) - edges.begin();
+				while( next < edges.size() && edges[ next ].a == end && used[ next ] )
+					++next;
+
+				if( next >= edges.size() || edges[ next ].a != end )
+					break;
+
+				current = next;
+			}
+
+			VectorAddLoop( shape, loop );
+		}
+
+		std::vector< VectorEdge >().swap( edges );
+	}
+
+	void VectorGetBounds( const std::vector< VectorPoint >& points, VectorPoint& bounds_min, VectorPoint& bounds_max )
+	{
+		bounds_min = bounds_max = points[ 0 ];
+		for( std::size_t i = 1; i < points.size(); ++i )
+		{
+			bounds_min.x = std::min( bounds_min.x, points[ i ].x );
+			bounds_min.y = std::min( bounds_min.y, points[ i ].y );
+			bounds_max.x = std::max( bounds_max.x, points[ i ].x );
+			bounds_max.y = std::max( bounds_max.y, points[ i ].y );
+		}
+	}
+
+	// the areas overlap, touching edges don't count
+	bool VectorBoundsOverlap( const VectorShape& shape, const VectorPoint& bounds_min, const VectorPoint& bounds_max )
+	{
+		return shape.bounds_min.x < bounds_max.x && bounds_min.x < shape.bounds_max.x &&
+			shape.bounds_min.y < bounds_max.y && bounds_min.y < shape.bounds_max.y;
+	}
+
+	void VectorAddBounds( VectorShape& shape, const VectorPoint& bounds_min, const VectorPoint& bounds_max )
+	{
+		if( shape.edges.empty() && shape.points.empty() )
+		{
+			shape.bounds_min = bounds_min;
+			shape.bounds_max = bounds_max;
+			return;
+		}
+
+		shape.bounds_min.x = std::min( shape.bounds_min.x, bounds_min.x );
+		shape.bounds_min.y = std::min( shape.bounds_min.y, bounds_min.y );
+		shape.bounds_max.x = std::max( shape.bounds_max.x, bounds_max.x );
+		shape.bounds_max.y = std::max( shape.bounds_max.y, bounds_max.y );
+	}
+
+	// The polygons as paths, in the order they're written. A polygon is 
+	// merged into the earlier shape of its color only if nothing that is
+	// written after that shape overlaps it, so the merging doesn't change
+	// what is on top of what.
+	void VectorBuildShapes( const PolygonBuffer& polygons, const VectorExportSettings& settings, std::vector< VectorShape >& shapes )
+	{
+		float scale = 1;
+		for( int i = 0; i < settings.precision; ++i )
+			scale *= 10;
+
+		// the merged shape for each opaque color
+		std::map< uint32, int > merged;
+
+		std::vector< VectorPoint > rounded;
+		std::vector< VectorPoint > outline;
+		std::vector< int > outline_ends;
+		for( int i = 0; i < polygons.GetPolygonCount(); ++i )
+		{
+			if( VectorGetLoops( polygons.GetVertices( i ), polygons.GetCount( i ), scale, rounded, outline, outline_ends ) == false )
+				continue;
+
+			const uint32 color = VectorColor( polygons.GetColor( i ) );
+			if( VectorAlpha( color ) == 0 )
+				continue;
+
+			VectorPoint bounds_min, bounds_max;
+			VectorGetBounds( outline, bounds_min, bounds_max );
+
+			if( settings.merge && VectorAlpha( color ) == 255 )
+			{
+				std::map< uint32, int >::iterator m = merged.find( color );
+				if( m != merged.end() )
+				{
+					for( int j = (int)shapes.size() - 1; j > m->second; --j )
+					{
+						if( VectorBoundsOverlap( shapes[ j ], bounds_min, bounds_max ) )
+						{
+							merged.erase( m );
+							m = merged.end();
+							break;
+						}
+					}
+				}
+
+				if( m == merged.end() )
+				{
+					m = merged.insert( std::make_pair( color, (int)shapes.size() ) ).first;
+					shapes.push_back( VectorShape() );
+					shapes.back().color = color;
+					shapes.back().merged = true;
+				}
+
+				VectorAddBounds( shapes[ m->second ], bounds_min, bounds_max );
+				std::vector< VectorEdge >& edges = shapes[ m->second ].edges;
+				int begin = 0;
+				for( std::size_t l = 0; l < outline_ends.size(); ++l )
+				{
+					const int end = outline_ends[ l ];
+					for( int j = begin; j < end; ++j )
+					{
+						VectorEdge edge;
+						edge.a = outline[ j ];
+						edge.b = outline[ ( j + 1 < end ) ? j + 1 : begin ];
+						edges.push_back( edge );
+					}
+					begin = end;
+				}
+				continue;
+			}
+
+			// without merging, opaque polygons of the same color that come 
+			// one after another still go in the same path
+			if( shapes.empty() || shapes.back().merged || shapes.back().color != color || VectorAlpha( color ) != 255 )
+			{
+				shapes.push_back( VectorShape() );
+				shapes.back().color = color;
+			}
+
+			VectorShape& shape = shapes.back();
+			VectorAddBounds( shape, bounds_min, bounds_max );
+			const int offset = (int)shape.points.size();
+			shape.points.insert( shape.points.end(), outline.begin(), outline.end() );
+			for( std::size_t l = 0; l < outline_ends.size(); ++l )
+				shape.loop_ends.push_back( offset + outline_ends[ l ] );
+		}
+
+		for( std::size_t i = 0; i < shapes.size(); ++i )
+		{
+			if( shapes[ i ].merged )
+			{
+				VectorCancelEdges( shapes[ i ].edges );
+				VectorChainEdges( shapes[ i ] );
+			}
+		}
+	}
+
+	//-------------------------------------------------------------------------
+
+	// buffered writes to a file, counts the bytes for the pdf xref table
+	class VectorWriter
+	{
+	public:
+		explicit VectorWriter( const std::string& filename ) : mFile( fopen( filename.c_str(), "wb" ) ), mUsed( 0 ), mWritten( 0 ) { }
+		~VectorWriter() { Close(); }
+
+		bool IsOpen() const { return mFile != NULL; }
+		long long GetPosition() const { return mWritten + mUsed; }
+
+		void Write( const char* text )
+		{
+			for( ; *text; ++text )
+				Write( *text );
+		}
+
+		void Write( char c )
+		{
+			if( mUsed == BUFFER_SIZE )
+				Flush();
+			mBuffer[ mUsed++ ] = c;
+		}
+
+		void WriteInt( long long value )
+		{
+			if( value < 0 )
+			{
+				Write( '-' );
+				value = -value;
+			}
+
+			char digits[ 24 ];
+			int count = 0;
+			do
+			{
+				digits[ count++ ] = (char)( '0' + value % 10 );
+				value /= 10;
+			} while( value > 0 );
+
+			while( count > 0 )
+				Write( digits[ --count ] );
+		}
+
+		// value / 10^decimals, without trailing zeros
+		void WriteFixed( long long value, int decimals )
+		{
+			long long divisor = 1;
+			for( int i = 0; i < decimals; ++i )
+				divisor *= 10;
+
+			if( value < 0 )
+			{
+				Write( '-' );
+				value = -value;
+			}
+
+			WriteInt( value / divisor );
+
+			long long fraction = value % divisor;
+			if( fraction == 0 )
+				return;
+
+			Write( '.' );
+			for( divisor /= 10; divisor > 0 && fraction > 0; divisor /= 10 )
+			{
+				Write( (char)( '0' + fraction / divisor ) );
+				fraction %= divisor;
+			}
+		}
+
+		void WriteFloat( float value, int decimals )
+		{
+			float scale = 1;
+			for( int i = 0; i < decimals; ++i )
+				scale *= 10;
+			WriteFixed( (long long)( value * scale + ( value < 0 ? -0.5f : 0.5f ) ), decimals );
+		}
+
+		void WriteHexColor( uint32 color )
+		{
+			const char* hex = "0123456789abcdef";
+			Write( '#' );
+			for( int i = 0; i < 3; ++i )
+			{
+				const int c = ( color >> ( i * 8 ) ) & 0xFF;
+				Write( hex[ c >> 4 ] );
+				Write( hex[ c & 15 ] );
+			}
+		}
+
+		// returns false if anything failed to write
+		bool Close()
+		{
+			if( mFile == NULL )
+				return false;
+
+			Flush();
+			const bool ok = ( ferror( mFile ) == 0 );
+			const bool closed = ( fclose( mFile ) == 0 );
+			mFile = NULL;
+			return ok && closed;
+		}
+
+	private:
+		enum { BUFFER_SIZE = 64 * 1024 };
+
+		void Flush()
+		{
+			if( mFile && mUsed > 0 )
+				fwrite( mBuffer, 1, mUsed, mFile );
+			mWritten += mUsed;
+			mUsed = 0;
+		}
+
+		FILE*		mFile;
+		char		mBuffer[ BUFFER_SIZE ];
+		int			mUsed;
+		long long	mWritten;
+
+		// no copying
+		VectorWriter( const VectorWriter& other );
+		VectorWriter& operator= ( const VectorWriter& other );
+	};
+
+	// the outlines as ConfigRoom::white_lines draws them. Shared edges only
+	// once, the same as DrawLineBatch(), so they don't get twice the alpha
+	template< class T >
+	void VectorForEachLine( const PolygonBuffer& polygons, T& visitor )
+	{
+		if( polygons.Empty() )
+			return;
+
+		std::vector< poro::types::vec2 > edges;
+		GetUniqueEdges( &polygons.GetAllVertices()[ 0 ], &polygons.GetAllOffsets()[ 0 ], 
+			&polygons.GetAllCounts()[ 0 ], polygons.GetPolygonCount(), edges );
+
+		for( std::size_t i = 0; i + 1 < edges.size(); i += 2 )
+		{
+			visitor.Begin( edges[ i ] );
+			visitor.Line( edges[ i + 1 ] );
+		}
+	}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+
+VectorExportSettings::VectorExportSettings() :
+	width( 1280 ),
+	height( 1125 ),
+	precision( 2 ),
+	merge( true ),
+	background( poro::GetFColor( 0, 0, 0, 1 ) ),
+	white_lines( false ),
+	line_width( 1 ),
+	line_alpha( 1 )
+{
+}
+
+//-----------------------------------------------------------------------------
+
+namespace
+{
+	struct SvgLineWriter
+	{
+		SvgLineWriter( VectorWriter& out, int precision ) : out( out ), precision( precision ) { }
+
+		void Point( const poro::types::vec2& v )
+		{
+			out.WriteFloat( v.x, precision );
+			out.Write( ' ' );
+			out.WriteFloat( v.y, precision );
+		}
+
+		void Begin( const poro::types::vec2& v )	{ out.Write( 'M' ); Point( v ); }
+		void Line( const poro::types::vec2& v )		{ out.Write( 'L' ); Point( v ); }
+
+		VectorWriter& out;
+		int precision;
+	};
+}
+
+bool SaveSvg( const std::string& filename, const PolygonBuffer& polygons, const VectorExportSettings& settings )
+{
+	VectorExportSettings s = settings;
+	s.precision = std::min( std::max( s.precision, 0 ), 4 );
+
+	std::vector< VectorShape > shapes;
+	VectorBuildShapes( polygons, s, shapes );
+
+	VectorWriter out( filename );
+	if( out.IsOpen() == false )
+		return false;
+
+	out.Write( "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n" );
+	out.Write( "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\" width=\"" );
+	out.WriteInt( s.width );
+	out.Write( "\" height=\"" );
+	out.WriteInt( s.height );
+	out.Write( "\" viewBox=\"0 0 " );
+	out.WriteInt( s.width );
+	out.Write( ' ' );
+	out.WriteInt( s.height );
+	out.Write( "\">\n" );
+
+	const uint32 background = VectorColor( s.background );
+	if( VectorAlpha( background ) > 0 )
+	{
+		out.Write( "<rect width=\"100%\" height=\"100%\" fill=\"" );
+		out.WriteHexColor( background );
+		if( VectorAlpha( background ) < 255 )
+		{
+			out.Write( "\" fill-opacity=\"" );
+			out.WriteFixed( VectorAlpha( background ) * 1000 / 255, 3 );
+		}
+		out.Write( "\"/>\n" );
+	}
+
+	// coordinates are relative to the previous point, that keeps them short
+	for( std::size_t i = 0; i < shapes.size(); ++i )
+	{
+		const VectorShape& shape = shapes[ i ];
+		if( shape.loop_ends.empty() )
+			continue;
+
+		out.Write( "<path fill=\"" );
+		out.WriteHexColor( shape.color );
+		if( VectorAlpha( shape.color ) < 255 )
+		{
+			out.Write( "\" fill-opacity=\"" );
+			out.WriteFixed( VectorAlpha( shape.color ) * 1000 / 255, 3 );
+		}
+		out.Write( "\" d=\"" );
+
+		VectorPoint prev;
+		prev.x = prev.y = 0;
+		int begin = 0;
+		for( std::size_t l = 0; l < shape.loop_ends.size(); ++l )
+		{
+			const int end = shape.loop_ends[ l ];
+			for( int p = begin; p < end; ++p )
+			{
+				const VectorPoint& point = shape.points[ p ];
+				if( p == begin )		out.Write( l == 0 ? "M" : "m" );
+				else if( p == begin + 1 )	out.Write( 'l' );
+				else					out.Write( ' ' );
+
+				out.WriteFixed( point.x - prev.x, s.precision );
+				out.Write( ' ' );
+				out.WriteFixed( point.y - prev.y, s.precision );
+
+				prev = point;
+			}
+
+			// after z the current point is back at the start of the loop
+			out.Write( 'z' );
+			prev = shape.points[ begin ];
+			begin = end;
+		}
+
+		out.Write( "\"/>\n" );
+	}
+
+	if( s.white_lines && s.line_alpha > 0 )
+	{
+		out.Write( "<path fill=\"none\" stroke=\"#ffffff\" stroke-linejoin=\"round\" stroke-width=\"" );
+		out.WriteFloat( s.line_width, 2 );
+		if( s.line_alpha < 1 )
+		{
+			out.Write( "\" stroke-opacity=\"" );
+			out.WriteFloat( s.line_alpha, 3 );
+		}
+		out.Write( "\" d=\"" );
+
+		SvgLineWriter lines( out, s.precision );
+		VectorForEachLine( polygons, lines );
+
+		out.Write( "\"/>\n" );
+	}
+
+	out.Write( "</svg>\n" );
+	return out.Close();
+}
+
+//-----------------------------------------------------------------------------
+
+namespace
+{
+	struct PdfLineWriter
+	{
+		PdfLineWriter( VectorWriter& out, int precision ) : out( out ), precision( precision ) { }
+
+		void Point( const poro::types::vec2& v )
+		{
+			out.WriteFloat( v.x, precision );
+			out.Write( ' ' );
+			out.WriteFloat( v.y, precision );
+		}
+
+		void Begin( const poro::types::vec2& v )	{ Point( v ); out.Write( " m\n" ); }
+		void Line( const poro::types::vec2& v )		{ Point( v ); out.Write( " l\n" ); }
+
+		VectorWriter& out;
+		int precision;
+	};
+
+	// r g b in 0 - 1
+	void PdfWriteColor( VectorWriter& out, uint32 color )
+	{
+		for( int i = 0; i < 3; ++i )
+		{
+			out.WriteFixed( ( ( color >> ( i * 8 ) ) & 0xFF ) * 1000 / 255, 3 );
+			out.Write( ' ' );
+		}
+	}
+
+	// the graphics state that sets this alpha, the states are /A0 - /A255
+	void PdfWriteAlpha( VectorWriter& out, int alpha )
+	{
+		out.Write( "/A" );
+		out.WriteInt( alpha );
+		out.Write( " gs\n" );
+	}
+}
+
+bool SavePdf( const std::string& filename, const PolygonBuffer& polygons, const VectorExportSettings& settings )
+{
+	VectorExportSettings s = settings;
+	s.precision = std::min( std::max( s.precision, 0 ), 4 );
+
+	std::vector< VectorShape > shapes;
+	VectorBuildShapes( polygons, s, shapes );
+
+	VectorWriter out( filename );
+	if( out.IsOpen() == false )
+		return false;
+
+	// the objects are 1 catalog, 2 pages, 3 page, 4 content stream and
+	// 5 its length. The content goes first, so that it can be written 
+	// straight out and its length written after it.
+	const int object_count = 5;
+	long long offsets[ object_count + 1 ] = { 0 };
+	std::vector< char > alphas_used( 256, 0 );
+
+	out.Write( "%PDF-1.4\n%\xE2\xE3\xCF\xD3\n" );
+
+	offsets[ 4 ] = out.GetPosition();
+	out.Write( "4 0 obj\n<< /Length 5 0 R >>\nstream\n" );
+	const long long stream_begin = out.GetPosition();
+
+	// y goes down like on the screen
+	out.Write( "1 0 0 -1 0 " );
+	out.WriteInt( s.height );
+	out.Write( " cm\n" );
+
+	const uint32 background = VectorColor( s.background );
+	if( VectorAlpha( background ) > 0 )
+	{
+		out.Write( "q\n" );
+		if( VectorAlpha( background ) < 255 )
+		{
+			PdfWriteAlpha( out, VectorAlpha( background ) );
+			alphas_used[ VectorAlpha( background ) ] = 1;
+		}
+		PdfWriteColor( out, background );
+		out.Write( "rg\n0 0 " );
+		out.WriteInt( s.width );
+		out.Write( ' ' );
+		out.WriteInt( s.height );
+		out.Write( " re f\nQ\n" );
+	}
+
+	for( std::size_t i = 0; i < shapes.size(); ++i )
+	{
+		const VectorShape& shape = shapes[ i ];
+		if( shape.loop_ends.empty() )
+			continue;
+
+		const int alpha = VectorAlpha( shape.color );
+		out.Write( "q\n" );
+		if( alpha < 255 )
+		{
+			PdfWriteAlpha( out, alpha );
+			alphas_used[ alpha ] = 1;
+		}
+		PdfWriteColor( out, shape.color );
+		out.Write( "rg\n" );
+
+		int begin = 0;
+		for( std::size_t l = 0; l < shape.loop_ends.size(); ++l )
+		{
+			const int end = shape.loop_ends[ l ];
+			for( int p = begin; p < end; ++p )
+			{
+				out.WriteFixed( shape.points[ p ].x, s.precision );
+				out.Write( ' ' );
+				out.WriteFixed( shape.points[ p ].y, s.precision );
+				out.Write( p == begin ? " m\n" : " l\n" );
+			}
+			out.Write( "h\n" );
+			begin = end;
+		}
+
+		out.Write( "f\nQ\n" );
+	}
+
+	if( s.white_lines && s.line_alpha > 0 )
+	{
+		const int alpha = VectorToByte( s.line_alpha );
+		out.Write( "q\n" );
+		if( alpha < 255 )
+		{
+			PdfWriteAlpha( out, alpha );
+			alphas_used[ alpha ] = 1;
+		}
+		out.Write( "1 1 1 RG 1 j " );
+		out.WriteFloat( s.line_width, 2 );
+		out.Write( " w\n" );
+
+		PdfLineWriter lines( out, s.precision );
+		VectorForEachLine( polygons, lines );
+
+		out.Write( "S\nQ\n" );
+	}
+
+	const long long stream_length = out.GetPosition() - stream_begin;
+	out.Write( "endstream\nendobj\n" );
+
+	offsets[ 5 ] = out.GetPosition();
+	out.Write( "5 0 obj\n" );
+	out.WriteInt( stream_length );
+	out.Write( "\nendobj\n" );
+
+	offsets[ 3 ] = out.GetPosition();
+	out.Write( "3 0 obj\n<< /Type /Page /Parent 2 0 R /MediaBox [0 0 " );
+	out.WriteInt( s.width );
+	out.Write( ' ' );
+	out.WriteInt( s.height );
+	out.Write( "] /Contents 4 0 R /Resources << /ExtGState <<" );
+	for( int i = 0; i < 256; ++i )
+	{
+		if( alphas_used[ i ] == 0 )
+			continue;
+
+		out.Write( " /A" );
+		out.WriteInt( i );
+		out.Write( " << /ca " );
+		out.WriteFixed( i * 1000 / 255, 3 );
+		out.Write( " /CA " );
+		out.WriteFixed( i * 1000 / 255, 3 );
+		out.Write( " >>" );
+	}
+	out.Write( " >> >> >>\nendobj\n" );
+
+	offsets[ 2 ] = out.GetPosition();
+	out.Write( "2 0 obj\n<< /Type /Pages /Kids [3 0 R] /Count 1 >>\nendobj\n" );
+
+	offsets[ 1 ] = out.GetPosition();
+	out.Write( "1 0 obj\n<< /Type /Catalog /Pages 2 0 R >>\nendobj\n" );
+
+	// every xref entry is exactly 20 bytes
+	const long long xref = out.GetPosition();
+	out.Write( "xref\n0 " );
+	out.WriteInt( object_count + 1 );
+	out.Write( "\n0000000000 65535 f \n" );
+	for( int i = 1; i <= object_count; ++i )
+	{
+		char entry[ 32 ];
+		sprintf( entry, "%010ld 00000 n \n", (long)offsets[ i ] );
+		out.Write( entry );
+	}
+
+	out.Write( "trailer\n<< /Size " );
+	out.WriteInt( object_count + 1 );
+	out.Write( " /Root 1 0 R >>\nstartxref\n" );
+	out.WriteInt( xref );
+	out.Write( "\n%%EOF\n" );
+
+	return out.Close();
+}
+
+//-----------------------------------------------------------------------------
+
+bool IsVectorFilename( const std::string& filename )
+{
+	const std::string extension = ceng::GetFileExtension( filename );
+	return extension == "svg" || extension == "pdf";
+}
+
+bool SaveVector( const std::string& filename, const PolygonBuffer& polygons, const VectorExportSettings& settings )
+{
+	if( ceng::GetFileExtension( filename ) == "pdf" )
+		return SavePdf( filename, polygons, settings );
+
+	return SaveSvg( filename, polygons, settings );
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,63 @@
+//-----------------------------------------------------------------------------
+// Vector export
+// =============
+//
+// Writes the polygons of a PolygonBuffer as an SVG or a PDF, for printing
+// without rasterizing anything. The polygons are read the same way the
+// preview draws them, as triangle strips.
+//
+// Coordinates are rounded to 1 / 10^precision pixels. With merge on, the
+// polygons of a color become one path: the edges that two polygons share
+// cancel out and only the outlines are written. A polygon is only merged into
+// an earlier path if nothing drawn in between overlaps it (by the bounding
+// boxes), so the polygons that are drawn on top of others stay on top.
+// Translucent polygons are never merged. The paths are filled with the 
+// nonzero rule and every loop winds the same way, so overlapping polygons of
+// a color don't leave holes. A strip that folds over itself is written as 
+// its triangles.
+//
+// The file is written as it goes through a small buffer, nothing is built
+// up in memory except the merged outlines.
+//
+// In the PDF one pixel is one point.
+//-----------------------------------------------------------------------------
+#ifndef INC_VECTOR_EXPORT_H
+#define INC_VECTOR_EXPORT_H
+
+#include <string>
+#include <poro/poro_types.h>
+
+class PolygonBuffer;
+
+struct VectorExportSettings
+{
+	VectorExportSettings();
+
+	int width;
+	int height;
+
+	// decimals in the coordinates, 0 - 4
+	int precision;
+
+	bool merge;
+
+	// the whole page is filled with this first, unless alpha is 0
+	poro::types::fcolor background;
+
+	// the white outlines that ConfigRoom::white_lines draws
+	bool	white_lines;
+	float	line_width;
+	float	line_alpha;
+};
+
+// returns false if the file couldn't be written
+bool SaveSvg( const std::string& filename, const PolygonBuffer& polygons, const VectorExportSettings& settings );
+bool SavePdf( const std::string& filename, const PolygonBuffer& polygons, const VectorExportSettings& settings );
+
+// true for .svg and .pdf files
+bool IsVectorFilename( const std::string& filename );
+
+// SaveSvg() or SavePdf() depending on the extension
+bool SaveVector( const std::string& filename, const PolygonBuffer& polygons, const VectorExportSettings& settings );
+
+#endif
@@ -7,6 +7,7 @@
 
 class DebugLayer;
 namespace as { class Sprite; }
+namespace poro { class IMesh; }
 
 
 class ProceduralTriangles : public poro::DefaultApplication
@@ -39,6 +40,18 @@ public:
 	as::Sprite* mBackgroundSprite;
 	std::auto_ptr< DebugLayer >		mDebugLayer;
 
+	// what triangles were generated from, they're only generated again
+	// when one of these changes
+	unsigned int	mGeneratedConfigHash;
+	int				mGeneratedPaletteVersion;
+	bool			mGenerated;
+
+	// triangles as retained geometry, rebuilt by Draw() when mMeshDirty
+	poro::IMesh*						mMesh;
+	bool								mMeshDirty;
+	std::vector< poro::types::vec2 >	mMeshVertices;
+	std::vector< poro::types::fcolor >	mMeshColors;
+
 };
 
 #endif
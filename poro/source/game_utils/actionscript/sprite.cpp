@@ -470,9 +470,15 @@ Sprite::Sprite() :
 	mCenterOffset( 0, 0 ),
 	mXForm(),
 	mZ( 100 ),
-	mColor( 4 ),
+	mColor(),
 	mDead( false ),
 	mVisible( true ),
+	mChildTransform(),
+	mChildTransformParent( 0 ),
+	mChildTransformDirty( true ),
+	mHitIndex( false ),
+	mHitBoundsDirty( true ),
+	mHitBounds( 0, 0, -1, -1 ),
 	mRect( NULL ),
 	mRectAnimation( NULL ),
 	mAnimations( NULL ),
@@ -592,7 +598,7 @@ bool Sprite::Draw( poro::IGraphics* graphics, types::camera* camera, Transform&
 		{
 			// the alpha mask is the child of the mask of the other
 			types::xform orign;
-			std::vector< float > orig_color( 4 );
+			poro::types::fcolor orig_color;
 			for( int i = 0; i < 4; ++i ) orig_color[ i ] = 1.f;
 			transform.PushXFormButDontMultiply( orign, orig_color );
 			types::xform x = ceng::math::Mul( GetXForm(), mAlphaMask->GetXForm() );
@@ -646,7 +652,18 @@ bool Sprite::DrawChildren( poro::IGraphics* graphics, types::camera* camera, Tra
 	if( mChildren.empty() )
 		return true;
 
-	transform.PushXForm( mXForm, mColor );
+	const Transform::TransformHelper& parent = transform.GetTop();
+	if( mChildTransformDirty || mChildTransformParent != parent.version )
+	{
+		mChildTransform.xform = ceng::math::Mul( parent.xform, mXForm );
+		mChildTransform.color = parent.color;
+		Transform::MulColor( mChildTransform.color, mColor );
+		mChildTransform.version = Transform::NewVersion();
+		mChildTransformParent = parent.version;
+		mChildTransformDirty = false;
+	}
+
+	transform.PushCached( mChildTransform );
 
 	DisplayObjectContainer::ChildList::iterator i;
 	Sprite* current = NULL;
@@ -658,7 +675,7 @@ bool Sprite::DrawChildren( poro::IGraphics* graphics, types::camera* camera, Tra
 
 		if( (*i)->GetSpriteType() == this->GetSpriteType() )
 		{			
-			current = dynamic_cast< Sprite* >(*i);
+			current = static_cast< Sprite* >(*i);
 			cassert( current );
 			if( current->IsSpriteDead() == false )
 			{
@@ -699,7 +716,7 @@ bool Sprite::DrawRect( const types::rect& rect, poro::IGraphics* graphics, types
 	if( true  )
 	{
 		const types::xform& matrix = transform.GetXForm();
-		const std::vector< float >& tcolor = transform.GetColor();
+		const poro::types::fcolor& tcolor = transform.GetColor();
 
 		types::rect dest_rect(rect.x, rect.y, rect.w, rect.h );
 		poro::types::fcolor color_me = poro::GetFColor( 
@@ -826,6 +843,8 @@ void Sprite::Update( float dt )
 void Sprite::SetScale( float w, float h ) { 
 	mXForm.scale.x = w; 
 	mXForm.scale.y = h; 
+	mChildTransformDirty = true;
+	SetHitBoundsDirty();
 }
 
 //=============================================================================
@@ -1174,6 +1193,12 @@ std::vector< Sprite* > Sprite::FindSpritesAtPoint( const types::vector2& p )
 {
 	std::vector< Sprite* > result;
 
+	if( mHitIndex )
+	{
+		FindSpritesAtPointIndexed( p, result );
+		return result;
+	}
+
     Transform t;
 	FindSpritesAtPointImpl( p, t, result );
 
@@ -1220,7 +1245,7 @@ void Sprite::FindSpritesAtPointImpl( const types::vector2& pos, Transform& trans
 	{
 		if( (*i)->GetSpriteType() == this->GetSpriteType() )
 		{			
-			current = dynamic_cast< Sprite* >(*i);
+			current = static_cast< Sprite* >(*i);
 			cassert( current );
 			if( current == NULL || current->IsSpriteDead() )
 				continue;
@@ -1232,5 +1257,161 @@ void Sprite::FindSpritesAtPointImpl( const types::vector2& pos, Transform& trans
 	transform.PopXForm();
 }
 
+//-----------------------------------------------------------------------------
+
+namespace {
+
+	void SpriteGrowBounds( types::vector2& min_p, types::vector2& max_p, bool& empty, const types::vector2& p )
+	{
+		if( empty )
+		{
+			min_p = p;
+			max_p = p;
+			empty = false;
+			return;
+		}
+
+		min_p.x = ceng::math::Min( min_p.x, p.x );
+		min_p.y = ceng::math::Min( min_p.y, p.y );
+		max_p.x = ceng::math::Max( max_p.x, p.x );
+		max_p.y = ceng::math::Max( max_p.y, p.y );
+	}
+
+	// the edges count as inside, the bounds are only there to reject things
+	bool SpriteIsInsideBounds( const types::rect& bounds, const types::vector2& p )
+	{
+		return bounds.w >= 0 && bounds.h >= 0 &&
+			p.x >= bounds.x && p.x <= bounds.x + bounds.w &&
+			p.y >= bounds.y && p.y <= bounds.y + bounds.h;
+	}
+
+	// the inverse of MulWithScale(), MulTWithScale() divides by the scale 
+	// before removing the position
+	types::vector2 SpriteToLocal( const types::xform& xform, const types::vector2& p )
+	{
+		types::vector2 result = ceng::math::MulT( xform.R, p - xform.position );
+		if( xform.scale.x != 0 ) result.x /= xform.scale.x;
+		if( xform.scale.y != 0 ) result.y /= xform.scale.y;
+		return result;
+	}
+
+} // end of anonymous namespace
+
+void Sprite::SetFather( DisplayObjectContainer* father )
+{
+	DisplayObjectContainer::SetFather( father );
+
+	// the new father has to be dirty even if we already are
+	mHitBoundsDirty = true;
+	if( father && father->GetSpriteType() == this->GetSpriteType() )
+		static_cast< Sprite* >( father )->SetHitBoundsDirty();
+}
+
+// if we're dirty all of our parents are already dirty as well, so this 
+// stops at the first dirty one
+void Sprite::SetHitBoundsDirty()
+{
+	if( mHitBoundsDirty ) 
+		return;
+
+	mHitBoundsDirty = true;
+	if( mFather && mFather->GetSpriteType() == this->GetSpriteType() )
+		static_cast< Sprite* >( mFather )->SetHitBoundsDirty();
+}
+
+const types::rect& Sprite::GetHitBounds()
+{
+	if( mHitBoundsDirty == false )
+		return mHitBounds;
+
+	// first in our own space
+	types::vector2 min_p( 0, 0 );
+	types::vector2 max_p( 0, 0 );
+	bool empty = true;
+
+	if( mTexture )
+	{
+		const types::rect dest_rect = GetRect();
+		SpriteGrowBounds( min_p, max_p, empty, types::vector2( -mCenterOffset.x, -mCenterOffset.y ) );
+		SpriteGrowBounds( min_p, max_p, empty, types::vector2( dest_rect.w - mCenterOffset.x, dest_rect.h - mCenterOffset.y ) );
+	}
+
+	for( ChildList::iterator i = mChildren.begin(); i != mChildren.end(); ++i )
+	{
+		if( (*i)->GetSpriteType() != this->GetSpriteType() )
+			continue;
+
+		const types::rect& child = static_cast< Sprite* >(*i)->GetHitBounds();
+		if( child.w < 0 || child.h < 0 )
+			continue;
+
+		SpriteGrowBounds( min_p, max_p, empty, types::vector2( child.x, child.y ) );
+		SpriteGrowBounds( min_p, max_p, empty, types::vector2( child.x + child.w, child.y + child.h ) );
+	}
+
+	if( empty )
+	{
+		mHitBounds = types::rect( 0, 0, -1, -1 );
+	}
+	else
+	{
+		// then the corners to the space of the parent
+		const types::vector2 corners[ 4 ] = { 
+			types::vector2( min_p.x, min_p.y ), types::vector2( min_p.x, max_p.y ),
+			types::vector2( max_p.x, max_p.y ), types::vector2( max_p.x, min_p.y ) };
+
+		bool parent_empty = true;
+		types::vector2 parent_min( 0, 0 );
+		types::vector2 parent_max( 0, 0 );
+		for( int i = 0; i < 4; ++i )
+			SpriteGrowBounds( parent_min, parent_max, parent_empty, ceng::math::MulWithScale( mXForm, corners[ i ] ) );
+
+		mHitBounds = types::rect( parent_min.x, parent_min.y, parent_max.x - parent_min.x, parent_max.y - parent_min.y );
+	}
+
+	mHitBoundsDirty = false;
+	return mHitBounds;
+}
+
+// pos is in the space of our parent, same as in FindSpritesAtPointImpl() 
+// with an identity transform
+void Sprite::FindSpritesAtPointIndexed( const types::vector2& pos, std::vector< Sprite* >& results )
+{
+	if( SpriteIsInsideBounds( GetHitBounds(), pos ) == false )
+		return;
+
+	if( mTexture )
+	{
+		const types::rect dest_rect = GetRect();
+		std::vector< types::vector2 > polygon( 4 );
+		polygon[ 0 ].Set( -mCenterOffset.x,					-mCenterOffset.y );
+		polygon[ 1 ].Set( -mCenterOffset.x,					dest_rect.h - mCenterOffset.y );
+		polygon[ 2 ].Set( dest_rect.w - mCenterOffset.x,	dest_rect.h - mCenterOffset.y );
+		polygon[ 3 ].Set( dest_rect.w - mCenterOffset.x,	-mCenterOffset.y );
+		for( int i = 0; i < (int)polygon.size(); ++i )
+			polygon[ i ] = ceng::math::MulWithScale( mXForm, polygon[ i ] );
+
+		if( ceng::math::IsPointInsidePolygon_Better( pos, polygon ) )
+			results.push_back( this );
+	}
+
+	if( mChildren.empty() ) 
+		return;
+
+	const types::vector2 local_pos = SpriteToLocal( mXForm, pos );
+
+	for( ChildList::iterator i = mChildren.begin(); i != mChildren.end(); ++i )
+	{
+		if( (*i)->GetSpriteType() == this->GetSpriteType() )
+		{
+			Sprite* current = static_cast< Sprite* >(*i);
+			if( current->IsSpriteDead() )
+				continue;
+		
+			current->FindSpritesAtPointIndexed( local_pos, results );
+		}
+	}
+}
+
 //-----------------------------------------------------------------------------
 } // end of namespace as
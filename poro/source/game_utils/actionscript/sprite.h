@@ -45,7 +45,101 @@ typedef poro::types::Uint32 Uint32;
 
 // ----------------------------------------------------------------------------
 
-struct Transform;
+// The stack of transforms and colors while drawing a sprite tree. It's a 
+// fixed array, so pushing and popping never allocates. Every entry has a 
+// version that changes whenever its contents change, the sprites use it to
+// know if the transform they've cached for their children is still valid.
+struct Transform
+{
+	struct TransformHelper
+	{
+		TransformHelper() : color(), xform(), version( 0 ) { color[ 0 ] = 1.f; color[ 1 ] = 1.f; color[ 2 ] = 1.f; color[ 3 ] = 1.f; xform.SetIdentity(); }
+
+		poro::types::fcolor			color;
+		types::xform				xform;
+		unsigned int				version;
+	};
+
+	enum { MAX_DEPTH = 64 };
+
+	Transform() : mTop(), mDepth( 0 )
+	{ 
+	}
+	
+	void PushXFormButDontMultiply( const types::xform& xform, const poro::types::fcolor& color )
+	{
+		Push();
+		mTop.xform = xform;
+		mTop.color = color;
+		mTop.version = NewVersion();
+	}
+
+	void PushXForm( const types::xform& xform, const poro::types::fcolor& color )
+	{
+		Push();
+		mTop.xform = ceng::math::Mul( mTop.xform, xform );
+		MulColor( mTop.color, color );
+		mTop.version = NewVersion();
+	}
+
+	// pushes a transform that has already been multiplied with the top, 
+	// keeping its version
+	void PushCached( const TransformHelper& top )
+	{
+		Push();
+		mTop = top;
+	}
+
+	void PopXForm()
+	{
+		if( mDepth > 0 )
+		{
+			--mDepth;
+			if( mDepth < MAX_DEPTH ) 
+				mTop = mQueue[ mDepth ];
+		}
+	}
+
+	static void MulColor( poro::types::fcolor& c1, const poro::types::fcolor& c2 )
+	{
+		c1[ 0 ] *= c2[ 0 ];
+		c1[ 1 ] *= c2[ 1 ];
+		c1[ 2 ] *= c2[ 2 ];
+		c1[ 3 ] *= c2[ 3 ];
+	}
+
+	// never returns 0, that's the version of the identity at the bottom
+	static unsigned int NewVersion()
+	{
+		static unsigned int version = 0;
+		++version;
+		if( version == 0 ) 
+			++version;
+		return version;
+	}
+
+	types::xform&					GetXForm()	{ return mTop.xform; }
+	const types::xform&				GetXForm() const { return mTop.xform; }
+	const poro::types::fcolor&		GetColor() const { return mTop.color; }
+	const TransformHelper&			GetTop() const { return mTop; }
+
+	TransformHelper mTop;
+	TransformHelper mQueue[ MAX_DEPTH ];
+	int				mDepth;
+
+private:
+	void Push()
+	{
+		// deeper trees than this aren't drawn correctly
+		cassert( mDepth < MAX_DEPTH );
+		if( mDepth < MAX_DEPTH ) 
+			mQueue[ mDepth ] = mTop;
+		++mDepth;
+	}
+};
+
+// ----------------------------------------------------------------------------
+
 class Animations;
 class SpriteAnimationUpdater;
 
@@ -84,7 +178,8 @@ public:
 	float			GetAlpha();
 	void 			SetColor( float r, float g, float b );
 	void 			SetColor( const std::vector< float >& color );
-	const std::vector< float >& GetColor();
+	void 			SetColor( const poro::types::fcolor& color );
+	const poro::types::fcolor& GetColor();
 	void 			SetRotation( float r );
 	float 			GetRotation();
 	void			SetVisibility( bool value );
@@ -117,8 +212,8 @@ public:
 
 	float		GetX() { return mXForm.position.x; }
 	float		GetY() { return mXForm.position.y; }
-	void		SetX( float x ) { mXForm.position.x = x; }
-	void		SetY( float y ) { mXForm.position.y = y; }
+	void		SetX( float x ) { mXForm.position.x = x; mChildTransformDirty = true; SetHitBoundsDirty(); }
+	void		SetY( float y ) { mXForm.position.y = y; mChildTransformDirty = true; SetHitBoundsDirty(); }
 
 	void		SetClearTweens( bool value )	{ mClearTweens = value; }
 	bool		GetClearTweens() const			{ return mClearTweens; }
@@ -293,6 +388,21 @@ public:
 	std::vector< Sprite* >	FindSpritesAtPoint( const types::vector2& p );
 	types::vector2			GetScreenPosition() const;
 	types::vector2			TransformWithAllParents( const types::vector2& mouse_pos ) const;
+
+	// With the hit index on FindSpritesAtPoint() skips the children whose 
+	// cached bounds don't contain the point. The bounds are kept per sprite 
+	// and only the ones that have been moved, resized or given new children
+	// since the last query are calculated again. If you change a sprite 
+	// some other way than with its setters, call SetHitBoundsDirty().
+	void					SetHitIndex( bool value )	{ mHitIndex = value; }
+	bool					GetHitIndex() const			{ return mHitIndex; }
+	void					SetHitBoundsDirty();
+
+	// bounds of this sprite and all of its children in the space of the 
+	// parent. w and h are negative if there's nothing to hit
+	const types::rect&		GetHitBounds();
+
+	virtual void			SetFather( DisplayObjectContainer* father );
 	
 	//-------------------------------------------------------------------------
 
@@ -306,6 +416,7 @@ public:
 protected:
 
 	void FindSpritesAtPointImpl( const types::vector2& pos, Transform& transform, std::vector< Sprite* >& results );
+	void FindSpritesAtPointIndexed( const types::vector2& pos, std::vector< Sprite* >& results );
 
 	types::vector2 MultiplyByParentXForm( const types::vector2& p ) const;
 	
@@ -325,10 +436,22 @@ protected:
 	types::xform				mXForm;
 	int							mZ;
 
-	std::vector< float >		mColor;
+	poro::types::fcolor			mColor;
 	bool						mDead;
 	bool						mVisible;
 
+	// what DrawChildren() pushes for the children, the parent transform 
+	// multiplied with mXForm and mColor. It's calculated again only when 
+	// one of the setters has changed this sprite or the version of the 
+	// parent transform isn't mChildTransformParent anymore.
+	Transform::TransformHelper	mChildTransform;
+	unsigned int				mChildTransformParent;
+	bool						mChildTransformDirty;
+
+	bool						mHitIndex;
+	bool						mHitBoundsDirty;
+	types::rect					mHitBounds;
+
 	types::rect*				mRect;
 
 	// animation stuff
@@ -341,72 +464,6 @@ protected:
 	std::string								mFilename;
 };
 
-// ----------------------------------------------------------------------------
-
-struct Transform
-{
-	struct TransformHelper
-	{
-		TransformHelper() : color( 4 ), xform() { color[ 0 ] = 1.f; color[ 1 ] = 1.f; color[ 2 ] = 1.f; color[ 3 ] = 1.f; xform.SetIdentity(); }
-
-		std::vector< float >		color;
-		types::xform				xform;
-	};
-
-	Transform() 
-	{ 
-	}
-	
-	void PushXFormButDontMultiply( const types::xform& xform,  const std::vector< float >& color )
-	{
-		mQueue.push_front( mTop );
-		mTop.xform = xform;
-		mTop.color = color;
-	}
-
-	void PushXForm( const types::xform& xform, const std::vector< float >& color )
-	{
-		mQueue.push_front( mTop );
-		mTop.xform = ceng::math::Mul( mTop.xform, xform );
-		MulColor( mTop.color, color );
-	}
-
-	void PopXForm()
-	{
-		if( mQueue.empty() == false )
-		{
-			mTop = mQueue.front();
-			mQueue.pop_front();
-		}
-	}
-
-	void MulColor( std::vector< float >& c1, const std::vector< float >& c2 )
-	{
-		cassert( c1.size() == 4 );
-		cassert( c2.size() == 4 );
-		c1[ 0 ] *= c2[ 0 ];
-		c1[ 1 ] *= c2[ 1 ];
-		c1[ 2 ] *= c2[ 2 ];
-		c1[ 3 ] *= c2[ 3 ];
-		/* for( std::size_t i = 0; i < result.size(); ++i )
-			c1[ i ] *= c2[ i ];
-			*/
-	}
-
-	types::xform&					GetXForm()	{ return mTop.xform; }
-	const types::xform&				GetXForm() const { return mTop.xform; }
-	const std::vector< float >&		GetColor() const { return mTop.color; }
-
-	/*
-	types::xform mXForm;
-	std::list< types::xform > mXFormQueue;
-	*/
-
-	TransformHelper mTop;
-	std::list< TransformHelper > mQueue;
-	
-};
-
 //-----------------------------------------------------------------------------
 
 void DrawSprite( Sprite* sprite, poro::IGraphics* graphics, types::camera* camera = NULL );
@@ -420,6 +477,8 @@ inline types::vector2 Sprite::GetCenterPos() const {
 
 inline void Sprite::MoveTo( const types::vector2& p ) { 
 	mXForm.position = p;
+	mChildTransformDirty = true;
+	SetHitBoundsDirty();
 }
 
 inline void Sprite::MoveBy( const types::vector2& p ) { 
@@ -461,6 +520,7 @@ inline float Sprite::GetScaleY() { return GetScale().y; }
 
 inline void Sprite::SetAlpha( float v ) { 
 	mColor[ 3 ] = ceng::math::Clamp( v, 0.f, 1.f ); 
+	mChildTransformDirty = true;
 }
 
 inline float Sprite::GetAlpha() { 
@@ -469,17 +529,29 @@ inline float Sprite::GetAlpha() {
 
 inline void Sprite::SetColor( float r, float g, float b ) { 
 	mColor[ 0 ] = r; mColor[ 1 ] = g; mColor[ 2 ] = b; 
+	mChildTransformDirty = true;
 }
 
 inline void Sprite::SetColor( const std::vector<float>& color) { 
+	cassert( color.size() == 4 );
+	for( int i = 0; i < 4 && i < (int)color.size(); ++i )
+		mColor[ i ] = color[ i ];
+	mChildTransformDirty = true;
+}
+
+inline void Sprite::SetColor( const poro::types::fcolor& color ) { 
 	mColor = color;
+	mChildTransformDirty = true;
 }
-inline const std::vector< float >& Sprite::GetColor() {
+
+inline const poro::types::fcolor& Sprite::GetColor() {
 	return mColor;
 }
 
 inline void Sprite::SetRotation( float angle ) { 
 	mXForm.R.Set( angle );
+	mChildTransformDirty = true;
+	SetHitBoundsDirty();
 }
 
 inline float Sprite::GetRotation() {
@@ -521,6 +593,7 @@ inline bool Sprite::IsSpriteDead() const {
 
 inline void Sprite::SetTexture( Image* texture ) { 
 	mTexture = texture;
+	SetHitBoundsDirty();
 }
 
 inline Sprite::Image* Sprite::GetTexture() { 
@@ -545,6 +618,7 @@ inline int Sprite::GetZ() const {
 
 inline void Sprite::SetCenterOffset( const types::vector2& p ) { 
 	mCenterOffset = p; 
+	SetHitBoundsDirty();
 }
 
 inline types::vector2 Sprite::GetCenterOffset() const {
@@ -553,6 +627,7 @@ inline types::vector2 Sprite::GetCenterOffset() const {
 
 inline void Sprite::SetSize( int w, int h ) { 
 	mSize.Set( (float)w, (float)h );
+	SetHitBoundsDirty();
 	/*SetCenterOffset( types::vector2( 0.5f * w, 0.5f * h ) );*/
 }
 
@@ -564,12 +639,14 @@ inline types::rect Sprite::GetRect() const {
 inline void Sprite::SetRect( const types::rect& r ) {
 	if( mRect == NULL ) mRect = new types::rect;
 	*mRect = r;
+	SetHitBoundsDirty();
 }
 
 inline void Sprite::RemoveRect() {
 	if( mRect ) {
 		delete mRect;
 		mRect = NULL;
+		SetHitBoundsDirty();
 	}
 }
 
@@ -579,6 +656,8 @@ inline types::xform	Sprite::GetXForm() const {
 
 inline void Sprite::SetXForm( const types::xform& transform ) {
 	mXForm = transform;
+	mChildTransformDirty = true;
+	SetHitBoundsDirty();
 }
 
 inline const std::string& Sprite::GetFilename() const {
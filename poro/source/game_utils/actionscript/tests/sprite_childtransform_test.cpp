@@ -0,0 +1,184 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2003 - 2011 Petri Purho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+
+#include "../sprite.h"
+#include "../../../utils/debug.h"
+
+#ifdef PORO_TESTER_ENABLED
+namespace as {
+namespace test {
+
+namespace {
+	// remembers the transform it was drawn with, doesn't draw anything
+	class ChildTransformProbe : public Sprite
+	{
+	public:
+		ChildTransformProbe() : draws( 0 ), xform(), color(), version( 0 ) { SetClearTweens( false ); }
+
+		virtual bool DrawRect( const types::rect& rect, poro::IGraphics* graphics, types::camera* camera, const Transform& transform )
+		{
+			draws++;
+			xform = transform.GetXForm();
+			color = transform.GetColor();
+			version = transform.GetTop().version;
+			return true;
+		}
+
+		int					draws;
+		types::xform		xform;
+		poro::types::fcolor	color;
+		unsigned int		version;
+	};
+
+	bool ChildTransformClose( float a, float b )
+	{
+		return a - b < 0.0001f && b - a < 0.0001f;
+	}
+
+	// what the father should push for its children
+	Transform::TransformHelper ChildTransformOf( const Transform::TransformHelper& parent, Sprite& father )
+	{
+		Transform::TransformHelper result = parent;
+		result.xform = ceng::math::Mul( parent.xform, father.GetXForm() );
+		Transform::MulColor( result.color, father.GetColor() );
+		return result;
+	}
+
+	// the child was drawn with the parent transform times the father
+	bool ChildTransformIsRight( const ChildTransformProbe& child, const Transform::TransformHelper& parent, Sprite& father )
+	{
+		const Transform::TransformHelper top = ChildTransformOf( parent, father );
+		const types::xform& expected = top.xform;
+
+		for( int i = 0; i < 4; ++i )
+		{
+			if( ChildTransformClose( child.color[ i ], top.color[ i ] ) == false )
+				return false;
+		}
+
+		return
+			ChildTransformClose( child.xform.position.x, expected.position.x ) &&
+			ChildTransformClose( child.xform.position.y, expected.position.y ) &&
+			ChildTransformClose( child.xform.R.col1.x, expected.R.col1.x ) &&
+			ChildTransformClose( child.xform.R.col1.y, expected.R.col1.y ) &&
+			ChildTransformClose( child.xform.scale.x, expected.scale.x ) &&
+			ChildTransformClose( child.xform.scale.y, expected.scale.y );
+	}
+} // end of anonymouns namespace
+
+int SpriteChildTransformTest()
+{
+	// the cached transform is used until a setter changes the father
+	{
+		Transform transform;
+		ChildTransformProbe father;
+		ChildTransformProbe* child = new ChildTransformProbe;
+		father.addChild( child );
+		father.MoveTo( types::vector2( 10, 0 ) );
+
+		father.Draw( NULL, NULL, transform );
+		test_assert( child->draws == 1 );
+		test_assert( ChildTransformIsRight( *child, transform.GetTop(), father ) );
+
+		unsigned int version = child->version;
+		father.Draw( NULL, NULL, transform );
+		test_assert( child->version == version );
+
+		for( int setter = 0; setter < 10; ++setter )
+		{
+			switch( setter )
+			{
+			case 0: father.MoveTo( types::vector2( 20, 5 ) ); break;
+			case 1: father.SetX( 30 ); break;
+			case 2: father.SetY( -7 ); break;
+			case 3: father.SetScale( 2.f, 0.5f ); break;
+			case 4: father.SetRotation( 0.7f ); break;
+			case 5: father.SetAlpha( 0.5f ); break;
+			case 6: father.SetColor( 0.2f, 0.4f, 0.6f ); break;
+			case 7: father.SetColor( poro::GetFColor( 1.f, 0.5f, 0.25f, 0.75f ) ); break;
+			case 8:
+				{
+					types::xform xform;
+					xform.position.Set( -3, 4 );
+					xform.R.Set( -1.2f );
+					xform.scale.Set( 1.5f, 1.5f );
+					father.SetXForm( xform );
+				}
+				break;
+			case 9: father.MoveBy( types::vector2( 1, 1 ) ); break;
+			}
+
+			father.Draw( NULL, NULL, transform );
+			test_assert( child->version != version );
+			test_assert( ChildTransformIsRight( *child, transform.GetTop(), father ) );
+			version = child->version;
+		}
+
+		// the transform the father is drawn with changes
+		types::xform xform;
+		xform.position.Set( 100, 50 );
+		xform.R.Set( 0.3f );
+		transform.PushXForm( xform, poro::GetFColor( 0.5f, 0.5f, 0.5f, 0.5f ) );
+		father.Draw( NULL, NULL, transform );
+		test_assert( child->version != version );
+		test_assert( ChildTransformIsRight( *child, transform.GetTop(), father ) );
+
+		transform.PopXForm();
+		father.Draw( NULL, NULL, transform );
+		test_assert( ChildTransformIsRight( *child, transform.GetTop(), father ) );
+	}
+
+	// moving the father to another parent
+	{
+		Transform transform;
+		ChildTransformProbe grandfather_a;
+		ChildTransformProbe grandfather_b;
+		grandfather_a.MoveTo( types::vector2( 100, 0 ) );
+		grandfather_b.MoveTo( types::vector2( 0, 100 ) );
+		grandfather_b.SetAlpha( 0.5f );
+
+		ChildTransformProbe* father = new ChildTransformProbe;
+		ChildTransformProbe* child = new ChildTransformProbe;
+		father->addChild( child );
+		father->MoveTo( types::vector2( 10, 10 ) );
+		grandfather_a.addChild( father );
+
+		grandfather_a.Draw( NULL, NULL, transform );
+		test_assert( ChildTransformIsRight( *child, ChildTransformOf( transform.GetTop(), grandfather_a ), *father ) );
+
+		grandfather_a.removeChild( father );
+		grandfather_b.addChild( father );
+		grandfather_b.Draw( NULL, NULL, transform );
+		test_assert( child->draws == 2 );
+		test_assert( ChildTransformIsRight( *child, ChildTransformOf( transform.GetTop(), grandfather_b ), *father ) );
+		test_assert( ChildTransformClose( child->xform.position.x, 10.f ) );
+		test_assert( ChildTransformClose( child->xform.position.y, 110.f ) );
+		test_assert( ChildTransformClose( child->color[ 3 ], 0.5f ) );
+	}
+
+	return 0;
+}
+
+TEST_REGISTER( SpriteChildTransformTest );
+
+} // end of namespace test
+} // end of namespace as 
+#endif
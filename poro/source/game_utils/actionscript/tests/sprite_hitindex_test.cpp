@@ -0,0 +1,135 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2003 - 2011 Petri Purho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+
+#include "../sprite.h"
+#include "../../../utils/debug.h"
+
+#ifdef PORO_TESTER_ENABLED
+namespace as {
+namespace test {
+
+namespace {
+	class HitTestTexture : public poro::ITexture
+	{
+	public:
+		int GetWidth() const { return 16; }
+		int GetHeight() const { return 16; }
+		poro::types::string GetFilename() const { return ""; }
+		unsigned char* GetPixelData() const { return NULL; }
+		void DeletePixelData() { }
+	};
+
+	bool SameHits( Sprite& root, const types::vector2& p )
+	{
+		root.SetHitIndex( false );
+		std::vector< Sprite* > linear = root.FindSpritesAtPoint( p );
+		root.SetHitIndex( true );
+		std::vector< Sprite* > indexed = root.FindSpritesAtPoint( p );
+		return linear == indexed;
+	}
+
+	bool SameHitsEverywhere( Sprite& root )
+	{
+		for( float y = -50.f; y < 250.f; y += 3.7f )
+		{
+			for( float x = -50.f; x < 250.f; x += 3.7f )
+			{
+				if( SameHits( root, types::vector2( x, y ) ) == false )
+					return false;
+			}
+		}
+		return true;
+	}
+
+	Sprite* NewHitTestSprite( HitTestTexture* texture, float x, float y )
+	{
+		Sprite* result = new Sprite;
+		result->SetClearTweens( false );
+		result->SetTexture( texture );
+		result->SetSize( texture->GetWidth(), texture->GetHeight() );
+		result->MoveTo( types::vector2( x, y ) );
+		return result;
+	}
+} // end of anonymouns namespace
+
+int SpriteHitIndexTest()
+{
+	HitTestTexture texture;
+
+	Sprite root;
+	root.SetClearTweens( false );
+
+	std::vector< Sprite* > rows;
+	for( int i = 0; i < 5; ++i )
+	{
+		Sprite* row = new Sprite;
+		row->SetClearTweens( false );
+		row->MoveTo( types::vector2( 0, i * 40.f ) );
+		root.addChild( row );
+		rows.push_back( row );
+
+		for( int j = 0; j < 5; ++j )
+		{
+			Sprite* item = NewHitTestSprite( &texture, j * 40.f, 0 );
+			item->SetCenterOffset( types::vector2( 8, 8 ) );
+			row->addChild( item );
+			item->addChild( NewHitTestSprite( &texture, 10, 10 ) );
+		}
+	}
+
+	test_assert( SameHitsEverywhere( root ) );
+	test_assert( root.FindSpritesAtPoint( types::vector2( 45, 45 ) ).size() == 1 );
+	test_assert( root.FindSpritesAtPoint( types::vector2( 300, 300 ) ).empty() );
+
+	// moving, scaling and rotating things deep in the tree
+	rows[ 2 ]->MoveTo( types::vector2( 100, 150 ) );
+	rows[ 3 ]->SetRotation( 0.7f );
+	rows[ 4 ]->SetScale( 2.f, 0.5f );
+	test_assert( SameHitsEverywhere( root ) );
+
+	// only the first item of the scaled row is there
+	root.SetHitIndex( true );
+	test_assert( root.FindSpritesAtPoint( types::vector2( -12, 157 ) ).size() == 1 );
+
+	Sprite* item = static_cast< Sprite* >( rows[ 1 ]->GetChildAt( 2 ) );
+	item->SetRect( types::rect( 0, 0, 64, 4 ) );
+	static_cast< Sprite* >( item->GetChildAt( 0 ) )->MoveTo( types::vector2( 120, -30 ) );
+	test_assert( SameHitsEverywhere( root ) );
+
+	// adding and removing children
+	rows[ 0 ]->addChild( NewHitTestSprite( &texture, 200, 200 ) );
+	test_assert( SameHitsEverywhere( root ) );
+	test_assert( root.FindSpritesAtPoint( types::vector2( 201, 201 ) ).empty() == false );
+
+	Sprite* removed = rows[ 0 ];
+	root.removeChild( removed );
+	delete removed;
+	test_assert( SameHitsEverywhere( root ) );
+	test_assert( root.FindSpritesAtPoint( types::vector2( 201, 201 ) ).empty() );
+
+	return 0;
+}
+
+TEST_REGISTER( SpriteHitIndexTest );
+
+} // end of namespace test
+} // end of namespace as 
+#endif
@@ -23,6 +23,9 @@
 
 #include "../../poro/igraphics.h"
 
+#include <cmath>
+#include <algorithm>
+
 #include "../../utils/math/math_utils.h"
 #include "../../utils/debug.h"
 
@@ -42,6 +45,50 @@ namespace {
 		return result;
 	}
 
+	//-------------------------------------------------------------------------
+
+	// an edge with its end points on a 1/16 pixel grid, the smaller point first
+	struct DrawLinesEdgeKey
+	{
+		int x0, y0, x1, y1;
+
+		bool operator==( const DrawLinesEdgeKey& other ) const
+		{
+			return x0 == other.x0 && y0 == other.y0 && x1 == other.x1 && y1 == other.y1;
+		}
+	};
+
+	inline int DrawLinesSnap( float f )
+	{
+		return (int)std::floor( f * 16.f + 0.5f );
+	}
+
+	DrawLinesEdgeKey DrawLinesGetKey( const poro::types::vec2& a, const poro::types::vec2& b )
+	{
+		int ax = DrawLinesSnap( a.x ), ay = DrawLinesSnap( a.y );
+		int bx = DrawLinesSnap( b.x ), by = DrawLinesSnap( b.y );
+		if( bx < ax || ( bx == ax && by < ay ) )
+		{
+			std::swap( ax, bx );
+			std::swap( ay, by );
+		}
+
+		DrawLinesEdgeKey key = { ax, ay, bx, by };
+		return key;
+	}
+
+	inline unsigned int DrawLinesHash( const DrawLinesEdgeKey& key )
+	{
+		unsigned int hash = 2166136261u;
+		hash = ( hash ^ (unsigned int)key.x0 ) * 16777619u;
+		hash = ( hash ^ (unsigned int)key.y0 ) * 16777619u;
+		hash = ( hash ^ (unsigned int)key.x1 ) * 16777619u;
+		hash = ( hash ^ (unsigned int)key.y1 ) * 16777619u;
+		return hash ^ ( hash >> 15 );
+	}
+
+	//-------------------------------------------------------------------------
+
 	// --- Hershey font's - stolen from Mikko Mononen's Paris Game AI Conference Presentation
 	// http://digestingduck.blogspot.fi/2010/07/my-paris-game-ai-conference.html
 	// Used with permission.
@@ -686,6 +733,145 @@ void DrawLines( poro::IGraphics* graphics, const std::vector< types::vector2 >&
 }
 
 
+//-----------------------------------------------------------------------------
+
+void GetUniqueEdges( const poro::types::vec2* vertices, const int* offsets, const int* counts, int polygon_count, std::vector< poro::types::vec2 >& edges )
+{
+	edges.clear();
+
+	int edge_count = 0;
+	for( int i = 0; i < polygon_count; ++i )
+		edge_count += ( counts[ i ] >= 2 ) ? counts[ i ] : 0;
+
+	if( edge_count == 0 )
+		return;
+
+	// open addressing, at most half full
+	std::size_t size = 16;
+	while( size < 2 * (std::size_t)edge_count )
+		size *= 2;
+
+	const std::size_t mask = size - 1;
+	std::vector< DrawLinesEdgeKey > keys( size );
+	std::vector< char > used( size, 0 );
+
+	edges.reserve( edge_count * 2 );
+	for( int i = 0; i < polygon_count; ++i )
+	{
+		const poro::types::vec2* vert = vertices + offsets[ i ];
+		const int count = counts[ i ];
+		if( count < 2 )
+			continue;
+
+		for( int j = 0; j < count; ++j )
+		{
+			const poro::types::vec2& a = vert[ j ];
+			const poro::types::vec2& b = vert[ ( j + 1 ) % count ];
+			const DrawLinesEdgeKey key = DrawLinesGetKey( a, b );
+
+			std::size_t k = DrawLinesHash( key ) & mask;
+			while( used[ k ] && !( keys[ k ] == key ) )
+				k = ( k + 1 ) & mask;
+
+			if( used[ k ] )
+				continue;
+
+			used[ k ] = 1;
+			keys[ k ] = key;
+			edges.push_back( a );
+			edges.push_back( b );
+		}
+	}
+}
+
+void DrawLineBatch( poro::IGraphics* graphics, const poro::types::vec2* vertices, const int* offsets, const int* counts, int polygon_count, const poro::types::fcolor& color, types::camera* camera )
+{
+	cassert( graphics );
+	if( color[ 3 ] <= 0.01f ) return;
+
+	static std::vector< poro::types::vec2 > edges;
+	static std::vector< poro::types::vec2 > triangles;
+	static std::vector< poro::types::fcolor > colors;
+
+	GetUniqueEdges( vertices, offsets, counts, polygon_count, edges );
+	if( edges.empty() )
+		return;
+
+	// The rails run along the line, from one side to the other. Without 
+	// smoothing there's just the two sides. With it the line is line_width
+	// minus a pixel wide and fades out over half a pixel on both sides, and
+	// lines thinner than a pixel fade out instead of getting thinner.
+	float rail_offset[ 4 ];
+	float rail_alpha[ 4 ];
+	int rail_count = 0;
+
+	const float half_width = 0.5f * line_width;
+	if( smooth_lines )
+	{
+		const float inner = std::max( half_width - 0.5f, 0.f );
+		const float outer = inner + 1.f;
+		const float alpha = color[ 3 ] * std::min( line_width, 1.f );
+
+		rail_offset[ rail_count ] = -outer;	rail_alpha[ rail_count++ ] = 0;
+		rail_offset[ rail_count ] = -inner;	rail_alpha[ rail_count++ ] = alpha;
+		if( inner > 0 ) {
+			rail_offset[ rail_count ] = inner;	rail_alpha[ rail_count++ ] = alpha;
+		}
+		rail_offset[ rail_count ] = outer;	rail_alpha[ rail_count++ ] = 0;
+	}
+	else
+	{
+		rail_offset[ rail_count ] = -half_width;	rail_alpha[ rail_count++ ] = color[ 3 ];
+		rail_offset[ rail_count ] = half_width;		rail_alpha[ rail_count++ ] = color[ 3 ];
+	}
+
+	const int edge_count = (int)edges.size() / 2;
+	const int vertex_count = edge_count * ( rail_count - 1 ) * 6;
+	triangles.resize( vertex_count );
+	colors.resize( vertex_count );
+
+	int o = 0;
+	for( int i = 0; i < edge_count; ++i )
+	{
+		types::vector2 p1( edges[ i * 2 ].x, edges[ i * 2 ].y );
+		types::vector2 p2( edges[ i * 2 + 1 ].x, edges[ i * 2 + 1 ].y );
+		if( camera ) {
+			p1 = camera->Transform( p1 );
+			p2 = camera->Transform( p2 );
+		}
+
+		const float dx = p2.x - p1.x;
+		const float dy = p2.y - p1.y;
+		const float length = std::sqrt( dx * dx + dy * dy );
+		if( length <= 0 )
+			continue;
+
+		const float nx = -dy / length;
+		const float ny = dx / length;
+
+		for( int r = 0; r + 1 < rail_count; ++r )
+		{
+			const float o0 = rail_offset[ r ];
+			const float o1 = rail_offset[ r + 1 ];
+			const poro::types::vec2 quad[ 4 ] = {
+				poro::types::vec2( p1.x + nx * o0, p1.y + ny * o0 ),
+				poro::types::vec2( p2.x + nx * o0, p2.y + ny * o0 ),
+				poro::types::vec2( p2.x + nx * o1, p2.y + ny * o1 ),
+				poro::types::vec2( p1.x + nx * o1, p1.y + ny * o1 ) };
+			const float alpha[ 4 ] = { rail_alpha[ r ], rail_alpha[ r ], rail_alpha[ r + 1 ], rail_alpha[ r + 1 ] };
+
+			const int corners[ 6 ] = { 0, 1, 2, 0, 2, 3 };
+			for( int k = 0; k < 6; ++k, ++o )
+			{
+				triangles[ o ] = quad[ corners[ k ] ];
+				colors[ o ] = poro::GetFColor( color[ 0 ], color[ 1 ], color[ 2 ], alpha[ corners[ k ] ] );
+			}
+		}
+	}
+
+	graphics->DrawColoredTriangles( &triangles[ 0 ], &colors[ 0 ], o );
+}
+
 //-----------------------------------------------------------------------------
 
 void DrawArrow( poro::IGraphics* graphics, const types::vector2& p1, const types::vector2& p2, const poro::types::fcolor& color, float arrow_size, types::camera* camera  )
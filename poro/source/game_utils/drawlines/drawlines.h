@@ -48,6 +48,19 @@ void DrawLines( poro::IGraphics* graphics, const std::vector< poro::types::vec2
 // draws a line segment
 void DrawLines( poro::IGraphics* graphics, const std::vector< types::vector2 >& lines, const poro::types::fcolor& color, types::camera* camera = NULL );
 
+// Draws the outlines of polygon_count polygons in one draw call. Polygon i is
+// counts[i] vertices from vertices[ offsets[i] ], the same layout as 
+// IGraphics::DrawFillBatch(), and its outline goes through the vertices in
+// order and back to the first one. Edges that two polygons share are drawn
+// only once. The lines are quads, line width wide, with a one pixel fade on
+// the sides if line smoothing is on.
+void DrawLineBatch( poro::IGraphics* graphics, const poro::types::vec2* vertices, const int* offsets, const int* counts, int polygon_count, const poro::types::fcolor& color, types::camera* camera = NULL );
+
+// the edges that DrawLineBatch() draws, as pairs of points in edges. Edges
+// that are the same to 1/16 of a pixel, in either direction, are the same 
+// edge. Can be called from any thread.
+void GetUniqueEdges( const poro::types::vec2* vertices, const int* offsets, const int* counts, int polygon_count, std::vector< poro::types::vec2 >& edges );
+
 // draws an arrow, useful for visualizing vectors
 void DrawArrow( poro::IGraphics* graphics, const types::vector2& p1, const types::vector2& p2, const poro::types::fcolor& color, float arrow_size = 10, types::camera* camera = NULL );
 
@@ -0,0 +1,164 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2003 - 2011 Petri Purho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+
+#include "../drawlines.h"
+#include "../../../utils/debug.h"
+
+#ifdef CENG_TESTER_ENABLED
+
+#include <algorithm>
+
+namespace test {
+
+namespace {
+
+struct DrawLinesTest_Polygons
+{
+	std::vector< poro::types::vec2 > vertices;
+	std::vector< int > offsets;
+	std::vector< int > counts;
+
+	void Add( const poro::types::vec2* v, int count )
+	{
+		offsets.push_back( (int)vertices.size() );
+		counts.push_back( count );
+		vertices.insert( vertices.end(), v, v + count );
+	}
+
+	void AddSquare( float x, float y, float size, bool clockwise )
+	{
+		poro::types::vec2 v[ 4 ];
+		v[ 0 ] = poro::types::vec2( x, y );
+		v[ 1 ] = poro::types::vec2( x + size, y );
+		v[ 2 ] = poro::types::vec2( x + size, y + size );
+		v[ 3 ] = poro::types::vec2( x, y + size );
+		if( clockwise == false )
+			std::swap( v[ 1 ], v[ 3 ] );
+		Add( v, 4 );
+	}
+
+	int GetUniqueEdgeCount( std::vector< poro::types::vec2 >& edges ) const
+	{
+		GetUniqueEdges( &vertices[ 0 ], &offsets[ 0 ], &counts[ 0 ], (int)counts.size(), edges );
+		test_assert( edges.size() % 2 == 0 );
+		return (int)edges.size() / 2;
+	}
+};
+
+bool DrawLinesTest_Same( const poro::types::vec2& a, const poro::types::vec2& b )
+{
+	return a.x == b.x && a.y == b.y;
+}
+
+} // end of anonymous namespace
+
+int DrawLinesTest()
+{
+	std::vector< poro::types::vec2 > edges;
+
+	// one polygon, every edge once with its own points
+	{
+		DrawLinesTest_Polygons polygons;
+		polygons.AddSquare( 10, 20, 5, true );
+		test_assert( polygons.GetUniqueEdgeCount( edges ) == 4 );
+		for( int i = 0; i < 4; ++i )
+		{
+			test_assert( DrawLinesTest_Same( edges[ 2 * i ], polygons.vertices[ i ] ) );
+			test_assert( DrawLinesTest_Same( edges[ 2 * i + 1 ], polygons.vertices[ ( i + 1 ) % 4 ] ) );
+		}
+	}
+
+	// a shared edge is only drawn once, whichever way the polygons go around
+	{
+		DrawLinesTest_Polygons polygons;
+		polygons.AddSquare( 0, 0, 10, true );
+		polygons.AddSquare( 10, 0, 10, true );
+		test_assert( polygons.GetUniqueEdgeCount( edges ) == 7 );
+
+		DrawLinesTest_Polygons same_way;
+		same_way.AddSquare( 0, 0, 10, true );
+		same_way.AddSquare( 10, 0, 10, false );
+		test_assert( same_way.GetUniqueEdgeCount( edges ) == 7 );
+
+		// the same polygon twice, both ways
+		DrawLinesTest_Polygons twice;
+		twice.AddSquare( 0, 0, 10, true );
+		twice.AddSquare( 0, 0, 10, true );
+		twice.AddSquare( 0, 0, 10, false );
+		test_assert( twice.GetUniqueEdgeCount( edges ) == 4 );
+	}
+
+	// the points are snapped to 1/16 of a pixel, the edge that is kept is
+	// the first one as it was
+	{
+		for( int reversed = 0; reversed < 2; ++reversed )
+		{
+			DrawLinesTest_Polygons polygons;
+			poro::types::vec2 a[ 2 ] = { poro::types::vec2( 10, 10 ), poro::types::vec2( 20, 10 ) };
+			poro::types::vec2 b[ 2 ] = { poro::types::vec2( 10.01f, 9.99f ), poro::types::vec2( 19.98f, 10.02f ) };
+			if( reversed )
+				std::swap( b[ 0 ], b[ 1 ] );
+
+			polygons.Add( a, 2 );
+			polygons.Add( b, 2 );
+			test_assert( polygons.GetUniqueEdgeCount( edges ) == 1 );
+			test_assert( DrawLinesTest_Same( edges[ 0 ], a[ 0 ] ) );
+			test_assert( DrawLinesTest_Same( edges[ 1 ], a[ 1 ] ) );
+
+			// more than 1/16 off is another edge
+			poro::types::vec2 c[ 2 ] = { poro::types::vec2( 10.1f, 10 ), poro::types::vec2( 20, 10 ) };
+			if( reversed )
+				std::swap( c[ 0 ], c[ 1 ] );
+			polygons.Add( c, 2 );
+			test_assert( polygons.GetUniqueEdgeCount( edges ) == 2 );
+		}
+	}
+
+	// polygons with less than two vertices have no edges
+	{
+		DrawLinesTest_Polygons polygons;
+		poro::types::vec2 v( 1, 1 );
+		polygons.Add( &v, 1 );
+		test_assert( polygons.GetUniqueEdgeCount( edges ) == 0 );
+		test_assert( edges.empty() );
+	}
+
+	// a grid of squares, the inner edges are shared by two of them
+	{
+		const int n = 40;
+		DrawLinesTest_Polygons polygons;
+		for( int y = 0; y < n; ++y )
+		{
+			for( int x = 0; x < n; ++x )
+				polygons.AddSquare( x * 0.5f, y * 0.5f, 0.5f, ( x + y ) % 2 == 0 );
+		}
+
+		test_assert( polygons.GetUniqueEdgeCount( edges ) == 2 * n * ( n + 1 ) );
+	}
+
+	return 0;
+}
+
+TEST_REGISTER( DrawLinesTest );
+
+} // end of namespace test
+
+#endif
@@ -22,90 +22,87 @@
 #include "gtween.h"
 #include "../actionscript/sprite.h"
 
+#include <algorithm>
+
 //=============================================================================
 // updates all gtweens and removes the dead gtweens from the list as well
 void UpdateGTweens( float dt )
 {
-	std::list< GTween* >& update_list = ceng::CAutoList< GTween >::GetList();
-
-	if( update_list.empty() ) 
-		return;
-
-	std::list< GTween* > release_us;
+	GetGTweenEngine()->Update( dt );
+}
 
-	GTween* tween = NULL;
-	for( std::list< GTween* >::iterator i = update_list.begin(); i != update_list.end();  )
-	{
-		tween = *i;
-		++i;
-		cassert( tween );
-		if( tween->IsDead() == false )
-			tween->Update( dt );
-
-		if( tween->IsDead() )
-			release_us.push_back( tween );
-	}
+const std::vector< GTween* >& GetGTweens()
+{
+	return GetGTweenEngine()->GetTweens();
+}
 
-	// release the dead tweens
-	for( std::list< GTween* >::iterator i = release_us.begin();
-		i != release_us.end(); ++i )
-	{
-		tween = *i;
-		delete tween;
-	}
+int GetGTweenCount()
+{
+	return GetGTweenEngine()->GetTweenCount();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 GTween::GTween() :
-	ceng::CAutoList< GTween >(),
-	mDirty( false ),
-	mDelay( 0 ),
-	mDuration( 1.f ),
-	mTimer( 0 ),
-	mDead( false ),
-	mCompleted( false ),
-	mLooping( false ),
-	mOnLoop( false ),
-	mLoopCount( -1 ),
-	mClampValues( false ),
-	mKillMeAutomatically( false ),
-	mMathFunc( NULL ),
+	mTracks(),
+	mListeners(),
+	mExtraPointers(),
 	mName(),
 	mUserData()
 {
+	Init( 1.f, false );
 }
 
 //-----------------------------------------------------------------------------
 
 GTween::GTween( float duration, bool auto_kill ) :
-	ceng::CAutoList< GTween >(),
-	mDirty( false ),
-	mDelay( 0 ),
-	mDuration( duration ),
-	mTimer( 0 ),
-	mDead( false ),
-	mCompleted( false ),
-	mLooping( false ),
-	mOnLoop( false ),
-	mLoopCount( -1 ),
-	mClampValues( false ),
-	mKillMeAutomatically( auto_kill ),
-	mMathFunc( NULL ),
+	mTracks(),
+	mListeners(),
+	mExtraPointers(),
 	mName(),
 	mUserData()
 {
+	Init( duration, auto_kill );
+}
+
+void GTween::Init( float duration, bool auto_kill )
+{
+	mEngineIndex = -1;
+
+	GTweenEngine* engine = GetGTweenEngine();
+	mClock = engine->AddClock( this );
+	engine->GetClock( mClock ).duration = duration;
+	SetClockFlag( GTweenEngine::CLOCK_AUTO_KILL, auto_kill );
+	engine->AddTween( this );
+}
+
+GTweenEngine::Clock& GTween::GetClock() const
+{
+	return GetGTweenEngine()->GetClock( mClock );
+}
+
+bool GTween::GetClockFlag( unsigned int flag ) const
+{
+	return ( GetClock().flags & flag ) != 0;
+}
+
+void GTween::SetClockFlag( unsigned int flag, bool value )
+{
+	if( value )
+		GetClock().flags |= flag;
+	else
+		GetClock().flags &= ~flag;
 }
 //-----------------------------------------------------------------------------
 
 GTween::~GTween()
 {
-	for( std::size_t i = 0; i <  mInterpolators.size(); ++i ) 
-	{
-		delete mInterpolators[ i ];
-	}
+	while( mTracks.empty() == false )
+		RemoveTrack( mTracks.size() - 1 );
 
-	mInterpolators.clear();
+	GTweenEngine* engine = GetGTweenEngine();
+	engine->RemoveClock( mClock );
+	engine->RemoveTween( this );
 
 	for( std::size_t i = 0; i < mListeners.size(); ++i )
 	{
@@ -123,63 +120,98 @@ void GTween::AddInterpolator( ceng::IInterpolator* in )
 {
 	if( in ) 
 	{
-		mDirty = true;
+		GetGTweenEngine()->SetClockDirty( mClock );
 	
 		RemoveDuplicateInterpolators( in->GetName() );
 		
-		mInterpolators.push_back( in );
+		Track track;
+		track.id = GetGTweenEngine()->AddInterpolatorTrack( mClock, in );
+		track.name = in->GetName();
+		mTracks.push_back( track );
 	}
 }
 
+void GTween::AddVariable( float& reference, const float& target_value, const std::string& name )
+{
+	RemoveDuplicateInterpolators( name );
+	AddFloatTrack( &reference, target_value, &reference, name );
+}
+
+void GTween::AddVariable( types::vector2& reference, const types::vector2& target_value, const std::string& name )
+{
+	RemoveDuplicateInterpolators( name );
+	AddFloatTrack( &reference.x, target_value.x, &reference, name );
+	AddFloatTrack( &reference.y, target_value.y, &reference, name );
+}
+
+void GTween::AddFloatTrack( float* target, float target_value, void* pointer, const std::string& name )
+{
+	GetGTweenEngine()->SetClockDirty( mClock );
+
+	Track track;
+	track.id = GetGTweenEngine()->AddFloatTrack( mClock, target, target_value );
+	track.is_float = true;
+	track.pointer = pointer;
+	track.name = name;
+	mTracks.push_back( track );
+}
+
+void GTween::RemoveTrack( std::size_t i )
+{
+	cassert( i < mTracks.size() );
+
+	if( mTracks[ i ].is_float )
+		GetGTweenEngine()->RemoveFloatTrack( mTracks[ i ].id );
+	else
+		GetGTweenEngine()->RemoveInterpolatorTrack( mTracks[ i ].id );
+
+	mTracks.erase( mTracks.begin() + i );
+}
+
 //-----------------------------------------------------------------------------
 
 // iterates over the list of interpolators and drops any interpolator that has the same name
 void GTween::RemoveDuplicateInterpolators( const std::string& name)
 {
-	// sets the iterator to the first item in the vector
-	std::vector< ceng::IInterpolator* >::iterator it = mInterpolators.begin();
-	while(it != mInterpolators.end()){
-
-		if((*it)->GetName() == name) {
-			// erase the interpolator and set the iterator to the return value
-			// the iterator breaks on erase, so that's needed
-			it = mInterpolators.erase(it);
-		} else {
-			++it;
-		}
+	for( std::size_t i = 0; i < mTracks.size(); )
+	{
+		if( mTracks[ i ].name == name )
+			RemoveTrack( i );
+		else
+			++i;
 	}
 }
 
 //-----------------------------------------------------------------------------
 	
 bool GTween::IsDead() const	{ 
-	return mDead; 
+	return GetClockFlag( GTweenEngine::CLOCK_DEAD ); 
 }
 
 void GTween::Kill()	{ 
-	mDead = true; 
+	GetGTweenEngine()->KillClock( mClock ); 
 }
 
 void GTween::SetAutoKill( bool kill_me_when_done )	{ 
-	mKillMeAutomatically = kill_me_when_done; 
+	SetClockFlag( GTweenEngine::CLOCK_AUTO_KILL, kill_me_when_done ); 
 }
 
 void GTween::SetLoopCount( int loop_count ) {
-	mLoopCount = loop_count;
+	GetClock().loop_count = loop_count;
 }
 
 //-----------------------------------------------------------------------------
 
 void GTween::SetFunction( ceng::easing::IEasingFunc& math_func ) {
-	mMathFunc = &math_func;
+	GetGTweenEngine()->SetClockEasing( mClock, &math_func );
 }
 
 //-----------------------------------------------------------------------------
 
 void GTween::SetDuration( float time )
 {
-	mDuration = time;
-	mDirty = true;
+	GetClock().duration = time;
+	GetGTweenEngine()->SetClockDirty( mClock );
 }
 
 //-----------------------------------------------------------------------------
@@ -188,129 +220,58 @@ void GTween::SetDuration( float time )
 // if you put delay the start values could have changes which causes a glitch instead of a smooth transformation
 void GTween::SetDelay( float delay ) 
 {
-	if( delay != mDelay )
+	GTweenEngine::Clock& clock = GetClock();
+	if( delay != clock.delay )
 	{
-		mDelay = delay;
-		mDirty = true;
+		clock.delay = delay;
+		GetGTweenEngine()->SetClockDirty( mClock );
 	}
 }
 
 bool GTween::GetIsCompleted() const
 {
-	return mCompleted;
+	return GetClockFlag( GTweenEngine::CLOCK_COMPLETED );
 }
 
 bool GTween::GetIsRunning() const
 {
-	return mDelay <= 0 && mTimer <= mDuration;
+	const GTweenEngine::Clock& clock = GetClock();
+	return clock.delay <= 0 && clock.timer <= clock.duration;
 }
 
 //-----------------------------------------------------------------------------
 
 void GTween::Update( float dt ) 
 {
-	if( mDirty )
-	{
-		Reset();
-		mDirty = false;
-		mCompleted = false;
-
-		if( mDelay <= 0 )
-			OnStart();
-	}
-	
-	if(mCompleted) return;
-	
-	if( mDelay > 0 )
-	{
-		mDelay -= dt;
-		if( mDelay <= 0 ) {
-			// restart start values?
-			Reset();
-			OnStart();
-		}
-	}
-	else if( mTimer <= mDuration )
-	{
-		cassert( mDuration != 0 );
-		if( mDuration == 0 )
-			return;
-
-		OnStep();
-
-		mTimer += dt;
-		
-		if( mInterpolators.empty() == false )
-		{
-			float t = mTimer / mDuration;
-
-			t = ceng::math::Clamp( t, 0.f, 1.f );
-			
-			if( mMathFunc )
-				t = mMathFunc->f( t );
+	GTweenEngine* engine = GetGTweenEngine();
 
-			if( mClampValues ) t = ceng::math::Clamp( t, 0.f, 1.f );
+	float t = 0;
+	if( engine->AdvanceClock( mClock, dt, t ) )
+		ApplyTracks( engine->EaseTime( mClock, t ) );
 
-			for( std::size_t i = 0; i < mInterpolators.size(); ++i )
-			{
-				mInterpolators[ i ]->Update( t );
-			}
-		}
-	}
-	else if( mOnLoop && mTimer > mDuration && mTimer <= mDuration * 2.f ) 
-	{
-		cassert( mDuration != 0 );
-		if( mDuration == 0 )
-			return;
-
-		OnStep();
-
-		mTimer += dt;
-		float t = 1.f - ( ( mTimer - mDuration ) / mDuration );
-
-		t = ceng::math::Clamp( t, 0.f, 1.f );
-		
-		if( mMathFunc )
-			t = mMathFunc->f( t );
+	if( GetClockFlag( GTweenEngine::CLOCK_COMPLETE_PENDING ) )
+		Complete();
+}
 
-		if( mClampValues ) t = ceng::math::Clamp( t, 0.f, 1.f );
+//-----------------------------------------------------------------------------
 
-		for( std::size_t i = 0; i < mInterpolators.size(); ++i )
-		{
-			mInterpolators[ i ]->Update( t );
-		}
-	}
-	
-	if( mOnLoop == false && mTimer >= mDuration )
+void GTween::ApplyTracks( float t )
+{
+	GTweenEngine* engine = GetGTweenEngine();
+	for( std::size_t i = 0; i < mTracks.size(); ++i )
 	{
-		if( mLooping == false )
-		{
-			mCompleted = true;
-			OnComplete();
-			if( mKillMeAutomatically ) mDead = true;
-		}
+		if( mTracks[ i ].is_float )
+			engine->ApplyFloatTrack( mTracks[ i ].id, t );
 		else
-		{
-			mOnLoop = true;
-		}
+			engine->GetInterpolator( mTracks[ i ].id )->Update( t );
 	}
-	else if( mOnLoop == true && mTimer >= mDuration * 2.f )
-	{
-		if( mLoopCount > 0 ) 
-			mLoopCount--;
-
-		// kill me
-		if( mLoopCount == 0 )
-		{
-			mCompleted = true;
-			OnComplete();
-			if( mKillMeAutomatically ) mDead = true;
-		}
+}
 
-		// OnStart();
-		mOnLoop = false;
-		mTimer = 0;
-	}
+void GTween::Complete()
+{
+	SetClockFlag( GTweenEngine::CLOCK_COMPLETE_PENDING, false );
+	OnComplete();
+	if( GetClockFlag( GTweenEngine::CLOCK_AUTO_KILL ) ) Kill();
 }
 
 //-----------------------------------------------------------------------------
@@ -321,6 +282,7 @@ void GTween::AddListener( GTweenListener* l )
 	if( l ) {
 		mListeners.push_back( l );
 		l->m_tweens_that_i_listen_to.push_back( this );
+		SetClockFlag( GTweenEngine::CLOCK_LISTENERS, true );
 	}
 }
 
@@ -337,6 +299,8 @@ void GTween::RemoveListener( GTweenListener* l )
 		}
 	}
 
+	SetClockFlag( GTweenEngine::CLOCK_LISTENERS, mListeners.empty() == false );
+
 	if( l ) {
 		l->RemoveGTweenFromListeners( this );
 	}
@@ -348,14 +312,12 @@ void GTween::RemoveListener( GTweenListener* l )
 bool GTween::ClearPointer( void* pointer )
 {
 	bool result = false;
-	for( std::size_t i = 0; i < mInterpolators.size();  )
+	for( std::size_t i = 0; i < mTracks.size();  )
 	{
-		if( mInterpolators[ i ]->UsesPointer( pointer ) )
+		if( TrackUsesPointer( mTracks[ i ], pointer ) )
 		{
 			result = true;
-			delete mInterpolators[ i ];
-			mInterpolators[ i ] = mInterpolators[ mInterpolators.size() - 1 ];
-			mInterpolators.pop_back();
+			RemoveTrack( i );
 		} else {
 			++i;
 		}
@@ -369,9 +331,9 @@ bool GTween::ClearPointer( void* pointer )
 
 bool GTween::HasPointer( void* pointer )
 {
-	for( std::size_t i = 0; i < mInterpolators.size(); ++i )
+	for( std::size_t i = 0; i < mTracks.size(); ++i )
 	{
-		if( mInterpolators[ i ]->UsesPointer( pointer ) )
+		if( TrackUsesPointer( mTracks[ i ], pointer ) )
 			return true;
 	}
 
@@ -381,6 +343,14 @@ bool GTween::HasPointer( void* pointer )
 	return false;
 }
 
+bool GTween::TrackUsesPointer( const Track& track, void* pointer ) const
+{
+	if( track.is_float ) 
+		return track.pointer == pointer;
+
+	return GetGTweenEngine()->GetInterpolator( track.id )->UsesPointer( pointer );
+}
+
 void GTween::AddPointer( void* pointer )
 {
 	mExtraPointers.push_back( pointer );
@@ -414,11 +384,16 @@ void GTween::OnComplete()
 
 void GTween::Reset()
 {
-			
-	for( std::size_t i = 0; i < mInterpolators.size(); ++i )
-		mInterpolators[ i ]->Reset();
+	GTweenEngine* engine = GetGTweenEngine();
+	for( std::size_t i = 0; i < mTracks.size(); ++i )
+	{
+		if( mTracks[ i ].is_float )
+			engine->ResetFloatTrack( mTracks[ i ].id );
+		else
+			engine->GetInterpolator( mTracks[ i ].id )->Reset();
+	}
 
-	mTimer = 0.f;
+	engine->GetClock( mClock ).timer = 0.f;
 
 }
 
@@ -426,30 +401,31 @@ void GTween::Reset()
 
 void GTween::Reverse()
 {
-	if( mLooping == false)
+	GTweenEngine::Clock& clock = GetClock();
+	const bool looping = ( clock.flags & GTweenEngine::CLOCK_LOOPING ) != 0;
+
+	if( looping == false)
 	{
-		if( mTimer == 0 )
+		if( clock.timer == 0 )
 		{
-			mCompleted = true;
+			clock.flags |= GTweenEngine::CLOCK_COMPLETED;
 			OnComplete();
-			if( mKillMeAutomatically ) mDead = true;
+			if( GetClockFlag( GTweenEngine::CLOCK_AUTO_KILL ) ) Kill();
 
 		}
 		else
 		{
-			mLooping = true;
-			float timer = mTimer;
-			mTimer = mDuration + ( mDuration - mTimer);
-			mLoopCount = 1;
+			clock.flags |= GTweenEngine::CLOCK_LOOPING;
+			clock.timer = clock.duration + ( clock.duration - clock.timer );
+			clock.loop_count = 1;
 		}
 	}
-	else if( mLooping && mTimer >= mDuration )
+	else if( looping && clock.timer >= clock.duration )
 	{
-		mLooping = false;
-		mOnLoop = false;
-		mTimer = mDuration - ( mTimer - mDuration );
+		clock.flags &= ~( GTweenEngine::CLOCK_LOOPING | GTweenEngine::CLOCK_ON_LOOP );
+		clock.timer = clock.duration - ( clock.timer - clock.duration );
 	}
-	else if( mLooping && mTimer < mDuration )
+	else if( looping && clock.timer < clock.duration )
 	{
 		std::cout << "ERROROR" <<std::endl;
 	}
@@ -34,23 +34,33 @@
 #define INC_GTWEEN_H
 
 
+#include <vector>
+
 #include "../../utils/math/math_utils.h"
 #include "../../utils/functionptr/cfunctionptr.h"
-#include "../../utils/autolist/cautolist.h"
 #include "../../utils/easing/easing.h"
 #include "cinterpolator.h"
 #include "gtween_listener.h"
+#include "gtween_engine.h"
 
 //-----------------------------------------------------------------------------
 // updates all gtweens and removes the dead gtweens from the list as well
 void UpdateGTweens( float dt );
 
-//-----------------------------------------------------------------------------
+// all the gtweens in the order they were created. Can have NULLs where
+// gtweens have been deleted, they're removed by the next UpdateGTweens()
+const std::vector< GTween* >& GetGTweens();
 
+// the number of gtweens alive
+int GetGTweenCount();
 
-// autolist?
-// the auto updating thing has to be implemented
-class GTween : public ceng::CAutoList< GTween >
+//-----------------------------------------------------------------------------
+
+// The timer and the interpolations are stored in GTweenEngine (gtween_engine.h)
+// and are updated in batches, GTween holds their handles. Floats (and vector2s)
+// added with AddVariable() are the fast case, other types and getters &
+// setters go through IInterpolator.
+class GTween
 {
 public:
 
@@ -60,7 +70,7 @@ public:
 	template< typename T >
 	GTween( T& variable, const T& target, float duration = 1.f, ceng::easing::IEasingFunc& math_func = ceng::easing::Linear::easeNone, bool autokill = true ) 
 	{
-		GTween( duration, autokill );
+		Init( duration, autokill );
 
 		SetFunction( math_func );
 		AddVariable( variable, target, "variable" );
@@ -90,6 +100,9 @@ public:
 		AddInterpolator( in );	
 	}
 
+	void AddVariable( float& reference, const float& target_value, const std::string& name );
+	void AddVariable( types::vector2& reference, const types::vector2& target_value, const std::string& name );
+
 	template< class T >
 	void AddGetterSetter( 
 			const ceng::CFunctionPtr<>& getter,
@@ -146,8 +159,35 @@ public:
 	std::string GetName() const;
 
 private:
+	friend class GTweenEngine;
+
+	struct Track
+	{
+		Track() : id( -1 ), is_float( false ), pointer( NULL ), name() { }
+
+		int id;
+		bool is_float;
+		// what UsesPointer() checks for the float tracks
+		void* pointer;
+		std::string name;
+	};
+
+	void Init( float duration, bool auto_kill );
+
+	// the timer, the delay & co. are in the clock of the gtween
+	GTweenEngine::Clock& GetClock() const;
+	bool GetClockFlag( unsigned int flag ) const;
+	void SetClockFlag( unsigned int flag, bool value );
+
+	void AddFloatTrack( float* target, float target_value, void* pointer, const std::string& name );
+	void RemoveTrack( std::size_t i );
+	bool TrackUsesPointer( const Track& track, void* pointer ) const;
 	void RemoveDuplicateInterpolators( const std::string& name );
-	
+
+	void ApplyTracks( float t );
+	// calls OnComplete() after the tracks have been set
+	void Complete();
+
 	// callbacks
 	void OnStart();
 	void OnStep();
@@ -156,25 +196,11 @@ private:
 	// magic reset button, resets interpolators
 	void Reset();
 
-	std::vector< ceng::IInterpolator* > mInterpolators;
+	int mEngineIndex;
+	int mClock;
+	std::vector< Track > mTracks;
 	std::vector< GTweenListener* > mListeners;
 	std::vector< void* > mExtraPointers;
-	
-	bool mDirty;
-	float mDelay;
-	float mDuration;
-	float mTimer;
-	bool mDead;
-	bool mKillMeAutomatically;
-	bool mCompleted;
-
-	bool mLooping;
-	bool mOnLoop;
-	int mLoopCount;	// if -1 loop indefinetely
-
-	bool mClampValues;
-
-	ceng::easing::IEasingFunc* mMathFunc;
 
 	std::string mName;
 	types::vector2 mUserData;
@@ -183,11 +209,11 @@ private:
 //-----------------------------------------------------------------------------
 
 inline void GTween::SetLooping( bool looping ) { 
-	mLooping = looping; 
+	SetClockFlag( GTweenEngine::CLOCK_LOOPING, looping );
 }
 
 inline void GTween::SetClampValues( bool clamp ) { 
-	mClampValues = clamp; 
+	SetClockFlag( GTweenEngine::CLOCK_CLAMP, clamp );
 }
 
 //-----------------------------------------------------------------------------
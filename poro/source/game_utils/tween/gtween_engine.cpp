@@ -0,0 +1,832 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2003 - 2011 Petri Purho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+
+#include "gtween_engine.h"
+#include "gtween.h"
+#include "../../utils/singleton/csingletonptr.h"
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#	define CENG_GTWEEN_SSE2
+#	include <emmintrin.h>
+#endif
+
+//=============================================================================
+
+GTweenEngine* GetGTweenEngine()
+{
+	return ceng::GetSingletonPtr< GTweenEngine >();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+GTweenEngine::GTweenEngine() :
+	mTweens(),
+	mTweenCount( 0 ),
+	mUpdating( false ),
+	mCompleted(),
+	mKilled(),
+	mClocks(),
+	mClockTween(),
+	mClockSequence(),
+	mSequence( 0 ),
+	mClockTime(),
+	mClockRunning(),
+	mClampedClocks(),
+	mFreeClocks(),
+	mPendingClocks(),
+	mDirtyClocks(),
+	mGroups(),
+	mInterpolators(),
+	mInterpolatorClock(),
+	mInterpolatorId(),
+	mInterpolatorOrder(),
+	mInterpolatorPosition(),
+	mFreeInterpolatorIds(),
+	mPendingInterpolators(),
+	mDeadInterpolators( 0 ),
+	mInterpolatorsUnordered( false ),
+	mFloatTarget(),
+	mFloatStart(),
+	mFloatDelta(),
+	mFloatEnd(),
+	mFloatClock(),
+	mFloatId(),
+	mFloatOrder(),
+	mFloatPosition(),
+	mFreeFloatIds(),
+	mDeadFloats( 0 ),
+	mFloatsUnordered( false ),
+	mFloatTime(),
+	mFloatValue()
+{
+	// group 0 is for the gtweens without an easing function
+	mGroups.push_back( EasingGroup() );
+
+	const int dead_clock = AddClock( NULL );
+	cassert( dead_clock == DEAD_CLOCK );
+	mClocks[ DEAD_CLOCK ].flags = CLOCK_UNUSED;
+}
+
+GTweenEngine::~GTweenEngine()
+{
+	// the dead tracks are NULL
+	for( std::size_t i = 0; i < mInterpolators.size(); ++i )
+		delete mInterpolators[ i ];
+
+	mInterpolators.clear();
+}
+
+//=============================================================================
+
+void GTweenEngine::AddTween( GTween* tween )
+{
+	cassert( tween );
+
+	// removed gtweens leave holes, which are normally removed in the update
+	if( mUpdating == false && (int)mTweens.size() > 2 * mTweenCount + 64 )
+		CompactTweens();
+
+	tween->mEngineIndex = (int)mTweens.size();
+	mTweens.push_back( tween );
+	mTweenCount++;
+}
+
+void GTweenEngine::RemoveTween( GTween* tween )
+{
+	cassert( tween );
+	const int i = tween->mEngineIndex;
+	cassert( i >= 0 && i < (int)mTweens.size() && mTweens[ i ] == tween );
+	if( i < 0 || i >= (int)mTweens.size() || mTweens[ i ] != tween )
+		return;
+
+	mTweens[ i ] = NULL;
+	tween->mEngineIndex = -1;
+	mTweenCount--;
+}
+
+void GTweenEngine::CompactTweens()
+{
+	std::size_t count = 0;
+	for( std::size_t i = 0; i < mTweens.size(); ++i )
+	{
+		if( mTweens[ i ] )
+		{
+			mTweens[ i ]->mEngineIndex = (int)count;
+			mTweens[ count++ ] = mTweens[ i ];
+		}
+	}
+
+	mTweens.resize( count );
+}
+
+//-----------------------------------------------------------------------------
+
+void GTweenEngine::Update( float dt )
+{
+	cassert( mUpdating == false );
+	mUpdating = true;
+
+	ResetDirtyClocks();
+
+	// timers. The clocks that the listeners add go to the end, so the new
+	// gtweens are updated too.
+	Clock* clocks = &mClocks[ 0 ];
+	float* clock_time = &mClockTime[ 0 ];
+	unsigned char* clock_running = &mClockRunning[ 0 ];
+	int count = (int)mClocks.size();
+
+	for( int c = 1; c < count; ++c )
+	{
+		float t = 0;
+		bool running = false;
+		if( ( clocks[ c ].flags & CLOCK_SLOW ) == 0 && clocks[ c ].delay <= 0 )
+		{
+			running = StepClock( clocks[ c ], c, dt, t );
+		}
+		else
+		{
+			running = AdvanceClock( c, dt, t );
+
+			// the callbacks can add clocks
+			clocks = &mClocks[ 0 ];
+			clock_time = &mClockTime[ 0 ];
+			clock_running = &mClockRunning[ 0 ];
+			count = (int)mClocks.size();
+		}
+
+		if( running )
+		{
+			clock_time[ c ] = t;
+			if( clock_running[ c ] == 0 )
+			{
+				clock_running[ c ] = 1;
+				mGroups[ clocks[ c ].group ].clocks.push_back( c );
+				if( clocks[ c ].flags & CLOCK_CLAMP )
+					mClampedClocks.push_back( c );
+			}
+		}
+	}
+
+	// easing functions, one group at the time
+	for( std::size_t g = 0; g < mGroups.size(); ++g )
+	{
+		EasingGroup& group = mGroups[ g ];
+		if( group.easing && group.clocks.empty() == false )
+		{
+			ceng::easing::IEasingFunc* easing = group.easing;
+			const int* running_clocks = &group.clocks[ 0 ];
+			const int running_count = (int)group.clocks.size();
+			for( int i = 0; i < running_count; ++i )
+				clock_time[ running_clocks[ i ] ] = easing->f( clock_time[ running_clocks[ i ] ] );
+		}
+	}
+
+	for( std::size_t i = 0; i < mClampedClocks.size(); ++i )
+		clock_time[ mClampedClocks[ i ] ] = ceng::math::Clamp( clock_time[ mClampedClocks[ i ] ], 0.f, 1.f );
+	mClampedClocks.clear();
+
+	UpdateFloatTracks();
+	UpdateInterpolatorTracks();
+
+	for( std::size_t g = 0; g < mGroups.size(); ++g )
+	{
+		EasingGroup& group = mGroups[ g ];
+		for( std::size_t i = 0; i < group.clocks.size(); ++i )
+			mClockRunning[ group.clocks[ i ] ] = 0;
+		group.clocks.clear();
+	}
+
+	// OnComplete() is called after the values have been set
+	for( std::size_t i = 0; i < mCompleted.size(); ++i )
+	{
+		const int c = mCompleted[ i ];
+		if( ( mClocks[ c ].flags & ( CLOCK_COMPLETE_PENDING | CLOCK_UNUSED ) ) == CLOCK_COMPLETE_PENDING )
+			mClockTween[ c ]->Complete();
+	}
+	mCompleted.clear();
+
+	// release the dead gtweens, their destructors can kill more of them
+	for( std::size_t i = 0; i < mKilled.size(); ++i )
+	{
+		const int c = mKilled[ i ];
+		if( ( mClocks[ c ].flags & ( CLOCK_DEAD | CLOCK_UNUSED ) ) == CLOCK_DEAD )
+			delete mClockTween[ c ];
+	}
+	mKilled.clear();
+
+	if( (int)mTweens.size() != mTweenCount )
+		CompactTweens();
+
+	mUpdating = false;
+	ReleasePending();
+}
+
+//-----------------------------------------------------------------------------
+
+void GTweenEngine::UpdateFloatTracks()
+{
+	if( mDeadFloats > 0 || mFloatsUnordered )
+		CompactFloatTracks();
+
+	const int count = (int)mFloatTarget.size();
+	if( count == 0 ) 
+		return;
+
+	// these only grow, so there's no allocating after the first frames
+	if( (int)mFloatTime.size() < count )
+	{
+		mFloatTime.resize( count );
+		mFloatValue.resize( count );
+	}
+
+	const int* clock = &mFloatClock[ 0 ];
+	const float* clock_time = &mClockTime[ 0 ];
+	const unsigned char* clock_running = &mClockRunning[ 0 ];
+	const float* start = &mFloatStart[ 0 ];
+	const float* delta = &mFloatDelta[ 0 ];
+	float* time = &mFloatTime[ 0 ];
+	float* value = &mFloatValue[ 0 ];
+	float* const* target = &mFloatTarget[ 0 ];
+
+	for( int i = 0; i < count; ++i )
+		time[ i ] = clock_time[ clock[ i ] ];
+
+	// no dependencies between the tracks, four at a time with SSE2. The 
+	// rounding is the same as in the scalar loop, so every track gets the 
+	// same value no matter where it is in the arrays
+	int i = 0;
+#ifdef CENG_GTWEEN_SSE2
+	for( ; i + 4 <= count; i += 4 )
+	{
+		const __m128 t = _mm_mul_ps( _mm_loadu_ps( time + i ), _mm_loadu_ps( delta + i ) );
+		_mm_storeu_ps( value + i, _mm_add_ps( _mm_loadu_ps( start + i ), t ) );
+	}
+#endif
+
+	for( ; i < count; ++i )
+		value[ i ] = start[ i ] + time[ i ] * delta[ i ];
+
+	for( i = 0; i < count; ++i )
+	{
+		if( clock_running[ clock[ i ] ] )
+			*target[ i ] = value[ i ];
+	}
+}
+
+void GTweenEngine::UpdateInterpolatorTracks()
+{
+	if( mDeadInterpolators > 0 || mInterpolatorsUnordered )
+		CompactInterpolatorTracks();
+
+	// the setters can add and remove tracks, so no pointers to the arrays.
+	// The tracks they add go to the end for this frame.
+	for( std::size_t i = 0; i < mInterpolators.size(); ++i )
+	{
+		const int clock = mInterpolatorClock[ i ];
+		if( mClockRunning[ clock ] )
+			mInterpolators[ i ]->Update( mClockTime[ clock ] );
+	}
+}
+
+//=============================================================================
+
+int GTweenEngine::AddClock( GTween* tween )
+{
+	// the clocks added during the update go to the end, so they are updated
+	// on the same frame
+	int clock = 0;
+	if( mFreeClocks.empty() == false && mUpdating == false )
+	{
+		clock = mFreeClocks.back();
+		mFreeClocks.pop_back();
+	}
+	else
+	{
+		clock = (int)mClocks.size();
+		mClocks.push_back( Clock() );
+		mClockTween.push_back( NULL );
+		mClockSequence.push_back( 0 );
+		mClockTime.push_back( 0 );
+		mClockRunning.push_back( 0 );
+	}
+
+	mClocks[ clock ] = Clock();
+	mClockTween[ clock ] = tween;
+	mClockSequence[ clock ] = mSequence++;
+	mClockTime[ clock ] = 0;
+	mClockRunning[ clock ] = 0;
+	return clock;
+}
+
+void GTweenEngine::RemoveClock( int clock )
+{
+	cassert( clock > DEAD_CLOCK && clock < (int)mClocks.size() );
+	mClocks[ clock ].flags = CLOCK_UNUSED;
+	mClockTween[ clock ] = NULL;
+
+	// it could still be in the running clocks of its easing group
+	if( mUpdating )
+		mPendingClocks.push_back( clock );
+	else
+		ReleaseClock( clock );
+}
+
+void GTweenEngine::ReleaseClock( int clock )
+{
+	mClockRunning[ clock ] = 0;
+	mFreeClocks.push_back( clock );
+}
+
+void GTweenEngine::SetClockEasing( int clock, ceng::easing::IEasingFunc* easing )
+{
+	cassert( clock >= 0 && clock < (int)mClocks.size() );
+
+	for( std::size_t g = 0; g < mGroups.size(); ++g )
+	{
+		if( mGroups[ g ].easing == easing )
+		{
+			mClocks[ clock ].group = (int)g;
+			return;
+		}
+	}
+
+	mClocks[ clock ].group = (int)mGroups.size();
+	mGroups.push_back( EasingGroup() );
+	mGroups.back().easing = easing;
+}
+
+void GTweenEngine::SetClockDirty( int clock )
+{
+	cassert( clock > DEAD_CLOCK && clock < (int)mClocks.size() );
+	if( mClocks[ clock ].flags & CLOCK_DIRTY )
+		return;
+
+	mClocks[ clock ].flags |= CLOCK_DIRTY;
+	mDirtyClocks.push_back( clock );
+}
+
+void GTweenEngine::KillClock( int clock )
+{
+	cassert( clock > DEAD_CLOCK && clock < (int)mClocks.size() );
+	if( mClocks[ clock ].flags & ( CLOCK_DEAD | CLOCK_UNUSED ) )
+		return;
+
+	mClocks[ clock ].flags |= CLOCK_DEAD;
+	mKilled.push_back( clock );
+}
+
+//-----------------------------------------------------------------------------
+
+// the start values are read before any of the tracks are set this frame. 
+// OnStart() can make more clocks dirty, so no iterators.
+void GTweenEngine::ResetDirtyClocks()
+{
+	for( std::size_t i = 0; i < mDirtyClocks.size(); ++i )
+	{
+		const int c = mDirtyClocks[ i ];
+		if( ( mClocks[ c ].flags & ( CLOCK_DIRTY | CLOCK_DEAD | CLOCK_UNUSED ) ) != CLOCK_DIRTY )
+			continue;
+
+		mClocks[ c ].flags &= ~( CLOCK_DIRTY | CLOCK_COMPLETED );
+		mClockTween[ c ]->Reset();
+
+		if( mClocks[ c ].delay <= 0 )
+			mClockTween[ c ]->OnStart();
+	}
+
+	mDirtyClocks.clear();
+}
+
+bool GTweenEngine::AdvanceClock( int c, float dt, float& t )
+{
+	cassert( c >= 0 && c < (int)mClocks.size() );
+
+	// the listeners can add clocks, so there are no references to mClocks
+	// over the callbacks. They can also delete the gtween.
+	if( mClocks[ c ].flags & ( CLOCK_DEAD | CLOCK_UNUSED ) ) 
+		return false;
+
+	// made dirty during this update or used through GTween::Update()
+	if( mClocks[ c ].flags & CLOCK_DIRTY )
+	{
+		mClocks[ c ].flags &= ~( CLOCK_DIRTY | CLOCK_COMPLETED );
+		mClockTween[ c ]->Reset();
+
+		if( mClocks[ c ].delay <= 0 )
+			mClockTween[ c ]->OnStart();
+
+		if( mClocks[ c ].flags & CLOCK_UNUSED ) 
+			return false;
+	}
+
+	if( mClocks[ c ].flags & CLOCK_COMPLETED ) 
+		return false;
+
+	if( mClocks[ c ].delay > 0 )
+	{
+		mClocks[ c ].delay -= dt;
+		if( mClocks[ c ].delay <= 0 ) 
+		{
+			// restart start values?
+			mClockTween[ c ]->Reset();
+			mClockTween[ c ]->OnStart();
+
+			if( mClocks[ c ].flags & CLOCK_UNUSED ) 
+				return false;
+		}
+
+		EndClockStep( mClocks[ c ], c );
+		return false;
+	}
+
+	if( mClocks[ c ].flags & CLOCK_LISTENERS )
+	{
+		const Clock& clock = mClocks[ c ];
+		if( clock.timer <= clock.duration || 
+			( ( clock.flags & CLOCK_ON_LOOP ) && clock.timer <= clock.duration * 2.f ) )
+		{
+			mClockTween[ c ]->OnStep();
+			if( mClocks[ c ].flags & CLOCK_UNUSED ) 
+				return false;
+		}
+	}
+
+	return StepClock( mClocks[ c ], c, dt, t );
+}
+
+// the clock isn't completed and has no delay
+inline bool GTweenEngine::StepClock( Clock& clock, int c, float dt, float& t )
+{
+	bool result = false;
+
+	const bool forward = clock.timer <= clock.duration;
+	if( forward || ( ( clock.flags & CLOCK_ON_LOOP ) && clock.timer <= clock.duration * 2.f ) ) 
+	{
+		cassert( clock.duration != 0 );
+		if( clock.duration == 0 )
+			return false;
+
+		clock.timer += dt;
+
+		if( forward )
+			t = clock.timer / clock.duration;
+		else
+			t = 1.f - ( ( clock.timer - clock.duration ) / clock.duration );
+		
+		t = ceng::math::Clamp( t, 0.f, 1.f );
+		result = true;
+	}
+
+	EndClockStep( clock, c );
+	return result;
+}
+
+inline void GTweenEngine::EndClockStep( Clock& clock, int c )
+{
+	if( ( clock.flags & CLOCK_ON_LOOP ) == 0 && clock.timer >= clock.duration )
+	{
+		if( clock.flags & CLOCK_LOOPING )
+			clock.flags |= CLOCK_ON_LOOP;
+		else
+			CompleteClock( c );
+	}
+	else if( ( clock.flags & CLOCK_ON_LOOP ) && clock.timer >= clock.duration * 2.f )
+	{
+		if( clock.loop_count > 0 ) 
+			clock.loop_count--;
+
+		// kill me
+		if( clock.loop_count == 0 )
+			CompleteClock( c );
+
+		clock.flags &= ~CLOCK_ON_LOOP;
+		clock.timer = 0;
+	}
+}
+
+void GTweenEngine::CompleteClock( int c )
+{
+	mClocks[ c ].flags |= CLOCK_COMPLETED | CLOCK_COMPLETE_PENDING;
+	if( mUpdating )
+		mCompleted.push_back( c );
+}
+
+float GTweenEngine::EaseTime( int clock, float t ) const
+{
+	cassert( clock >= 0 && clock < (int)mClocks.size() );
+
+	ceng::easing::IEasingFunc* easing = mGroups[ mClocks[ clock ].group ].easing;
+	if( easing ) 
+		t = easing->f( t );
+
+	if( mClocks[ clock ].flags & CLOCK_CLAMP ) 
+		t = ceng::math::Clamp( t, 0.f, 1.f );
+
+	return t;
+}
+
+//=============================================================================
+
+int GTweenEngine::AddInterpolatorTrack( int clock, ceng::IInterpolator* interpolator )
+{
+	cassert( interpolator );
+	cassert( clock >= 0 && clock < (int)mClocks.size() );
+
+	if( mUpdating == false && mDeadInterpolators > (int)mInterpolators.size() / 2 + 64 )
+		CompactInterpolatorTracks();
+
+	int track = 0;
+	if( mFreeInterpolatorIds.empty() == false )
+	{
+		track = mFreeInterpolatorIds.back();
+		mFreeInterpolatorIds.pop_back();
+	}
+	else
+	{
+		track = (int)mInterpolatorPosition.size();
+		mInterpolatorPosition.push_back( -1 );
+	}
+
+	// a track added to an older gtween is sorted in before the next update
+	const unsigned int order = mClockSequence[ clock ];
+	if( mInterpolatorOrder.empty() == false && order < mInterpolatorOrder.back() )
+		mInterpolatorsUnordered = true;
+
+	mInterpolatorPosition[ track ] = (int)mInterpolators.size();
+	mInterpolators.push_back( interpolator );
+	mInterpolatorClock.push_back( clock );
+	mInterpolatorId.push_back( track );
+	mInterpolatorOrder.push_back( order );
+	return track;
+}
+
+void GTweenEngine::RemoveInterpolatorTrack( int track )
+{
+	cassert( track >= 0 && track < (int)mInterpolatorPosition.size() );
+	cassert( mInterpolatorPosition[ track ] >= 0 );
+
+	if( mUpdating )
+	{
+		// the interpolator could be the one that is being updated
+		mInterpolatorClock[ mInterpolatorPosition[ track ] ] = DEAD_CLOCK;
+		mPendingInterpolators.push_back( track );
+	}
+	else
+	{
+		ReleaseInterpolatorTrack( track );
+	}
+}
+
+// the track stays in the arrays as a dead track, so the order of the others
+// doesn't change
+void GTweenEngine::ReleaseInterpolatorTrack( int track )
+{
+	const int i = mInterpolatorPosition[ track ];
+
+	delete mInterpolators[ i ];
+	mInterpolators[ i ] = NULL;
+	mInterpolatorClock[ i ] = DEAD_CLOCK;
+	mInterpolatorId[ i ] = -1;
+	mDeadInterpolators++;
+
+	mInterpolatorPosition[ track ] = -1;
+	mFreeInterpolatorIds.push_back( track );
+}
+
+inline void GTweenEngine::MoveInterpolatorTrack( int to, int from )
+{
+	mInterpolators[ to ] = mInterpolators[ from ];
+	mInterpolatorClock[ to ] = mInterpolatorClock[ from ];
+	mInterpolatorId[ to ] = mInterpolatorId[ from ];
+	mInterpolatorOrder[ to ] = mInterpolatorOrder[ from ];
+	mInterpolatorPosition[ mInterpolatorId[ to ] ] = to;
+}
+
+void GTweenEngine::CompactInterpolatorTracks()
+{
+	int count = 0;
+	for( int i = 0; i < (int)mInterpolators.size(); ++i )
+	{
+		if( mInterpolatorId[ i ] >= 0 )
+			MoveInterpolatorTrack( count++, i );
+	}
+
+	mInterpolators.resize( count );
+	mInterpolatorClock.resize( count );
+	mInterpolatorId.resize( count );
+	mInterpolatorOrder.resize( count );
+	mDeadInterpolators = 0;
+
+	if( mInterpolatorsUnordered == false )
+		return;
+
+	// insertion sort, only the few tracks that were added to the older 
+	// gtweens are out of place. Stable, so the tracks of a gtween stay in 
+	// the order they were added in.
+	for( int i = 1; i < count; ++i )
+	{
+		const unsigned int order = mInterpolatorOrder[ i ];
+		if( order >= mInterpolatorOrder[ i - 1 ] )
+			continue;
+
+		ceng::IInterpolator* interpolator = mInterpolators[ i ];
+		const int clock = mInterpolatorClock[ i ];
+		const int id = mInterpolatorId[ i ];
+
+		int j = i;
+		for( ; j > 0 && mInterpolatorOrder[ j - 1 ] > order; --j )
+			MoveInterpolatorTrack( j, j - 1 );
+
+		mInterpolators[ j ] = interpolator;
+		mInterpolatorClock[ j ] = clock;
+		mInterpolatorId[ j ] = id;
+		mInterpolatorOrder[ j ] = order;
+		mInterpolatorPosition[ id ] = j;
+	}
+
+	mInterpolatorsUnordered = false;
+}
+
+ceng::IInterpolator* GTweenEngine::GetInterpolator( int track ) const
+{
+	cassert( track >= 0 && track < (int)mInterpolatorPosition.size() );
+	cassert( mInterpolatorPosition[ track ] >= 0 );
+
+	return mInterpolators[ mInterpolatorPosition[ track ] ];
+}
+
+//-----------------------------------------------------------------------------
+
+int GTweenEngine::AddFloatTrack( int clock, float* target, float end_value )
+{
+	cassert( target );
+	cassert( clock >= 0 && clock < (int)mClocks.size() );
+
+	if( mUpdating == false && mDeadFloats > (int)mFloatTarget.size() / 2 + 64 )
+		CompactFloatTracks();
+
+	int track = 0;
+	if( mFreeFloatIds.empty() == false )
+	{
+		track = mFreeFloatIds.back();
+		mFreeFloatIds.pop_back();
+	}
+	else
+	{
+		track = (int)mFloatPosition.size();
+		mFloatPosition.push_back( -1 );
+	}
+
+	const unsigned int order = mClockSequence[ clock ];
+	if( mFloatOrder.empty() == false && order < mFloatOrder.back() )
+		mFloatsUnordered = true;
+
+	mFloatPosition[ track ] = (int)mFloatTarget.size();
+	mFloatTarget.push_back( target );
+	mFloatStart.push_back( *target );
+	mFloatDelta.push_back( end_value - *target );
+	mFloatEnd.push_back( end_value );
+	mFloatClock.push_back( clock );
+	mFloatId.push_back( track );
+	mFloatOrder.push_back( order );
+	return track;
+}
+
+void GTweenEngine::RemoveFloatTrack( int track )
+{
+	cassert( track >= 0 && track < (int)mFloatPosition.size() );
+	cassert( mFloatPosition[ track ] >= 0 );
+
+	// the float tracks aren't moved during the update, so this can be 
+	// released right away
+	ReleaseFloatTrack( track );
+}
+
+void GTweenEngine::ReleaseFloatTrack( int track )
+{
+	const int i = mFloatPosition[ track ];
+
+	mFloatClock[ i ] = DEAD_CLOCK;
+	mFloatId[ i ] = -1;
+	mDeadFloats++;
+
+	mFloatPosition[ track ] = -1;
+	mFreeFloatIds.push_back( track );
+}
+
+inline void GTweenEngine::MoveFloatTrack( int to, int from )
+{
+	mFloatTarget[ to ] = mFloatTarget[ from ];
+	mFloatStart[ to ] = mFloatStart[ from ];
+	mFloatDelta[ to ] = mFloatDelta[ from ];
+	mFloatEnd[ to ] = mFloatEnd[ from ];
+	mFloatClock[ to ] = mFloatClock[ from ];
+	mFloatId[ to ] = mFloatId[ from ];
+	mFloatOrder[ to ] = mFloatOrder[ from ];
+	mFloatPosition[ mFloatId[ to ] ] = to;
+}
+
+void GTweenEngine::CompactFloatTracks()
+{
+	int count = 0;
+	for( int i = 0; i < (int)mFloatTarget.size(); ++i )
+	{
+		if( mFloatId[ i ] >= 0 )
+			MoveFloatTrack( count++, i );
+	}
+
+	mFloatTarget.resize( count );
+	mFloatStart.resize( count );
+	mFloatDelta.resize( count );
+	mFloatEnd.resize( count );
+	mFloatClock.resize( count );
+	mFloatId.resize( count );
+	mFloatOrder.resize( count );
+	mDeadFloats = 0;
+
+	if( mFloatsUnordered == false )
+		return;
+
+	// same as in CompactInterpolatorTracks()
+	for( int i = 1; i < count; ++i )
+	{
+		const unsigned int order = mFloatOrder[ i ];
+		if( order >= mFloatOrder[ i - 1 ] )
+			continue;
+
+		float* const target = mFloatTarget[ i ];
+		const float start = mFloatStart[ i ];
+		const float delta = mFloatDelta[ i ];
+		const float end = mFloatEnd[ i ];
+		const int clock = mFloatClock[ i ];
+		const int id = mFloatId[ i ];
+
+		int j = i;
+		for( ; j > 0 && mFloatOrder[ j - 1 ] > order; --j )
+			MoveFloatTrack( j, j - 1 );
+
+		mFloatTarget[ j ] = target;
+		mFloatStart[ j ] = start;
+		mFloatDelta[ j ] = delta;
+		mFloatEnd[ j ] = end;
+		mFloatClock[ j ] = clock;
+		mFloatId[ j ] = id;
+		mFloatOrder[ j ] = order;
+		mFloatPosition[ id ] = j;
+	}
+
+	mFloatsUnordered = false;
+}
+
+void GTweenEngine::ResetFloatTrack( int track )
+{
+	cassert( track >= 0 && track < (int)mFloatPosition.size() );
+	const int i = mFloatPosition[ track ];
+	cassert( i >= 0 );
+
+	mFloatStart[ i ] = *mFloatTarget[ i ];
+	mFloatDelta[ i ] = mFloatEnd[ i ] - mFloatStart[ i ];
+}
+
+void GTweenEngine::ApplyFloatTrack( int track, float t )
+{
+	cassert( track >= 0 && track < (int)mFloatPosition.size() );
+	const int i = mFloatPosition[ track ];
+	cassert( i >= 0 );
+
+	*mFloatTarget[ i ] = mFloatStart[ i ] + t * mFloatDelta[ i ];
+}
+
+//-----------------------------------------------------------------------------
+
+void GTweenEngine::ReleasePending()
+{
+	for( std::size_t i = 0; i < mPendingClocks.size(); ++i )
+		ReleaseClock( mPendingClocks[ i ] );
+
+	for( std::size_t i = 0; i < mPendingInterpolators.size(); ++i )
+		ReleaseInterpolatorTrack( mPendingInterpolators[ i ] );
+
+	mPendingClocks.clear();
+	mPendingInterpolators.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
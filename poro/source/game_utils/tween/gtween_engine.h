@@ -0,0 +1,263 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2003 - 2011 Petri Purho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// GTweenEngine
+// ============
+//
+// The data UpdateGTweens() goes through every frame, in flat arrays. GTween
+// is the interface on top of this, there shouldn't be a need to use this
+// directly.
+//
+//	- the gtweens are in a vector in the order they were created. A deleted
+//	  gtween leaves a NULL that is removed at the end of the next update.
+//
+//	- every gtween has a clock, which has the timer, the duration, the delay
+//	  and the looping of the gtween. The clocks are run in one loop that
+//	  only touches the gtween when there's a callback to call (the start,
+//	  the listeners, the completion).
+//
+//	- the gtweens that were changed (new tracks, duration, delay) are reset
+//	  before any clock is run, so they start from the values the previous
+//	  update left. Unlike when every gtween was updated on its own, a
+//	  gtween doesn't see what the older gtweens set on the same frame.
+//
+//	- the t of the clocks is grouped by the easing function, so each easing
+//	  function is run over its clocks in one loop.
+//
+//	- float variables are float tracks: arrays of targets, start values and
+//	  deltas. They are all updated in one loop that the compiler can
+//	  vectorize and then written to the targets.
+//
+//	- everything else (getters & setters, angles, ints...) is an
+//	  interpolator track, that is updated through IInterpolator::Update( t ).
+//
+//	- the tracks are kept in the order their gtweens were created in, so if
+//	  two gtweens set the same variable the newer one wins. Removing a track
+//	  only marks it dead, the dead tracks are dropped before the tracks are
+//	  updated. The float tracks are set before the interpolator tracks.
+//
+// The removed clocks and tracks are reused, so once the arrays have grown
+// nothing is allocated during the update. Things that are removed during the
+// update (from the listeners or setters) are released after it.
+//
+//-----------------------------------------------------------------------------
+#ifndef INC_GTWEEN_ENGINE_H
+#define INC_GTWEEN_ENGINE_H
+
+#include <vector>
+
+#include "../../utils/debug.h"
+#include "../../utils/easing/easing.h"
+#include "cinterpolator.h"
+
+class GTween;
+
+class GTweenEngine
+{
+public:
+	GTweenEngine();
+	~GTweenEngine();
+
+	//-------------------------------------------------------------------------
+	// gtweens
+
+	void AddTween( GTween* tween );
+	void RemoveTween( GTween* tween );
+
+	// can have NULLs of the gtweens that have been deleted
+	const std::vector< GTween* >&	GetTweens() const	{ return mTweens; }
+	int								GetTweenCount() const { return mTweenCount; }
+
+	// updates all the gtweens and deletes the dead ones
+	void Update( float dt );
+
+	//-------------------------------------------------------------------------
+	// clocks
+
+	enum ClockFlags
+	{
+		// the tracks have to be reset before the next step
+		CLOCK_DIRTY				= 1 << 0,
+		CLOCK_COMPLETED			= 1 << 1,
+		// OnComplete() hasn't been called yet
+		CLOCK_COMPLETE_PENDING	= 1 << 2,
+		CLOCK_LOOPING			= 1 << 3,
+		// playing backwards
+		CLOCK_ON_LOOP			= 1 << 4,
+		CLOCK_DEAD				= 1 << 5,
+		CLOCK_AUTO_KILL			= 1 << 6,
+		CLOCK_CLAMP				= 1 << 7,
+		// the gtween has listeners, so OnStep() has to be called
+		CLOCK_LISTENERS			= 1 << 8,
+		// removed, or the dead clock
+		CLOCK_UNUSED			= 1 << 9,
+
+		// the clocks with these can't be run without calling the gtween
+		CLOCK_SLOW				= CLOCK_DIRTY | CLOCK_COMPLETED | CLOCK_DEAD | CLOCK_LISTENERS | CLOCK_UNUSED
+	};
+
+	struct Clock
+	{
+		Clock() : timer( 0 ), duration( 1.f ), delay( 0 ), loop_count( -1 ), group( 0 ), flags( 0 ) { }
+
+		float			timer;
+		float			duration;
+		float			delay;
+		// if -1 loops indefinitely
+		int				loop_count;
+		// to mGroups, by the easing function
+		int				group;
+		unsigned int	flags;
+	};
+
+	int		AddClock( GTween* tween );
+	void	RemoveClock( int clock );
+
+	Clock&			GetClock( int clock )		{ cassert( clock >= 0 && clock < (int)mClocks.size() ); return mClocks[ clock ]; }
+	const Clock&	GetClock( int clock ) const	{ cassert( clock >= 0 && clock < (int)mClocks.size() ); return mClocks[ clock ]; }
+
+	void	SetClockEasing( int clock, ceng::easing::IEasingFunc* easing );
+
+	// the gtween of the clock is reset before its next step
+	void	SetClockDirty( int clock );
+
+	// the gtween of the clock is deleted in the next update
+	void	KillClock( int clock );
+
+	// runs the timer of the clock and calls OnStart() and OnStep() of its
+	// gtween. Returns true if the tracks should be set with t
+	bool	AdvanceClock( int clock, float dt, float& t );
+
+	// applies the easing function and the clamping of the clock to t
+	float	EaseTime( int clock, float t ) const;
+
+	//-------------------------------------------------------------------------
+	// tracks
+
+	// the engine owns the interpolator
+	int		AddInterpolatorTrack( int clock, ceng::IInterpolator* interpolator );
+	void	RemoveInterpolatorTrack( int track );
+	ceng::IInterpolator* GetInterpolator( int track ) const;
+
+	int		AddFloatTrack( int clock, float* target, float end_value );
+	void	RemoveFloatTrack( int track );
+	// takes the current value of the target as the start value
+	void	ResetFloatTrack( int track );
+	void	ApplyFloatTrack( int track, float t );
+
+private:
+	// the removed tracks point to this, it never runs
+	enum { DEAD_CLOCK = 0 };
+
+	struct EasingGroup
+	{
+		EasingGroup() : easing( NULL ), clocks() { }
+
+		ceng::easing::IEasingFunc*	easing;
+		// the clocks that are running this frame
+		std::vector< int >			clocks;
+	};
+
+	// the timer part of AdvanceClock(), without the callbacks
+	void	ResetDirtyClocks();
+	inline bool StepClock( Clock& clock, int c, float dt, float& t );
+	inline void	EndClockStep( Clock& clock, int c );
+	void	CompleteClock( int clock );
+	void	ReleaseClock( int clock );
+	void	ReleaseInterpolatorTrack( int track );
+	void	ReleaseFloatTrack( int track );
+	void	ReleasePending();
+	void	CompactTweens();
+
+	// drop the dead tracks and put the tracks back in the gtween order
+	void	CompactInterpolatorTracks();
+	void	CompactFloatTracks();
+	inline void	MoveInterpolatorTrack( int to, int from );
+	inline void	MoveFloatTrack( int to, int from );
+
+	void	UpdateFloatTracks();
+	void	UpdateInterpolatorTracks();
+
+	//-------------------------------------------------------------------------
+
+	std::vector< GTween* >		mTweens;
+	int							mTweenCount;
+	bool						mUpdating;
+	// the clocks that completed during the update
+	std::vector< int >			mCompleted;
+	// the clocks of the gtweens to delete
+	std::vector< int >			mKilled;
+
+	// clocks
+	std::vector< Clock >		mClocks;
+	std::vector< GTween* >		mClockTween;
+	// the order the gtweens of the clocks were created in
+	std::vector< unsigned int >	mClockSequence;
+	unsigned int				mSequence;
+	// the t of the clock and whether it's running, for the frame
+	std::vector< float >		mClockTime;
+	std::vector< unsigned char > mClockRunning;
+	// the running clocks that clamp t
+	std::vector< int >			mClampedClocks;
+	std::vector< int >			mFreeClocks;
+	std::vector< int >			mPendingClocks;
+	// the clocks that have been set dirty since the last update
+	std::vector< int >			mDirtyClocks;
+	std::vector< EasingGroup >	mGroups;
+
+	// interpolator tracks, a track id is mapped to its position in the arrays.
+	// The dead tracks have the id -1 and the DEAD_CLOCK.
+	std::vector< ceng::IInterpolator* > mInterpolators;
+	std::vector< int >			mInterpolatorClock;
+	std::vector< int >			mInterpolatorId;
+	// the sequence of the gtween, the arrays are sorted by this
+	std::vector< unsigned int >	mInterpolatorOrder;
+	std::vector< int >			mInterpolatorPosition;
+	std::vector< int >			mFreeInterpolatorIds;
+	std::vector< int >			mPendingInterpolators;
+	int							mDeadInterpolators;
+	bool						mInterpolatorsUnordered;
+
+	// float tracks
+	std::vector< float* >		mFloatTarget;
+	std::vector< float >		mFloatStart;
+	std::vector< float >		mFloatDelta;
+	std::vector< float >		mFloatEnd;
+	std::vector< int >			mFloatClock;
+	std::vector< int >			mFloatId;
+	std::vector< unsigned int >	mFloatOrder;
+	std::vector< int >			mFloatPosition;
+	std::vector< int >			mFreeFloatIds;
+	int							mDeadFloats;
+	bool						mFloatsUnordered;
+	// the t and the new value of each float track during the update
+	std::vector< float >		mFloatTime;
+	std::vector< float >		mFloatValue;
+};
+
+//-----------------------------------------------------------------------------
+
+GTweenEngine* GetGTweenEngine();
+
+//-----------------------------------------------------------------------------
+#endif
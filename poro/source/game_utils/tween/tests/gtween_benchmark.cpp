@@ -0,0 +1,108 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2003 - 2011 Petri Purho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+
+// Times UpdateGTweens() with 100k tweens running at the same time. Only built
+// when CENG_GTWEEN_BENCHMARK is defined.
+
+#include "../gtween.h"
+#include "../../../utils/timer/ctimer.h"
+#include "../../../utils/debug.h"
+
+#include <iostream>
+#include <vector>
+
+#if defined( CENG_TESTER_ENABLED ) && defined( CENG_GTWEEN_BENCHMARK )
+
+namespace test
+{
+
+namespace {
+
+const int GTWEEN_BENCHMARK_COUNT = 100000;
+const int GTWEEN_BENCHMARK_FRAMES = 500;
+
+ceng::easing::IEasingFunc* GTweenBenchmarkEasing( int i )
+{
+	switch( i % 4 )
+	{
+	case 0: return &ceng::easing::Linear::easeNone;
+	case 1: return &ceng::easing::Quad::easeInOut;
+	case 2: return &ceng::easing::Cubic::easeOut;
+	default: return &ceng::easing::Back::easeOut;
+	}
+}
+
+template< class T >
+void GTweenBenchmarkRun( const char* name, std::vector< T >& values, const T& target )
+{
+	ceng::CTimer timer;
+	for( std::size_t i = 0; i < values.size(); ++i )
+	{
+		GTween* tween = new GTween( 0.5f + (float)( i % 7 ) * 0.25f, false );
+		tween->AddVariable( values[ i ], target, "value" );
+		tween->SetFunction( *GTweenBenchmarkEasing( (int)i ) );
+		tween->SetLooping( true );
+	}
+	std::cout << "GTween create 100k " << name << ": " << timer.GetTime() << " ms" << std::endl;
+
+	// the first frame resets the start values
+	UpdateGTweens( 1.f / 60.f );
+
+	timer.Reset();
+	for( int frame = 0; frame < GTWEEN_BENCHMARK_FRAMES; ++frame )
+		UpdateGTweens( 1.f / 60.f );
+	std::cout << "UpdateGTweens( 100k " << name << " ): " << (float)timer.GetTime() / (float)GTWEEN_BENCHMARK_FRAMES << " ms per frame" << std::endl;
+
+	timer.Reset();
+	for( std::size_t i = 0; i < GetGTweens().size(); ++i )
+	{
+		if( GetGTweens()[ i ] )
+			GetGTweens()[ i ]->Kill();
+	}
+	UpdateGTweens( 0 );
+	std::cout << "GTween kill 100k " << name << ": " << timer.GetTime() << " ms" << std::endl;
+}
+
+} // end of anonymous namespace
+
+int GTweenBenchmark()
+{
+	std::vector< float > floats( GTWEEN_BENCHMARK_COUNT, 0.f );
+	GTweenBenchmarkRun( "floats", floats, 100.f );
+	test_assert( GetGTweenCount() == 0 );
+
+	std::vector< types::vector2 > vectors( GTWEEN_BENCHMARK_COUNT );
+	GTweenBenchmarkRun( "vector2s", vectors, types::vector2( 100.f, 50.f ) );
+	test_assert( GetGTweenCount() == 0 );
+
+	// ints go through IInterpolator
+	std::vector< int > ints( GTWEEN_BENCHMARK_COUNT, 0 );
+	GTweenBenchmarkRun( "ints", ints, 100 );
+	test_assert( GetGTweenCount() == 0 );
+
+	return 0;
+}
+
+TEST_REGISTER( GTweenBenchmark );
+
+} // end of namespace test
+
+#endif
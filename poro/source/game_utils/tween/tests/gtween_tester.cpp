@@ -63,6 +63,30 @@ struct GTweenListenerTest : public GTweenListener
 	int on_start;
 };
 
+// reads the value in OnComplete and deletes the other tween
+struct GTweenListenerReader : public GTweenListener
+{
+	GTweenListenerReader( float* value ) : 
+		value( value ),
+		value_on_complete( -1 ),
+		delete_me( NULL )
+	{
+	}
+
+	virtual void GTween_OnStep( GTween* tweener ) { }
+	virtual void GTween_OnStart( GTween* tweener ) { }
+	virtual void GTween_OnComplete( GTween* tweener ) 
+	{ 
+		value_on_complete = *value; 
+		delete delete_me;
+		delete_me = NULL;
+	}
+
+	float* value;
+	float value_on_complete;
+	GTween* delete_me;
+};
+
 struct FunctionTesting
 {
 
@@ -148,9 +172,9 @@ int GTween_Test()
 		tween->SetDuration( 1.f );
 		tween->SetAutoKill( true );
 
-		test_assert( ceng::CAutoList< GTween >::GetList().size() == 1 );
+		test_assert( GetGTweenCount() == 1 );
 		UpdateGTweens( 2.f );
-		test_assert( ceng::CAutoList< GTween >::GetList().size() == 0 );
+		test_assert( GetGTweenCount() == 0 );
 	}
 
 	// compare pointers
@@ -249,6 +273,141 @@ int GTween_Test()
 		test_assert( listener.on_start == 1 );
 
 	}
+	// floats and vector2s, with different easing functions
+	{
+		float a = 0;
+		float b = 10.f;
+		types::vector2 v( 0, 100.f );
+		std::auto_ptr< GTween > tween_a( new GTween( 1.f, false ) );
+		std::auto_ptr< GTween > tween_b( new GTween( 1.f, false ) );
+		tween_a->AddVariable( a, 1.f, "a" );
+		tween_a->AddVariable( v, types::vector2( 10.f, 0 ), "v" );
+		tween_b->AddVariable( b, 20.f, "b" );
+		tween_b->SetFunction( ceng::easing::Quad::easeIn );
+
+		UpdateGTweens( 0.5f );
+		test_assert( a == 0.5f );
+		test_assert( v.x == 5.f );
+		test_assert( v.y == 50.f );
+		test_assert( b == 10.f + 10.f * ceng::easing::Quad::easeIn.f( 0.5f ) );
+
+		// a new one with the same name replaces the old one
+		tween_a->AddVariable( a, 2.f, "a" );
+		test_assert( tween_a->ClearPointer( &v ) == true );
+		test_assert( tween_a->HasPointer( &v ) == false );
+
+		UpdateGTweens( 0.25f );
+		test_assert( v.x == 5.f );
+		test_assert( v.y == 50.f );
+		test_assert( a > 0.5f && a < 2.f );
+
+		UpdateGTweens( 1.f );
+		test_assert( a == 2.f );
+		test_assert( b == 20.f );
+		test_assert( tween_a->GetIsCompleted() );
+	}
+
+	// OnComplete sees the final values, the listener can delete other tweens
+	{
+		float value = 0;
+		float other_value = 0;
+		GTweenListenerReader listener( &value );
+		GTween* tween = new GTween( 1.f, true );
+		tween->AddVariable( value, 4.f, "value" );
+		tween->AddListener( &listener );
+
+		listener.delete_me = new GTween( 1.f, true );
+		listener.delete_me->AddVariable( other_value, 4.f, "value" );
+		test_assert( GetGTweenCount() == 2 );
+
+		UpdateGTweens( 0.5f );
+		test_assert( value == 2.f );
+		test_assert( other_value == 2.f );
+
+		UpdateGTweens( 1.f );
+		test_assert( listener.value_on_complete == 4.f );
+		test_assert( GetGTweenCount() == 0 );
+	}
+
+	// lots of tweens being created and killed, the values go where they should
+	{
+		std::vector< float > values( 1000, 0.f );
+		for( int round = 0; round < 3; ++round )
+		{
+			for( std::size_t i = 0; i < values.size(); ++i )
+			{
+				GTween* tween = new GTween( 1.f + (float)( i % 3 ), true );
+				tween->AddVariable( values[ i ], (float)( round + 1 ), "value" );
+				if( i % 2 ) tween->SetFunction( ceng::easing::Cubic::easeOut );
+			}
+
+			for( int frame = 0; frame < 5; ++frame )
+				UpdateGTweens( 1.f );
+
+			test_assert( GetGTweenCount() == 0 );
+			for( std::size_t i = 0; i < values.size(); ++i )
+				test_assert( values[ i ] == (float)( round + 1 ) );
+		}
+	}
+
+	// two tweens on the same variable, the newer one wins even after a tween
+	// before them has been removed
+	{
+		float other = 0;
+		float x = 50.f;
+		int i = 50;
+		GTween* short_tween = new GTween( 0.1f, true );
+		short_tween->AddVariable( other, 1.f, "other" );
+
+		std::auto_ptr< GTween > tween_a( new GTween( 10.f, false ) );
+		tween_a->AddVariable( x, 100.f, "x" );
+		tween_a->AddVariable( i, 100, "i" );
+		std::auto_ptr< GTween > tween_b( new GTween( 10.f, false ) );
+		tween_b->AddVariable( x, 0.f, "x" );
+		tween_b->AddVariable( i, 0, "i" );
+
+		float last_x = x;
+		int last_i = i;
+		for( int frame = 0; frame < 40; ++frame )
+		{
+			UpdateGTweens( 0.25f );
+			test_assert( x < last_x );
+			test_assert( i <= last_i );
+			last_x = x;
+			last_i = i;
+
+			// moving the old tween back to its target doesn't let it win
+			if( frame == 10 )
+			{
+				tween_a->AddVariable( x, 100.f, "x" );
+				tween_a->AddVariable( i, 100, "i" );
+			}
+		}
+
+		test_assert( GetGTweenCount() == 2 );
+		test_assert( tween_b->GetIsCompleted() );
+		test_assert( x == 0.f );
+		test_assert( i == 0 );
+	}
+
+	// the new tweens start from the values of the previous update, not from
+	// what the older tweens set on the same frame
+	{
+		float x = 0;
+		std::auto_ptr< GTween > tween_a( new GTween( 1.f, false ) );
+		tween_a->AddVariable( x, 100.f, "x" );
+		std::auto_ptr< GTween > tween_b( new GTween( 1.f, false ) );
+		tween_b->AddVariable( x, 10.f, "x" );
+
+		UpdateGTweens( 0.25f );
+		test_assert( x == 2.5f );
+
+		// b is reset to start from 2.5
+		tween_b->SetDuration( 2.f );
+		UpdateGTweens( 1.f );
+		test_assert( x == 2.5f + 0.5f * 7.5f );
+	}
+
 	return 0;
 }
 
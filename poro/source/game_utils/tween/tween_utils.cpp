@@ -31,14 +31,12 @@ void GTweenClearSpriteOfTweens( as::Sprite* sprite ) {
 
 void GTweenClearPointerOfTweens( void* pointer )
 {
-	std::list< GTween* >& list_of_gtweens = ceng::CAutoList< GTween >::GetList();
+	const std::vector< GTween* >& list_of_gtweens = GetGTweens();
 
-
-	for( std::list< GTween* >::iterator i = list_of_gtweens.begin();
-		i != list_of_gtweens.end(); ++i )
+	for( std::size_t i = 0; i < list_of_gtweens.size(); ++i )
 	{
-		GTween* tween = *i;
-		cassert( tween );
+		GTween* tween = list_of_gtweens[ i ];
+		if( tween == NULL ) continue;
 		bool value = tween->ClearPointer( pointer );
 		if( value ) 
 		{
@@ -55,13 +53,12 @@ bool GTweenIsSpriteInUse( as::Sprite* sprite ) {
 
 bool GTweenIsPointerInUse( void* pointer )
 {
-	std::list< GTween* >& list_of_gtweens = ceng::CAutoList< GTween >::GetList();
+	const std::vector< GTween* >& list_of_gtweens = GetGTweens();
 
-	for( std::list< GTween* >::iterator i = list_of_gtweens.begin();
-		i != list_of_gtweens.end(); ++i )
+	for( std::size_t i = 0; i < list_of_gtweens.size(); ++i )
 	{
-		GTween* tween = *i;
-		cassert( tween );
+		GTween* tween = list_of_gtweens[ i ];
+		if( tween == NULL ) continue;
 		bool value = tween->HasPointer( pointer );
 		if( value ) 
 			return true;
@@ -75,13 +72,12 @@ bool GTweenIsPointerInUse( void* pointer )
 int GTweenReverseTweens( void* pointer )
 {
 	int result = 0;
-	std::list< GTween* >& list_of_gtweens = ceng::CAutoList< GTween >::GetList();
+	const std::vector< GTween* >& list_of_gtweens = GetGTweens();
 
-	for( std::list< GTween* >::iterator i = list_of_gtweens.begin();
-		i != list_of_gtweens.end(); ++i )
+	for( std::size_t i = 0; i < list_of_gtweens.size(); ++i )
 	{
-		GTween* tween = *i;
-		cassert( tween );
+		GTween* tween = list_of_gtweens[ i ];
+		if( tween == NULL ) continue;
 		bool value = tween->HasPointer( pointer );
 		if( value ) 
 		{
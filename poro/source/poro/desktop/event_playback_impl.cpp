@@ -1,6 +1,6 @@
 #include "event_playback_impl.h"
 
-#include <fstream>
+#include <cstdio>
 #include <sstream>
 
 #include "../poro_macros.h"
@@ -78,37 +78,23 @@ std::string RemoveWhiteSpace( std::string line )
 }
 //-----------------------------------------------------------------------------
 
-bool CheckIfTheBeginningIsSame( const std::string& beginning, const std::string& line )
-{
-	if( line.size() > beginning.size() )
-	{
-		if( line.substr( 0, beginning.size() ) == beginning )
-			return true;
-	}
-	else if( line == beginning )
-	{
-		return true;
-	}
-	else
-	{
-		return false;
-	}
-
-	return false;
-}
-//-----------------------------------------------------------------------------
-
 template< class T >
 T ParseSafely( const std::vector< std::string >& pieces, int i ) 
 {
 	if( i < 0 || i >= (int)pieces.size() ) 
 	{
-		poro_logger << "Error: EventPlaybackImpl::DoAnEventFromString() trying to parse index: " << i << " for an event that doesn't exist in the array" << std::endl;
+		poro_logger << "Error: EventPlaybackImpl::ParseEventFromString() trying to parse index: " << i << " for an event that doesn't exist in the array" << std::endl;
 		return T();
 	}
 
 	return CastFromString< T >( pieces[ i ] );
 }
+//-----------------------------------------------------------------------------
+
+types::vec2 ParsePosition( const std::vector< std::string >& pieces )
+{
+	return types::vec2( ParseSafely< float >( pieces, 1 ), ParseSafely< float >( pieces, 2 ) );
+}
 
 } // end of anonymous namespace
 //=============================================================================	
@@ -118,7 +104,8 @@ EventPlaybackImpl::EventPlaybackImpl() :
 	mEventsEnabled( false ),
 	mFrameCount( 0 ),
 	mPlaybacks(),
-	mPlaybacksPos( 0 )
+	mPlaybacksPos( 0 ),
+	mFrameLengths()
 { 
 }
 
@@ -127,7 +114,8 @@ EventPlaybackImpl::EventPlaybackImpl( Keyboard* keyboard, Mouse* mouse, Touch* t
 	mEventsEnabled( false ),
 	mFrameCount( 0 ),
 	mPlaybacks(),
-	mPlaybacksPos( 0 )
+	mPlaybacksPos( 0 ),
+	mFrameLengths()
 { 
 }
 //=============================================================================	
@@ -194,121 +182,211 @@ void EventPlaybackImpl::FireTouchUpEvent(const types::vec2& pos, int touchId) {
 
 void EventPlaybackImpl::LoadPlaybacksFromFile( const std::string& filename )
 {
-	std::fstream file_input;
-	std::string line;
-
 	poro_assert( mPlaybacks.empty() );
 
-	int random_seed = 0;
-	int line_num = 0;
-	if( filename.empty() == false )
+	std::vector< unsigned char > data;
+	FILE* file = filename.empty() ? NULL : fopen( filename.c_str(), "rb" );
+	if( file == NULL )
 	{
-		file_input.open( filename.c_str(), std::ios::in );
-        
-		while ( file_input.good() ) 
+		poro_logger << "Error: couldn't read playback file: " << filename << std::endl;
+		return;
+	}
+
+	fseek( file, 0, SEEK_END );
+	const long size = ftell( file );
+	fseek( file, 0, SEEK_SET );
+	if( size > 0 )
+	{
+		data.resize( size );
+		if( fread( &data[ 0 ], 1, size, file ) != (size_t)size )
 		{
-			std::getline( file_input, line );
+			poro_logger << "Error: couldn't read playback file: " << filename << std::endl;
+			data.clear();
+		}
+	}
+	fclose( file );
+
+	if( data.empty() == false && EventRecordDecoder::IsBinary( &data[ 0 ], (int)data.size() ) )
+		LoadBinaryPlaybacks( data );
+	else if( data.empty() == false )
+		LoadTextPlaybacks( std::string( data.begin(), data.end() ) );
+
+	if( mRandomSeed != 0 )
+		std::cout << "randomseed: " << mRandomSeed << std::endl;
+}
+
+void EventPlaybackImpl::LoadBinaryPlaybacks( const std::vector< unsigned char >& data )
+{
+	EventRecordDecoder decoder( &data[ 0 ], (int)data.size() );
+	if( decoder.ReadHeader() == false )
+	{
+		poro_logger << "Error: EventPlaybackImpl - unknown version of the playback file" << std::endl;
+		return;
+	}
+
+	int frame_lasted = 0;
+	std::vector< RecordedEvent > events;
+	while( decoder.ReadFrame( frame_lasted, events ) )
+	{
+		const int frame = (int)mFrameLengths.size();
+		mFrameLengths.push_back( frame_lasted );
+
+		for( std::size_t i = 0; i < events.size(); ++i )
+			AddPlayback( frame, events[ i ] );
+	}
+
+	// the last frame might have been cut when the recording crashed
+	if( decoder.IsBroken() )
+		poro_logger << "Warning: EventPlaybackImpl - the playback file is broken after frame: " << mFrameLengths.size() << std::endl;
+}
+
+void EventPlaybackImpl::LoadTextPlaybacks( const std::string& data )
+{
+	std::stringstream file_input( data );
+	std::string line;
+	RecordedEvent event;
+
+	int line_num = 0;
+	while ( file_input.good() ) 
+	{
+		std::getline( file_input, line );
 
-			// comment sections
-			if( line.empty() == false && line[ 0 ] == '#' ) continue;
+		// comment sections
+		if( line.empty() == false && line[ 0 ] == '#' ) continue;
 
-			// ParseLine( line );    
+		// ParseLine( line );    
+		{
+			std::vector< std::string > linenum_and_rest = Split( ":", line );
+			if( linenum_and_rest.size() > 1 ) 
 			{
-				std::vector< std::string > linenum_and_rest = Split( ":", line );
-				if( linenum_and_rest.size() > 1 ) 
+				int frame = line_num++;
+				int frame_lasted = 0;
+
+				// remove the timestamp of how long using this took
+				if( linenum_and_rest[ 0 ].empty() == false && linenum_and_rest[ 0 ].find( "," ) != linenum_and_rest[ 0 ].npos )
 				{
-					int frame = line_num++;
-					int frame_lasted = 0;
-
-					// remove the timestamp of how long using this took
-					if( linenum_and_rest[ 0 ].empty() == false && linenum_and_rest[ 0 ].find( "," ) != linenum_and_rest[ 0 ].npos )
-					{
-						std::vector< std::string > tmp = Split( ",", linenum_and_rest[ 0 ] );
-						linenum_and_rest[ 0 ] = tmp[ 0 ];
-						if( tmp.size() > 1 ) tmp = Split( " ", tmp[ 1 ] );
-						if( tmp.size() > 0 ) frame_lasted = CastFromString< int >( tmp[ 0 ] );
-					}
-
-					frame = CastFromString< int >( linenum_and_rest[ 0 ] );
-					
-					std::vector< std::string > list_of_events = Split( ",", linenum_and_rest[ 1 ] );
-
-					for( std::size_t i = 0; i < list_of_events.size(); ++i ) 
-					{
-						PlaybackEvent* pevent = new PlaybackEvent;
-						pevent->frame = frame;
-						pevent->frame_lasted = frame_lasted;
-						std::string str = RemoveWhiteSpace( list_of_events[ i ] );
-						pevent->str = str;
-						
-						mPlaybacks.push_back( pevent );
-
-						// check if this is the first random seed?
-						if( random_seed == 0 ) 
-						{
-							if( CheckIfTheBeginningIsSame( "randomseed", str ) ) 
-							{
-								std::vector< std::string > pieces = Split( " ", str );
-								random_seed = ParseSafely< int >( pieces, 1 );
-								std::cout << "randomseed: " << random_seed << std::endl;
-							}
-						}
-					}
+					std::vector< std::string > tmp = Split( ",", linenum_and_rest[ 0 ] );
+					linenum_and_rest[ 0 ] = tmp[ 0 ];
+					if( tmp.size() > 1 ) tmp = Split( " ", tmp[ 1 ] );
+					if( tmp.size() > 0 ) frame_lasted = CastFromString< int >( tmp[ 0 ] );
+				}
+
+				frame = CastFromString< int >( linenum_and_rest[ 0 ] );
+				SetFrameLength( frame, frame_lasted );
+				
+				std::vector< std::string > list_of_events = Split( ",", linenum_and_rest[ 1 ] );
+
+				for( std::size_t i = 0; i < list_of_events.size(); ++i ) 
+				{
+					if( ParseEventFromString( RemoveWhiteSpace( list_of_events[ i ] ), event ) )
+						AddPlayback( frame, event );
 				}
 			}
 		}
-		file_input.close();
-	}
-	else
-	{
-		poro_logger << "Error: couldn't read playback file: " << filename << std::endl;
 	}
+}
 
-	if( random_seed != 0 ) 
+void EventPlaybackImpl::AddPlayback( int frame, const RecordedEvent& event )
+{
+	// the first random seed is the one the game was started with
+	if( event.type == RecordedEvent::RANDOM_SEED )
 	{
-		mRandomSeed = random_seed;
+		if( mRandomSeed == 0 ) 
+			mRandomSeed = event.button;
+		return;
 	}
+
+	mPlaybacks.push_back( PlaybackEvent( frame, event ) );
+}
+
+void EventPlaybackImpl::SetFrameLength( int frame, int frame_lasted )
+{
+	if( frame < 0 ) return;
+
+	if( frame >= (int)mFrameLengths.size() )
+		mFrameLengths.resize( frame + 1, 0 );
+
+	mFrameLengths[ frame ] = frame_lasted;
 }
 
 //=============================================================================
 
-void EventPlaybackImpl::DoAnEventFromString( const std::string& event_string )
+bool EventPlaybackImpl::ParseEventFromString( const std::string& event_string, RecordedEvent& event )
 {
-	if( event_string.empty() ) return;
+	if( event_string.empty() ) return false;
 
 	std::vector< std::string > pieces = Split( " ", event_string );
 	std::string type = pieces[ 0 ];
-	
 
 	// switch( type ) 
 	if( type == "mm" ) {
-		FireMouseMoveEvent( types::Vec2( ParseSafely< float >( pieces, 1 ), ParseSafely< float >( pieces, 2 ) ) );
+		event = RecordedEvent( RecordedEvent::MOUSE_MOVE, ParsePosition( pieces ), 0 );
 	} 
 	else if( type == "md" ) {
-		FireMouseDownEvent( types::Vec2( ParseSafely< float >( pieces, 1 ), ParseSafely< float >( pieces, 2 ) ), ParseSafely< int >( pieces, 3 ) );
+		event = RecordedEvent( RecordedEvent::MOUSE_DOWN, ParsePosition( pieces ), ParseSafely< int >( pieces, 3 ) );
 	}
 	else if( type == "mu" ) {
-		FireMouseUpEvent( types::Vec2( ParseSafely< float >( pieces, 1 ), ParseSafely< float >( pieces, 2 ) ), ParseSafely< int >( pieces, 3 ) );
+		event = RecordedEvent( RecordedEvent::MOUSE_UP, ParsePosition( pieces ), ParseSafely< int >( pieces, 3 ) );
 	}
 	else if( type == "kd" ) {
-		FireKeyDownEvent( ParseSafely< int >( pieces, 1 ), ParseSafely< poro::types::charset >( pieces, 2 ) );
+		event = RecordedEvent( RecordedEvent::KEY_DOWN, types::vec2(), ParseSafely< int >( pieces, 1 ), ParseSafely< poro::types::charset >( pieces, 2 ) );
 	}
 	else if( type == "ku" ) {
-		FireKeyUpEvent( ParseSafely< int >( pieces, 1 ), ParseSafely< poro::types::charset >( pieces, 2 ) );
+		event = RecordedEvent( RecordedEvent::KEY_UP, types::vec2(), ParseSafely< int >( pieces, 1 ), ParseSafely< poro::types::charset >( pieces, 2 ) );
 	}
 	else if( type == "tm" ) {
-		FireTouchMoveEvent( types::Vec2( ParseSafely< float >( pieces, 1 ), ParseSafely< float >( pieces, 2 ) ), ParseSafely< int >( pieces, 3 )  );
+		event = RecordedEvent( RecordedEvent::TOUCH_MOVE, ParsePosition( pieces ), ParseSafely< int >( pieces, 3 ) );
 	}
 	else if( type == "td" ) {
-		FireTouchDownEvent( types::Vec2( ParseSafely< float >( pieces, 1 ), ParseSafely< float >( pieces, 2 ) ), ParseSafely< int >( pieces, 3 )  );
+		event = RecordedEvent( RecordedEvent::TOUCH_DOWN, ParsePosition( pieces ), ParseSafely< int >( pieces, 3 ) );
 	}
 	else if( type == "tu" ) {
-		FireTouchUpEvent(  types::Vec2( ParseSafely< float >( pieces, 1 ), ParseSafely< float >( pieces, 2 ) ), ParseSafely< int >( pieces, 3 )  );
+		event = RecordedEvent( RecordedEvent::TOUCH_UP, ParsePosition( pieces ), ParseSafely< int >( pieces, 3 ) );
+	}
+	else if( type == "randomseed" ) {
+		event = RecordedEvent( RecordedEvent::RANDOM_SEED, types::vec2(), ParseSafely< int >( pieces, 1 ) );
 	}
 	else {
-		poro_logger << "Error: EventPlaybackImpl::DoAnEventFromString() - unknown event type: " << type << std::endl;
+		poro_logger << "Error: EventPlaybackImpl::ParseEventFromString() - unknown event type: " << type << std::endl;
+		return false;
 	}
 
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void EventPlaybackImpl::DoAnEvent( const RecordedEvent& event )
+{
+	switch( event.type ) 
+	{
+	case RecordedEvent::MOUSE_MOVE:
+		FireMouseMoveEvent( event.pos );
+		break;
+	case RecordedEvent::MOUSE_DOWN:
+		FireMouseDownEvent( event.pos, event.button );
+		break;
+	case RecordedEvent::MOUSE_UP:
+		FireMouseUpEvent( event.pos, event.button );
+		break;
+	case RecordedEvent::KEY_DOWN:
+		FireKeyDownEvent( event.button, event.unicode );
+		break;
+	case RecordedEvent::KEY_UP:
+		FireKeyUpEvent( event.button, event.unicode );
+		break;
+	case RecordedEvent::TOUCH_MOVE:
+		FireTouchMoveEvent( event.pos, event.button );
+		break;
+	case RecordedEvent::TOUCH_DOWN:
+		FireTouchDownEvent( event.pos, event.button );
+		break;
+	case RecordedEvent::TOUCH_UP:
+		FireTouchUpEvent( event.pos, event.button );
+		break;
+	default:
+		break;
+	}
 }
 
 //=============================================================================
@@ -316,7 +394,7 @@ void EventPlaybackImpl::DoAnEventFromString( const std::string& event_string )
 EventPlaybackImpl::PlaybackEvent* EventPlaybackImpl::TopEvent()
 {
 	if( mPlaybacksPos >= 0 && mPlaybacksPos < (int)mPlaybacks.size() )
-		return mPlaybacks[ mPlaybacksPos ];
+		return &mPlaybacks[ mPlaybacksPos ];
 
 	return NULL;
 }
@@ -331,15 +409,13 @@ void EventPlaybackImpl::DoPlaybacksForFrame()
 {
 	SetEventsEnabled( true );
 	
-	// parse from strings? or not?
 	PlaybackEvent* current_event = TopEvent();
 	while( current_event && current_event->frame == mFrameCount ) 
 	{
 		poro_assert( current_event );
 		poro_assert( current_event->frame == mFrameCount );
 
-		if( current_event->str.empty() == false )
-			DoAnEventFromString( current_event->str );
+		DoAnEvent( current_event->event );
 		
 		current_event = NextEvent();
 	}
@@ -349,14 +425,20 @@ void EventPlaybackImpl::DoPlaybacksForFrame()
 }
 //=============================================================================
 
+// the length of the frame that is being played back
 int EventPlaybackImpl::GetFrameLength() const
 {
-	if( mFrameCount > 1 && mFrameCount < (int) mPlaybacks.size() ) 
-		return mPlaybacks[ mFrameCount - 2]->frame_lasted;
+	if( mFrameCount > 0 && mFrameCount <= (int)mFrameLengths.size() ) 
+		return mFrameLengths[ mFrameCount - 1 ];
 
 	return 0;
 }
 
+bool EventPlaybackImpl::IsPlaybackFinished() const
+{
+	return mFrameCount >= (int)mFrameLengths.size() && mPlaybacksPos >= (int)mPlaybacks.size();
+}
+
 //=============================================================================
 
 void EventPlaybackImpl::LoadFromFile( const std::string& filename )
@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "../event_recorder.h"
+#include "event_record_format.h"
 
 namespace poro {
 
@@ -62,24 +63,32 @@ public:
 	//-------------------------------------------------------------------------
 
 	virtual int GetFrameLength() const;
+	virtual bool IsPlaybackFinished() const;
 
 protected:
 
 	//-------------------------------------------------------------------------
 
-	void DoAnEventFromString( const std::string& event_string );
+	void DoAnEvent( const RecordedEvent& event );
+	bool ParseEventFromString( const std::string& event_string, RecordedEvent& event );
+
 	void LoadPlaybacksFromFile( const std::string& filename );
+	void LoadBinaryPlaybacks( const std::vector< unsigned char >& data );
+	// the old text format
+	void LoadTextPlaybacks( const std::string& data );
+
+	void AddPlayback( int frame, const RecordedEvent& event );
+	void SetFrameLength( int frame, int frame_lasted );
 
 	//-------------------------------------------------------------------------
 
 	struct PlaybackEvent
 	{
-		PlaybackEvent() : frame( 0 ),  frame_lasted( 0 ), str() { }
-		PlaybackEvent( int frame, int frame_lasted, const std::string& str ) : frame( frame ), frame_lasted( 0 ), str( str ) { }
+		PlaybackEvent() : frame( 0 ), event() { }
+		PlaybackEvent( int frame, const RecordedEvent& event ) : frame( frame ), event( event ) { }
 
 		int frame;
-		int frame_lasted;
-		std::string str;
+		RecordedEvent event;
 	};
 
 	//-------------------------------------------------------------------------
@@ -90,9 +99,12 @@ protected:
 	PlaybackEvent* TopEvent();
 	PlaybackEvent* NextEvent();
 
-	std::vector< PlaybackEvent* > mPlaybacks;
+	std::vector< PlaybackEvent > mPlaybacks;
 	int mPlaybacksPos;
 
+	// how many ms each of the recorded frames took
+	std::vector< int > mFrameLengths;
+
 };
 
 //-----------------------------------------------------------------------------
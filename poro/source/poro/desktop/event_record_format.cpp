@@ -0,0 +1,267 @@
+#include "event_record_format.h"
+
+#include <cstring>
+
+namespace poro {
+
+namespace {
+
+const unsigned char EVENT_RECORD_MAGIC[] = { 'P', 'R', 'B', '1' };
+const types::Uint32 EVENT_RECORD_VERSION = 1;
+
+// positions are stored in 1/256 pixels when that's exact
+const types::Float32 EVENT_RECORD_POSITION_SCALE = 256.f;
+const types::Float32 EVENT_RECORD_POSITION_MAX = 1 << 22;
+
+void EventRecordWriteVarint( std::vector< unsigned char >& output, types::Uint32 value )
+{
+	while( value >= 0x80 )
+	{
+		output.push_back( (unsigned char)( value | 0x80 ) );
+		value >>= 7;
+	}
+	output.push_back( (unsigned char)value );
+}
+
+void EventRecordWriteSigned( std::vector< unsigned char >& output, int value )
+{
+	// zigzag, so that small negative numbers stay small
+	EventRecordWriteVarint( output, ( (types::Uint32)value << 1 ) ^ (types::Uint32)( value >> 31 ) );
+}
+
+void EventRecordWriteFloat( std::vector< unsigned char >& output, types::Float32 value )
+{
+	types::Uint32 bits = 0;
+	memcpy( &bits, &value, sizeof( bits ) );
+	for( int i = 0; i < 4; ++i )
+		output.push_back( (unsigned char)( bits >> ( i * 8 ) ) );
+}
+
+// true if the value is exactly representable in the fixed point format
+bool EventRecordToFixed( types::Float32 value, int& result )
+{
+	const types::Float32 scaled = value * EVENT_RECORD_POSITION_SCALE;
+	if( scaled < -EVENT_RECORD_POSITION_MAX || scaled > EVENT_RECORD_POSITION_MAX )
+		return false;
+
+	result = (int)scaled;
+	return (types::Float32)result / EVENT_RECORD_POSITION_SCALE == value;
+}
+
+bool EventRecordHasPosition( int type )
+{
+	return type >= RecordedEvent::MOUSE_MOVE && type <= RecordedEvent::TOUCH_UP;
+}
+
+bool EventRecordHasButton( int type )
+{
+	return type != RecordedEvent::MOUSE_MOVE;
+}
+
+} // end of anonymous namespace
+
+//=============================================================================
+
+EventRecordEncoder::EventRecordEncoder() :
+	mEvents(),
+	mEventCount( 0 ),
+	mLastPos()
+{
+}
+
+void EventRecordEncoder::WriteHeader( std::vector< unsigned char >& output )
+{
+	output.insert( output.end(), EVENT_RECORD_MAGIC, EVENT_RECORD_MAGIC + sizeof( EVENT_RECORD_MAGIC ) );
+	EventRecordWriteVarint( output, EVENT_RECORD_VERSION );
+}
+
+void EventRecordEncoder::AddEvent( const RecordedEvent& event )
+{
+	mEventCount++;
+
+	if( EventRecordHasPosition( event.type ) == false )
+	{
+		mEvents.push_back( (unsigned char)event.type );
+		EventRecordWriteSigned( mEvents, event.button );
+		if( event.type != RecordedEvent::RANDOM_SEED )
+			EventRecordWriteVarint( mEvents, event.unicode );
+		return;
+	}
+
+	int x = 0, y = 0, last_x = 0, last_y = 0;
+	if( EventRecordToFixed( event.pos.x, x ) && EventRecordToFixed( event.pos.y, y ) &&
+		EventRecordToFixed( mLastPos.x, last_x ) && EventRecordToFixed( mLastPos.y, last_y ) )
+	{
+		mEvents.push_back( (unsigned char)event.type );
+		EventRecordWriteSigned( mEvents, x - last_x );
+		EventRecordWriteSigned( mEvents, y - last_y );
+	}
+	else
+	{
+		mEvents.push_back( (unsigned char)( event.type | RecordedEvent::RAW_POSITION ) );
+		EventRecordWriteFloat( mEvents, event.pos.x );
+		EventRecordWriteFloat( mEvents, event.pos.y );
+	}
+	mLastPos = event.pos;
+
+	if( EventRecordHasButton( event.type ) )
+		EventRecordWriteSigned( mEvents, event.button );
+}
+
+void EventRecordEncoder::EndFrame( int frame_ms, std::vector< unsigned char >& output )
+{
+	EventRecordWriteVarint( output, (types::Uint32)( frame_ms < 0 ? 0 : frame_ms ) );
+	EventRecordWriteVarint( output, (types::Uint32)mEventCount );
+	output.insert( output.end(), mEvents.begin(), mEvents.end() );
+
+	mEvents.clear();
+	mEventCount = 0;
+}
+
+//=============================================================================
+
+bool EventRecordDecoder::IsBinary( const unsigned char* data, int size )
+{
+	return data && size >= (int)sizeof( EVENT_RECORD_MAGIC ) &&
+		memcmp( data, EVENT_RECORD_MAGIC, sizeof( EVENT_RECORD_MAGIC ) ) == 0;
+}
+
+EventRecordDecoder::EventRecordDecoder( const unsigned char* data, int size ) :
+	mPos( data ),
+	mEnd( data + size ),
+	mBroken( false ),
+	mLastPos()
+{
+}
+
+bool EventRecordDecoder::ReadHeader()
+{
+	types::Uint32 version = 0;
+	if( IsBinary( mPos, (int)( mEnd - mPos ) ) == false )
+	{
+		mBroken = true;
+		return false;
+	}
+
+	mPos += sizeof( EVENT_RECORD_MAGIC );
+	if( ReadVarint( version ) == false || version != EVENT_RECORD_VERSION )
+	{
+		mBroken = true;
+		return false;
+	}
+
+	return true;
+}
+
+bool EventRecordDecoder::ReadFrame( int& frame_ms, std::vector< RecordedEvent >& events )
+{
+	events.clear();
+	if( mBroken || mPos >= mEnd )
+		return false;
+
+	types::Uint32 ms = 0, count = 0;
+	if( ReadVarint( ms ) == false || ReadVarint( count ) == false || count > (types::Uint32)( mEnd - mPos ) )
+	{
+		mBroken = true;
+		return false;
+	}
+	frame_ms = (int)ms;
+
+	for( types::Uint32 i = 0; i < count; ++i )
+	{
+		if( mPos >= mEnd )
+		{
+			mBroken = true;
+			return false;
+		}
+
+		const int type_byte = *mPos++;
+		RecordedEvent event;
+		event.type = type_byte & ~RecordedEvent::RAW_POSITION;
+		if( event.type < RecordedEvent::KEY_DOWN || event.type > RecordedEvent::RANDOM_SEED )
+		{
+			mBroken = true;
+			return false;
+		}
+
+		bool ok = true;
+		if( EventRecordHasPosition( event.type ) == false )
+		{
+			types::Uint32 unicode = 0;
+			ok = ReadSigned( event.button );
+			if( ok && event.type != RecordedEvent::RANDOM_SEED )
+				ok = ReadVarint( unicode );
+			event.unicode = (types::charset)unicode;
+		}
+		else
+		{
+			if( type_byte & RecordedEvent::RAW_POSITION )
+			{
+				ok = ReadFloat( event.pos.x ) && ReadFloat( event.pos.y );
+			}
+			else
+			{
+				int dx = 0, dy = 0, last_x = 0, last_y = 0;
+				ok = ReadSigned( dx ) && ReadSigned( dy ) &&
+					EventRecordToFixed( mLastPos.x, last_x ) && EventRecordToFixed( mLastPos.y, last_y );
+				event.pos.x = (types::Float32)( last_x + dx ) / EVENT_RECORD_POSITION_SCALE;
+				event.pos.y = (types::Float32)( last_y + dy ) / EVENT_RECORD_POSITION_SCALE;
+			}
+			mLastPos = event.pos;
+
+			if( ok && EventRecordHasButton( event.type ) )
+				ok = ReadSigned( event.button );
+		}
+
+		if( ok == false )
+		{
+			mBroken = true;
+			return false;
+		}
+
+		events.push_back( event );
+	}
+
+	return true;
+}
+
+bool EventRecordDecoder::ReadVarint( types::Uint32& value )
+{
+	value = 0;
+	for( int shift = 0; shift < 35; shift += 7 )
+	{
+		if( mPos >= mEnd )
+			return false;
+
+		const unsigned char byte = *mPos++;
+		value |= (types::Uint32)( byte & 0x7F ) << shift;
+		if( ( byte & 0x80 ) == 0 )
+			return true;
+	}
+
+	return false;
+}
+
+bool EventRecordDecoder::ReadSigned( int& value )
+{
+	types::Uint32 zigzag = 0;
+	if( ReadVarint( zigzag ) == false )
+		return false;
+
+	value = (int)( zigzag >> 1 ) ^ -(int)( zigzag & 1 );
+	return true;
+}
+
+bool EventRecordDecoder::ReadFloat( types::Float32& value )
+{
+	if( mEnd - mPos < 4 )
+		return false;
+
+	types::Uint32 bits = mPos[ 0 ] | ( mPos[ 1 ] << 8 ) | ( mPos[ 2 ] << 16 ) | ( (types::Uint32)mPos[ 3 ] << 24 );
+	memcpy( &value, &bits, sizeof( value ) );
+	mPos += 4;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+} // end of namespace poro
@@ -0,0 +1,114 @@
+#ifndef INC_EVENT_RECORD_FORMAT_H
+#define INC_EVENT_RECORD_FORMAT_H
+
+#include <string>
+#include <vector>
+
+#include "../poro_types.h"
+
+namespace poro {
+
+//-----------------------------------------------------------------------------
+// Binary playback file.
+//
+//	"PRB1" version
+//	frame frame frame ...
+//
+// Every frame is written, the frame number is the position in the file:
+//
+//	frame_ms event_count event event ...
+//
+// Each event starts with the type byte, followed by
+//
+//	key events		button unicode
+//	mouse / touch	dx dy button ( or touch id, nothing for mouse moves )
+//	random seed		seed
+//
+// The numbers are little-endian varints, the signed ones zigzagged. The
+// positions are deltas from the previous mouse or touch event in 1/256
+// pixels. If a position can't be stored exactly that way, the type byte has
+// RecordedEvent::RAW_POSITION set and the floats are written as they are, so
+// the playback always gets the exact same positions.
+//-----------------------------------------------------------------------------
+
+struct RecordedEvent
+{
+	enum Type
+	{
+		KEY_DOWN = 1,
+		KEY_UP,
+		MOUSE_MOVE,
+		MOUSE_DOWN,
+		MOUSE_UP,
+		TOUCH_MOVE,
+		TOUCH_DOWN,
+		TOUCH_UP,
+		RANDOM_SEED,
+
+		RAW_POSITION = 0x80
+	};
+
+	RecordedEvent() : type( 0 ), pos(), button( 0 ), unicode( 0 ) { }
+	RecordedEvent( int type, const types::vec2& pos, int button, types::charset unicode = 0 ) :
+		type( type ), pos( pos ), button( button ), unicode( unicode ) { }
+
+	int				type;
+	types::vec2		pos;
+	// button, touch id or the random seed
+	int				button;
+	types::charset	unicode;
+};
+
+//-----------------------------------------------------------------------------
+
+class EventRecordEncoder
+{
+public:
+	EventRecordEncoder();
+
+	// appends the magic and the version
+	void WriteHeader( std::vector< unsigned char >& output );
+
+	void AddEvent( const RecordedEvent& event );
+
+	// appends the frame with the events added since the last EndFrame()
+	void EndFrame( int frame_ms, std::vector< unsigned char >& output );
+
+private:
+	std::vector< unsigned char >	mEvents;
+	int								mEventCount;
+	types::vec2						mLastPos;
+};
+
+//-----------------------------------------------------------------------------
+
+class EventRecordDecoder
+{
+public:
+	static bool IsBinary( const unsigned char* data, int size );
+
+	EventRecordDecoder( const unsigned char* data, int size );
+
+	// false if the header is broken or of an unknown version
+	bool ReadHeader();
+
+	// returns false at the end of the data or if the data is broken
+	bool ReadFrame( int& frame_ms, std::vector< RecordedEvent >& events );
+
+	bool IsBroken() const { return mBroken; }
+
+private:
+	bool ReadVarint( types::Uint32& value );
+	bool ReadSigned( int& value );
+	bool ReadFloat( types::Float32& value );
+
+	const unsigned char*	mPos;
+	const unsigned char*	mEnd;
+	bool					mBroken;
+	types::vec2				mLastPos;
+};
+
+//-----------------------------------------------------------------------------
+} // end of namespace poro
+
+#endif
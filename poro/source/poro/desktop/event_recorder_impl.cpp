@@ -1,10 +1,13 @@
 #include "event_recorder_impl.h"
 
-#include <fstream>
+#include <cstdio>
 #include <sstream>
 #include <iomanip>
 #include <ctime>
 
+#include "../libraries.h"
+#include "../poro_macros.h"
+
 namespace poro {
 
 //=============================================================================	
@@ -24,12 +27,144 @@ std::string GetEventRecorderFilename()
 	return ss.str();
 }
 
+//============================ EventRecordWriter ==============================
+//
+// Keeps the playback file open and appends the encoded frames to it on a
+// worker thread, so recording doesn't reopen the file or wait for the disk
+// every frame. Every frame is flushed, so a crash loses at most the frames
+// the thread hasn't got to yet.
+//
+// If the thread can't be created, the frames are written on the main thread.
+//
+class EventRecordWriter {
+public:
+
+	EventRecordWriter( const std::string& filename ) :
+		mFile( NULL ),
+		mThread( NULL ),
+		mMutex( NULL ),
+		mDataAdded( NULL ),
+		mPending(),
+		mWriting(),
+		mQuit( false )
+	{
+		mFile = fopen( filename.c_str(), "wb" );
+		if( mFile == NULL ) 
+		{
+			poro_logger << "Error EventRecorderImpl - couldn't open the playback file: " << filename << std::endl;
+			return;
+		}
+
+		mMutex = SDL_CreateMutex();
+		mDataAdded = SDL_CreateCond();
+		mThread = SDL_CreateThread( EventRecordWriter::WriteThread, this );
+		if( mThread == NULL ) 
+			poro_logger << "Warning - EventRecordWriter couldn't create a thread, writing the playback on the main thread" << std::endl;
+	}
+
+	~EventRecordWriter()
+	{
+		if( mThread ) 
+		{
+			SDL_mutexP( mMutex );
+			mQuit = true;
+			SDL_CondSignal( mDataAdded );
+			SDL_mutexV( mMutex );
+
+			SDL_WaitThread( mThread, NULL );
+		}
+
+		if( mMutex ) SDL_DestroyMutex( mMutex );
+		if( mDataAdded ) SDL_DestroyCond( mDataAdded );
+		if( mFile ) fclose( mFile );
+	}
+
+	// takes the contents of data, data is left empty
+	void Write( std::vector< unsigned char >& data )
+	{
+		if( mFile == NULL || data.empty() ) 
+		{
+			data.clear();
+			return;
+		}
+
+		if( mThread == NULL ) 
+		{
+			WriteToFile( data );
+			data.clear();
+			return;
+		}
+
+		SDL_mutexP( mMutex );
+		if( mPending.empty() ) 
+			mPending.swap( data );
+		else 
+			mPending.insert( mPending.end(), data.begin(), data.end() );
+		SDL_CondSignal( mDataAdded );
+		SDL_mutexV( mMutex );
+
+		data.clear();
+	}
+
+private:
+
+	void WriteToFile( const std::vector< unsigned char >& data )
+	{
+		if( fwrite( &data[ 0 ], 1, data.size(), mFile ) != data.size() ) 
+			poro_logger << "Error EventRecorderImpl - couldn't write to the playback file" << std::endl;
+		fflush( mFile );
+	}
+
+	static int WriteThread( void* data )
+	{
+		EventRecordWriter* self = static_cast< EventRecordWriter* >( data );
+
+		SDL_mutexP( self->mMutex );
+		while( true )
+		{
+			if( self->mPending.empty() == false ) 
+			{
+				self->mWriting.swap( self->mPending );
+				SDL_mutexV( self->mMutex );
+
+				self->WriteToFile( self->mWriting );
+				self->mWriting.clear();
+
+				SDL_mutexP( self->mMutex );
+			}
+			else if( self->mQuit ) 
+			{
+				break;
+			}
+			else 
+			{
+				SDL_CondWait( self->mDataAdded, self->mMutex );
+			}
+		}
+		SDL_mutexV( self->mMutex );
+		return 0;
+	}
+
+	FILE*						mFile;
+
+	SDL_Thread*					mThread;
+	SDL_mutex*					mMutex;
+	SDL_cond*					mDataAdded;
+
+	std::vector< unsigned char > mPending;
+	std::vector< unsigned char > mWriting;
+	bool						mQuit;
+};
+
 //=============================================================================	
 
 EventRecorderImpl::EventRecorderImpl() : 
 	EventRecorder(), 
-	mFrameCount( 0 ), 
+	mEncoder(),
+	mFrameBuffer(),
+	mWriter( NULL ),
 	mFilename(),
+	mFrameCount( 0 ), 
 	mFrameStartTime( 0 )
 { 
 	mFilename = GetEventRecorderFilename();
@@ -37,13 +172,22 @@ EventRecorderImpl::EventRecorderImpl() :
 
 EventRecorderImpl::EventRecorderImpl( Keyboard* keyboard, Mouse* mouse, Touch* touch ) : 
 	EventRecorder( keyboard, mouse, touch ), 
-	mFrameCount( 0 ),
+	mEncoder(),
+	mFrameBuffer(),
+	mWriter( NULL ),
 	mFilename(),
+	mFrameCount( 0 ),
 	mFrameStartTime( 0 )
 { 
 	mFilename = GetEventRecorderFilename();
 }
 
+EventRecorderImpl::~EventRecorderImpl()
+{
+	delete mWriter;
+	mWriter = NULL;
+}
+
 //=============================================================================	
 
 int EventRecorderImpl::GetRandomSeed() 
@@ -51,84 +195,61 @@ int EventRecorderImpl::GetRandomSeed()
 	if( mRandomSeed == 0 ) 
 	{
 		mRandomSeed = (int)( time(NULL) * time(NULL) );
-
-		std::stringstream ss;
-		ss << "randomseed " << mRandomSeed;
-		mEventBuffer.push_back( ss.str() );
+		AddEvent( RecordedEvent( RecordedEvent::RANDOM_SEED, types::vec2(), mRandomSeed ) );
 	}
 
 	return mRandomSeed;
 }
 
+void EventRecorderImpl::AddEvent( const RecordedEvent& event )
+{
+	mEncoder.AddEvent( event );
+}
+
 //=============================================================================	
 // keyboard events
 void EventRecorderImpl::FireKeyDownEvent( int button, types::charset unicode ) {
 	EventRecorder::FireKeyDownEvent( button, unicode );
-
-	std::stringstream ss;
-	ss << "kd " << button << " " << unicode;
-	mEventBuffer.push_back( ss.str() );
-
+	AddEvent( RecordedEvent( RecordedEvent::KEY_DOWN, types::vec2(), button, unicode ) );
 }
 
 void EventRecorderImpl::FireKeyUpEvent( int button, types::charset unicode ) {
 	EventRecorder::FireKeyUpEvent( button, unicode );
-
-	std::stringstream ss;
-	ss << "ku " << button << " " << unicode;
-	mEventBuffer.push_back( ss.str() );
+	AddEvent( RecordedEvent( RecordedEvent::KEY_UP, types::vec2(), button, unicode ) );
 }
 
 //-----------------------------------------------------------------------------	
 // mouse events
 void EventRecorderImpl::FireMouseMoveEvent(const types::vec2& pos) {
 	EventRecorder::FireMouseMoveEvent( pos );
-
-	std::stringstream ss;
-	ss << "mm " << pos.x << " " << pos.y;
-	mEventBuffer.push_back( ss.str() );
+	AddEvent( RecordedEvent( RecordedEvent::MOUSE_MOVE, pos, 0 ) );
 }
 
 void EventRecorderImpl::FireMouseDownEvent(const types::vec2& pos, int button) {
 	EventRecorder::FireMouseDownEvent( pos, button );
-
-	std::stringstream ss;
-	ss << "md " << pos.x << " " << pos.y << " " << button;
-	mEventBuffer.push_back( ss.str() );
+	AddEvent( RecordedEvent( RecordedEvent::MOUSE_DOWN, pos, button ) );
 }
 
 void EventRecorderImpl::FireMouseUpEvent(const types::vec2& pos, int button) { 
 	EventRecorder::FireMouseUpEvent( pos, button );
-
-	std::stringstream ss;
-	ss << "mu " << pos.x << " " << pos.y << " " << button;
-	mEventBuffer.push_back( ss.str() );
+	AddEvent( RecordedEvent( RecordedEvent::MOUSE_UP, pos, button ) );
 }
 
 //-----------------------------------------------------------------------------
 // touch events
 void EventRecorderImpl::FireTouchMoveEvent(const types::vec2& pos, int touchId) {
 	EventRecorder::FireTouchMoveEvent( pos, touchId );
-
-	std::stringstream ss;
-	ss << "tm " << pos.x << " " << pos.y << " " << touchId;
-	mEventBuffer.push_back( ss.str() );
+	AddEvent( RecordedEvent( RecordedEvent::TOUCH_MOVE, pos, touchId ) );
 }
 
 void EventRecorderImpl::FireTouchDownEvent(const types::vec2& pos, int touchId) {
 	EventRecorder::FireTouchDownEvent( pos, touchId );
-
-	std::stringstream ss;
-	ss << "td " << pos.x << " " << pos.y << " " << touchId;
-	mEventBuffer.push_back( ss.str() );
+	AddEvent( RecordedEvent( RecordedEvent::TOUCH_DOWN, pos, touchId ) );
 }
 
 void EventRecorderImpl::FireTouchUpEvent(const types::vec2& pos, int touchId) {
 	EventRecorder::FireTouchUpEvent( pos, touchId );
-
-	std::stringstream ss;
-	ss << "tu " << pos.x << " " << pos.y << " " << touchId;
-	mEventBuffer.push_back( ss.str() );
+	AddEvent( RecordedEvent( RecordedEvent::TOUCH_UP, pos, touchId ) );
 }
 
 //=============================================================================
@@ -144,24 +265,17 @@ void EventRecorderImpl::StartOfFrame( float start_time ) {
 
 void EventRecorderImpl::EndOfFrame( float time ) {
 
-	std::ofstream		file_out;
+	// the file is opened on the first frame, so that SetFilename() still works
 	if( mFrameCount == 0 ) 
-		file_out.open( mFilename.c_str(), std::ios::out );
-	else 
-		file_out.open( mFilename.c_str(), std::ios::app );
-
-
-
-	file_out << mFrameCount << ", " << (int)(( time - mFrameStartTime ) * 1000.f) << " ms : ";
-	for( int i = 0; i < (int)mEventBuffer.size(); ++i ) {
-		file_out << mEventBuffer[ i ];
-		if( i < (int)mEventBuffer.size() - 1 ) 
-			file_out << ", ";
+	{
+		delete mWriter;
+		mWriter = new EventRecordWriter( mFilename );
+		mEncoder.WriteHeader( mFrameBuffer );
 	}
-	file_out << std::endl;
-	file_out.close();
 
-	mEventBuffer.clear();
+	mEncoder.EndFrame( (int)(( time - mFrameStartTime ) * 1000.f), mFrameBuffer );
+	mWriter->Write( mFrameBuffer );
+
 	mFrameCount++;
 }
 
@@ -5,16 +5,19 @@
 #include <vector>
 
 #include "../event_recorder.h"
+#include "event_record_format.h"
 
 namespace poro {
 
+class EventRecordWriter;
+
 class EventRecorderImpl : public EventRecorder
 {
 public:
 	EventRecorderImpl();
 	EventRecorderImpl( Keyboard* keyboard, Mouse* mouse, Touch* touch );
 	
-	virtual ~EventRecorderImpl() { }
+	virtual ~EventRecorderImpl();
 
 	//-------------------------------------------------------------------------
 	
@@ -51,7 +54,13 @@ public:
 
 	//-------------------------------------------------------------------------
 protected:
-	std::vector< std::string > mEventBuffer;
+	void AddEvent( const RecordedEvent& event );
+
+	EventRecordEncoder mEncoder;
+	// the encoded frames waiting to be handed over to the writer
+	std::vector< unsigned char > mFrameBuffer;
+	EventRecordWriter* mWriter;
+
 	std::string mFilename;
 	int mFrameCount;
 	float mFrameStartTime;
@@ -21,12 +21,16 @@
 #include "graphics_opengl.h"
 
 #include <cmath>
+#include <cstring>
+#include <deque>
+#include <algorithm>
 
 #include "../iplatform.h"
 #include "../libraries.h"
 #include "../poro_macros.h"
 #include "texture_opengl.h"
 #include "texture3d_opengl.h"
+#include "mesh_opengl.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "../external/stb_image.h"
@@ -43,6 +47,7 @@
 // for screenshot saving
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "../external/stb_image_write.h"
+#include "../../utils/pngwriter/pngwriter.h"
 #undef STB_IMAGE_WRITE_IMPLEMENTATION
 
 
@@ -66,6 +71,9 @@ namespace {
 
 	GraphicsSettings OPENGL_SETTINGS;
 
+	// draw calls since the last EndRendering()
+	int OPENGL_DRAW_CALLS = 0;
+
 	Uint32 GetGLVertexMode(int vertex_mode){
 		switch (vertex_mode) {
 			case IGraphics::VERTEX_MODE_TRIANGLE_FAN:
@@ -109,15 +117,18 @@ namespace {
 		float y;
 		float tx;
 		float ty;
+
+		// only used by the DrawTextureBuffer
+		float r;
+		float g;
+		float b;
+		float a;
 	};
 
 	//-------------------------------------------------------------------------
 
-	//static int drawcalls=0;
 	void drawsprite( TextureOpenGL* texture, Vertex* vertices, const types::fcolor& color, int count, Uint32 vertex_mode, int blend_mode )
 	{
-		//++drawcalls;
-		
 		Uint32 tex = texture->mTexture;
 		glBindTexture(GL_TEXTURE_2D, tex);
 		glEnable(GL_TEXTURE_2D);
@@ -131,11 +142,10 @@ namespace {
 			if( color[ 3 ] == 0 ) 
 				return;
 
-			glColor4f(
-				color[ 0 ] / color[ 3 ], 
-				color[ 1 ] / color[ 3 ], 
-				color[ 2 ] / color[ 3 ], color[ 3 ] );
-
+			// dest * color, the same as drawsprite_batch() and SoftRasterizer. 
+			// The color isn't divided by alpha, alpha only multiplies the
+			// destination alpha.
+			glColor4f(color[ 0 ], color[ 1 ], color[ 2 ], color[ 3 ] );
 			glBlendFunc(GL_ZERO, GL_SRC_COLOR);
 		} else if ( blend_mode == poro::IGraphics::BLEND_MODE_SCREEN ) {
 			glColor4f(color[0], color[1], color[2], color[3]);
@@ -145,6 +155,7 @@ namespace {
 
 		glColor4f(color[ 0 ], color[ 1 ], color[ 2 ], color[ 3 ] );
 
+		++OPENGL_DRAW_CALLS;
 		glBegin( vertex_mode );
 		for( int i = 0; i < count; ++i )
 		{
@@ -193,6 +204,7 @@ namespace {
 		glBindTexture(GL_TEXTURE_2D, image_id );
 
 		glDisable(GL_CULL_FACE);
+		++OPENGL_DRAW_CALLS;
 		glBegin( vertex_mode );
 		for( int i = 0; i < count; ++i )
 		{
@@ -213,6 +225,44 @@ namespace {
 #endif
 	}
 
+	//-------------------------------------------------------------------------
+
+	// draws GL_TRIANGLES with the color in every vertex, for the 
+	// DrawTextureBuffer
+	void drawsprite_batch( Uint32 texture_id, const Vertex* vertices, int count, int blend_mode )
+	{
+		glBindTexture(GL_TEXTURE_2D, texture_id);
+		glEnable(GL_TEXTURE_2D);
+		glEnable(GL_BLEND);
+
+		if( blend_mode == poro::IGraphics::BLEND_MODE_NORMAL ) 
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		else if( blend_mode == 1 ) 
+			glBlendFunc(GL_ZERO, GL_SRC_COLOR);
+		else if ( blend_mode == poro::IGraphics::BLEND_MODE_SCREEN ) 
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+
+		glVertexPointer(2, GL_FLOAT, sizeof( Vertex ), &vertices[ 0 ].x);
+		glTexCoordPointer(2, GL_FLOAT, sizeof( Vertex ), &vertices[ 0 ].tx);
+		glColorPointer(4, GL_FLOAT, sizeof( Vertex ), &vertices[ 0 ].r);
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		glEnableClientState(GL_COLOR_ARRAY);
+
+		++OPENGL_DRAW_CALLS;
+		glDrawArrays(GL_TRIANGLES, 0, count);
+
+		glDisableClientState(GL_COLOR_ARRAY);
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		glDisableClientState(GL_VERTEX_ARRAY);
+
+		glDisable(GL_BLEND);
+		glDisable(GL_TEXTURE_2D);
+
+		// the color array leaves the current color undefined
+		glColor4f( 1.f, 1.f, 1.f, 1.f );
+	}
+
 
 	//-------------------------------------------------------------------------
 
@@ -403,11 +453,9 @@ namespace {
 		return "";
 	}
 
-	TextureOpenGL* LoadTextureForReal( const types::string& filename, bool store_raw_pixel_data )
+	// loads the image as 4 bytes per pixel, free the result with stbi_image_free()
+	unsigned char* LoadImageForReal( const types::string& filename, int& x, int& y, int& bpp )
 	{
-		TextureOpenGL* result = NULL;
-		
-		int x,y,bpp;
 		unsigned char *data = stbi_load(filename.c_str(), &x, &y, &bpp, 4);
 
 		if( data == NULL ) 
@@ -430,9 +478,7 @@ namespace {
 #endif
 		}
 
-		result = CreateImage( data, x, y, bpp, store_raw_pixel_data );
-
-		return result;
+		return data;
 	}
 
 	//-----------------------------------------------------------------------------
@@ -458,10 +504,19 @@ namespace {
 
 	void SetTextureDataForReal(TextureOpenGL* texture, void* data)
 	{
+		// an image in the atlas is written to its place in the shared page,
+		// the padding around it keeps the old pixels
+		int x = 0;
+		int y = 0;
+		if( texture->mInAtlas ) {
+			x = (int)( texture->mUvOrigin[ 0 ] * (float)texture->mRealSizeX + 0.5f );
+			y = (int)( texture->mUvOrigin[ 1 ] * (float)texture->mRealSizeY + 0.5f );
+		}
+
 		// update the texture image:
 		glEnable(GL_TEXTURE_2D);
 		glBindTexture(GL_TEXTURE_2D, (GLuint)texture->mTexture);
-		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, texture->mWidth, texture->mHeight, GL_RGBA, GL_UNSIGNED_BYTE, data);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, texture->mWidth, texture->mHeight, GL_RGBA, GL_UNSIGNED_BYTE, data);
 		glDisable(GL_TEXTURE_2D);
 	}
 
@@ -479,107 +534,645 @@ namespace {
 //
 // Or maybe we just turn this on when we're using an atlas...
 //
+// The sprites are collected into batches that share the texture and the 
+// blend mode, the color goes into every vertex. Without sorting only the
+// last batch is added to. With sorting a sprite can go to an earlier batch 
+// if it doesn't overlap the bounds of any of the batches after it, so the 
+// result looks the same as drawing everything in order.
+//
 class GraphicsOpenGL::DrawTextureBuffered {
 public:
 
-	Vertex				vertex_buffer[PORO_DRAW_TEXTURE_BUFFER_SIZE];
-	int					vertex_buffer_count;
-	TextureOpenGL*		prev_texture;
-	Uint32				prev_texture_id;
-	types::fcolor		prev_color;
-	int					prev_vertex_mode;
-	int					prev_blend_mode;
+	enum { MAX_BATCHES = 16 };
 
-	DrawTextureBuffered() 
+	struct Bounds
+	{
+		Bounds() : min_x( 0 ), min_y( 0 ), max_x( 0 ), max_y( 0 ) { }
+
+		void Add( const Bounds& other )
+		{
+			min_x = std::min( min_x, other.min_x );
+			min_y = std::min( min_y, other.min_y );
+			max_x = std::max( max_x, other.max_x );
+			max_y = std::max( max_y, other.max_y );
+		}
+
+		bool Overlaps( const Bounds& other ) const
+		{
+			return min_x < other.max_x && other.min_x < max_x &&
+				min_y < other.max_y && other.min_y < max_y;
+		}
+
+		float min_x;
+		float min_y;
+		float max_x;
+		float max_y;
+	};
+
+	struct Batch
+	{
+		Batch() : texture_id( 0 ), blend_mode( 0 ), vertices(), bounds() { }
+
+		Uint32					texture_id;
+		int						blend_mode;
+		std::vector< Vertex >	vertices;
+
+		// of all the vertices
+		Bounds					bounds;
+	};
+
+	std::vector< Batch >	batches;
+	int						batch_count;
+	int						vertex_buffer_count;
+	bool					sorting;
+
+	DrawTextureBuffered() :
+		batches( MAX_BATCHES ),
+		batch_count( 0 ),
+		vertex_buffer_count( 0 ),
+		sorting( false )
 	{
-		vertex_buffer_count = 0;
-		prev_texture = NULL;
-		prev_texture_id = 0;
-		prev_color = GetFColor(0,0,0,0);
-		prev_vertex_mode = 0;
-		prev_blend_mode = 0;
 	}
 
-	bool CanDrawSpriteToBuffer( TextureOpenGL* texture, const types::fcolor& color, int count, Uint32 vertex_mode, int blend_mode ) 
+	// the batch the sprite can be added to, or NULL if it needs a new one
+	Batch* FindBatch( TextureOpenGL* texture, int blend_mode, const Bounds& sprite ) 
 	{
-		poro_assert( texture );
-		poro_assert( count > 0 );
+		if( batch_count == 0 ) 
+			return NULL;
 
-		if( vertex_buffer_count == 0 )
-			return true;
-		
-		if( prev_texture_id != texture->mTexture )
-			return false;
-		
-		if( vertex_buffer_count+(count-2)*3 >= PORO_DRAW_TEXTURE_BUFFER_SIZE )
-			return false;
-		
-		if( prev_color[0] != color[0] || prev_color[1] != color[1] || prev_color[2] != color[2] || prev_color[3] != color[3] )
-			return false;
-		
-		if( prev_blend_mode != blend_mode )
-			return false;
-		
-		return true;
+		if( sorting == false )
+		{
+			Batch& last = batches[ batch_count - 1 ];
+			if( last.texture_id == texture->mTexture && last.blend_mode == blend_mode ) 
+				return &last;
+			return NULL;
+		}
+
+		// bounds of the batches that are drawn after batches[ i ]
+		Bounds above = batches[ batch_count - 1 ].bounds;
+		for( int i = batch_count - 1; i >= 0; --i )
+		{
+			Batch& batch = batches[ i ];
+			if( batch.texture_id == texture->mTexture && batch.blend_mode == blend_mode ) 
+				return &batch;
+
+			above.Add( batch.bounds );
+			if( sprite.Overlaps( above ) )
+				return NULL;
+		}
+
+		return NULL;
 	}
-	
-	void DrawSpriteToBuffer( TextureOpenGL* texture, Vertex* vertices, const types::fcolor& color, int count, Uint32 vertex_mode, int blend_mode )
+
+	void DrawSpriteToBuffer( Batch& batch, Vertex* vertices, const types::fcolor& color, int count, Uint32 vertex_mode )
 	{
-		poro_assert( texture );
-		
-		prev_color = color;
-		prev_texture_id = texture->mTexture;
-		prev_texture = texture;
-		prev_vertex_mode = vertex_mode;
-		prev_blend_mode= blend_mode;
-		
+		for( int i = 0; i < count; ++i )
+		{
+			vertices[ i ].r = color[ 0 ];
+			vertices[ i ].g = color[ 1 ];
+			vertices[ i ].b = color[ 2 ];
+			vertices[ i ].a = color[ 3 ];
+		}
+
 		//convert GL_TRIANGLE_FAN and GL_TRIANGLE_STRIP to GL_TRIANGLES
+		std::vector< Vertex >& vertex_buffer = batch.vertices;
+		const std::size_t start = vertex_buffer.size();
 		if(vertex_mode==GL_TRIANGLE_FAN){
 			for( int i=2; i<count; ++i ){
-				vertex_buffer[vertex_buffer_count] = vertices[0];
-				++vertex_buffer_count;
-				vertex_buffer[vertex_buffer_count] = vertices[i-1];
-				++vertex_buffer_count;
-				vertex_buffer[vertex_buffer_count] = vertices[i];
-				++vertex_buffer_count;
+				vertex_buffer.push_back( vertices[0] );
+				vertex_buffer.push_back( vertices[i-1] );
+				vertex_buffer.push_back( vertices[i] );
 			}
 		} else if(vertex_mode==GL_TRIANGLE_STRIP){
 			for( int i=2; i<count; ++i ){
-				vertex_buffer[vertex_buffer_count] = vertices[i-2];
-				++vertex_buffer_count;
-				vertex_buffer[vertex_buffer_count] = vertices[i-1];
-				++vertex_buffer_count;
-				vertex_buffer[vertex_buffer_count] = vertices[i];
-				++vertex_buffer_count;
+				vertex_buffer.push_back( vertices[i-2] );
+				vertex_buffer.push_back( vertices[i-1] );
+				vertex_buffer.push_back( vertices[i] );
 			}
 		} else if(vertex_mode==GL_TRIANGLES) {
 			for( int i=0; i<count; ++i ){
-				vertex_buffer[vertex_buffer_count] = vertices[i];
-				++vertex_buffer_count;
+				vertex_buffer.push_back( vertices[i] );
 			}
 		}
+		vertex_buffer_count += (int)( vertex_buffer.size() - start );
 	}
 	
 	void FlushDrawSpriteBuffer()
 	{
-		if( vertex_buffer_count > 0 ) {
-			drawsprite( prev_texture, vertex_buffer, prev_color, vertex_buffer_count, GL_TRIANGLES, prev_blend_mode );
-			/*if( vertex_buffer_count != 6 )
-				std::cout << "Buffered draw call: " << vertex_buffer_count << std::endl;*/
+		for( int i = 0; i < batch_count; ++i )
+		{
+			Batch& batch = batches[ i ];
+			if( batch.vertices.empty() == false ) 
+				drawsprite_batch( batch.texture_id, &batch.vertices[ 0 ], (int)batch.vertices.size(), batch.blend_mode );
+
+			// keeps the memory
+			batch.vertices.clear();
 		}
+		batch_count = 0;
 		vertex_buffer_count = 0;
 	}
 	
 	void BufferedDrawSprite( TextureOpenGL* texture, Vertex* vertices, const types::fcolor& color, int count, Uint32 vertex_mode, int blend_mode )
 	{
-		if( !CanDrawSpriteToBuffer( texture, color, count, vertex_mode, blend_mode ) ){
+		poro_assert( texture );
+		poro_assert( count > 0 );
+
+		const int triangle_vertex_count = ( vertex_mode == GL_TRIANGLES ) ? count : ( count - 2 ) * 3;
+		if( vertex_buffer_count + triangle_vertex_count >= PORO_DRAW_TEXTURE_BUFFER_SIZE )
 			FlushDrawSpriteBuffer();
+
+		Bounds sprite;
+		sprite.min_x = sprite.max_x = vertices[ 0 ].x;
+		sprite.min_y = sprite.max_y = vertices[ 0 ].y;
+		for( int i = 1; i < count; ++i )
+		{
+			sprite.min_x = std::min( sprite.min_x, vertices[ i ].x );
+			sprite.min_y = std::min( sprite.min_y, vertices[ i ].y );
+			sprite.max_x = std::max( sprite.max_x, vertices[ i ].x );
+			sprite.max_y = std::max( sprite.max_y, vertices[ i ].y );
 		}
-		DrawSpriteToBuffer( texture, vertices, color, count, vertex_mode, blend_mode );
+
+		Batch* batch = FindBatch( texture, blend_mode, sprite );
+		if( batch == NULL )
+		{
+			if( batch_count == MAX_BATCHES ) 
+				FlushDrawSpriteBuffer();
+
+			batch = &batches[ batch_count ];
+			++batch_count;
+			batch->texture_id = texture->mTexture;
+			batch->blend_mode = blend_mode;
+			batch->bounds = sprite;
+		}
+		else
+		{
+			batch->bounds.Add( sprite );
+		}
+
+		DrawSpriteToBuffer( *batch, vertices, color, count, vertex_mode );
 	}
 	
 };
 
+//============================== TextureAtlas =================================
+//
+// Small images from LoadTexture() are packed into big shared textures, so 
+// that sprites using different images can still be drawn with one draw call
+// by the DrawTextureBuffer. The images are put on shelves, rows that are as
+// high as the highest image in them and that are filled from left to right. 
+// The edge pixels of every image are repeated around it, so that linear 
+// filtering doesn't bleed in the neighbours. 
+//
+// The space of released textures isn't reused.
+//
+class GraphicsOpenGL::TextureAtlas {
+public:
+
+	enum { PAGE_SIZE = 1024, PADDING = 1 };
+
+	TextureAtlas() : mPages(), mBlock() { }
+
+	~TextureAtlas()
+	{
+		for( std::size_t i = 0; i < mPages.size(); ++i ) 
+			glDeleteTextures( 1, (GLuint*)&mPages[ i ].texture );
+	}
+
+	// returns NULL if the image is bigger than max_size
+	TextureOpenGL* Add( const unsigned char* pixels, int w, int h, int max_size )
+	{
+		if( w <= 0 || h <= 0 || w > max_size || h > max_size )
+			return NULL;
+
+		const int block_w = w + 2 * PADDING;
+		const int block_h = h + 2 * PADDING;
+		if( block_w > PAGE_SIZE || block_h > PAGE_SIZE )
+			return NULL;
+
+		int x = 0;
+		int y = 0;
+		const Page& page = FindSpace( block_w, block_h, x, y );
+
+		mBlock.resize( block_w * block_h * 4 );
+		for( int by = 0; by < block_h; ++by )
+		{
+			const int sy = std::min( std::max( by - PADDING, 0 ), h - 1 );
+			for( int bx = 0; bx < block_w; ++bx )
+			{
+				const int sx = std::min( std::max( bx - PADDING, 0 ), w - 1 );
+				memcpy( &mBlock[ ( by * block_w + bx ) * 4 ], pixels + ( sy * w + sx ) * 4, 4 );
+			}
+		}
+
+		glBindTexture( GL_TEXTURE_2D, page.texture );
+		glTexSubImage2D( GL_TEXTURE_2D, 0, x, y, block_w, block_h, GL_RGBA, GL_UNSIGNED_BYTE, &mBlock[ 0 ] );
+		glBindTexture( GL_TEXTURE_2D, 0 );
+
+		TextureOpenGL* result = new TextureOpenGL;
+		result->mTexture = page.texture;
+		result->mWidth = w;
+		result->mHeight = h;
+		result->mRealSizeX = PAGE_SIZE;
+		result->mRealSizeY = PAGE_SIZE;
+		result->mInAtlas = true;
+		result->mUvOrigin[ 0 ] = (float)( x + PADDING ) / (float)PAGE_SIZE;
+		result->mUvOrigin[ 1 ] = (float)( y + PADDING ) / (float)PAGE_SIZE;
+		result->mUv[ 0 ] = result->mUvOrigin[ 0 ];
+		result->mUv[ 1 ] = result->mUvOrigin[ 1 ];
+		result->mUv[ 2 ] = (float)( x + PADDING + w ) / (float)PAGE_SIZE;
+		result->mUv[ 3 ] = (float)( y + PADDING + h ) / (float)PAGE_SIZE;
+		return result;
+	}
+
+private:
+	// only the last shelf of a page is filled
+	struct Page
+	{
+		Uint32	texture;
+		int		shelf_x;
+		int		shelf_y;
+		int		shelf_height;
+	};
+
+	const Page& FindSpace( int w, int h, int& x, int& y )
+	{
+		for( std::size_t i = 0; i < mPages.size(); ++i )
+		{
+			Page& page = mPages[ i ];
+			if( page.shelf_x + w > PAGE_SIZE )
+			{
+				// starts a new shelf
+				if( page.shelf_y + page.shelf_height + h > PAGE_SIZE ) 
+					continue;
+
+				page.shelf_y += page.shelf_height;
+				page.shelf_x = 0;
+				page.shelf_height = 0;
+			}
+
+			if( page.shelf_y + h > PAGE_SIZE )
+				continue;
+
+			x = page.shelf_x;
+			y = page.shelf_y;
+			page.shelf_x += w;
+			page.shelf_height = std::max( page.shelf_height, h );
+			return page;
+		}
+
+		Page page;
+		page.texture = CreatePage();
+		page.shelf_x = w;
+		page.shelf_y = 0;
+		page.shelf_height = h;
+		mPages.push_back( page );
+
+		x = 0;
+		y = 0;
+		return mPages.back();
+	}
+
+	Uint32 CreatePage()
+	{
+		Uint32 texture = 0;
+		std::vector< unsigned char > empty( PAGE_SIZE * PAGE_SIZE * 4, 0 );
+
+		glGenTextures(1, (GLuint*)&texture);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, PAGE_SIZE, PAGE_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, &empty[ 0 ]);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+		if(IPlatform::Instance()->GetGraphics()->GetMipmapMode()==IGraphics::MIPMAP_MODE_NEAREST){
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		} else {
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		}
+
+		glBindTexture(GL_TEXTURE_2D, 0);
+		return texture;
+	}
+
+	std::vector< Page >				mPages;
+	std::vector< unsigned char >	mBlock;
+};
+
+//============================ ScreenshotSaver ================================
+//
+// Screenshots are read back and saved without stalling the render thread.
+// glReadPixels() goes into one of two pixel buffer objects, so it returns
+// right away. The pixels are mapped a frame later, when the GPU is done 
+// with them, and the crop is copied out one row at a time (flipping it at
+// the same time). The png encoding and the file write happen on a worker 
+// thread.
+//
+// Without PBOs the read is synchronous, but the encoding is still done on
+// the worker thread.
+//
+class GraphicsOpenGL::ScreenshotSaver {
+public:
+
+	ScreenshotSaver() :
+		mFrame( 0 ),
+		mUsePBO( false ),
+		mReadPixels(),
+		mThread( NULL ),
+		mMutex( NULL ),
+		mJobAdded( NULL ),
+		mJobDone( NULL ),
+		mJobs(),
+		mEncoding( false ),
+		mQuit( false )
+	{
+#ifndef PORO_DONT_USE_GLEW
+		mUsePBO = ( GLEW_VERSION_2_1 != 0 );
+#endif
+		for( int i = 0; i < CAPTURE_COUNT; ++i )
+		{
+			mCaptures[ i ].pbo = 0;
+			mCaptures[ i ].pbo_size = 0;
+			mCaptures[ i ].pending = false;
+		}
+
+		mMutex = SDL_CreateMutex();
+		mJobAdded = SDL_CreateCond();
+		mJobDone = SDL_CreateCond();
+		mThread = SDL_CreateThread( ScreenshotSaver::EncodeThread, this );
+		if( mThread == NULL ) 
+			poro_logger << "Warning - ScreenshotSaver couldn't create a thread, saving screenshots on the main thread" << std::endl;
+	}
+
+	~ScreenshotSaver()
+	{
+		Wait();
+
+		SDL_mutexP( mMutex );
+		mQuit = true;
+		SDL_CondSignal( mJobAdded );
+		SDL_mutexV( mMutex );
+
+		if( mThread ) 
+			SDL_WaitThread( mThread, NULL );
+
+		SDL_DestroyCond( mJobDone );
+		SDL_DestroyCond( mJobAdded );
+		SDL_DestroyMutex( mMutex );
+
+#ifndef PORO_DONT_USE_GLEW
+		for( int i = 0; i < CAPTURE_COUNT; ++i ) 
+		{
+			if( mCaptures[ i ].pbo ) 
+				glDeleteBuffers( 1, &mCaptures[ i ].pbo );
+		}
+#endif
+	}
+
+	// reads the view_* rect of the framebuffer and saves the crop_* part of 
+	// it, crop is in pixels from the top left corner of the view
+	void Capture( const std::string& filename, int view_x, int view_y, int view_w, int view_h, int crop_x, int crop_y, int crop_w, int crop_h )
+	{
+		if( view_w <= 0 || view_h <= 0 || crop_w <= 0 || crop_h <= 0 )
+			return;
+
+		Capture_t request;
+		request.filename = filename;
+		request.view_w = view_w;
+		request.view_h = view_h;
+		request.crop_x = crop_x;
+		request.crop_y = crop_y;
+		request.crop_w = crop_w;
+		request.crop_h = crop_h;
+		request.frame = mFrame;
+		request.pbo = 0;
+		request.pbo_size = 0;
+		request.pending = false;
+
+		// tightly packed rows, so they can be memcpy'd
+		glPixelStorei( GL_PACK_ALIGNMENT, 1 );
+		const int size = 3 * view_w * view_h;
+
+#ifndef PORO_DONT_USE_GLEW
+		if( mUsePBO )
+		{
+			// both are in flight, the older one has to be finished now
+			Capture_t* capture = GetFreeCapture();
+			if( capture == NULL ) 
+			{
+				Finish( *GetOldestCapture() );
+				capture = GetFreeCapture();
+			}
+
+			if( capture->pbo == 0 ) 
+				glGenBuffers( 1, &capture->pbo );
+
+			glBindBuffer( GL_PIXEL_PACK_BUFFER, capture->pbo );
+			if( capture->pbo_size != size ) 
+			{
+				glBufferData( GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ );
+				capture->pbo_size = size;
+			}
+			glReadPixels( view_x, view_y, view_w, view_h, GL_RGB, GL_UNSIGNED_BYTE, NULL );
+			glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+
+			request.pbo = capture->pbo;
+			request.pbo_size = capture->pbo_size;
+			request.pending = true;
+			*capture = request;
+			return;
+		}
+#endif
+
+		if( (int)mReadPixels.size() < size ) 
+			mReadPixels.resize( size );
+
+		glReadPixels( view_x, view_y, view_w, view_h, GL_RGB, GL_UNSIGNED_BYTE, &mReadPixels[ 0 ] );
+		AddJob( request, &mReadPixels[ 0 ] );
+	}
+
+	// called once a frame, after the buffers have been swapped
+	void Update()
+	{
+		for( int i = 0; i < CAPTURE_COUNT; ++i ) 
+		{
+			if( mCaptures[ i ].pending && mCaptures[ i ].frame < mFrame ) 
+				Finish( mCaptures[ i ] );
+		}
+
+		mFrame++;
+	}
+
+	// returns when all the screenshots have been written
+	void Wait()
+	{
+		while( GetOldestCapture() )
+			Finish( *GetOldestCapture() );
+
+		SDL_mutexP( mMutex );
+		while( mJobs.empty() == false || mEncoding )
+			SDL_CondWait( mJobDone, mMutex );
+		SDL_mutexV( mMutex );
+	}
+
+private:
+
+	enum { CAPTURE_COUNT = 2 };
+
+	struct Capture_t
+	{
+		std::string filename;
+		int view_w, view_h;
+		int crop_x, crop_y, crop_w, crop_h;
+		int frame;
+
+		unsigned int pbo;
+		int pbo_size;
+		bool pending;
+	};
+
+	struct Job
+	{
+		std::string filename;
+		int width, height;
+		std::vector< unsigned char > pixels;
+	};
+
+	Capture_t* GetFreeCapture()
+	{
+		for( int i = 0; i < CAPTURE_COUNT; ++i ) 
+		{
+			if( mCaptures[ i ].pending == false ) 
+				return &mCaptures[ i ];
+		}
+		return NULL;
+	}
+
+	Capture_t* GetOldestCapture()
+	{
+		Capture_t* result = NULL;
+		for( int i = 0; i < CAPTURE_COUNT; ++i ) 
+		{
+			if( mCaptures[ i ].pending && ( result == NULL || mCaptures[ i ].frame < result->frame ) ) 
+				result = &mCaptures[ i ];
+		}
+		return result;
+	}
+
+	void Finish( Capture_t& capture )
+	{
+#ifndef PORO_DONT_USE_GLEW
+		glBindBuffer( GL_PIXEL_PACK_BUFFER, capture.pbo );
+		const unsigned char* pixels = (const unsigned char*)glMapBuffer( GL_PIXEL_PACK_BUFFER, GL_READ_ONLY );
+		if( pixels ) 
+		{
+			AddJob( capture, pixels );
+			glUnmapBuffer( GL_PIXEL_PACK_BUFFER );
+		}
+		else 
+		{
+			poro_logger << "Error SaveScreenshot() - couldn't map the pixels for: " << capture.filename << std::endl;
+		}
+		glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+#endif
+		capture.pending = false;
+	}
+
+	// copies the crop out of the bottom up pixels and queues it for saving
+	void AddJob( const Capture_t& capture, const unsigned char* pixels )
+	{
+		Job* job = new Job;
+		job->filename = capture.filename;
+		job->width = capture.crop_w;
+		job->height = capture.crop_h;
+		job->pixels.resize( 3 * capture.crop_w * capture.crop_h, 0 );
+
+		// the parts of the crop that are outside of the view stay black
+		const int x0 = std::max( capture.crop_x, 0 );
+		const int x1 = std::min( capture.crop_x + capture.crop_w, capture.view_w );
+		for( int y = 0; y < capture.crop_h && x0 < x1; ++y )
+		{
+			const int src_y = capture.view_h - 1 - ( capture.crop_y + y );
+			if( src_y < 0 || src_y >= capture.view_h )
+				continue;
+
+			memcpy( &job->pixels[ 3 * ( y * capture.crop_w + ( x0 - capture.crop_x ) ) ], 
+				pixels + 3 * ( src_y * capture.view_w + x0 ), 
+				3 * ( x1 - x0 ) );
+		}
+
+		if( mThread == NULL ) 
+		{
+			Encode( job );
+			return;
+		}
+
+		SDL_mutexP( mMutex );
+		mJobs.push_back( job );
+		SDL_CondSignal( mJobAdded );
+		SDL_mutexV( mMutex );
+	}
+
+	static void Encode( Job* job )
+	{
+		// screenshots are taken while the game runs, speed matters more than 
+		// size. One thread, so that the encode doesn't take cores from the game
+		ceng::PngWriterSettings settings;
+		settings.compression = 2;
+		settings.thread_count = 1;
+		bool result = ceng::WritePng( job->filename, job->width, job->height, 3, &job->pixels[ 0 ], job->width * 3, settings );
+		if( result == false ) poro_logger << "Error SaveScreenshot() - couldn't write to file: " << job->filename << std::endl;
+		delete job;
+	}
+
+	static int EncodeThread( void* data )
+	{
+		ScreenshotSaver* self = static_cast< ScreenshotSaver* >( data );
+
+		SDL_mutexP( self->mMutex );
+		while( true )
+		{
+			if( self->mJobs.empty() == false ) 
+			{
+				Job* job = self->mJobs.front();
+				self->mJobs.pop_front();
+				self->mEncoding = true;
+				SDL_mutexV( self->mMutex );
+
+				Encode( job );
+
+				SDL_mutexP( self->mMutex );
+				self->mEncoding = false;
+				SDL_CondBroadcast( self->mJobDone );
+			}
+			else if( self->mQuit ) 
+			{
+				break;
+			}
+			else 
+			{
+				SDL_CondWait( self->mJobAdded, self->mMutex );
+			}
+		}
+		SDL_mutexV( self->mMutex );
+		return 0;
+	}
+
+	int						mFrame;
+	bool					mUsePBO;
+	Capture_t				mCaptures[ CAPTURE_COUNT ];
+	std::vector< unsigned char > mReadPixels;
+
+	SDL_Thread*				mThread;
+	SDL_mutex*				mMutex;
+	SDL_cond*				mJobAdded;
+	SDL_cond*				mJobDone;
+	std::deque< Job* >		mJobs;
+	bool					mEncoding;
+	bool					mQuit;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
 
@@ -598,15 +1191,38 @@ GraphicsOpenGL::GraphicsOpenGL() :
 	mGlContextInitialized( false ),
 
 	mDrawTextureBuffered( NULL ),	
-	mUseDrawTextureBuffering( false )
+	mUseDrawTextureBuffering( false ),
+	mDrawTextureSorting( false ),
+	mTextureAtlas( NULL ),
+	mDrawCallCount( 0 ),
+
+	mFillVertices(),
+	mFillColors(),
+
+	mScreenshotSaver( NULL )
+{
+
+}
+
+GraphicsOpenGL::~GraphicsOpenGL()
 {
+	// writes the screenshots that are still on the way
+	delete mScreenshotSaver;
+	mScreenshotSaver = NULL;
 
+	delete mTextureAtlas;
+	mTextureAtlas = NULL;
 }
 //-----------------------------------------------------------------------------
 
 void GraphicsOpenGL::SetSettings( const GraphicsSettings& settings ) {
 	OPENGL_SETTINGS = settings;
 	this->SetDrawTextureBuffering( settings.buffered_textures );
+	this->SetDrawTextureSorting( settings.buffered_textures_sort );
+
+	// the textures that are already in the atlas stay there
+	if( settings.textures_atlas && mTextureAtlas == NULL ) 
+		mTextureAtlas = new TextureAtlas;
 }
 //-----------------------------------------------------------------------------
 	
@@ -616,12 +1232,31 @@ void GraphicsOpenGL::SetDrawTextureBuffering( bool buffering ) {
 
 	if( mUseDrawTextureBuffering && mDrawTextureBuffered == NULL ) 
 		mDrawTextureBuffered = new DrawTextureBuffered;
+
+	if( mDrawTextureBuffered ) 
+		mDrawTextureBuffered->sorting = mDrawTextureSorting;
 }
 
 bool GraphicsOpenGL::GetDrawTextureBuffering() const {
 	return mUseDrawTextureBuffering;
 }
 
+void GraphicsOpenGL::SetDrawTextureSorting( bool sorting ) {
+	FlushDrawTextureBuffer();
+	mDrawTextureSorting = sorting;
+
+	if( mDrawTextureBuffered ) 
+		mDrawTextureBuffered->sorting = mDrawTextureSorting;
+}
+
+bool GraphicsOpenGL::GetDrawTextureSorting() const {
+	return mDrawTextureSorting;
+}
+
+int GraphicsOpenGL::GetDrawCallCount() const {
+	return mDrawCallCount;
+}
+
 //-----------------------------------------------------------------------------
 
 bool GraphicsOpenGL::Init( int width, int height, bool fullscreen, const types::string& caption )
@@ -826,7 +1461,21 @@ ITexture* GraphicsOpenGL::LoadTexture( const types::string& filename )
 
 ITexture* GraphicsOpenGL::LoadTexture( const types::string& filename, bool store_raw_pixel_data )
 {
-	ITexture* result = LoadTextureForReal( filename, store_raw_pixel_data );
+	ITexture* result = NULL;
+
+	int x, y, bpp;
+	unsigned char* data = LoadImageForReal( filename, x, y, bpp );
+	if( data )
+	{
+		// the raw pixel data is only kept for images that have a texture of their own
+		if( mTextureAtlas && store_raw_pixel_data == false ) 
+			result = mTextureAtlas->Add( data, x, y, OPENGL_SETTINGS.textures_atlas_max_size );
+
+		if( result ) 
+			stbi_image_free( data );
+		else
+			result = CreateImage( data, x, y, bpp, store_raw_pixel_data );
+	}
 	
 	if( result == NULL )
 		poro_logger << "Couldn't load image: " << filename << std::endl;
@@ -842,7 +1491,8 @@ void GraphicsOpenGL::ReleaseTexture( ITexture* itexture )
 {
 	TextureOpenGL* texture = dynamic_cast< TextureOpenGL* >( itexture );
 
-	if( texture )
+	// the atlas textures are shared
+	if( texture && texture->mInAtlas == false )
 		glDeleteTextures(1, &texture->mTexture);
 }
 
@@ -850,6 +1500,12 @@ void GraphicsOpenGL::SetTextureSmoothFiltering( ITexture* itexture, bool enabled
 {
 	TextureOpenGL* texture = dynamic_cast< TextureOpenGL* >( itexture );
 
+	// the atlas texture is shared by all the images in it
+	if( texture && texture->mInAtlas ) {
+		poro_logger << "Warning - SetTextureSmoothFiltering() doesn't work for textures in the atlas: " << texture->GetFilename() << std::endl;
+		return;
+	}
+
 	glEnable( GL_TEXTURE_2D );
 
 	if( texture )
@@ -872,6 +1528,12 @@ void GraphicsOpenGL::SetTextureWrappingMode( ITexture* itexture, int mode )
 {
 	TextureOpenGL* texture = dynamic_cast< TextureOpenGL* >( itexture );
 
+	// the atlas texture is shared by all the images in it
+	if( texture && texture->mInAtlas ) {
+		poro_logger << "Warning - SetTextureWrappingMode() doesn't work for textures in the atlas: " << texture->GetFilename() << std::endl;
+		return;
+	}
+
 	glEnable( GL_TEXTURE_2D );
 
 	if( texture )
@@ -1147,9 +1809,12 @@ void GraphicsOpenGL::BeginRendering()
 void GraphicsOpenGL::EndRendering()
 {
 	FlushDrawTextureBuffer();
-	// std::cout << "DrawCalls:" << drawcalls << std::endl;
-	// drawcalls=0;
+	mDrawCallCount = OPENGL_DRAW_CALLS;
+	OPENGL_DRAW_CALLS = 0;
 	SDL_GL_SwapBuffers();
+
+	if( mScreenshotSaver ) 
+		mScreenshotSaver->Update();
 }
 
 //=============================================================================
@@ -1171,6 +1836,7 @@ void GraphicsOpenGL::DrawLines( const std::vector< poro::types::vec2 >& vertices
 		glHint(GL_LINE_SMOOTH_HINT, GL_NICEST); 
 	}
 	glColor4f( color[ 0 ], color[ 1 ], color[ 2 ], color[ 3 ] );
+	++OPENGL_DRAW_CALLS;
 	glBegin(loop?GL_LINE_LOOP:GL_LINE_STRIP);
 
 	for( std::size_t i = 0; i < vertices.size(); ++i )
@@ -1207,10 +1873,9 @@ void GraphicsOpenGL::DrawFill( const std::vector< poro::types::vec2 >& vertices,
 		const float yPlatformScale = 1.f;
 
 		
-		const int max_buffer_size = 256;
-		static GLfloat glVertices[ max_buffer_size ];
-
-		poro_assert( vertCount * 2 <= max_buffer_size );
+		if( (int)mFillVertices.size() < vertCount * 2 )
+			mFillVertices.resize( vertCount * 2 );
+		GLfloat* glVertices = &mFillVertices[ 0 ];
 
 		int o = -1;
 		for(int i=0; i < vertCount; ++i){
@@ -1229,6 +1894,7 @@ void GraphicsOpenGL::DrawFill( const std::vector< poro::types::vec2 >& vertices,
 		// glBlendFunc(GL_SRC_ALPHA_SATURATE, GL_ZERO);
 
 		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+		++OPENGL_DRAW_CALLS;
 		glBegin(GL_POLYGON);
 		for( std::size_t i = 0; i < vertices.size(); ++i )
 		{                            
@@ -1264,10 +1930,9 @@ void GraphicsOpenGL::DrawFill( const std::vector< poro::types::vec2 >& vertices,
 		const float xPlatformScale = 1.f;
 		const float yPlatformScale = 1.f;
 
-		const int max_buffer_size = 256;
-		static GLfloat glVertices[ max_buffer_size ];
-
-		poro_assert( vertCount * 2 <= max_buffer_size );
+		if( (int)mFillVertices.size() < vertCount * 2 )
+			mFillVertices.resize( vertCount * 2 );
+		GLfloat* glVertices = &mFillVertices[ 0 ];
 
 		int o = -1;
 		for(int i=0; i < vertCount; ++i){
@@ -1291,6 +1956,7 @@ void GraphicsOpenGL::DrawFill( const std::vector< poro::types::vec2 >& vertices,
 		}
 				glVertexPointer(2, GL_FLOAT , 0, glVertices);
 				glEnableClientState(GL_VERTEX_ARRAY);
+				++OPENGL_DRAW_CALLS;
 				glDrawArrays (GL_TRIANGLE_STRIP, 0, vertCount);
 				glDisableClientState(GL_VERTEX_ARRAY);
 		
@@ -1301,6 +1967,116 @@ void GraphicsOpenGL::DrawFill( const std::vector< poro::types::vec2 >& vertices,
 	}
 }
 
+//-----------------------------------------------------------------------------
+
+void GraphicsOpenGL::DrawFillBatch( const poro::types::vec2* vertices, const int* offsets, const int* counts, const types::fcolor* colors, int polygon_count )
+{
+	if( polygon_count <= 0 )
+		return;
+
+	FlushDrawTextureBuffer();
+
+	// everything is turned into GL_TRIANGLES with the color in every vertex,
+	// so the whole batch is one glDrawArrays()
+	int triangle_count = 0;
+	for( int i = 0; i < polygon_count; ++i )
+	{
+		if( counts[ i ] >= 3 )
+			triangle_count += counts[ i ] - 2;
+	}
+
+	if( triangle_count == 0 )
+		return;
+
+	if( (int)mFillVertices.size() < triangle_count * 3 * 2 )
+		mFillVertices.resize( triangle_count * 3 * 2 );
+	if( (int)mFillColors.size() < triangle_count * 3 * 4 )
+		mFillColors.resize( triangle_count * 3 * 4 );
+
+	GLfloat* out_vertex = &mFillVertices[ 0 ];
+	GLfloat* out_color = &mFillColors[ 0 ];
+	bool blend = false;
+
+	const bool strip = ( GetDrawFillMode() == DRAWFILL_MODE_TRIANGLE_STRIP );
+	for( int i = 0; i < polygon_count; ++i )
+	{
+		const poro::types::vec2* poly = vertices + offsets[ i ];
+		const types::fcolor& color = colors[ i ];
+		if( color[ 3 ] < 1.f ) 
+			blend = true;
+
+		for( int j = 0; j + 2 < counts[ i ]; ++j )
+		{
+			// strips are j, j+1, j+2 and polygons are fans around the first vertex
+			const int corners[ 3 ] = { strip ? j : 0, j + 1, j + 2 };
+			for( int k = 0; k < 3; ++k )
+			{
+				*out_vertex++ = poly[ corners[ k ] ].x;
+				*out_vertex++ = poly[ corners[ k ] ].y;
+				*out_color++ = color[ 0 ];
+				*out_color++ = color[ 1 ];
+				*out_color++ = color[ 2 ];
+				*out_color++ = color[ 3 ];
+			}
+		}
+	}
+
+	// DrawFill() uses GL_POLYGON_SMOOTH in the front and back mode, that 
+	// can't be used here since it leaves seams between the triangles
+	DrawFillArrays( triangle_count * 3, blend );
+}
+
+void GraphicsOpenGL::DrawColoredTriangles( const poro::types::vec2* vertices, const types::fcolor* colors, int vertex_count )
+{
+	vertex_count -= vertex_count % 3;
+	if( vertex_count <= 0 )
+		return;
+
+	FlushDrawTextureBuffer();
+
+	if( (int)mFillVertices.size() < vertex_count * 2 )
+		mFillVertices.resize( vertex_count * 2 );
+	if( (int)mFillColors.size() < vertex_count * 4 )
+		mFillColors.resize( vertex_count * 4 );
+
+	for( int i = 0; i < vertex_count; ++i )
+	{
+		mFillVertices[ i * 2 + 0 ] = vertices[ i ].x;
+		mFillVertices[ i * 2 + 1 ] = vertices[ i ].y;
+		mFillColors[ i * 4 + 0 ] = colors[ i ][ 0 ];
+		mFillColors[ i * 4 + 1 ] = colors[ i ][ 1 ];
+		mFillColors[ i * 4 + 2 ] = colors[ i ][ 2 ];
+		mFillColors[ i * 4 + 3 ] = colors[ i ][ 3 ];
+	}
+
+	DrawFillArrays( vertex_count, true );
+}
+
+void GraphicsOpenGL::DrawFillArrays( int vertex_count, bool blend )
+{
+	if( blend ) {
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	}
+
+	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+	glVertexPointer(2, GL_FLOAT, 0, &mFillVertices[ 0 ]);
+	glColorPointer(4, GL_FLOAT, 0, &mFillColors[ 0 ]);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	++OPENGL_DRAW_CALLS;
+	glDrawArrays(GL_TRIANGLES, 0, vertex_count);
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+
+	if( blend ) 
+		glDisable(GL_BLEND);
+
+	// the color array leaves the current color undefined
+	glColor4f( 1.f, 1.f, 1.f, 1.f );
+}
+
+//-----------------------------------------------------------------------------
 
 void GraphicsOpenGL::DrawTexturedRect( const poro::types::vec2& position, const poro::types::vec2& size, ITexture* itexture, const poro::types::fcolor& color, types::vec2* tex_coords, int count )
 {
@@ -1336,6 +2112,7 @@ void GraphicsOpenGL::DrawTexturedRect( const poro::types::vec2& position, const
 	glEnable(GL_BLEND);
 	glColor4f( color[ 0 ], color[ 1 ], color[ 2 ], color[ 3 ] );
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	++OPENGL_DRAW_CALLS;
 	glBegin( GL_TRIANGLE_STRIP );
 
 	for( int i = 0; i < 4; i++)
@@ -1397,6 +2174,37 @@ types::vec2	GraphicsOpenGL::ConvertToInternalPos( int x, int y )
 
 //=============================================================================
 
+IMesh* GraphicsOpenGL::CreateMesh( const poro::types::vec2* vertices, const types::fcolor* colors, int vertex_count )
+{
+	MeshOpenGL* mesh = new MeshOpenGL;
+	mesh->Init( vertices, colors, vertex_count );
+	return mesh;
+}
+
+void GraphicsOpenGL::UpdateMesh( IMesh* mesh, int first_vertex, const poro::types::vec2* vertices, const types::fcolor* colors, int count )
+{
+	poro_assert( mesh );
+	if( mesh ) 
+		((MeshOpenGL*)mesh)->Update( first_vertex, vertices, colors, count );
+}
+
+void GraphicsOpenGL::DrawMesh( IMesh* mesh )
+{
+	if( mesh == NULL || mesh->GetVertexCount() == 0 )
+		return;
+
+	FlushDrawTextureBuffer();
+	++OPENGL_DRAW_CALLS;
+	((MeshOpenGL*)mesh)->Draw();
+}
+
+void GraphicsOpenGL::DestroyMesh( IMesh* mesh )
+{
+	delete mesh;
+}
+
+//=============================================================================
+
 IGraphicsBuffer* GraphicsOpenGL::CreateGraphicsBuffer(int width, int height)
 {
 #ifdef PORO_DONT_USE_GLEW
@@ -1457,60 +2265,25 @@ void GraphicsOpenGL::FlushDrawTextureBuffer()
 }
 //=============================================================================
 
+//-----------------------------------------------------------------------------
+
 void GraphicsOpenGL::SaveScreenshot( const std::string& filename, int pos_x, int pos_y, int w, int h )
 {
-	int width = (int)mViewportSize.x;
-	int height = (int)mViewportSize.y;
-
-	static unsigned char* pixels = new unsigned char[ 3 * (int)mViewportSize.x * (int)mViewportSize.y ];
-	const int pixels_size = 3 * (int)mViewportSize.x * (int)mViewportSize.y;
+	const int width = (int)mViewportSize.x;
+	const int height = (int)mViewportSize.y;
 
-	// read the whole image into a buffer, since this crashes with unspecified sizes
-	glReadPixels( (int)mViewportOffset.x, (int)mViewportOffset.y, (int)mViewportSize.x, (int)mViewportSize.y, GL_RGB, GL_UNSIGNED_BYTE, pixels);
-
-	// need to flip the pixels
-	for( int x = 0; x < width * 3; ++x ) 
-	{
-		for( int y = 0; y < height / 2; ++y ) 
-		{
-			std::swap( 
-				pixels[ x + 3 * width * y ], 
-				pixels[ x + 3 * width * ( height - y - 1 ) ] );
-		}
-	}
-	
-
-	unsigned char* other_pixels = pixels;
-
-	// copy to other buffer
 	if( pos_x != 0 || pos_y != 0 || w != width || height != h ) 
 	{
 		pos_x = (int)( ((float)pos_x) * ( mViewportSize.x / GetInternalSize().x ) );
 		pos_y = (int)( ((float)pos_y) * ( mViewportSize.y / GetInternalSize().y  ) );
 		w = (int)( ((float)w) * ( mViewportSize.x / GetInternalSize().x ) );
 		h = (int)( ((float)h) * ( mViewportSize.y / GetInternalSize().y ) );
-
-		other_pixels = new unsigned char[ 3 * w * h ];	
-		for( int y = 0; y < h; ++y )
-		{
-			for( int x = 0; x < w * 3; ++x )
-			{
-				int p1 = (x + 3 * w * y);
-				int p2 = (x + (pos_x * 3)) + ( 3 * width * ( y + pos_y));
-				if( p2 < pixels_size )
-					other_pixels[ p1 ] = pixels[ p2 ];
-				else 
-					other_pixels[ p1 ] = 0;
-			}
-		}
 	}
 
-	int result = stbi_write_png( filename.c_str(), w, h, 3, other_pixels, w * 3 );
-	if( result == 0 ) poro_logger << "Error SaveScreenshot() - couldn't write to file: " << filename << std::endl;
+	if( mScreenshotSaver == NULL ) 
+		mScreenshotSaver = new ScreenshotSaver;
 
-	if( other_pixels != pixels ) delete [] other_pixels;
-	// no need to release the static pixels
-	// delete [] pixels;	
+	mScreenshotSaver->Capture( filename, (int)mViewportOffset.x, (int)mViewportOffset.y, width, height, pos_x, pos_y, w, h );
 }
 
 void GraphicsOpenGL::SaveScreenshot( const std::string& filename )
@@ -1518,6 +2291,12 @@ void GraphicsOpenGL::SaveScreenshot( const std::string& filename )
 	SaveScreenshot( filename, 0, 0, (int)mViewportSize.x, (int)mViewportSize.y );
 }
 
+void GraphicsOpenGL::WaitForScreenshots()
+{
+	if( mScreenshotSaver ) 
+		mScreenshotSaver->Wait();
+}
+
 unsigned char*	GraphicsOpenGL::ImageLoad( char const *filename, int *x, int *y, int *comp, int req_comp )
 {
 	return stbi_load( filename, x, y, comp, req_comp );
@@ -1525,7 +2304,7 @@ unsigned char*	GraphicsOpenGL::ImageLoad( char const *filename, int *x, int *y,
 
 int	GraphicsOpenGL::ImageSave( char const *filename, int x, int y, int comp, const void *data, int stride_bytes )
 {
-	return stbi_write_png( filename, x, y, comp, data, stride_bytes );
+	return ceng::WritePng( filename, x, y, comp, data, stride_bytes ) ? 1 : 0;
 }
 
 //=============================================================================
@@ -38,6 +38,7 @@ class GraphicsOpenGL : public IGraphics
 {
 public:
 	GraphicsOpenGL();
+	~GraphicsOpenGL();
 
 	//-------------------------------------------------------------------------
 
@@ -54,6 +55,10 @@ public:
 	virtual void		SetSettings( const GraphicsSettings& settings );
 	virtual void		SetDrawTextureBuffering( bool buffering );
 	virtual bool		GetDrawTextureBuffering() const;
+	virtual void		SetDrawTextureSorting( bool sorting );
+	virtual bool		GetDrawTextureSorting() const;
+
+	virtual int			GetDrawCallCount() const;
 
 	//-------------------------------------------------------------------------
 
@@ -108,10 +113,19 @@ public:
 
 	virtual void		DrawLines( const std::vector< poro::types::vec2 >& vertices, const types::fcolor& color, bool smooth, float width, bool loop );
 	virtual void		DrawFill( const std::vector< poro::types::vec2 >& vertices, const types::fcolor& color );
+	virtual void		DrawFillBatch( const poro::types::vec2* vertices, const int* offsets, const int* counts, const types::fcolor* colors, int polygon_count );
+	virtual void		DrawColoredTriangles( const poro::types::vec2* vertices, const types::fcolor* colors, int vertex_count );
 	virtual void		DrawTexturedRect( const poro::types::vec2& position, const poro::types::vec2& size, ITexture* itexture,  const types::fcolor& color = poro::GetFColor( 1, 1, 1, 1 ), types::vec2* tex_coords = NULL, int count = 0 );
 	
 	//-------------------------------------------------------------------------
 
+	virtual IMesh*		CreateMesh( const poro::types::vec2* vertices, const types::fcolor* colors, int vertex_count );
+	virtual void		UpdateMesh( IMesh* mesh, int first_vertex, const poro::types::vec2* vertices, const types::fcolor* colors, int count );
+	virtual void		DrawMesh( IMesh* mesh );
+	virtual void		DestroyMesh( IMesh* mesh );
+
+	//-------------------------------------------------------------------------
+
 	virtual IGraphicsBuffer* CreateGraphicsBuffer(int width, int height);
 	virtual void DestroyGraphicsBuffer(IGraphicsBuffer* buffer);
 
@@ -134,6 +148,7 @@ public:
 
 	void SaveScreenshot( const std::string& filename );
 	void SaveScreenshot( const std::string& filename, int x, int y, int w, int h );
+	void WaitForScreenshots();
 
 	//-------------------------------------------------------------------------
 	virtual unsigned char*	ImageLoad( char const *filename, int *x, int *y, int *comp, int req_comp );
@@ -157,6 +172,24 @@ private:
 	class					DrawTextureBuffered;
 	DrawTextureBuffered*	mDrawTextureBuffered;
 	bool					mUseDrawTextureBuffering;
+	bool					mDrawTextureSorting;
+
+	class					TextureAtlas;
+	TextureAtlas*			mTextureAtlas;
+
+	int						mDrawCallCount;
+
+	// scratch buffers for DrawFill(), DrawFillBatch() and 
+	// DrawColoredTriangles(), they only grow
+	std::vector< float >	mFillVertices;
+	std::vector< float >	mFillColors;
+
+	// draws the first vertex_count vertices of the scratch buffers as 
+	// GL_TRIANGLES
+	void DrawFillArrays( int vertex_count, bool blend );
+
+	class					ScreenshotSaver;
+	ScreenshotSaver*		mScreenshotSaver;
 
 };
 
@@ -164,7 +197,7 @@ types::Uint32 GetNextPowerOfTwo(types::Uint32 input);
 
 //-----------------------------------------------------------------------------
 
-// ImageLoad is just a wrapper for stbi_load and stbi_write_png
+// ImageLoad is just a wrapper for stbi_load, ImageSave for ceng::WritePng
 // unsigned char*	ImageLoad( char const *filename, int *x, int *y, int *comp, int req_comp );
 // int				ImageSave( char const *filename, int x, int y, int comp, const void *data, int stride_bytes );
 
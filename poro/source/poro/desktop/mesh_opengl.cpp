@@ -0,0 +1,173 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2010 Petri Purho, Dennis Belfrage
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+#include "mesh_opengl.h"
+#include "../libraries.h"
+
+namespace poro {
+
+namespace {
+
+// copies count vertices into out_vertices and out_colors, returns true if
+// any of them is translucent
+bool MeshCopyVertices( const types::vec2* vertices, const types::fcolor* colors, int count, float* out_vertices, float* out_colors )
+{
+	bool translucent = false;
+	for( int i = 0; i < count; ++i )
+	{
+		*out_vertices++ = vertices[ i ].x;
+		*out_vertices++ = vertices[ i ].y;
+		*out_colors++ = colors[ i ][ 0 ];
+		*out_colors++ = colors[ i ][ 1 ];
+		*out_colors++ = colors[ i ][ 2 ];
+		*out_colors++ = colors[ i ][ 3 ];
+
+		if( colors[ i ][ 3 ] < 1.f )
+			translucent = true;
+	}
+
+	return translucent;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+
+void MeshOpenGL::Init( const types::vec2* vertices, const types::fcolor* colors, int vertex_count )
+{
+	Release();
+
+	mVertexCount = vertex_count - vertex_count % 3;
+	mBlend = false;
+	mUseBuffer = false;
+
+	if( mVertexCount <= 0 )
+	{
+		mVertexCount = 0;
+		return;
+	}
+
+#ifndef PORO_DONT_USE_GLEW
+	mUseBuffer = ( GLEW_VERSION_1_5 != 0 );
+	if( mUseBuffer )
+	{
+		glGenBuffers( 1, (GLuint*)&mBuffer );
+		glBindBuffer( GL_ARRAY_BUFFER, mBuffer );
+		glBufferData( GL_ARRAY_BUFFER, mVertexCount * 6 * sizeof( GLfloat ), NULL, GL_STATIC_DRAW );
+		glBindBuffer( GL_ARRAY_BUFFER, 0 );
+	}
+#endif
+
+	if( mUseBuffer == false )
+	{
+		mVertices.resize( mVertexCount * 2 );
+		mColors.resize( mVertexCount * 4 );
+	}
+
+	Update( 0, vertices, colors, mVertexCount );
+}
+
+void MeshOpenGL::Update( int first_vertex, const types::vec2* vertices, const types::fcolor* colors, int count )
+{
+	poro_assert( first_vertex >= 0 && first_vertex + count <= mVertexCount );
+	if( first_vertex < 0 || count <= 0 || first_vertex + count > mVertexCount )
+		return;
+
+	if( mUseBuffer == false )
+	{
+		if( MeshCopyVertices( vertices, colors, count, &mVertices[ first_vertex * 2 ], &mColors[ first_vertex * 4 ] ) )
+			mBlend = true;
+		return;
+	}
+
+#ifndef PORO_DONT_USE_GLEW
+	std::vector< GLfloat > upload_vertices( count * 2 );
+	std::vector< GLfloat > upload_colors( count * 4 );
+	if( MeshCopyVertices( vertices, colors, count, &upload_vertices[ 0 ], &upload_colors[ 0 ] ) )
+		mBlend = true;
+
+	const GLintptr colors_start = mVertexCount * 2 * sizeof( GLfloat );
+	glBindBuffer( GL_ARRAY_BUFFER, mBuffer );
+	glBufferSubData( GL_ARRAY_BUFFER, first_vertex * 2 * sizeof( GLfloat ), count * 2 * sizeof( GLfloat ), &upload_vertices[ 0 ] );
+	glBufferSubData( GL_ARRAY_BUFFER, colors_start + first_vertex * 4 * sizeof( GLfloat ), count * 4 * sizeof( GLfloat ), &upload_colors[ 0 ] );
+	glBindBuffer( GL_ARRAY_BUFFER, 0 );
+#endif
+}
+
+void MeshOpenGL::Draw()
+{
+	if( mVertexCount == 0 )
+		return;
+
+	if( mBlend ) {
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	}
+
+	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+	if( mUseBuffer )
+	{
+#ifndef PORO_DONT_USE_GLEW
+		// with a buffer bound the pointers are offsets into it
+		const GLintptr colors_start = mVertexCount * 2 * sizeof( GLfloat );
+		glBindBuffer( GL_ARRAY_BUFFER, mBuffer );
+		glVertexPointer(2, GL_FLOAT, 0, (const GLvoid*)0 );
+		glColorPointer(4, GL_FLOAT, 0, (const GLvoid*)colors_start );
+#endif
+	}
+	else
+	{
+		glVertexPointer(2, GL_FLOAT, 0, &mVertices[ 0 ]);
+		glColorPointer(4, GL_FLOAT, 0, &mColors[ 0 ]);
+	}
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glDrawArrays(GL_TRIANGLES, 0, mVertexCount);
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+
+#ifndef PORO_DONT_USE_GLEW
+	if( mUseBuffer )
+		glBindBuffer( GL_ARRAY_BUFFER, 0 );
+#endif
+
+	if( mBlend ) 
+		glDisable(GL_BLEND);
+
+	// the color array leaves the current color undefined
+	glColor4f( 1.f, 1.f, 1.f, 1.f );
+}
+
+void MeshOpenGL::Release()
+{
+#ifndef PORO_DONT_USE_GLEW
+	if( mBuffer != 0 )
+		glDeleteBuffers( 1, (GLuint*)&mBuffer );
+#endif
+
+	mBuffer = 0;
+	mVertexCount = 0;
+	mVertices.clear();
+	mColors.clear();
+}
+
+} // end o namespace poro
@@ -0,0 +1,71 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2010 Petri Purho, Dennis Belfrage
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+#ifndef INC_MESH_OPENGL_H
+#define INC_MESH_OPENGL_H
+
+#include "../imesh.h"
+#include "../poro_types.h"
+
+#include <vector>
+
+namespace poro {
+
+// The positions and the colors are in one vertex buffer object, all the 
+// positions first and then all the colors. Without GLEW or OpenGL 1.5 they
+// are kept in mVertices and mColors and drawn from there as client arrays.
+class MeshOpenGL : public IMesh
+{
+public:
+	MeshOpenGL() : 
+		mBuffer( 0 ),
+		mVertexCount( 0 ),
+		mUseBuffer( false ),
+		mBlend( false ),
+		mVertices(),
+		mColors()
+	{
+	}
+
+	virtual ~MeshOpenGL() { Release(); }
+
+	virtual int GetVertexCount() const { return mVertexCount; }
+
+	void Init( const types::vec2* vertices, const types::fcolor* colors, int vertex_count );
+	void Update( int first_vertex, const types::vec2* vertices, const types::fcolor* colors, int count );
+	void Draw();
+	void Release();
+
+private:
+	types::Uint32			mBuffer;
+	int						mVertexCount;
+	bool					mUseBuffer;
+
+	// set once any of the vertices is translucent
+	bool					mBlend;
+
+	// the client arrays, empty when mUseBuffer is set
+	std::vector< float >	mVertices;
+	std::vector< float >	mColors;
+};
+
+} // end o namespace poro
+
+#endif
@@ -99,7 +99,8 @@ PlatformDesktop::PlatformDesktop() :
 	mMousePos(),
 	mSleepingMode( PORO_MAXIMIZE_SLEEP ),
 	mPrintFramerate( false ),
-	mRandomSeed( 1234567 )
+	mRandomSeed( 1234567 ),
+	mFastPlayback( false )
 {
 	StartCounter();
 }
@@ -187,6 +188,12 @@ void PlatformDesktop::StartMainLoop()
     int					mFrameRateUpdateCounter = 0;
 	types::Double32		mProcessorRate = 0;
 
+	// fast playback doesn't wait for the frames, so the recordings can be 
+	// used to measure how long the same frames take to simulate and render
+	const bool fast_playback = mFastPlayback && mEventRecorder && mEventRecorder->IsPlaybacking();
+	const types::Double32 playback_start_time = GetUpTime();
+	const int playback_start_frame = mFrameCount;
+
 	while( mRunning )
 	{
 	    const types::Double32 time_before = GetUpTime();
@@ -199,10 +206,13 @@ void PlatformDesktop::StartMainLoop()
 
         const types::Double32 time_after = GetUpTime();
         const types::Double32 elapsed_time = ( time_after - time_before );
-        if( elapsed_time < mOneFrameShouldLast )
-            Sleep( mOneFrameShouldLast - elapsed_time );
+		if( fast_playback == false )
+		{
+			if( elapsed_time < mOneFrameShouldLast )
+				Sleep( mOneFrameShouldLast - elapsed_time );
 
-		while( ( GetUpTime() - time_before ) < mOneFrameShouldLast ) { Sleep( 0 ); }
+			while( ( GetUpTime() - time_before ) < mOneFrameShouldLast ) { Sleep( 0 ); }
+		}
 
         // frame-rate check
 		mProcessorRate += ( elapsed_time / mOneFrameShouldLast );
@@ -221,6 +231,15 @@ void PlatformDesktop::StartMainLoop()
 			
 			mProcessorRate = 0;
         }
+
+		if( fast_playback && mEventRecorder->IsPlaybackFinished() )
+		{
+			const int frames = mFrameCount - playback_start_frame;
+			const types::Double32 total_time = GetUpTime() - playback_start_time;
+			std::cout << "Playback finished: " << frames << " frames in " << total_time << " s, " 
+				<< ( frames > 0 ? 1000.0 * total_time / (types::Double32)frames : 0 ) << " ms per frame" << std::endl;
+			mRunning = false;
+		}
 	}
 
 	if( mApplication )
@@ -238,8 +257,10 @@ void PlatformDesktop::SingleLoop()
 	poro_assert( GetApplication() );
 	poro_assert( mGraphics );
 
+	// fast playback always uses the fixed time step, otherwise the frames 
+	// would get a different dt than they were recorded with
 	types::Double32 dt = mOneFrameShouldLast;
-	if( mFixedTimeStep == false )
+	if( mFixedTimeStep == false && ( mFastPlayback == false || mEventRecorder == NULL || mEventRecorder->IsPlaybacking() == false ) )
 	{
 		static types::Double32 last_time_update_called = 0;
 		dt = (types::Double32)( GetUpTime() - last_time_update_called );
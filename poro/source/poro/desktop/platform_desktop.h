@@ -88,6 +88,7 @@ public:
 	
 	virtual void DoEventPlayback( const std::string& filename );
 	virtual bool IsBreakpointFrame();
+	virtual void SetFastPlayback( bool fast_playback );
 
 	// filesystem
 	virtual void				SetWorkingDir( poro::types::string dir = poro::types::string(".") );
@@ -124,6 +125,7 @@ protected:
 	bool							mPrintFramerate;
 	poro::types::string				mWorkingDir;
 	int								mRandomSeed;
+	bool							mFastPlayback;
 
 private:
 };
@@ -170,6 +172,10 @@ inline void PlatformDesktop::SetFrameRate( int targetRate, bool fixed_time_step
 	mFixedTimeStep = fixed_time_step;
 }
 
+inline void PlatformDesktop::SetFastPlayback( bool fast_playback ) {
+	mFastPlayback = fast_playback;
+}
+
 inline int PlatformDesktop::GetFrameRate() {
 	return mFrameRate;
 }
@@ -39,12 +39,15 @@ public:
 		mExternalSizeY( 1.f ),
 		mRealSizeX( 0 ),
 		mRealSizeY( 0 ),
-		mPixelData( NULL )
+		mPixelData( NULL ),
+		mInAtlas( false )
 	{ 
 		mUv[ 0 ] = 0; 
 		mUv[ 1 ] = 0; 
 		mUv[ 2 ] = 0; 
 		mUv[ 3 ] = 0; 
+		mUvOrigin[ 0 ] = 0;
+		mUvOrigin[ 1 ] = 0;
 	}
 
 	TextureOpenGL( TextureOpenGL* other ) : 
@@ -55,12 +58,15 @@ public:
 		mExternalSizeY( other->mExternalSizeY ),
 		mRealSizeX( other->mRealSizeX ),
 		mRealSizeY( other->mRealSizeY ),
-		mPixelData( other->mPixelData )
+		mPixelData( other->mPixelData ),
+		mInAtlas( other->mInAtlas )
 	{ 
 		mUv[ 0 ] = other->mUv[0]; 
 		mUv[ 1 ] = other->mUv[1]; 
 		mUv[ 2 ] = other->mUv[2]; 
 		mUv[ 3 ] = other->mUv[3]; 
+		mUvOrigin[ 0 ] = other->mUvOrigin[0];
+		mUvOrigin[ 1 ] = other->mUvOrigin[1];
 	}
 
 	virtual int GetWidth() const	{ return (int)(((float)mWidth) / mExternalSizeX); } 
@@ -91,10 +97,10 @@ public:
 
 	virtual void SetUVCoords( float x1, float y1, float x2, float y2 ) 
 	{
-		mUv[ 0 ] = x1 * ( (float)mWidth / (float)mRealSizeX );
-		mUv[ 1 ] = y1 * ( (float)mHeight / (float)mRealSizeY );
-		mUv[ 2 ] = x2 * ( (float)mWidth / (float)mRealSizeX );
-		mUv[ 3 ] = y2 * ( (float)mHeight / (float)mRealSizeY );
+		mUv[ 0 ] = mUvOrigin[ 0 ] + x1 * ( (float)mWidth / (float)mRealSizeX );
+		mUv[ 1 ] = mUvOrigin[ 1 ] + y1 * ( (float)mHeight / (float)mRealSizeY );
+		mUv[ 2 ] = mUvOrigin[ 0 ] + x2 * ( (float)mWidth / (float)mRealSizeX );
+		mUv[ 3 ] = mUvOrigin[ 1 ] + y2 * ( (float)mHeight / (float)mRealSizeY );
 	}
 
 	virtual void GetUVCoords( types::vec2& coord1, types::vec2& coord2 )
@@ -118,6 +124,11 @@ public:
 
 	unsigned char*	mPixelData;
 	types::string	mFilename;
+
+	// set for images packed into an atlas by LoadTexture(), mTexture is the
+	// shared atlas texture and the image starts from mUvOrigin in it
+	bool			mInAtlas;
+	float			mUvOrigin[2];
 };
 
 } // end o namespace poro
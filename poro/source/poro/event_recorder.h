@@ -73,6 +73,8 @@ public:
 	//-------------------------------------------------------------------------
 
 	virtual int GetFrameLength() const { return 0; }
+	// true when a playback has run out of recorded frames
+	virtual bool IsPlaybackFinished() const { return false; }
 
 protected:
 	Keyboard* mKeyboard;
@@ -28,6 +28,7 @@
 #include "poro_macros.h"
 #include "itexture.h"
 #include "itexture3d.h"
+#include "imesh.h"
 
 //Number of vertices that can be stored in the DrawTextureBuffer.
 //6000 = 2000 triangles = 1000 quads, since we use GL_TRIANGLES.
@@ -48,13 +49,24 @@ struct GraphicsSettings
 	GraphicsSettings() : 
 		textures_resize_to_power_of_two( true ), 
 		textures_fix_alpha_channel( true ),
-		buffered_textures( false )
+		textures_atlas( false ),
+		textures_atlas_max_size( 256 ),
+		buffered_textures( false ),
+		buffered_textures_sort( false )
     {
 	}
 
 	bool textures_resize_to_power_of_two;
 	bool textures_fix_alpha_channel;
+
+	// LoadTexture() packs images that are at most textures_atlas_max_size 
+	// pixels wide and high into shared atlas textures. Atlas textures can't
+	// be wrapped, have their own filtering or be bound to shaders.
+	bool textures_atlas;
+	int  textures_atlas_max_size;
+
 	bool buffered_textures;
+	bool buffered_textures_sort;
 };
 //-----------------------------
 
@@ -155,15 +167,26 @@ public:
     // The DrawTextureBuffer works so that consecutive calls to DrawTexture are buffered. 
     // The buffer is automatically flushed using a single draw call when one of the following things happen:
     // - The used texture changes.
-    // - The used color changes.
     // - The used blendmode changes.
     // - EndRendering() is called.
     // - Any other Draw function ecept the two DrawTexture() functions are called.
     // - The buffer is full.
     // - Turinging of the buffering.
+    // The color is stored in every vertex, so changing it doesn't flush.
+    //
+    // With sorting on, a sprite is added to an earlier draw call with the 
+    // same texture and blend mode if it doesn't overlap anything that has 
+    // been drawn after that draw call. A texture change then flushes only 
+    // when the sprites actually overlap.
     
     virtual void        SetDrawTextureBuffering( bool buffering ) {}
 	virtual bool		GetDrawTextureBuffering() const { return false; }
+
+	virtual void		SetDrawTextureSorting( bool sorting ) {}
+	virtual bool		GetDrawTextureSorting() const { return false; }
+
+	// number of draw calls in the last finished frame
+	virtual int			GetDrawCallCount() const { return 0; }
 	
     //-------------------------------------------------------------------------
 
@@ -216,6 +239,52 @@ public:
 
 	virtual void		DrawFill( const std::vector< poro::types::vec2 >& vertices, const types::fcolor& color ) { }
 
+	// Draws polygon_count polygons from one flat vertex array. Polygon i is 
+	// counts[i] vertices starting from vertices[ offsets[i] ], drawn with 
+	// colors[i] in the current draw fill mode. Implementations should submit 
+	// the whole batch at once, the default one just calls DrawFill() for 
+	// every polygon.
+	virtual void		DrawFillBatch( const poro::types::vec2* vertices, const int* offsets, const int* counts, const types::fcolor* colors, int polygon_count )
+	{
+		std::vector< poro::types::vec2 > polygon;
+		for( int i = 0; i < polygon_count; ++i )
+		{
+			polygon.assign( vertices + offsets[ i ], vertices + offsets[ i ] + counts[ i ] );
+			DrawFill( polygon, colors[ i ] );
+		}
+	}
+
+	// Draws vertex_count / 3 triangles with a color for every vertex, alpha
+	// blended. Implementations should submit them all at once, the default
+	// one draws every triangle with DrawFill() in the color of its first
+	// vertex.
+	virtual void		DrawColoredTriangles( const poro::types::vec2* vertices, const types::fcolor* colors, int vertex_count )
+	{
+		const int mode = GetDrawFillMode();
+		SetDrawFillMode( DRAWFILL_MODE_FRONT_AND_BACK );
+
+		std::vector< poro::types::vec2 > triangle;
+		for( int i = 0; i + 2 < vertex_count; i += 3 )
+		{
+			triangle.assign( vertices + i, vertices + i + 3 );
+			DrawFill( triangle, colors[ i ] );
+		}
+
+		SetDrawFillMode( mode );
+	}
+
+	//-------------------------------------------------------------------------
+
+	// Retained geometry: vertex_count / 3 triangles with a color for every 
+	// vertex, drawn like DrawColoredTriangles() but the vertices are uploaded
+	// only when the mesh is created or updated. UpdateMesh() replaces count 
+	// vertices starting from first_vertex, the vertex count of a mesh can't 
+	// change.
+	virtual IMesh*		CreateMesh( const poro::types::vec2* vertices, const types::fcolor* colors, int vertex_count );
+	virtual void		UpdateMesh( IMesh* mesh, int first_vertex, const poro::types::vec2* vertices, const types::fcolor* colors, int count );
+	virtual void		DrawMesh( IMesh* mesh );
+	virtual void		DestroyMesh( IMesh* mesh );
+
 	//-------------------------------------------------------------------------
 
 	virtual IGraphicsBuffer* CreateGraphicsBuffer(int width, int height);
@@ -232,9 +301,11 @@ public:
 
 	//-------------------------------------------------------------------------
 
-	// Save screen (only supports .png format)
+	// Save screen (only supports .png format). The file can be written after
+	// these return, WaitForScreenshots() returns when they're all on disk.
 	virtual void SaveScreenshot( const std::string& filename )								{ poro_assert( false && "IMPLEMENTATION NEEDED" ); }
 	virtual void SaveScreenshot( const std::string& filename, int x, int y, int w, int h )	{ poro_assert( false && "IMPLEMENTATION NEEDED" ); }
+	virtual void WaitForScreenshots()														{ }
 
 	//-------------------------------------------------------------------------
 	// Methods for loading and saving images to a pixel buffer
@@ -311,6 +382,24 @@ inline void IGraphics::DestroyGraphicsBuffer(IGraphicsBuffer* buffer){
 	poro_assert( false );
 }
 
+inline IMesh* IGraphics::CreateMesh( const poro::types::vec2* vertices, const types::fcolor* colors, int vertex_count ) {
+	// If this fails, it means you should implement meshes on your end of things
+	poro_assert( false );
+	return NULL;
+}
+inline void IGraphics::UpdateMesh( IMesh* mesh, int first_vertex, const poro::types::vec2* vertices, const types::fcolor* colors, int count ) {
+	// If this fails, it means you should implement meshes on your end of things
+	poro_assert( false );
+}
+inline void IGraphics::DrawMesh( IMesh* mesh ) {
+	// If this fails, it means you should implement meshes on your end of things
+	poro_assert( false );
+}
+inline void IGraphics::DestroyMesh( IMesh* mesh ) {
+	// If this fails, it means you should implement meshes on your end of things
+	poro_assert( false );
+}
+
 inline IRenderTexture* IGraphics::CreateRenderTexture(int width, int height, bool linear_filtering) {
 	// If this fails, it means you should implement render texture on your end of things
 	poro_assert( false );
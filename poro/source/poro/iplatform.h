@@ -116,6 +116,9 @@ public:
 	
 	virtual void DoEventPlayback( const std::string& filename ) { }
 	virtual bool IsBreakpointFrame() { return false; }
+	// runs the playback frames as fast as possible with a fixed time step and
+	// exits with the timings when the playback ends, for performance testing
+	virtual void SetFastPlayback( bool fast_playback )			{ }
 
 	// filesystem
 	virtual void				SetWorkingDir(poro::types::string dir = poro::types::string("."));
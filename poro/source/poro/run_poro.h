@@ -35,6 +35,7 @@ struct AppConfig
 		record_events( true ),
 		do_a_playback( false ),
 		playback_file( "" ),
+		playback_fast( false ),
 		graphics_settings(),
 		report_fps( false ),
 		SetRandomSeed( NULL )
@@ -59,6 +60,8 @@ struct AppConfig
     bool			record_events;
     bool			do_a_playback;
     std::string		playback_file;
+	// runs the playback without the frame rate limit and prints the timings
+	bool			playback_fast;
 
 	bool			report_fps;
 
@@ -95,6 +98,8 @@ int RunPoro( const AppConfig& conf = AppConfig()  )
         if( conf.do_a_playback ) 
             poro->DoEventPlayback( conf.playback_file );
 
+		poro->SetFastPlayback( conf.do_a_playback && conf.playback_fast );
+
 		// set random seed
 		if( conf.SetRandomSeed ) 
             conf.SetRandomSeed( poro->GetRandomSeed() );
@@ -0,0 +1,134 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2010 Petri Purho, Dennis Belfrage
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+#include "../desktop/event_record_format.h"
+#include "../poro_libraries.h"
+
+#ifdef PORO_TESTER_ENABLED
+
+namespace poro {
+namespace test {
+///////////////////////////////////////////////////////////////////////////////
+namespace {
+
+bool IsSameEvent( const RecordedEvent& a, const RecordedEvent& b )
+{
+	return a.type == b.type && a.pos.x == b.pos.x && a.pos.y == b.pos.y && 
+		a.button == b.button && a.unicode == b.unicode;
+}
+
+} // end of anonymous namespace
+///////////////////////////////////////////////////////////////////////////////
+
+int EventRecordFormat_Test()
+{
+	// the frames that are written
+	std::vector< std::vector< RecordedEvent > > frames( 4 );
+	frames[ 0 ].push_back( RecordedEvent( RecordedEvent::RANDOM_SEED, types::vec2(), -123456789 ) );
+	frames[ 0 ].push_back( RecordedEvent( RecordedEvent::KEY_DOWN, types::vec2(), 32, 'a' ) );
+	frames[ 0 ].push_back( RecordedEvent( RecordedEvent::KEY_UP, types::vec2(), 1073741904, 0xFFFF ) );
+	// frame 1 is empty
+	frames[ 2 ].push_back( RecordedEvent( RecordedEvent::MOUSE_MOVE, types::vec2( 100, 200 ), 0 ) );
+	frames[ 2 ].push_back( RecordedEvent( RecordedEvent::MOUSE_DOWN, types::vec2( 100.5f, 199.25f ), 1 ) );
+	frames[ 2 ].push_back( RecordedEvent( RecordedEvent::MOUSE_UP, types::vec2( -3.75f, 0 ), 3 ) );
+	// these can't be stored as 1/256 pixels, so they go in as raw floats
+	frames[ 3 ].push_back( RecordedEvent( RecordedEvent::TOUCH_MOVE, types::vec2( 0.1f, 1.f / 3.f ), 2 ) );
+	frames[ 3 ].push_back( RecordedEvent( RecordedEvent::TOUCH_DOWN, types::vec2( 1e9f, -1e9f ), 4 ) );
+	frames[ 3 ].push_back( RecordedEvent( RecordedEvent::TOUCH_UP, types::vec2( 640, 480 ), 4 ) );
+
+	std::vector< unsigned char > data;
+	{
+		EventRecordEncoder encoder;
+		encoder.WriteHeader( data );
+		for( std::size_t i = 0; i < frames.size(); ++i ) 
+		{
+			for( std::size_t j = 0; j < frames[ i ].size(); ++j )
+				encoder.AddEvent( frames[ i ][ j ] );
+			encoder.EndFrame( (int)i * 10, data );
+		}
+	}
+
+	test_assert( EventRecordDecoder::IsBinary( &data[ 0 ], (int)data.size() ) );
+
+	// everything comes back as it was
+	{
+		EventRecordDecoder decoder( &data[ 0 ], (int)data.size() );
+		test_assert( decoder.ReadHeader() );
+
+		int frame_ms = -1;
+		std::vector< RecordedEvent > events;
+		for( std::size_t i = 0; i < frames.size(); ++i ) 
+		{
+			test_assert( decoder.ReadFrame( frame_ms, events ) );
+			test_assert( frame_ms == (int)i * 10 );
+			test_assert( events.size() == frames[ i ].size() );
+			for( std::size_t j = 0; j < events.size(); ++j )
+				test_assert( IsSameEvent( events[ j ], frames[ i ][ j ] ) );
+		}
+
+		test_assert( decoder.ReadFrame( frame_ms, events ) == false );
+		test_assert( decoder.IsBroken() == false );
+	}
+
+	// the small moves are delta encoded, so a frame of them stays small
+	{
+		std::vector< unsigned char > moves;
+		EventRecordEncoder encoder;
+		for( int i = 0; i < 100; ++i )
+			encoder.AddEvent( RecordedEvent( RecordedEvent::MOUSE_MOVE, types::vec2( 500.f + i, 300.f - i ), 0 ) );
+		encoder.EndFrame( 16, moves );
+		
+		// the first one is far from the origin
+		test_assert( moves.size() < 100 * 5 + 20 );
+	}
+
+	// a cut file reads the whole frames and then stops
+	{
+		EventRecordDecoder decoder( &data[ 0 ], (int)data.size() - 1 );
+		test_assert( decoder.ReadHeader() );
+
+		int frame_ms = 0;
+		std::vector< RecordedEvent > events;
+		int frame_count = 0;
+		while( decoder.ReadFrame( frame_ms, events ) )
+			frame_count++;
+
+		test_assert( frame_count == (int)frames.size() - 1 );
+		test_assert( decoder.IsBroken() );
+	}
+
+	// not a binary file, like the old text playbacks
+	{
+		const std::string text = "0, 16 ms : randomseed 1234";
+		test_assert( EventRecordDecoder::IsBinary( (const unsigned char*)text.c_str(), (int)text.size() ) == false );
+
+		EventRecordDecoder decoder( (const unsigned char*)text.c_str(), (int)text.size() );
+		test_assert( decoder.ReadHeader() == false );
+	}
+
+	return 0;
+}
+
+TEST_REGISTER( EventRecordFormat_Test );
+
+} // end of namespace test
+} // end of namespace poro
+
+#endif
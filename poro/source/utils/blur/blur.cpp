@@ -0,0 +1,408 @@
+#include "blur.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "../threadpool/cthreadpool.h"
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#	define CENG_BLUR_SSE2
+#	include <emmintrin.h>
+#endif
+
+namespace ceng {
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+	// rows in one task of the horizontal pass
+	const int BLUR_BAND_ROWS = 16;
+
+	// pixels in one column tile of the vertical pass, a tile row is 256 bytes
+	const int BLUR_TILE_WIDTH = 64;
+
+	const int BLUR_MAX_PASSES = 3;
+
+	struct BlurPasses
+	{
+		BlurPasses() : count( 0 ) { }
+
+		int radius[ BLUR_MAX_PASSES ];
+		int count;
+	};
+
+	//-------------------------------------------------------------------------
+	// The running sum of the four channels of a pixel
+
+#ifdef CENG_BLUR_SSE2
+	typedef __m128i BlurSum;
+	typedef __m128	BlurScale;
+
+	inline BlurScale BlurMakeScale( int count )	{ return _mm_set1_ps( 1.f / count ); }
+	inline void BlurSumZero( BlurSum& sum )		{ sum = _mm_setzero_si128(); }
+
+	inline __m128i BlurLoad( const unsigned char* p )
+	{
+		int value;
+		memcpy( &value, p, 4 );
+		const __m128i zero = _mm_setzero_si128();
+		return _mm_unpacklo_epi16( _mm_unpacklo_epi8( _mm_cvtsi32_si128( value ), zero ), zero );
+	}
+
+	inline void BlurSumAdd( BlurSum& sum, const unsigned char* p )
+	{
+		sum = _mm_add_epi32( sum, BlurLoad( p ) );
+	}
+
+	inline void BlurSumSlide( BlurSum& sum, const unsigned char* add, const unsigned char* remove )
+	{
+		sum = _mm_add_epi32( sum, _mm_sub_epi32( BlurLoad( add ), BlurLoad( remove ) ) );
+	}
+
+	inline void BlurSumStore( unsigned char* p, const BlurSum& sum, const BlurScale& scale )
+	{
+		__m128i value = _mm_cvtps_epi32( _mm_mul_ps( _mm_cvtepi32_ps( sum ), scale ) );
+		value = _mm_packs_epi32( value, value );
+		value = _mm_packus_epi16( value, value );
+		const int result = _mm_cvtsi128_si32( value );
+		memcpy( p, &result, 4 );
+	}
+#else
+	struct BlurSum { int c[ 4 ]; };
+	typedef float BlurScale;
+
+	inline BlurScale BlurMakeScale( int count )	{ return 1.f / count; }
+
+	inline void BlurSumZero( BlurSum& sum )
+	{
+		sum.c[ 0 ] = sum.c[ 1 ] = sum.c[ 2 ] = sum.c[ 3 ] = 0;
+	}
+
+	inline void BlurSumAdd( BlurSum& sum, const unsigned char* p )
+	{
+		for( int i = 0; i < 4; ++i )
+			sum.c[ i ] += p[ i ];
+	}
+
+	inline void BlurSumSlide( BlurSum& sum, const unsigned char* add, const unsigned char* remove )
+	{
+		for( int i = 0; i < 4; ++i )
+			sum.c[ i ] += add[ i ] - remove[ i ];
+	}
+
+	inline void BlurSumStore( unsigned char* p, const BlurSum& sum, const BlurScale& scale )
+	{
+		for( int i = 0; i < 4; ++i )
+			p[ i ] = (unsigned char)( sum.c[ i ] * scale + 0.5f );
+	}
+#endif
+
+	//-------------------------------------------------------------------------
+
+	// Copies count pixels that are step bytes apart into out, with radius
+	// copies of the first pixel in front and radius + 1 copies of the last
+	// one after them. The extra one is read by the last slide of the sum.
+	void BlurPadLine( const unsigned char* line, int step, int count, int radius, std::vector< unsigned char >& out )
+	{
+		out.resize( ( count + 2 * radius + 1 ) * 4 );
+		unsigned char* p = &out[ 0 ];
+		for( int i = 0; i < radius; ++i, p += 4 )
+			memcpy( p, line, 4 );
+
+		for( int i = 0; i < count; ++i, p += 4 )
+			memcpy( p, line + i * step, 4 );
+
+		for( int i = 0; i <= radius; ++i, p += 4 )
+			memcpy( p, line + ( count - 1 ) * step, 4 );
+	}
+
+	// src is a line padded by BlurPadLine()
+	void BlurLine( const unsigned char* src, unsigned char* dst, int count, int radius )
+	{
+		const int size = 2 * radius + 1;
+		const BlurScale scale = BlurMakeScale( size );
+
+		BlurSum sum;
+		BlurSumZero( sum );
+		for( int i = 0; i < size; ++i )
+			BlurSumAdd( sum, src + i * 4 );
+
+		for( int x = 0; x < count; ++x )
+		{
+			BlurSumStore( dst + x * 4, sum, scale );
+			BlurSumSlide( sum, src + ( x + size ) * 4, src + x * 4 );
+		}
+	}
+
+	//-------------------------------------------------------------------------
+
+	struct BlurImage
+	{
+		unsigned char*		rgba;
+		int					width;
+		int					height;
+		int					stride;
+		const BlurPasses*	passes;
+	};
+
+	struct BlurRowsBody
+	{
+		BlurImage image;
+
+		void operator()( int band )
+		{
+			std::vector< unsigned char > line;
+			const int end = std::min( image.height, ( band + 1 ) * BLUR_BAND_ROWS );
+			for( int y = band * BLUR_BAND_ROWS; y < end; ++y )
+			{
+				unsigned char* row = image.rgba + y * image.stride;
+				for( int i = 0; i < image.passes->count; ++i )
+				{
+					BlurPadLine( row, 4, image.width, image.passes->radius[ i ], line );
+					BlurLine( &line[ 0 ], row, image.width, image.passes->radius[ i ] );
+				}
+			}
+		}
+	};
+
+	// All the columns of a tile are summed at the same time, one row after
+	// another, so the reads and writes go along the rows
+	struct BlurColumnsBody
+	{
+		BlurImage image;
+
+		void operator()( int tile )
+		{
+			const int x0 = tile * BLUR_TILE_WIDTH;
+			const int tile_width = std::min( BLUR_TILE_WIDTH, image.width - x0 );
+			const int row_bytes = tile_width * 4;
+
+			std::vector< unsigned char > padded;
+			BlurSum sums[ BLUR_TILE_WIDTH ];
+
+			for( int i = 0; i < image.passes->count; ++i )
+			{
+				const int radius = image.passes->radius[ i ];
+				const int size = 2 * radius + 1;
+				const BlurScale scale = BlurMakeScale( size );
+
+				// the tile with the edge rows repeated, see BlurPadLine()
+				padded.resize( ( image.height + size ) * row_bytes );
+				for( int y = 0; y < image.height + size; ++y )
+				{
+					const int src_y = std::min( std::max( y - radius, 0 ), image.height - 1 );
+					memcpy( &padded[ y * row_bytes ], image.rgba + src_y * image.stride + x0 * 4, row_bytes );
+				}
+
+				for( int x = 0; x < tile_width; ++x )
+					BlurSumZero( sums[ x ] );
+
+				for( int y = 0; y < size; ++y )
+				{
+					const unsigned char* src = &padded[ y * row_bytes ];
+					for( int x = 0; x < tile_width; ++x )
+						BlurSumAdd( sums[ x ], src + x * 4 );
+				}
+
+				for( int y = 0; y < image.height; ++y )
+				{
+					unsigned char* dst = image.rgba + y * image.stride + x0 * 4;
+					const unsigned char* add = &padded[ ( y + size ) * row_bytes ];
+					const unsigned char* remove = &padded[ y * row_bytes ];
+					for( int x = 0; x < tile_width; ++x )
+					{
+						BlurSumStore( dst + x * 4, sums[ x ], scale );
+						BlurSumSlide( sums[ x ], add + x * 4, remove + x * 4 );
+					}
+				}
+			}
+		}
+	};
+
+	void BlurWithPool( CThreadPool& pool, unsigned char* rgba, int width, int height, int stride, const BlurPasses& passes )
+	{
+		if( rgba == NULL || width <= 0 || height <= 0 || passes.count <= 0 )
+			return;
+
+		BlurRowsBody rows;
+		rows.image.rgba = rgba;
+		rows.image.width = width;
+		rows.image.height = height;
+		rows.image.stride = stride;
+		rows.image.passes = &passes;
+		ParallelFor( pool, ( height + BLUR_BAND_ROWS - 1 ) / BLUR_BAND_ROWS, rows );
+
+		BlurColumnsBody columns;
+		columns.image = rows.image;
+		ParallelFor( pool, ( width + BLUR_TILE_WIDTH - 1 ) / BLUR_TILE_WIDTH, columns );
+	}
+
+	// Box sizes for three box blurs that come out close to a gaussian, from
+	// "Fast Almost-Gaussian Filtering" by Peter Kovesi
+	BlurPasses GetGaussianPasses( float sigma )
+	{
+		BlurPasses result;
+		if( sigma <= 0 )
+			return result;
+
+		const int n = BLUR_MAX_PASSES;
+		const double variance = 12.0 * sigma * sigma;
+		int lower = (int)floor( sqrt( variance / n + 1 ) );
+		if( lower % 2 == 0 )
+			--lower;
+
+		const int upper = lower + 2;
+		const int lower_count = (int)floor( ( variance - n * lower * lower - 4.0 * n * lower - 3.0 * n ) / ( -4.0 * lower - 4.0 ) + 0.5 );
+
+		for( int i = 0; i < n; ++i )
+		{
+			const int radius = ( ( i < lower_count ? lower : upper ) - 1 ) / 2;
+			if( radius > 0 )
+				result.radius[ result.count++ ] = radius;
+		}
+
+		return result;
+	}
+
+	//-------------------------------------------------------------------------
+
+	struct GlowBrightBody
+	{
+		const unsigned char*	rgba;
+		int						width;
+		int						height;
+		int						stride;
+		unsigned char*			glow;
+		const unsigned char*	table;
+
+		void operator()( int band )
+		{
+			const int end = std::min( height, ( band + 1 ) * BLUR_BAND_ROWS );
+			for( int y = band * BLUR_BAND_ROWS; y < end; ++y )
+			{
+				const unsigned char* src = rgba + y * stride;
+				unsigned char* dst = glow + y * width * 4;
+				for( int x = 0; x < width * 4; x += 4 )
+				{
+					dst[ x + 0 ] = table[ src[ x + 0 ] ];
+					dst[ x + 1 ] = table[ src[ x + 1 ] ];
+					dst[ x + 2 ] = table[ src[ x + 2 ] ];
+					dst[ x + 3 ] = 0;
+				}
+			}
+		}
+	};
+
+	struct GlowAddBody
+	{
+		unsigned char*			rgba;
+		int						width;
+		int						height;
+		int						stride;
+		const unsigned char*	glow;
+		const unsigned char*	table;
+
+		void operator()( int band )
+		{
+			const int end = std::min( height, ( band + 1 ) * BLUR_BAND_ROWS );
+			for( int y = band * BLUR_BAND_ROWS; y < end; ++y )
+			{
+				unsigned char* dst = rgba + y * stride;
+				const unsigned char* src = glow + y * width * 4;
+				for( int x = 0; x < width * 4; x += 4 )
+				{
+					dst[ x + 0 ] = (unsigned char)std::min( 255, dst[ x + 0 ] + table[ src[ x + 0 ] ] );
+					dst[ x + 1 ] = (unsigned char)std::min( 255, dst[ x + 1 ] + table[ src[ x + 1 ] ] );
+					dst[ x + 2 ] = (unsigned char)std::min( 255, dst[ x + 2 ] + table[ src[ x + 2 ] ] );
+				}
+			}
+		}
+	};
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+
+void BoxBlur( unsigned char* rgba, int width, int height, int stride, int radius, int thread_count )
+{
+	BlurPasses passes;
+	if( radius > 0 )
+		passes.radius[ passes.count++ ] = radius;
+
+	CThreadPool pool( thread_count );
+	BlurWithPool( pool, rgba, width, height, stride, passes );
+}
+
+void GaussianBlur( unsigned char* rgba, int width, int height, int stride, float sigma, int thread_count )
+{
+	CThreadPool pool( thread_count );
+	BlurWithPool( pool, rgba, width, height, stride, GetGaussianPasses( sigma ) );
+}
+
+void BoxBlur( unsigned char* rgba, int width, int height, int stride, int radius, CThreadPool& pool )
+{
+	BlurPasses passes;
+	if( radius > 0 )
+		passes.radius[ passes.count++ ] = radius;
+
+	BlurWithPool( pool, rgba, width, height, stride, passes );
+}
+
+void GaussianBlur( unsigned char* rgba, int width, int height, int stride, float sigma, CThreadPool& pool )
+{
+	BlurWithPool( pool, rgba, width, height, stride, GetGaussianPasses( sigma ) );
+}
+
+//-----------------------------------------------------------------------------
+
+void ApplyGlow( unsigned char* rgba, int width, int height, int stride, const GlowSettings& settings )
+{
+	const BlurPasses passes = GetGaussianPasses( settings.sigma );
+	const float threshold = std::min( std::max( settings.threshold, 0.f ), 1.f ) * 255.f;
+	if( rgba == NULL || width <= 0 || height <= 0 || settings.strength <= 0 || threshold >= 255.f )
+		return;
+
+	// the part of a channel that is over the threshold, stretched back to 
+	// 0 - 255, and how much a glow value adds to the image
+	unsigned char bright_table[ 256 ];
+	unsigned char add_table[ 256 ];
+	for( int i = 0; i < 256; ++i )
+	{
+		const float bright = std::max( 0.f, i - threshold ) * 255.f / ( 255.f - threshold );
+		bright_table[ i ] = (unsigned char)( bright + 0.5f );
+		add_table[ i ] = (unsigned char)std::min( 255.f, i * settings.strength + 0.5f );
+	}
+
+	std::vector< unsigned char > glow( width * height * 4 );
+	const int bands = ( height + BLUR_BAND_ROWS - 1 ) / BLUR_BAND_ROWS;
+
+	CThreadPool own_pool( settings.pool ? 1 : settings.thread_count );
+	CThreadPool& pool = settings.pool ? *settings.pool : own_pool;
+
+	GlowBrightBody bright;
+	bright.rgba = rgba;
+	bright.width = width;
+	bright.height = height;
+	bright.stride = stride;
+	bright.glow = &glow[ 0 ];
+	bright.table = bright_table;
+	ParallelFor( pool, bands, bright );
+
+	BlurWithPool( pool, &glow[ 0 ], width, height, width * 4, passes );
+
+	GlowAddBody add;
+	add.rgba = rgba;
+	add.width = width;
+	add.height = height;
+	add.stride = stride;
+	add.glow = &glow[ 0 ];
+	add.table = add_table;
+	ParallelFor( pool, bands, add );
+}
+
+//-----------------------------------------------------------------------------
+
+} // end of namespace ceng
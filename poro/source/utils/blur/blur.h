@@ -0,0 +1,106 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2003 - 2011 Petri Purho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Blur
+// ====
+//
+// Box and gaussian blurs for rgba images, and a glow made out of them, so
+// that exports can get the same kind of bloom the post fx glow passes give
+// on screen.
+//
+// The box blur keeps a running sum, so every pixel costs the same no matter
+// how big the radius is. The sums are kept for all four channels of a pixel
+// at once with SSE2 when it's available. Rows are blurred in bands and
+// columns in tiles that are narrow enough to stay in the cache, both spread
+// over a CThreadPool. The edges are repeated, like GL_CLAMP_TO_EDGE.
+//
+// GaussianBlur() runs three box blurs with sizes picked so that the result
+// is close to a gaussian with the given standard deviation.
+//
+//.............................................................................
+//
+// Usage:
+//
+//	ceng::GlowSettings glow;
+//	glow.sigma = 12;
+//	glow.threshold = 0.6f;
+//	ceng::ApplyGlow( pixels, w, h, w * 4, glow );
+//
+//=============================================================================
+#ifndef INC_BLUR_H
+#define INC_BLUR_H
+
+#include <cstddef>
+
+namespace ceng {
+
+class CThreadPool;
+
+//-----------------------------------------------------------------------------
+
+// Every pixel becomes the average of the ( 2 * radius + 1 )^2 pixels around
+// it. stride is the number of bytes between rows. thread_count <= 0 uses one
+// thread per core.
+void BoxBlur( unsigned char* rgba, int width, int height, int stride, int radius, int thread_count = 0 );
+
+// close to a gaussian blur with sigma as the standard deviation in pixels
+void GaussianBlur( unsigned char* rgba, int width, int height, int stride, float sigma, int thread_count = 0 );
+
+// the same two on a pool the caller already has, so that no threads get 
+// started. Must not be a pool that the caller is running a task on.
+void BoxBlur( unsigned char* rgba, int width, int height, int stride, int radius, CThreadPool& pool );
+void GaussianBlur( unsigned char* rgba, int width, int height, int stride, float sigma, CThreadPool& pool );
+
+//-----------------------------------------------------------------------------
+
+struct GlowSettings
+{
+	GlowSettings() : sigma( 8 ), strength( 1 ), threshold( 0.5f ), thread_count( 0 ), pool( NULL ) { }
+
+	// how far the glow spreads, see GaussianBlur()
+	float sigma;
+
+	// the blurred glow is multiplied by this before it's added
+	float strength;
+
+	// 0 - 1, channels darker than this don't glow
+	float threshold;
+
+	// thread_count <= 0 uses one thread per core
+	int thread_count;
+
+	// if set, the glow is done on this pool and thread_count is ignored.
+	// Must not be a pool that the caller is running a task on.
+	CThreadPool* pool;
+};
+
+// Takes the parts of the image that are brighter than threshold, blurs them
+// and adds them back on top. Alpha isn't touched.
+void ApplyGlow( unsigned char* rgba, int width, int height, int stride, const GlowSettings& settings = GlowSettings() );
+
+//-----------------------------------------------------------------------------
+
+} // end of namespace ceng
+
+#endif
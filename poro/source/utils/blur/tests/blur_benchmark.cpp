@@ -0,0 +1,90 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2003 - 2011 Petri Purho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+
+
+// Times the blurs on a print sized card back. Only built when
+// CENG_BLUR_BENCHMARK is defined.
+
+#include "../blur.h"
+#include "../../timer/ctimer.h"
+#include "../../debug.h"
+
+#include <iostream>
+#include <vector>
+
+#if defined( CENG_TESTER_ENABLED ) && defined( CENG_BLUR_BENCHMARK )
+
+namespace ceng {
+namespace test {
+
+int BlurBenchmark()
+{
+	// 300 dpi card back
+	const int width = 2700;
+	const int height = 3800;
+	std::vector< unsigned char > pixels( width * height * 4 );
+	for( int y = 0; y < height; ++y )
+	{
+		for( int x = 0; x < width; ++x )
+		{
+			const int cell = ( ( x / 150 ) * 7 + ( y / 150 ) * 13 + ( ( x % 150 ) > ( y % 150 ) ) ) % 9;
+			unsigned char* p = &pixels[ ( y * width + x ) * 4 ];
+			p[ 0 ] = (unsigned char)( cell * 25 );
+			p[ 1 ] = (unsigned char)( cell * 53 );
+			p[ 2 ] = (unsigned char)( ( x + y ) / 30 );
+			p[ 3 ] = 255;
+		}
+	}
+
+	const int threads[] = { 1, 0 };
+	for( int t = 0; t < 2; ++t )
+	{
+		const char* name = threads[ t ] ? "1 thread" : "all cores";
+
+		CTimer timer;
+		BoxBlur( &pixels[ 0 ], width, height, width * 4, 30, threads[ t ] );
+		std::cout << "BoxBlur( radius 30, " << name << " ): " << timer.GetTime() << " ms" << std::endl;
+
+		const float sigmas[] = { 4.f, 32.f };
+		for( int s = 0; s < 2; ++s )
+		{
+			timer.Reset();
+			GaussianBlur( &pixels[ 0 ], width, height, width * 4, sigmas[ s ], threads[ t ] );
+			std::cout << "GaussianBlur( sigma " << sigmas[ s ] << ", " << name << " ): " << timer.GetTime() << " ms" << std::endl;
+		}
+
+		GlowSettings settings;
+		settings.sigma = 24;
+		settings.thread_count = threads[ t ];
+		timer.Reset();
+		ApplyGlow( &pixels[ 0 ], width, height, width * 4, settings );
+		std::cout << "ApplyGlow( sigma 24, " << name << " ): " << timer.GetTime() << " ms" << std::endl;
+	}
+
+	return 0;
+}
+
+TEST_REGISTER( BlurBenchmark );
+
+} // end of namespace test
+} // end of namespace ceng
+
+#endif
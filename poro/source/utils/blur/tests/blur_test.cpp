@@ -0,0 +1,187 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2003 - 2011 Petri Purho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+
+
+#include "../blur.h"
+#include "../../threadpool/cthreadpool.h"
+#include "../../random/random.h"
+#include "../../debug.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#ifdef CENG_TESTER_ENABLED
+
+namespace ceng {
+namespace test {
+
+namespace {
+
+// box blur straight from the definition, one axis at a time, in doubles
+void BlurTest_Box( std::vector< double >& pixels, int width, int height, int radius, bool horizontal )
+{
+	const std::vector< double > src = pixels;
+	for( int y = 0; y < height; ++y )
+	{
+		for( int x = 0; x < width; ++x )
+		{
+			for( int c = 0; c < 4; ++c )
+			{
+				double sum = 0;
+				for( int i = -radius; i <= radius; ++i )
+				{
+					const int sx = horizontal ? std::min( std::max( x + i, 0 ), width - 1 ) : x;
+					const int sy = horizontal ? y : std::min( std::max( y + i, 0 ), height - 1 );
+					sum += src[ ( sy * width + sx ) * 4 + c ];
+				}
+				pixels[ ( y * width + x ) * 4 + c ] = sum / ( 2 * radius + 1 );
+			}
+		}
+	}
+}
+
+} // end of anonymous namespace
+
+int BlurTest()
+{
+	CLGMRandom random;
+	random.SetSeed( 1234 );
+
+	// against the definition, with padding between the rows that mustn't
+	// change. Radiuses bigger than the image are fine too.
+	{
+		CThreadPool pool( 3 );
+		const int sizes[][ 2 ] = { { 1, 1 }, { 7, 3 }, { 50, 70 }, { 130, 9 } };
+		const int radiuses[] = { 1, 2, 5, 40, 200 };
+		for( int s = 0; s < (int)( sizeof( sizes ) / sizeof( sizes[ 0 ] ) ); ++s )
+		{
+			for( int r = 0; r < (int)( sizeof( radiuses ) / sizeof( radiuses[ 0 ] ) ); ++r )
+			{
+				const int width = sizes[ s ][ 0 ];
+				const int height = sizes[ s ][ 1 ];
+				const int stride = width * 4 + 8;
+
+				std::vector< unsigned char > image( stride * height, 77 );
+				std::vector< double > expected( width * height * 4 );
+				for( int y = 0; y < height; ++y )
+				{
+					for( int x = 0; x < width * 4; ++x )
+					{
+						image[ y * stride + x ] = (unsigned char)random.Random( 0, 255 );
+						expected[ y * width * 4 + x ] = image[ y * stride + x ];
+					}
+				}
+
+				std::vector< unsigned char > threaded = image;
+				std::vector< unsigned char > pooled = image;
+				BoxBlur( &image[ 0 ], width, height, stride, radiuses[ r ], 1 );
+				BoxBlur( &threaded[ 0 ], width, height, stride, radiuses[ r ], 4 );
+				BoxBlur( &pooled[ 0 ], width, height, stride, radiuses[ r ], pool );
+				test_assert( image == threaded );
+				test_assert( image == pooled );
+
+				BlurTest_Box( expected, width, height, radiuses[ r ], true );
+				BlurTest_Box( expected, width, height, radiuses[ r ], false );
+
+				// the horizontal pass is rounded to bytes before the vertical one
+				for( int y = 0; y < height; ++y )
+				{
+					for( int x = 0; x < width * 4; ++x )
+						test_assert( std::fabs( image[ y * stride + x ] - expected[ y * width * 4 + x ] ) <= 1.0 );
+
+					for( int x = width * 4; x < stride; ++x )
+						test_assert( image[ y * stride + x ] == 77 );
+				}
+			}
+		}
+	}
+
+	// a single dot spreads out like a gaussian with the given sigma
+	{
+		const int size = 201;
+		const float sigmas[] = { 2.f, 5.f, 12.f };
+		for( int s = 0; s < (int)( sizeof( sigmas ) / sizeof( sigmas[ 0 ] ) ); ++s )
+		{
+			// a wide line, so that the bytes don't round the tails away
+			std::vector< unsigned char > image( size * size * 4, 0 );
+			for( int y = 0; y < size; ++y )
+				image[ ( y * size + size / 2 ) * 4 ] = 255;
+
+			GaussianBlur( &image[ 0 ], size, size, size * 4, sigmas[ s ] );
+
+			double sum = 0;
+			double variance = 0;
+			for( int x = 0; x < size; ++x )
+			{
+				const double value = image[ ( size / 2 * size + x ) * 4 ];
+				sum += value;
+				variance += value * ( x - size / 2 ) * ( x - size / 2 );
+			}
+			variance /= sum;
+			test_assert( std::fabs( sqrt( variance ) - sigmas[ s ] ) < 0.15 * sigmas[ s ] );
+			test_assert( std::fabs( sum - 255 ) < 0.1 * 255 );
+		}
+	}
+
+	// glow
+	{
+		const int width = 64;
+		const int height = 40;
+		std::vector< unsigned char > image( width * height * 4 );
+		for( int i = 0; i < (int)image.size(); ++i )
+			image[ i ] = (unsigned char)random.Random( 0, 100 );
+
+		// nothing is over the threshold
+		GlowSettings settings;
+		settings.sigma = 4;
+		settings.threshold = 0.5f;
+		std::vector< unsigned char > result = image;
+		ApplyGlow( &result[ 0 ], width, height, width * 4, settings );
+		test_assert( result == image );
+
+		// a bright spot brightens its surroundings, alpha stays the same
+		unsigned char* spot = &image[ ( 20 * width + 30 ) * 4 ];
+		spot[ 0 ] = spot[ 1 ] = spot[ 2 ] = 255;
+		result = image;
+		settings.strength = 2;
+		ApplyGlow( &result[ 0 ], width, height, width * 4, settings );
+		for( int i = 0; i < (int)image.size(); ++i )
+		{
+			if( i % 4 == 3 )
+				test_assert( result[ i ] == image[ i ] );
+			else
+				test_assert( result[ i ] >= image[ i ] );
+		}
+
+		test_assert( result[ ( 20 * width + 32 ) * 4 ] > image[ ( 20 * width + 32 ) * 4 ] );
+		test_assert( result[ ( 2 * width + 2 ) * 4 ] == image[ ( 2 * width + 2 ) * 4 ] );
+	}
+
+	return 0;
+}
+
+TEST_REGISTER( BlurTest );
+
+} // end of namespace test
+} // end of namespace ceng
+
+#endif
@@ -0,0 +1,316 @@
+#include "cclut_baker.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "../threadpool/cthreadpool.h"
+
+namespace ceng {
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+	const int CLUT_BAKER_LEAF_SIZE = 8;
+
+	struct ClutBakerSortByAxis
+	{
+		explicit ClutBakerSortByAxis( int axis ) : axis( axis ) { }
+
+		template< class T >
+		bool operator()( const T& a, const T& b ) const
+		{
+			return a.x[ axis ] < b.x[ axis ];
+		}
+
+		int axis;
+	};
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+
+struct CClutBaker::SearchState
+{
+	int x[ 3 ];
+
+	// squared distance to the closest defined cells and the sum of their
+	// colors
+	int best_dist;
+	int sum_r;
+	int sum_g;
+	int sum_b;
+	int count;
+
+	void Reset( int cx, int cy, int cz )
+	{
+		x[ 0 ] = cx;
+		x[ 1 ] = cy;
+		x[ 2 ] = cz;
+		best_dist = std::numeric_limits< int >::max();
+		sum_r = 0;
+		sum_g = 0;
+		sum_b = 0;
+		count = 0;
+	}
+
+	void Add( const Point& point, int dist )
+	{
+		if( dist < best_dist )
+		{
+			best_dist = dist;
+			sum_r = 0;
+			sum_g = 0;
+			sum_b = 0;
+			count = 0;
+		}
+
+		sum_r += point.r;
+		sum_g += point.g;
+		sum_b += point.b;
+		++count;
+	}
+};
+
+struct CClutBaker::BakeBody
+{
+	CClutBaker* baker;
+
+	void operator()( int x ) { baker->BakeSlice( x ); }
+};
+
+//-----------------------------------------------------------------------------
+
+CClutBaker::CClutBaker() :
+	mSize( 0 ),
+	mCells(),
+	mDefined(),
+	mPoints(),
+	mNodes()
+{
+}
+
+CClutBaker::CClutBaker( int size ) :
+	mSize( 0 ),
+	mCells(),
+	mDefined(),
+	mPoints(),
+	mNodes()
+{
+	Reset( size );
+}
+
+void CClutBaker::Reset( int size )
+{
+	mSize = std::max( 0, size );
+	mCells.assign( mSize * mSize * mSize, 0 );
+	mDefined.assign( mSize * mSize * mSize, 0 );
+	mPoints.clear();
+	mNodes.clear();
+}
+
+void CClutBaker::SetCell( int index, uint32 color )
+{
+	mCells[ index ] = color;
+	mDefined[ index ] = 0;
+}
+
+void CClutBaker::SetDefined( int index, uint32 color )
+{
+	mCells[ index ] = color;
+	mDefined[ index ] = 1;
+}
+
+//-----------------------------------------------------------------------------
+
+void CClutBaker::BuildPoints()
+{
+	mPoints.clear();
+	mNodes.clear();
+
+	for( int i = 0; i < (int)mCells.size(); ++i )
+	{
+		if( mDefined[ i ] == 0 )
+			continue;
+
+		const CColorUint8 color( mCells[ i ] );
+
+		Point point;
+		point.x[ 0 ] = i / ( mSize * mSize );
+		point.x[ 1 ] = ( i / mSize ) % mSize;
+		point.x[ 2 ] = i % mSize;
+		point.r = color.GetR8();
+		point.g = color.GetG8();
+		point.b = color.GetB8();
+		mPoints.push_back( point );
+	}
+}
+
+int CClutBaker::BuildNode( int begin, int end )
+{
+	const int result = (int)mNodes.size();
+	mNodes.push_back( Node() );
+
+	Node node;
+	node.axis = -1;
+	node.split = 0;
+	node.left = -1;
+	node.right = -1;
+	node.begin = begin;
+	node.end = end;
+
+	if( end - begin > CLUT_BAKER_LEAF_SIZE )
+	{
+		// split along the axis with the biggest spread
+		int min_v[ 3 ] = { mPoints[ begin ].x[ 0 ], mPoints[ begin ].x[ 1 ], mPoints[ begin ].x[ 2 ] };
+		int max_v[ 3 ] = { min_v[ 0 ], min_v[ 1 ], min_v[ 2 ] };
+		for( int i = begin + 1; i < end; ++i )
+		{
+			for( int a = 0; a < 3; ++a )
+			{
+				min_v[ a ] = std::min( min_v[ a ], mPoints[ i ].x[ a ] );
+				max_v[ a ] = std::max( max_v[ a ], mPoints[ i ].x[ a ] );
+			}
+		}
+
+		int axis = 0;
+		for( int a = 1; a < 3; ++a )
+		{
+			if( max_v[ a ] - min_v[ a ] > max_v[ axis ] - min_v[ axis ] )
+				axis = a;
+		}
+
+		// the cells are unique, so there's always some spread
+		const int mid = ( begin + end ) / 2;
+		std::nth_element( mPoints.begin() + begin, mPoints.begin() + mid, mPoints.begin() + end, ClutBakerSortByAxis( axis ) );
+
+		node.axis = axis;
+		node.split = mPoints[ mid ].x[ axis ];
+		node.left = BuildNode( begin, mid );
+		node.right = BuildNode( mid, end );
+	}
+
+	mNodes[ result ] = node;
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+
+void CClutBaker::Bake( int thread_count )
+{
+	CThreadPool pool( thread_count );
+	Bake( pool );
+}
+
+void CClutBaker::Bake( CThreadPool& pool )
+{
+	BuildPoints();
+	if( mPoints.empty() )
+		return;
+
+	mNodes.reserve( 2 * ( mPoints.size() / CLUT_BAKER_LEAF_SIZE ) + 1 );
+	BuildNode( 0, (int)mPoints.size() );
+
+	// CColorUint8 sets up its masks the first time one is created, BuildPoints()
+	// has done that before there's more than one thread
+	BakeBody body;
+	body.baker = this;
+	ParallelFor( pool, mSize, body );
+}
+
+void CClutBaker::BakeSlice( int x )
+{
+	SearchState state;
+	for( int y = 0; y < mSize; ++y )
+	{
+		for( int z = 0; z < mSize; ++z )
+		{
+			const int index = GetIndex( x, y, z );
+			if( mDefined[ index ] )
+				continue;
+
+			state.Reset( x, y, z );
+			SearchNode( 0, state, 0, 0, 0, 0 );
+			mCells[ index ] = GetAverage( state );
+		}
+	}
+}
+
+// off_x, off_y and off_z are how far the cell is from this node's box on each
+// axis, min_dist is the sum of their squares. Nodes that are just as far as
+// the best so far are still searched, they can have ties in them.
+void CClutBaker::SearchNode( int node_i, SearchState& state, int off_x, int off_y, int off_z, int min_dist ) const
+{
+	if( min_dist > state.best_dist )
+		return;
+
+	const Node& node = mNodes[ node_i ];
+	if( node.axis < 0 )
+	{
+		for( int i = node.begin; i < node.end; ++i )
+		{
+			const Point& point = mPoints[ i ];
+			const int dx = point.x[ 0 ] - state.x[ 0 ];
+			const int dy = point.x[ 1 ] - state.x[ 1 ];
+			const int dz = point.x[ 2 ] - state.x[ 2 ];
+			const int dist = dx * dx + dy * dy + dz * dz;
+			if( dist <= state.best_dist )
+				state.Add( point, dist );
+		}
+		return;
+	}
+
+	int* off[ 3 ] = { &off_x, &off_y, &off_z };
+	const int diff = state.x[ node.axis ] - node.split;
+
+	const int near_node = ( diff < 0 ) ? node.left : node.right;
+	const int far_node = ( diff < 0 ) ? node.right : node.left;
+
+	SearchNode( near_node, state, off_x, off_y, off_z, min_dist );
+
+	const int old_off = *off[ node.axis ];
+	*off[ node.axis ] = diff;
+	SearchNode( far_node, state, off_x, off_y, off_z, min_dist - old_off * old_off + diff * diff );
+}
+
+CClutBaker::uint32 CClutBaker::GetAverage( const SearchState& state ) const
+{
+	return CColorUint8( 
+		(CColorUint8::uint8)( state.sum_r / state.count ),
+		(CColorUint8::uint8)( state.sum_g / state.count ),
+		(CColorUint8::uint8)( state.sum_b / state.count ) ).Get32();
+}
+
+//-----------------------------------------------------------------------------
+
+void CClutBaker::BakeLinear()
+{
+	BuildPoints();
+	if( mPoints.empty() )
+		return;
+
+	SearchState state;
+	for( int i = 0; i < (int)mCells.size(); ++i )
+	{
+		if( mDefined[ i ] )
+			continue;
+
+		state.Reset( i / ( mSize * mSize ), ( i / mSize ) % mSize, i % mSize );
+		for( int j = 0; j < (int)mPoints.size(); ++j )
+		{
+			const Point& point = mPoints[ j ];
+			const int dx = point.x[ 0 ] - state.x[ 0 ];
+			const int dy = point.x[ 1 ] - state.x[ 1 ];
+			const int dz = point.x[ 2 ] - state.x[ 2 ];
+			const int dist = dx * dx + dy * dy + dz * dz;
+			if( dist <= state.best_dist )
+				state.Add( point, dist );
+		}
+
+		mCells[ i ] = GetAverage( state );
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+} // end of namespace ceng
@@ -0,0 +1,146 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2003 - 2011 Petri Purho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// CClutBaker
+// ==========
+//
+// Fills in a color lookup table (a size * size * size lattice of 32 bit
+// colors) from a handful of defined cells. Every cell that isn't defined gets
+// the average color of the defined cells that are closest to it. Distances
+// are measured in lattice steps, so they're exact integers and ties are
+// really ties.
+//
+// The defined cells are put into a k-d tree and the lattice is baked over a
+// CThreadPool, one slice at a time. BakeLinear() does the same thing by
+// checking every defined cell for every cell, it's there for testing.
+//
+// Cells are indexed as ( x * size + y ) * size + z, GetIndex() does that.
+//
+//.............................................................................
+//
+// Usage:
+//
+//	ceng::CClutBaker baker( 64 );
+//	baker.SetDefined( baker.GetIndex( 10, 20, 30 ), color );
+//	...
+//	baker.Bake();
+//	const std::vector< ceng::CClutBaker::uint32 >& clut = baker.GetCells();
+//
+//=============================================================================
+#ifndef INC_CCLUT_BAKER_H
+#define INC_CCLUT_BAKER_H
+
+#include <vector>
+#include "ccolor.h"
+
+namespace ceng {
+
+class CThreadPool;
+
+class CClutBaker
+{
+public:
+	typedef CColorUint8::uint32 uint32;
+
+	CClutBaker();
+	explicit CClutBaker( int size );
+
+	// every cell is set to 0 and isn't defined
+	void Reset( int size );
+
+	int GetSize() const;
+	int GetCellCount() const;
+	int GetIndex( int x, int y, int z ) const;
+
+	// sets the color of a cell that Bake() is free to overwrite
+	void SetCell( int index, uint32 color );
+
+	// sets the color of a cell that Bake() interpolates from
+	void SetDefined( int index, uint32 color );
+
+	bool IsDefined( int index ) const;
+	uint32 GetCell( int index ) const;
+	const std::vector< uint32 >& GetCells() const;
+
+	// fills every cell that isn't defined with the average color of the
+	// closest defined cells. Does nothing if there are no defined cells.
+	// thread_count <= 0 uses one thread per core
+	void Bake( int thread_count = 0 );
+
+	// same as above on a pool the caller already has. Must not be a pool 
+	// that the caller is running a task on.
+	void Bake( CThreadPool& pool );
+
+	// same result as Bake(), done by checking every defined cell
+	void BakeLinear();
+
+private:
+	struct Node
+	{
+		// axis < 0 means leaf
+		int		axis;
+		int		split;
+		int		left;
+		int		right;
+		int		begin;
+		int		end;
+	};
+
+	struct Point
+	{
+		int x[ 3 ];
+		int r, g, b;
+	};
+
+	struct SearchState;
+	struct BakeBody;
+
+	void BuildPoints();
+	int  BuildNode( int begin, int end );
+	void SearchNode( int node, SearchState& state, int off_x, int off_y, int off_z, int min_dist ) const;
+
+	void BakeSlice( int x );
+	uint32 GetAverage( const SearchState& state ) const;
+
+	int						mSize;
+	std::vector< uint32 >	mCells;
+	std::vector< char >		mDefined;
+
+	// the defined cells, in k-d tree order
+	std::vector< Point >	mPoints;
+	std::vector< Node >		mNodes;
+};
+
+//-----------------------------------------------------------------------------
+
+inline int CClutBaker::GetSize() const							{ return mSize; }
+inline int CClutBaker::GetCellCount() const						{ return (int)mCells.size(); }
+inline int CClutBaker::GetIndex( int x, int y, int z ) const	{ return ( x * mSize + y ) * mSize + z; }
+inline bool CClutBaker::IsDefined( int index ) const			{ return mDefined[ index ] != 0; }
+inline CClutBaker::uint32 CClutBaker::GetCell( int index ) const	{ return mCells[ index ]; }
+inline const std::vector< CClutBaker::uint32 >& CClutBaker::GetCells() const { return mCells; }
+
+} // end of namespace ceng
+
+#endif
@@ -0,0 +1,281 @@
+#include "ccolor_lut.h"
+
+#include <algorithm>
+
+#include "../threadpool/cthreadpool.h"
+#include "../../poro/external/stb_image.h"
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#	define CENG_COLOR_LUT_SSE2
+#	include <emmintrin.h>
+#endif
+
+namespace ceng {
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+	// rows in one ParallelFor task
+	const int COLOR_LUT_BAND_ROWS = 32;
+
+#ifdef CENG_COLOR_LUT_SSE2
+	inline __m128 ColorLutLerp( __m128 a, __m128 b, __m128 t )
+	{
+		return _mm_add_ps( a, _mm_mul_ps( _mm_sub_ps( b, a ), t ) );
+	}
+
+	// trilinear lookup, c is the lower corner of the cube the color is in.
+	// All four channels are interpolated at once.
+	inline __m128 ColorLutSample( const float* c, int step_g, int step_b, float fr, float fg, float fb )
+	{
+		const __m128 tr = _mm_set1_ps( fr );
+		const __m128 c00 = ColorLutLerp( _mm_loadu_ps( c ), _mm_loadu_ps( c + 4 ), tr );
+		const __m128 c10 = ColorLutLerp( _mm_loadu_ps( c + step_g ), _mm_loadu_ps( c + step_g + 4 ), tr );
+		const __m128 c01 = ColorLutLerp( _mm_loadu_ps( c + step_b ), _mm_loadu_ps( c + step_b + 4 ), tr );
+		const __m128 c11 = ColorLutLerp( _mm_loadu_ps( c + step_g + step_b ), _mm_loadu_ps( c + step_g + step_b + 4 ), tr );
+
+		const __m128 tg = _mm_set1_ps( fg );
+		return ColorLutLerp( ColorLutLerp( c00, c10, tg ), ColorLutLerp( c01, c11, tg ), _mm_set1_ps( fb ) );
+	}
+#else
+	inline float ColorLutLerp( float a, float b, float t )
+	{
+		return a + ( b - a ) * t;
+	}
+
+	// trilinear lookup of the rgb channels, c is the lower corner of the cube
+	// the color is in
+	inline void ColorLutSample( const float* c, int step_g, int step_b, float fr, float fg, float fb, float* out )
+	{
+		for( int i = 0; i < 3; ++i )
+		{
+			const float c00 = ColorLutLerp( c[ i ], c[ i + 4 ], fr );
+			const float c10 = ColorLutLerp( c[ i + step_g ], c[ i + step_g + 4 ], fr );
+			const float c01 = ColorLutLerp( c[ i + step_b ], c[ i + step_b + 4 ], fr );
+			const float c11 = ColorLutLerp( c[ i + step_g + step_b ], c[ i + step_g + step_b + 4 ], fr );
+			out[ i ] = ColorLutLerp( ColorLutLerp( c00, c10, fg ), ColorLutLerp( c01, c11, fg ), fb );
+		}
+	}
+#endif
+
+	struct ColorLutBody
+	{
+		unsigned char*		rgba;
+		int					width;
+		int					height;
+		int					stride;
+		const CColorLut*	prev;
+		const CColorLut*	next;
+		float				interpolation;
+
+		void operator()( int band )
+		{
+			const int end = std::min( height, ( band + 1 ) * COLOR_LUT_BAND_ROWS );
+			for( int y = band * COLOR_LUT_BAND_ROWS; y < end; ++y )
+				prev->ApplyRow( rgba + y * stride, width, next, interpolation );
+		}
+	};
+
+	// runs on pool if there is one, otherwise starts thread_count threads
+	void ApplyColorLutBands( ColorLutBody& body, CThreadPool* pool, int thread_count )
+	{
+		if( body.rgba == NULL || body.width <= 0 || body.height <= 0 || body.prev->Empty() )
+			return;
+
+		const int bands = ( body.height + COLOR_LUT_BAND_ROWS - 1 ) / COLOR_LUT_BAND_ROWS;
+		if( pool )
+		{
+			ParallelFor( *pool, bands, body );
+			return;
+		}
+
+		CThreadPool own_pool( thread_count );
+		ParallelFor( own_pool, bands, body );
+	}
+
+	ColorLutBody GetColorLutBody( unsigned char* rgba, int width, int height, int stride, const CColorLut* prev, const CColorLut* next, float interpolation )
+	{
+		ColorLutBody body;
+		body.rgba = rgba;
+		body.width = width;
+		body.height = height;
+		body.stride = stride;
+		body.prev = prev;
+		body.next = next;
+		body.interpolation = interpolation;
+		return body;
+	}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+
+CColorLut::CColorLut() :
+	mSize( 0 ),
+	mCells()
+{
+	Clear();
+}
+
+void CColorLut::Clear()
+{
+	mSize = 0;
+	mCells.clear();
+	for( int i = 0; i < 256; ++i )
+	{
+		mR[ i ].offset = mG[ i ].offset = mB[ i ].offset = 0;
+		mR[ i ].fraction = mG[ i ].fraction = mB[ i ].fraction = 0;
+	}
+}
+
+bool CColorLut::Load( const std::string& filename )
+{
+	int width = 0;
+	int height = 0;
+	int comp = 0;
+	unsigned char* data = stbi_load( filename.c_str(), &width, &height, &comp, 4 );
+	if( data == NULL )
+	{
+		Clear();
+		return false;
+	}
+
+	const bool result = Set( data, width, height );
+	stbi_image_free( data );
+	return result;
+}
+
+bool CColorLut::Set( const unsigned char* rgba, int width, int height )
+{
+	Clear();
+
+	// same checks as GraphicsOpenGL::LoadTexture3d(), the image is z^3 wide
+	// and the cube is z^2 on each side
+	if( rgba == NULL || width != height )
+		return false;
+
+	int z = 1;
+	while( z * z * z < width )
+		++z;
+
+	if( z * z * z != width || z < 2 )
+		return false;
+
+	mSize = z * z;
+	mCells.resize( width * height * 4 );
+	for( int i = 0; i < width * height * 4; ++i )
+		mCells[ i ] = rgba[ i ];
+
+	// 0 maps to the first cell and 255 to the last one. The last cube starts
+	// from the second to last cell, so 255 is at its far end
+	for( int i = 0; i < 256; ++i )
+	{
+		const float pos = i * ( mSize - 1 ) / 255.f;
+		const int cell = std::min( (int)pos, mSize - 2 );
+
+		mR[ i ].offset = cell * 4;
+		mG[ i ].offset = cell * mSize * 4;
+		mB[ i ].offset = cell * mSize * mSize * 4;
+		mR[ i ].fraction = mG[ i ].fraction = mB[ i ].fraction = pos - cell;
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void CColorLut::ApplyRow( unsigned char* rgba, int count, const CColorLut* next, float interpolation ) const
+{
+	if( Empty() )
+		return;
+
+	if( next && next->Empty() )
+		next = NULL;
+
+	interpolation = std::min( std::max( interpolation, 0.f ), 1.f );
+
+	const int step_g = mSize * 4;
+	const int step_b = mSize * mSize * 4;
+	const int next_step_g = next ? next->mSize * 4 : 0;
+	const int next_step_b = next ? next->mSize * next->mSize * 4 : 0;
+
+#ifdef CENG_COLOR_LUT_SSE2
+	const __m128 t = _mm_set1_ps( interpolation );
+#endif
+
+	for( int i = 0; i < count; ++i, rgba += 4 )
+	{
+		const Axis& r = mR[ rgba[ 0 ] ];
+		const Axis& g = mG[ rgba[ 1 ] ];
+		const Axis& b = mB[ rgba[ 2 ] ];
+		const float* cell = &mCells[ r.offset + g.offset + b.offset ];
+
+#ifdef CENG_COLOR_LUT_SSE2
+		__m128 color = ColorLutSample( cell, step_g, step_b, r.fraction, g.fraction, b.fraction );
+		if( next )
+		{
+			const Axis& nr = next->mR[ rgba[ 0 ] ];
+			const Axis& ng = next->mG[ rgba[ 1 ] ];
+			const Axis& nb = next->mB[ rgba[ 2 ] ];
+			const float* next_cell = &next->mCells[ nr.offset + ng.offset + nb.offset ];
+			color = ColorLutLerp( color, ColorLutSample( next_cell, next_step_g, next_step_b, nr.fraction, ng.fraction, nb.fraction ), t );
+		}
+
+		const __m128i color32 = _mm_cvtps_epi32( color );
+		const __m128i color16 = _mm_packs_epi32( color32, color32 );
+		const int color8 = _mm_cvtsi128_si32( _mm_packus_epi16( color16, color16 ) );
+		rgba[ 0 ] = (unsigned char)( color8 );
+		rgba[ 1 ] = (unsigned char)( color8 >> 8 );
+		rgba[ 2 ] = (unsigned char)( color8 >> 16 );
+#else
+		float color[ 3 ];
+		ColorLutSample( cell, step_g, step_b, r.fraction, g.fraction, b.fraction, color );
+		if( next )
+		{
+			const Axis& nr = next->mR[ rgba[ 0 ] ];
+			const Axis& ng = next->mG[ rgba[ 1 ] ];
+			const Axis& nb = next->mB[ rgba[ 2 ] ];
+			const float* next_cell = &next->mCells[ nr.offset + ng.offset + nb.offset ];
+
+			float next_color[ 3 ];
+			ColorLutSample( next_cell, next_step_g, next_step_b, nr.fraction, ng.fraction, nb.fraction, next_color );
+			for( int c = 0; c < 3; ++c )
+				color[ c ] = ColorLutLerp( color[ c ], next_color[ c ], interpolation );
+		}
+
+		for( int c = 0; c < 3; ++c )
+			rgba[ c ] = (unsigned char)( color[ c ] + 0.5f );
+#endif
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+void ApplyColorLut( unsigned char* rgba, int width, int height, int stride, const CColorLut& lut, int thread_count )
+{
+	ColorLutBody body = GetColorLutBody( rgba, width, height, stride, &lut, NULL, 0 );
+	ApplyColorLutBands( body, NULL, thread_count );
+}
+
+void ApplyColorLut( unsigned char* rgba, int width, int height, int stride, const CColorLut& prev, const CColorLut& next, float interpolation, int thread_count )
+{
+	ColorLutBody body = GetColorLutBody( rgba, width, height, stride, &prev, &next, interpolation );
+	ApplyColorLutBands( body, NULL, thread_count );
+}
+
+void ApplyColorLut( unsigned char* rgba, int width, int height, int stride, const CColorLut& lut, CThreadPool& pool )
+{
+	ColorLutBody body = GetColorLutBody( rgba, width, height, stride, &lut, NULL, 0 );
+	ApplyColorLutBands( body, &pool, 0 );
+}
+
+void ApplyColorLut( unsigned char* rgba, int width, int height, int stride, const CColorLut& prev, const CColorLut& next, float interpolation, CThreadPool& pool )
+{
+	ColorLutBody body = GetColorLutBody( rgba, width, height, stride, &prev, &next, interpolation );
+	ApplyColorLutBands( body, &pool, 0 );
+}
+
+//-----------------------------------------------------------------------------
+
+} // end of namespace ceng
@@ -0,0 +1,125 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2003 - 2011 Petri Purho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// CColorLut
+// =========
+//
+// A 3d color lookup table applied on the CPU, so that images can be color
+// graded without an OpenGL context. It reads the same cube-in-a-square images
+// that GraphicsOpenGL::LoadTexture3d() takes: a square image that is
+// size * size cells wide, where the red axis runs along the rows, green goes
+// down a row at a time and blue moves a whole size * size block at a time.
+//
+// Lookups are trilinear, like the GL_LINEAR 3d texture. A channel value of 0
+// is the first cell and 255 the last one, so an identity table gives back
+// the same colors. Alpha isn't touched.
+//
+// ApplyRow() is const and can be called from any number of threads.
+// ApplyColorLut() runs it over an image in bands of rows on a CThreadPool.
+// Passing two tables blends them like the post fx shader blends
+// tex_clut_prev and tex_clut_next with clut_interpolation.
+//
+//.............................................................................
+//
+// Usage:
+//
+//	ceng::CColorLut lut;
+//	if( lut.Load( "data/weather_gfx/clut_day.png" ) )
+//		ceng::ApplyColorLut( pixels, width, height, width * 4, lut );
+//
+//=============================================================================
+#ifndef INC_CCOLOR_LUT_H
+#define INC_CCOLOR_LUT_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace ceng {
+
+class CThreadPool;
+
+class CColorLut
+{
+public:
+	CColorLut();
+
+	// returns false if the file can't be read or isn't a cube-in-a-square
+	bool Load( const std::string& filename );
+
+	// rgba is width * height pixels, 4 bytes each. Returns false if the size
+	// isn't right for a cube
+	bool Set( const unsigned char* rgba, int width, int height );
+
+	void Clear();
+	bool Empty() const;
+
+	// number of cells on each axis
+	int GetSize() const;
+
+	// looks up count rgba pixels in place. If next is given, the result is
+	// blended towards next by interpolation (0 - 1)
+	void ApplyRow( unsigned char* rgba, int count, const CColorLut* next = NULL, float interpolation = 0 ) const;
+
+private:
+	struct Axis
+	{
+		int		offset;
+		float	fraction;
+	};
+
+	int						mSize;
+
+	// the cells as floats, 4 per cell
+	std::vector< float >	mCells;
+
+	// for each channel value, the offset to the lower cell on that axis and
+	// how far towards the next cell it is
+	Axis					mR[ 256 ];
+	Axis					mG[ 256 ];
+	Axis					mB[ 256 ];
+};
+
+//-----------------------------------------------------------------------------
+
+// applies lut to every pixel of an rgba image. stride is the number of bytes
+// between rows. thread_count <= 0 uses one thread per core
+void ApplyColorLut( unsigned char* rgba, int width, int height, int stride, const CColorLut& lut, int thread_count = 0 );
+
+// same as above, blended from prev towards next by interpolation (0 - 1)
+void ApplyColorLut( unsigned char* rgba, int width, int height, int stride, const CColorLut& prev, const CColorLut& next, float interpolation, int thread_count = 0 );
+
+// the same two on a pool the caller already has, so that no threads get 
+// started. Must not be a pool that the caller is running a task on.
+void ApplyColorLut( unsigned char* rgba, int width, int height, int stride, const CColorLut& lut, CThreadPool& pool );
+void ApplyColorLut( unsigned char* rgba, int width, int height, int stride, const CColorLut& prev, const CColorLut& next, float interpolation, CThreadPool& pool );
+
+//-----------------------------------------------------------------------------
+
+inline bool CColorLut::Empty() const	{ return mSize == 0; }
+inline int CColorLut::GetSize() const	{ return mSize; }
+
+} // end of namespace ceng
+
+#endif
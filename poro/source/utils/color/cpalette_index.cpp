@@ -0,0 +1,343 @@
+#include "cpalette_index.h"
+
+#include <cmath>
+#include <algorithm>
+
+#include "color_utils.h"
+
+#if defined( __SSE__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 1 )
+#	define CENG_PALETTE_INDEX_SSE
+#	include <xmmintrin.h>
+#endif
+
+namespace ceng {
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+	// The search itself runs on (|dr| + |dg|) + |db| computed here, which can
+	// be a hair off from what ColorDistance() returns depending on how the
+	// compiler does its float math. Anything that is within this much from the
+	// best one is checked with ColorDistance().
+	inline float PaletteIndexSlack( float best )
+	{
+		return 1.0e-4f + best * 1.0e-5f;
+	}
+
+	inline float PaletteIndexDistance( float r, float g, float b, float pr, float pg, float pb )
+	{
+		return ( std::fabs( r - pr ) + std::fabs( g - pg ) ) + std::fabs( b - pb );
+	}
+
+	const int	PALETTE_INDEX_LEAF_SIZE = 8;
+
+	// padding for the linear search, far enough to never be the closest
+	const float PALETTE_INDEX_FAR_AWAY = 1.0e6f;
+
+	struct PaletteIndexSortByAxis
+	{
+		PaletteIndexSortByAxis( const std::vector< CColorFloat >& colors, int axis ) : colors( colors ), axis( axis ) { }
+
+		bool operator()( int a, int b ) const
+		{
+			return colors[ a ][ axis ] < colors[ b ][ axis ];
+		}
+
+		const std::vector< CColorFloat >& colors;
+		int axis;
+	};
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+
+struct CPaletteIndex::SearchState
+{
+	CColorFloat color;
+	float		r, g, b;
+
+	// smallest (|dr| + |dg|) + |db| found so far
+	float		best_approx;
+
+	// ColorDistance() of the best color so far
+	float		best_dist;
+	int			best_index;
+};
+
+//-----------------------------------------------------------------------------
+
+CPaletteIndex::CPaletteIndex() :
+	mColors(),
+	mR(),
+	mG(),
+	mB(),
+	mIndex(),
+	mNodes()
+{
+}
+
+CPaletteIndex::CPaletteIndex( const std::vector< uint32 >& colors ) :
+	mColors(),
+	mR(),
+	mG(),
+	mB(),
+	mIndex(),
+	mNodes()
+{
+	Build( colors );
+}
+
+void CPaletteIndex::Clear()
+{
+	mColors.clear();
+	mR.clear();
+	mG.clear();
+	mB.clear();
+	mIndex.clear();
+	mNodes.clear();
+}
+
+//-----------------------------------------------------------------------------
+
+void CPaletteIndex::Build( const std::vector< uint32 >& colors )
+{
+	Clear();
+
+	mColors.resize( colors.size() );
+	for( std::size_t i = 0; i < colors.size(); ++i )
+		mColors[ i ] = CColorFloat( colors[ i ] );
+
+	const int count = (int)mColors.size();
+	mIndex.resize( count );
+	for( int i = 0; i < count; ++i )
+		mIndex[ i ] = i;
+
+	if( count > LINEAR_SEARCH_SIZE )
+	{
+		mNodes.reserve( 2 * ( count / PALETTE_INDEX_LEAF_SIZE ) + 1 );
+		BuildNode( 0, count );
+	}
+
+	// the linear search reads 4 at a time, so it gets padded
+	const int padded = ( count > LINEAR_SEARCH_SIZE ) ? count : ( ( count + 3 ) & ~3 );
+	mR.resize( padded, PALETTE_INDEX_FAR_AWAY );
+	mG.resize( padded, PALETTE_INDEX_FAR_AWAY );
+	mB.resize( padded, PALETTE_INDEX_FAR_AWAY );
+
+	for( int i = 0; i < count; ++i )
+	{
+		const CColorFloat& c = mColors[ mIndex[ i ] ];
+		mR[ i ] = c.GetR();
+		mG[ i ] = c.GetG();
+		mB[ i ] = c.GetB();
+	}
+}
+
+int CPaletteIndex::BuildNode( int begin, int end )
+{
+	const int result = (int)mNodes.size();
+	mNodes.push_back( Node() );
+
+	Node node;
+	node.axis = -1;
+	node.split = 0;
+	node.left = -1;
+	node.right = -1;
+	node.begin = begin;
+	node.end = end;
+
+	if( end - begin > PALETTE_INDEX_LEAF_SIZE )
+	{
+		// split along the axis with the biggest spread
+		float min_v[ 3 ] = { mColors[ mIndex[ begin ] ][ 0 ], mColors[ mIndex[ begin ] ][ 1 ], mColors[ mIndex[ begin ] ][ 2 ] };
+		float max_v[ 3 ] = { min_v[ 0 ], min_v[ 1 ], min_v[ 2 ] };
+		for( int i = begin + 1; i < end; ++i )
+		{
+			for( int a = 0; a < 3; ++a )
+			{
+				const float v = mColors[ mIndex[ i ] ][ a ];
+				min_v[ a ] = std::min( min_v[ a ], v );
+				max_v[ a ] = std::max( max_v[ a ], v );
+			}
+		}
+
+		int axis = 0;
+		for( int a = 1; a < 3; ++a )
+		{
+			if( max_v[ a ] - min_v[ a ] > max_v[ axis ] - min_v[ axis ] )
+				axis = a;
+		}
+
+		// everything is the same color, no point in splitting
+		if( max_v[ axis ] > min_v[ axis ] )
+		{
+			const int mid = ( begin + end ) / 2;
+			std::nth_element( mIndex.begin() + begin, mIndex.begin() + mid, mIndex.begin() + end, PaletteIndexSortByAxis( mColors, axis ) );
+
+			node.axis = axis;
+			node.split = mColors[ mIndex[ mid ] ][ axis ];
+			node.left = BuildNode( begin, mid );
+			node.right = BuildNode( mid, end );
+		}
+	}
+
+	mNodes[ result ] = node;
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+
+int CPaletteIndex::FindClosest( const CColorFloat& color ) const
+{
+	if( mColors.empty() )
+		return 0;
+
+	if( mNodes.empty() )
+		return FindClosestSmall( color );
+
+	SearchState state;
+	state.color = color;
+	state.r = color.GetR();
+	state.g = color.GetG();
+	state.b = color.GetB();
+	state.best_approx = 3 * 1000.f;
+	state.best_dist = 1000.f;
+	state.best_index = -1;
+
+	SearchNode( 0, state, 0, 0, 0, 0 );
+
+	return ( state.best_index < 0 ) ? 0 : state.best_index;
+}
+
+// off_r, off_g and off_b are how far the color is from this node's box on
+// each axis, min_dist is their sum
+void CPaletteIndex::SearchNode( int node_i, SearchState& state, float off_r, float off_g, float off_b, float min_dist ) const
+{
+	if( min_dist > state.best_approx + PaletteIndexSlack( state.best_approx ) )
+		return;
+
+	const Node& node = mNodes[ node_i ];
+	if( node.axis < 0 )
+	{
+		for( int i = node.begin; i < node.end; ++i )
+			CheckColor( i, state );
+		return;
+	}
+
+	float* off[ 3 ] = { &off_r, &off_g, &off_b };
+	const float value = ( node.axis == 0 ) ? state.r : ( ( node.axis == 1 ) ? state.g : state.b );
+	const float diff = value - node.split;
+
+	const int near_node = ( diff < 0 ) ? node.left : node.right;
+	const int far_node = ( diff < 0 ) ? node.right : node.left;
+
+	SearchNode( near_node, state, off_r, off_g, off_b, min_dist );
+
+	const float old_off = *off[ node.axis ];
+	const float new_off = std::fabs( diff );
+	*off[ node.axis ] = new_off;
+	SearchNode( far_node, state, off_r, off_g, off_b, min_dist - old_off + new_off );
+}
+
+void CPaletteIndex::CheckColor( int i, SearchState& state ) const
+{
+	const float approx = PaletteIndexDistance( state.r, state.g, state.b, mR[ i ], mG[ i ], mB[ i ] );
+	if( approx > state.best_approx + PaletteIndexSlack( state.best_approx ) )
+		return;
+
+	if( approx < state.best_approx )
+		state.best_approx = approx;
+
+	const int index = mIndex[ i ];
+	const float dist = ColorDistance( state.color, mColors[ index ] );
+	if( dist < state.best_dist || ( dist == state.best_dist && index < state.best_index ) )
+	{
+		state.best_dist = dist;
+		state.best_index = index;
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+int CPaletteIndex::FindClosestSmall( const CColorFloat& color ) const
+{
+	const int count = (int)mColors.size();
+	const float r = color.GetR();
+	const float g = color.GetG();
+	const float b = color.GetB();
+
+	float approx[ LINEAR_SEARCH_SIZE ];
+	float best_approx = 3 * 1000.f;
+
+#ifdef CENG_PALETTE_INDEX_SSE
+	const __m128 sign_mask = _mm_set1_ps( -0.f );
+	const __m128 qr = _mm_set1_ps( r );
+	const __m128 qg = _mm_set1_ps( g );
+	const __m128 qb = _mm_set1_ps( b );
+	__m128 best4 = _mm_set1_ps( best_approx );
+
+	for( int i = 0; i < count; i += 4 )
+	{
+		const __m128 dr = _mm_andnot_ps( sign_mask, _mm_sub_ps( qr, _mm_loadu_ps( &mR[ i ] ) ) );
+		const __m128 dg = _mm_andnot_ps( sign_mask, _mm_sub_ps( qg, _mm_loadu_ps( &mG[ i ] ) ) );
+		const __m128 db = _mm_andnot_ps( sign_mask, _mm_sub_ps( qb, _mm_loadu_ps( &mB[ i ] ) ) );
+		const __m128 d = _mm_add_ps( _mm_add_ps( dr, dg ), db );
+		_mm_storeu_ps( &approx[ i ], d );
+		best4 = _mm_min_ps( d, best4 );
+	}
+
+	float best_lanes[ 4 ];
+	_mm_storeu_ps( best_lanes, best4 );
+	best_approx = std::min( std::min( best_lanes[ 0 ], best_lanes[ 1 ] ), std::min( best_lanes[ 2 ], best_lanes[ 3 ] ) );
+#else
+	for( int i = 0; i < count; ++i )
+	{
+		approx[ i ] = PaletteIndexDistance( r, g, b, mR[ i ], mG[ i ], mB[ i ] );
+		if( approx[ i ] < best_approx )
+			best_approx = approx[ i ];
+	}
+#endif
+
+	// the first one that is the closest according to ColorDistance()
+	const float limit = best_approx + PaletteIndexSlack( best_approx );
+	float closest = 1000;
+	int closest_i = 0;
+	for( int i = 0; i < count; ++i )
+	{
+		if( approx[ i ] > limit )
+			continue;
+
+		const float dist = ColorDistance( color, mColors[ i ] );
+		if( dist < closest )
+		{
+			closest = dist;
+			closest_i = i;
+		}
+	}
+
+	return closest_i;
+}
+
+//-----------------------------------------------------------------------------
+
+int CPaletteIndex::FindClosestLinear( const CColorFloat& color ) const
+{
+	float closest = 1000;
+	int closest_i = 0;
+	for( int i = 0; i < (int)mColors.size(); ++i )
+	{
+		float dist = ColorDistance( color, mColors[ i ] );
+		if( dist < closest )
+		{
+			closest = dist;
+			closest_i = i;
+		}
+	}
+
+	return closest_i;
+}
+
+//-----------------------------------------------------------------------------
+
+} // end of namespace ceng
@@ -0,0 +1,118 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2003 - 2011 Petri Purho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// CPaletteIndex
+// =============
+//
+// Finds the closest palette color to a given color, using ColorDistance()
+// as the metric. The result is always the same as this linear search:
+//
+//	float closest = 1000;
+//	int closest_i = 0;
+//	for( int i = 0; i < (int)colors.size(); ++i ) {
+//		float dist = ColorDistance( color, CColorFloat( colors[i] ) );
+//		if( dist < closest ) { closest = dist; closest_i = i; }
+//	}
+//
+// including which index wins when two colors are just as close.
+//
+// Build() is called once for a palette, after that FindClosest() can be
+// called from any number of threads. Big palettes are put into a k-d tree.
+// Small palettes are searched linearly, 4 colors at a time with SSE when
+// it's available. Both paths run the final comparisons with ColorDistance()
+// itself, so the float math matches the linear search exactly.
+//
+//=============================================================================
+#ifndef INC_CPALETTE_INDEX_H
+#define INC_CPALETTE_INDEX_H
+
+#include <vector>
+#include "ccolor.h"
+
+namespace ceng {
+
+class CPaletteIndex
+{
+public:
+	typedef CColorFloat::uint32 uint32;
+
+	// palettes up to this size are searched linearly
+	enum { LINEAR_SEARCH_SIZE = 32 };
+
+	CPaletteIndex();
+	explicit CPaletteIndex( const std::vector< uint32 >& colors );
+
+	// colors are 32 bit colors as CColorFloat::Set32() reads them
+	void Build( const std::vector< uint32 >& colors );
+	void Clear();
+
+	int  Size() const;
+	bool Empty() const;
+
+	// returns the index of the closest color in the palette, 0 if the palette
+	// is empty
+	int FindClosest( const CColorFloat& color ) const;
+
+	// the plain linear search, for testing
+	int FindClosestLinear( const CColorFloat& color ) const;
+
+private:
+	struct Node
+	{
+		// axis < 0 means leaf
+		int		axis;
+		float	split;
+		int		left;
+		int		right;
+		int		begin;
+		int		end;
+	};
+
+	struct SearchState;
+
+	int  BuildNode( int begin, int end );
+	void SearchNode( int node, SearchState& state, float off_r, float off_g, float off_b, float min_dist ) const;
+	void CheckColor( int i, SearchState& state ) const;
+
+	int FindClosestSmall( const CColorFloat& color ) const;
+
+	std::vector< CColorFloat >	mColors;
+
+	// component arrays, in k-d tree order for big palettes and in palette
+	// order for small ones
+	std::vector< float >		mR;
+	std::vector< float >		mG;
+	std::vector< float >		mB;
+	std::vector< int >			mIndex;
+
+	std::vector< Node >			mNodes;
+};
+
+//-----------------------------------------------------------------------------
+
+inline int CPaletteIndex::Size() const		{ return (int)mColors.size(); }
+inline bool CPaletteIndex::Empty() const	{ return mColors.empty(); }
+
+} // end of namespace ceng
+
+#endif
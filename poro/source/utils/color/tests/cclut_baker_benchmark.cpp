@@ -0,0 +1,152 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2003 - 2011 Petri Purho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+
+
+// Compares CClutBaker against the way post_fx used to generate its color
+// lookup tables: every undefined cell walked a std::map of the defined cells
+// twice and took a sqrt for each one. Takes several seconds, so it's only
+// built when CENG_CLUT_BAKER_BENCHMARK is defined.
+
+#include "../cclut_baker.h"
+#include "../../random/random.h"
+#include "../../timer/ctimer.h"
+#include "../../debug.h"
+
+#include <map>
+#include <cmath>
+#include <limits>
+#include <iostream>
+
+#if defined( CENG_TESTER_ENABLED ) && defined( CENG_CLUT_BAKER_BENCHMARK )
+
+namespace ceng {
+namespace test {
+
+namespace {
+
+// the old loop, except that the distances are signed. The old one subtracted
+// unsigned ints, so cells "below" a defined cell were never close to it.
+void ClutBakerBenchmark_Old( int size, std::vector< CClutBaker::uint32 >& clut, const std::vector< char >& defined )
+{
+	std::map< CClutBaker::uint32, int > palette_hash;
+	for( int i = 0; i < (int)clut.size(); ++i )
+	{
+		if( defined[ i ] )
+			palette_hash.insert( std::pair< CClutBaker::uint32, int >( i, 0 ) );
+	}
+
+	for( int i = 0; i < size; i++ )
+	{
+		for( int j = 0; j < size; j++ )
+		{
+			for( int k = 0; k < size; k++ )
+			{
+				const CClutBaker::uint32 index = ( i * size + j ) * size + k;
+				if( defined[ index ] )
+					continue;
+
+				double nearest_dist = std::numeric_limits< double >::max();
+				for( std::map< CClutBaker::uint32, int >::iterator iter = palette_hash.begin(); iter != palette_hash.end(); ++iter )
+				{
+					const int index_1d = iter->first;
+					const double dist_x = index_1d / ( size * size ) - i;
+					const double dist_y = ( index_1d / size ) % size - j;
+					const double dist_z = index_1d % size - k;
+					const double dist = sqrt( dist_x * dist_x + dist_y * dist_y + dist_z * dist_z );
+					if( dist < nearest_dist )
+						nearest_dist = dist;
+				}
+
+				double r_accum = 0, g_accum = 0, b_accum = 0, weight_sum = 0;
+				for( std::map< CClutBaker::uint32, int >::iterator iter = palette_hash.begin(); iter != palette_hash.end(); ++iter )
+				{
+					const int index_1d = iter->first;
+					const double dist_x = index_1d / ( size * size ) - i;
+					const double dist_y = ( index_1d / size ) % size - j;
+					const double dist_z = index_1d % size - k;
+					const double dist = sqrt( dist_x * dist_x + dist_y * dist_y + dist_z * dist_z );
+					const double weight = ( dist == nearest_dist ) ? 1 : 0;
+
+					const CColorUint8 color( clut[ index_1d ] );
+					r_accum += color.r * weight;
+					g_accum += color.g * weight;
+					b_accum += color.b * weight;
+					weight_sum += weight;
+				}
+
+				clut[ index ] = CColorUint8( 
+					(CColorUint8::uint8)( r_accum / weight_sum ),
+					(CColorUint8::uint8)( g_accum / weight_sum ),
+					(CColorUint8::uint8)( b_accum / weight_sum ) ).Get32();
+			}
+		}
+	}
+}
+
+} // end of anonymous namespace
+
+int ClutBakerBenchmark()
+{
+	CLGMRandom random;
+	random.SetSeed( 1234 );
+
+	const int size = 64;
+	const int counts[] = { 64, 512, 4096 };
+	for( int c = 0; c < (int)( sizeof( counts ) / sizeof( counts[ 0 ] ) ); ++c )
+	{
+		CClutBaker baker( size );
+		for( int i = 0; i < counts[ c ]; ++i )
+		{
+			const int index = baker.GetIndex( random.Random( 0, size - 1 ), random.Random( 0, size - 1 ), random.Random( 0, size - 1 ) );
+			baker.SetDefined( index, CColorUint8( random.Random( 0, 255 ), random.Random( 0, 255 ), random.Random( 0, 255 ) ).Get32() );
+		}
+
+		std::vector< CClutBaker::uint32 > old_clut = baker.GetCells();
+		std::vector< char > defined( old_clut.size() );
+		for( int i = 0; i < (int)defined.size(); ++i )
+			defined[ i ] = baker.IsDefined( i );
+
+		CTimer timer;
+		ClutBakerBenchmark_Old( size, old_clut, defined );
+		std::cout << "old, " << counts[ c ] << " colors: " << timer.GetTime() << " ms" << std::endl;
+
+		CClutBaker single = baker;
+		timer.Reset();
+		single.Bake( 1 );
+		std::cout << "CClutBaker( 1 thread ), " << counts[ c ] << " colors: " << timer.GetTime() << " ms" << std::endl;
+
+		timer.Reset();
+		baker.Bake();
+		std::cout << "CClutBaker( all cores ), " << counts[ c ] << " colors: " << timer.GetTime() << " ms" << std::endl;
+
+		test_assert( baker.GetCells() == old_clut );
+		test_assert( single.GetCells() == old_clut );
+	}
+
+	return 0;
+}
+
+TEST_REGISTER( ClutBakerBenchmark );
+
+} // end of namespace test
+} // end of namespace ceng
+
+#endif
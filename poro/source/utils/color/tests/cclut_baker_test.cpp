@@ -0,0 +1,110 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2003 - 2011 Petri Purho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+
+
+#include "../cclut_baker.h"
+#include "../../random/random.h"
+#include "../../debug.h"
+
+#ifdef CENG_TESTER_ENABLED
+
+namespace ceng {
+namespace test {
+
+int CClutBakerTest()
+{
+	// nothing defined, nothing changes
+	{
+		CClutBaker baker( 4 );
+		for( int i = 0; i < baker.GetCellCount(); ++i )
+			baker.SetCell( i, i );
+
+		baker.Bake( 1 );
+		for( int i = 0; i < baker.GetCellCount(); ++i )
+			test_assert( baker.GetCell( i ) == (CClutBaker::uint32)i );
+	}
+
+	// one defined cell fills the whole lattice
+	{
+		const CClutBaker::uint32 color = CColorUint8( 10, 20, 30 ).Get32();
+
+		CClutBaker baker( 8 );
+		baker.SetDefined( baker.GetIndex( 1, 2, 3 ), color );
+		baker.Bake();
+		for( int i = 0; i < baker.GetCellCount(); ++i )
+			test_assert( baker.GetCell( i ) == color );
+	}
+
+	// ties are averaged: the cell in the middle of these two is between them
+	{
+		CClutBaker baker( 3 );
+		baker.SetDefined( baker.GetIndex( 0, 1, 1 ), CColorUint8( 10, 100, 0 ).Get32() );
+		baker.SetDefined( baker.GetIndex( 2, 1, 1 ), CColorUint8( 21, 200, 0 ).Get32() );
+		baker.Bake();
+		test_assert( baker.GetCell( baker.GetIndex( 1, 1, 1 ) ) == CColorUint8( 15, 150, 0 ).Get32() );
+		test_assert( baker.GetCell( baker.GetIndex( 0, 0, 0 ) ) == CColorUint8( 10, 100, 0 ).Get32() );
+		test_assert( baker.GetCell( baker.GetIndex( 2, 2, 2 ) ) == CColorUint8( 21, 200, 0 ).Get32() );
+	}
+
+	// the k-d tree gives the same result as checking every defined cell, for
+	// sparse and dense lattices. Clustered cells make plenty of ties.
+	{
+		CLGMRandom random;
+		random.SetSeed( 4321 );
+
+		const int sizes[] = { 5, 16, 32 };
+		const int counts[] = { 2, 9, 50, 700 };
+		for( int s = 0; s < (int)( sizeof( sizes ) / sizeof( sizes[ 0 ] ) ); ++s )
+		{
+			for( int c = 0; c < (int)( sizeof( counts ) / sizeof( counts[ 0 ] ) ); ++c )
+			{
+				const int size = sizes[ s ];
+				CClutBaker tree( size );
+				CClutBaker linear( size );
+				for( int i = 0; i < counts[ c ]; ++i )
+				{
+					const int step = ( i % 2 ) ? 1 : 4;
+					const int index = tree.GetIndex( 
+						( random.Random( 0, size - 1 ) / step ) * step,
+						( random.Random( 0, size - 1 ) / step ) * step,
+						( random.Random( 0, size - 1 ) / step ) * step );
+
+					const CClutBaker::uint32 color = CColorUint8( random.Random( 0, 255 ), random.Random( 0, 255 ), random.Random( 0, 255 ) ).Get32();
+					tree.SetDefined( index, color );
+					linear.SetDefined( index, color );
+				}
+
+				tree.Bake( 4 );
+				linear.BakeLinear();
+				test_assert( tree.GetCells() == linear.GetCells() );
+			}
+		}
+	}
+
+	return 0;
+}
+
+TEST_REGISTER( CClutBakerTest );
+
+} // end of namespace test
+} // end of namespace ceng
+
+#endif
@@ -0,0 +1,187 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2003 - 2011 Petri Purho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+
+
+#include "../ccolor_lut.h"
+#include "../../random/random.h"
+#include "../../debug.h"
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef CENG_TESTER_ENABLED
+
+namespace ceng {
+namespace test {
+
+namespace {
+
+// a cube-in-a-square image, z^3 pixels wide
+std::vector< unsigned char > ColorLutTest_MakeImage( int z, CLGMRandom* random )
+{
+	const int size = z * z;
+	const int width = z * z * z;
+	std::vector< unsigned char > result( width * width * 4 );
+	for( int b = 0; b < size; ++b )
+	{
+		for( int g = 0; g < size; ++g )
+		{
+			for( int r = 0; r < size; ++r )
+			{
+				unsigned char* p = &result[ ( ( b * size + g ) * size + r ) * 4 ];
+				p[ 0 ] = (unsigned char)( random ? random->Random( 0, 255 ) : r * 255 / ( size - 1 ) );
+				p[ 1 ] = (unsigned char)( random ? random->Random( 0, 255 ) : g * 255 / ( size - 1 ) );
+				p[ 2 ] = (unsigned char)( random ? random->Random( 0, 255 ) : b * 255 / ( size - 1 ) );
+				p[ 3 ] = 255;
+			}
+		}
+	}
+	return result;
+}
+
+// straight from the definition, in doubles
+double ColorLutTest_Sample( const std::vector< unsigned char >& image, int size, const unsigned char* rgba, int channel )
+{
+	int cell[ 3 ];
+	double fraction[ 3 ];
+	for( int i = 0; i < 3; ++i )
+	{
+		const double pos = rgba[ i ] * ( size - 1 ) / 255.0;
+		cell[ i ] = std::min( (int)pos, size - 2 );
+		fraction[ i ] = pos - cell[ i ];
+	}
+
+	double result = 0;
+	for( int corner = 0; corner < 8; ++corner )
+	{
+		double weight = 1;
+		int index = 0;
+		for( int i = 2; i >= 0; --i )
+		{
+			const int d = ( corner >> i ) & 1;
+			weight *= d ? fraction[ i ] : 1 - fraction[ i ];
+			index = index * size + cell[ i ] + d;
+		}
+		result += weight * image[ index * 4 + channel ];
+	}
+	return result;
+}
+
+} // end of anonymous namespace
+
+int CColorLutTest()
+{
+	// sizes GraphicsOpenGL::LoadTexture3d() wouldn't take
+	{
+		std::vector< unsigned char > image( 64 * 64 * 4 );
+		CColorLut lut;
+		test_assert( lut.Set( &image[ 0 ], 64, 32 ) == false );
+		test_assert( lut.Set( &image[ 0 ], 10, 10 ) == false );
+		test_assert( lut.Set( &image[ 0 ], 1, 1 ) == false );
+		test_assert( lut.Empty() );
+		test_assert( lut.Set( &image[ 0 ], 64, 64 ) );
+		test_assert( lut.GetSize() == 16 );
+		test_assert( lut.Load( "this_file_does_not_exist.png" ) == false );
+		test_assert( lut.Empty() );
+	}
+
+	CLGMRandom random;
+	random.SetSeed( 1234 );
+
+	const int count = 5000;
+	std::vector< unsigned char > pixels( count * 4 );
+	for( int i = 0; i < count * 4; ++i )
+		pixels[ i ] = (unsigned char)random.Random( 0, 255 );
+
+	// the identity gives back the same colors, alpha isn't touched
+	{
+		const std::vector< unsigned char > image = ColorLutTest_MakeImage( 4, NULL );
+		CColorLut lut;
+		test_assert( lut.Set( &image[ 0 ], 64, 64 ) );
+
+		std::vector< unsigned char > result = pixels;
+		lut.ApplyRow( &result[ 0 ], count );
+		test_assert( result == pixels );
+	}
+
+	// random tables against the definition, the rounding can be off by one
+	const int sizes[] = { 2, 3, 4 };
+	for( int s = 0; s < (int)( sizeof( sizes ) / sizeof( sizes[ 0 ] ) ); ++s )
+	{
+		const int z = sizes[ s ];
+		const int width = z * z * z;
+		const std::vector< unsigned char > image = ColorLutTest_MakeImage( z, &random );
+		const std::vector< unsigned char > image_next = ColorLutTest_MakeImage( z, &random );
+
+		CColorLut lut;
+		CColorLut lut_next;
+		test_assert( lut.Set( &image[ 0 ], width, width ) );
+		test_assert( lut_next.Set( &image_next[ 0 ], width, width ) );
+
+		const float interpolation = 0.3f;
+		std::vector< unsigned char > result = pixels;
+		std::vector< unsigned char > blended = pixels;
+		lut.ApplyRow( &result[ 0 ], count );
+		lut.ApplyRow( &blended[ 0 ], count, &lut_next, interpolation );
+
+		for( int i = 0; i < count; ++i )
+		{
+			const unsigned char* p = &pixels[ i * 4 ];
+			for( int c = 0; c < 3; ++c )
+			{
+				const double expected = ColorLutTest_Sample( image, z * z, p, c );
+				const double expected_next = ColorLutTest_Sample( image_next, z * z, p, c );
+				const double expected_blend = expected + ( expected_next - expected ) * interpolation;
+				test_assert( std::fabs( result[ i * 4 + c ] - expected ) <= 0.51 );
+				test_assert( std::fabs( blended[ i * 4 + c ] - expected_blend ) <= 0.51 );
+			}
+			test_assert( result[ i * 4 + 3 ] == p[ 3 ] );
+			test_assert( blended[ i * 4 + 3 ] == p[ 3 ] );
+		}
+
+		// over the thread pool, with padding between the rows
+		const int image_w = 70;
+		const int image_h = count / image_w;
+		const int stride = image_w * 4 + 12;
+		std::vector< unsigned char > padded( stride * image_h, 7 );
+		for( int y = 0; y < image_h; ++y )
+			std::copy( &pixels[ y * image_w * 4 ], &pixels[ ( y + 1 ) * image_w * 4 ], &padded[ y * stride ] );
+
+		std::vector< unsigned char > padded_blend = padded;
+		ApplyColorLut( &padded[ 0 ], image_w, image_h, stride, lut, 4 );
+		ApplyColorLut( &padded_blend[ 0 ], image_w, image_h, stride, lut, lut_next, interpolation, 4 );
+		for( int y = 0; y < image_h; ++y )
+		{
+			test_assert( std::equal( &padded[ y * stride ], &padded[ y * stride ] + image_w * 4, &result[ y * image_w * 4 ] ) );
+			test_assert( std::equal( &padded_blend[ y * stride ], &padded_blend[ y * stride ] + image_w * 4, &blended[ y * image_w * 4 ] ) );
+			test_assert( padded[ y * stride + image_w * 4 ] == 7 );
+		}
+	}
+
+	return 0;
+}
+
+TEST_REGISTER( CColorLutTest );
+
+} // end of namespace test
+} // end of namespace ceng
+
+#endif
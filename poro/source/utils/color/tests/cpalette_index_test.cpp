@@ -0,0 +1,94 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2003 - 2011 Petri Purho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+
+#include "../cpalette_index.h"
+#include "../../random/random.h"
+#include "../../debug.h"
+
+#ifdef CENG_TESTER_ENABLED
+
+namespace ceng {
+namespace test {
+
+int CPaletteIndexTest()
+{
+	// empty palette
+	{
+		CPaletteIndex index;
+		test_assert( index.Empty() );
+		test_assert( index.FindClosest( CColorFloat( 0.5f, 0.5f, 0.5f ) ) == 0 );
+	}
+
+	// exact colors are found from the palette
+	{
+		std::vector< CPaletteIndex::uint32 > colors;
+		colors.push_back( 0x000000 );
+		colors.push_back( 0xFF0000 );
+		colors.push_back( 0x00FF00 );
+		colors.push_back( 0x0000FF );
+
+		CPaletteIndex index( colors );
+		test_assert( index.Size() == 4 );
+		for( int i = 0; i < (int)colors.size(); ++i )
+			test_assert( index.FindClosest( CColorFloat( colors[ i ] ) ) == i );
+	}
+
+	// same results as the linear search, both for small and big palettes.
+	// The colors are on a coarse grid so that there are plenty of ties.
+	{
+		CLGMRandom random;
+		random.SetSeed( 1234 );
+
+		const int sizes[] = { 1, 3, 4, 31, 32, 33, 100, 1000 };
+		for( int s = 0; s < (int)( sizeof( sizes ) / sizeof( sizes[ 0 ] ) ); ++s )
+		{
+			std::vector< CPaletteIndex::uint32 > colors( sizes[ s ] );
+			for( int i = 0; i < (int)colors.size(); ++i )
+			{
+				if( i % 2 )
+					colors[ i ] = random.Random( 0, 7 ) * 32 | random.Random( 0, 7 ) * 32 << 8 | random.Random( 0, 7 ) * 32 << 16;
+				else
+					colors[ i ] = random.Random( 0, 0xFFFFFF );
+			}
+
+			CPaletteIndex index( colors );
+			for( int i = 0; i < 2000; ++i )
+			{
+				CColorFloat color;
+				if( i % 2 )
+					color = CColorFloat( random.Random( 0, 8 ) / 8.f, random.Random( 0, 8 ) / 8.f, random.Random( 0, 8 ) / 8.f );
+				else
+					color = CColorFloat( random.Randomf( -0.2f, 1.2f ), random.Randomf( -0.2f, 1.2f ), random.Randomf( -0.2f, 1.2f ) );
+
+				test_assert( index.FindClosest( color ) == index.FindClosestLinear( color ) );
+			}
+		}
+	}
+
+	return 0;
+}
+
+TEST_REGISTER( CPaletteIndexTest );
+
+} // end of namespace test
+} // end of namespace ceng
+
+#endif
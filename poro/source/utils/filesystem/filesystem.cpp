@@ -18,6 +18,8 @@
 
 #ifdef CENG_PLATFORM_WINDOWS
 #include <io.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 #include "../../poro/external/poro_windows.h"
 #include <shlobj.h>
 #endif
@@ -27,7 +29,14 @@
 #endif
 #ifdef CENG_PLATFORM_LINUX
 #include <sys/stat.h>
+#include <sys/inotify.h>
+#include <fcntl.h>
+#endif
+#if defined(CENG_PLATFORM_LINUX) || defined(CENG_PLATFORM_MACOSX)
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <fcntl.h>
+#include <unistd.h>
 #endif
 
 
@@ -150,6 +159,21 @@ bool DoesExist( const std::string& filename )
 	return true;
 }
 
+std::time_t GetFileModifiedTime( const std::string& filename )
+{
+	#ifdef CENG_PLATFORM_WINDOWS
+		struct _stat sb;
+		if( _stat( filename.c_str(), &sb ) != 0 )
+			return 0;
+	#else
+		struct stat sb;
+		if( stat( filename.c_str(), &sb ) != 0 )
+			return 0;
+	#endif
+
+	return sb.st_mtime;
+}
+
 std::string GetDateForFile( const std::string& filename )
 {
 	std::string result;
@@ -396,6 +420,217 @@ std::string MakeUniqueFilename( const std::string& file, const std::string& exte
 }
 
 
+CMappedFile::CMappedFile() :
+	mData( NULL ),
+	mSize( 0 ),
+	mMapping( NULL ),
+	mBuffer()
+{
+}
+
+CMappedFile::~CMappedFile()
+{
+	Close();
+}
+
+bool CMappedFile::Open( const std::string& filename )
+{
+	Close();
+
+#if defined(CENG_PLATFORM_WINDOWS)
+	HANDLE file = CreateFileA( filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+	if( file == INVALID_HANDLE_VALUE )
+		return false;
+
+	const DWORD size = GetFileSize( file, NULL );
+	if( size != INVALID_FILE_SIZE && size > 0 )
+	{
+		HANDLE mapping = CreateFileMappingA( file, NULL, PAGE_READONLY, 0, 0, NULL );
+		if( mapping )
+		{
+			mMapping = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+			// the view keeps the mapping alive
+			CloseHandle( mapping );
+		}
+	}
+	CloseHandle( file );
+
+	if( mMapping )
+	{
+		mData = (const char*)mMapping;
+		mSize = (long)size;
+		return true;
+	}
+	else if( size == 0 )
+	{
+		return true;
+	}
+
+#elif defined(CENG_PLATFORM_LINUX) || defined(CENG_PLATFORM_MACOSX)
+	const int file = open( filename.c_str(), O_RDONLY );
+	if( file < 0 )
+		return false;
+
+	struct stat sb;
+	const bool stat_ok = fstat( file, &sb ) == 0;
+	if( stat_ok && sb.st_size > 0 )
+	{
+		void* mapping = mmap( NULL, (size_t)sb.st_size, PROT_READ, MAP_PRIVATE, file, 0 );
+		if( mapping != MAP_FAILED )
+		{
+			mMapping = mapping;
+			mData = (const char*)mapping;
+			mSize = (long)sb.st_size;
+		}
+	}
+	close( file );
+
+	if( mMapping || ( stat_ok && sb.st_size == 0 ) )
+		return true;
+#endif
+
+	// couldn't map it, so we read it
+	std::fstream file_input;
+	file_input.open( filename.c_str(), std::ios::in | std::ios::binary );
+	if( file_input.is_open() == false )
+		return false;
+
+	const long size = ReadFileSize( file_input );
+	if( size > 0 )
+	{
+		mBuffer.resize( size );
+		file_input.read( &mBuffer[ 0 ], size );
+		mData = &mBuffer[ 0 ];
+		mSize = (long)file_input.gcount();
+	}
+
+	file_input.close();
+	return true;
+}
+
+void CMappedFile::Close()
+{
+#if defined(CENG_PLATFORM_WINDOWS)
+	if( mMapping ) 
+		UnmapViewOfFile( mMapping );
+#elif defined(CENG_PLATFORM_LINUX) || defined(CENG_PLATFORM_MACOSX)
+	if( mMapping ) 
+		munmap( mMapping, (size_t)mSize );
+#endif
+
+	mMapping = NULL;
+	mData = NULL;
+	mSize = 0;
+	mBuffer.clear();
+}
+
+//-----------------------------------------------------------------------------
+
+CFileWatcher::CFileWatcher() :
+	mHandle( -1 ),
+	mDirectories(),
+	mFiles()
+{
+#if defined(CENG_PLATFORM_LINUX)
+	mHandle = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+	if( mHandle < 0 )
+		logger_warning << "CFileWatcher - inotify_init1 failed, files will be polled" << std::endl;
+#endif
+}
+
+CFileWatcher::~CFileWatcher()
+{
+#if defined(CENG_PLATFORM_LINUX)
+	if( mHandle >= 0 )
+		close( mHandle );
+#endif
+}
+
+bool CFileWatcher::IsEventDriven() const
+{
+	return mHandle >= 0;
+}
+
+bool CFileWatcher::AddFile( const std::string& filename )
+{
+	if( mHandle < 0 )
+		return false;
+
+	if( HasFile( filename ) )
+		return true;
+
+	// the directory is watched instead of the file, because editors often 
+	// save by writing a new file and renaming it over the old one
+	const std::string directory = GetParentPath( filename );
+
+#if defined(CENG_PLATFORM_LINUX)
+	const int watch = inotify_add_watch( mHandle, directory.empty() ? "." : directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO );
+	if( watch < 0 )
+		return false;
+
+	std::vector< std::string >& prefixes = mDirectories[ watch ];
+	const std::string prefix = directory.empty() ? "" : directory + separator;
+	if( std::find( prefixes.begin(), prefixes.end(), prefix ) == prefixes.end() )
+		prefixes.push_back( prefix );
+
+	mFiles.insert( filename );
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool CFileWatcher::HasFile( const std::string& filename ) const
+{
+	return mFiles.find( filename ) != mFiles.end();
+}
+
+void CFileWatcher::GetChanges( std::vector< std::string >& output )
+{
+#if defined(CENG_PLATFORM_LINUX)
+	if( mHandle < 0 )
+		return;
+
+	// long for the alignment of inotify_event
+	long buffer[ 1024 ];
+	for( ;; )
+	{
+		// returns -1 with EAGAIN when there's nothing more to read
+		const ssize_t size = read( mHandle, buffer, sizeof( buffer ) );
+		if( size <= 0 )
+			break;
+
+		const char* p = (const char*)buffer;
+		const char* end = p + size;
+		while( p < end )
+		{
+			const inotify_event* event = (const inotify_event*)p;
+			p += sizeof( inotify_event ) + event->len;
+
+			// events were lost, so anything could have changed
+			if( event->mask & IN_Q_OVERFLOW )
+			{
+				output.insert( output.end(), mFiles.begin(), mFiles.end() );
+				continue;
+			}
+
+			std::map< int, std::vector< std::string > >::const_iterator directory = mDirectories.find( event->wd );
+			if( event->len == 0 || directory == mDirectories.end() )
+				continue;
+
+			for( std::size_t i = 0; i < directory->second.size(); ++i )
+			{
+				const std::string filename = directory->second[ i ] + event->name;
+				if( HasFile( filename ) )
+					output.push_back( filename );
+			}
+		}
+	}
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
 void CopyFileCeng( const std::string& from, const std::string& to )
 {
 #ifdef CENG_PLATFORM_WINDOWS
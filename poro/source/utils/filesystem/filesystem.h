@@ -3,8 +3,12 @@
 
 #pragma warning(disable:4786)
 
+#include <ctime>
 #include <string>
 #include <list>
+#include <map>
+#include <set>
+#include <vector>
 
 #include "../safearray/csafearray.h"
 
@@ -12,6 +16,8 @@ namespace ceng
 {
 	void		CreateDir( const std::string& directory );
 	std::string GetDateForFile( const std::string& file );
+	// last modification time, 0 if the file doesn't exist
+	std::time_t	GetFileModifiedTime( const std::string& file );
 	bool		DoesExist( const std::string& file );
 
 	void CopyFileCeng( const std::string& from, const std::string& to );
@@ -25,6 +31,59 @@ namespace ceng
 	// every line is a separate element in the vector
 	void ReadFileToVector( const std::string& filename, std::vector< std::string >& output );		
 
+	// Read only view to the whole file. The file is memory mapped where the
+	// platform can do it, otherwise it's read to a buffer in one go.
+	class CMappedFile
+	{
+	public:
+		CMappedFile();
+		~CMappedFile();
+
+		bool		Open( const std::string& filename );
+		void		Close();
+
+		const char*	GetData() const { return mData; }
+		long		GetSize() const { return mSize; }
+
+	private:
+		CMappedFile( const CMappedFile& other );
+		CMappedFile& operator=( const CMappedFile& other );
+
+		const char*			mData;
+		long				mSize;
+		void*				mMapping;
+		std::vector< char >	mBuffer;
+	};
+
+	// Tells which files have been written. Uses inotify on linux, so there's
+	// no cost while nothing changes. On the other platforms (or if a file's
+	// directory can't be watched) AddFile() returns false and the file has to
+	// be polled with GetFileModifiedTime().
+	class CFileWatcher
+	{
+	public:
+		CFileWatcher();
+		~CFileWatcher();
+
+		bool		IsEventDriven() const;
+
+		bool		AddFile( const std::string& filename );
+		bool		HasFile( const std::string& filename ) const;
+
+		// appends the files written since the last call, doesn't block. 
+		// A file can be there more than once if it was written many times.
+		void		GetChanges( std::vector< std::string >& output );
+
+	private:
+		CFileWatcher( const CFileWatcher& other );
+		CFileWatcher& operator=( const CFileWatcher& other );
+
+		int												mHandle;
+		// watch -> the directories as they were written in the filenames
+		std::map< int, std::vector< std::string > >		mDirectories;
+		std::set< std::string >							mFiles;
+	};
+
 	std::string GetFilename( const std::string& filename );
 	std::string GetFileExtension( const std::string& filename );
 	std::string GetFilenameWithoutExtension( const std::string& filename );
@@ -22,10 +22,14 @@
 #ifndef INC_CHOTLOADER_H
 #define INC_CHOTLOADER_H
 
+#include <algorithm>
+#include <ctime>
 #include <string>
 #include <vector>
 #include <map>
 
+#include "../filesystem/filesystem.h"
+
 namespace ceng {
 
 //-----------------------------------------------------------------------------
@@ -43,6 +47,10 @@ public:
 //-----------------------------------------------------------------------------
 
 // autoloader 
+// Files are watched with CFileWatcher where the platform supports it (inotify
+// on linux), the rest are polled every mCheckFilesEveryTSeconds. Changes are 
+// collected and the listeners are called from Update(), once per file even if
+// the file was written many times.
 class CHotloader
 {
 public:
@@ -71,7 +79,14 @@ public:
 	float mCheckFilesEveryTSeconds; // when time passes this we check files. Default check every 1 seconds
 
 	std::vector< IHotloaderListener* > mHotListeners;
-	std::map< std::string, std::string > mTimeStamps;
+
+	// only the files that the watcher couldn't take are polled
+	CFileWatcher mWatcher;
+	std::map< std::string, std::time_t > mTimeStamps;
+	std::vector< std::string > mChangedFiles;
+
+private:
+	void WatchFile( const std::string& filename );
 };
 
 //-----------------------------------------------------------------------------
@@ -81,7 +96,6 @@ public:
 // this is copied from chotloader.cpp and can be moved into .cpp file if that's
 // better, but I'm tired of linking problems right now :)
 // chotloader.cpp 
-#include "../filesystem/filesystem.h"
 #include "../vector_utils/vector_utils.h"
 
 namespace ceng { 
@@ -93,17 +107,37 @@ inline void CHotloader::Clear()
 
 inline void CHotloader::Update( float dt )
 {
-	mTime += dt;
-	if( mTime > mCheckFilesEveryTSeconds ) { CheckFiles(); mTime = 0; }
+	// one non-blocking read, when nothing has changed that's all it costs
+	if( mWatcher.IsEventDriven() )
+		mWatcher.GetChanges( mChangedFiles );
+
+	if( mTimeStamps.empty() == false )
+	{
+		mTime += dt;
+		if( mTime > mCheckFilesEveryTSeconds ) { CheckFiles(); mTime = 0; }
+	}
+
+	if( mChangedFiles.empty() == false )
+	{
+		// swapped out in case a listener adds hot files while reloading
+		std::vector< std::string > changed_files;
+		changed_files.swap( mChangedFiles );
+
+		std::sort( changed_files.begin(), changed_files.end() );
+		changed_files.erase( std::unique( changed_files.begin(), changed_files.end() ), changed_files.end() );
+
+		for( std::size_t i = 0; i < changed_files.size(); ++i ) 
+			FileChanged( changed_files[ i ] );
+	}
 }
 
 inline void CHotloader::CheckFiles()
 {
-	std::map< std::string, std::string >::iterator i;
-	std::string timestamp;
+	std::map< std::string, std::time_t >::iterator i;
+	std::time_t timestamp;
 	for( i = mTimeStamps.begin(); i != mTimeStamps.end(); ++i ) 
 	{
-		timestamp = GetDateForFile( i->first );
+		timestamp = GetFileModifiedTime( i->first );
 		if( timestamp != i->second ) 
 		{
 			FileChanged( i->first );
@@ -135,10 +169,7 @@ inline void CHotloader::AddListener( IHotloaderListener* hot_listener )
 	if( unique ) 
 	{
 		for( std::size_t i = 0; i < hot_listener->mHotloadingFilenames.size(); ++i ) 
-		{
-			std::string timestamp = GetDateForFile( hot_listener->mHotloadingFilenames[ i ] );
-			mTimeStamps[ hot_listener->mHotloadingFilenames[ i ] ] = timestamp;
-		}
+			WatchFile( hot_listener->mHotloadingFilenames[ i ] );
 	}
 }
 
@@ -153,15 +184,7 @@ inline void CHotloader::AddHotFile( const std::string& filename, IHotloaderListe
 	if( unique ) 
 	{
 		for( std::size_t i = 0; i < hot_listener->mHotloadingFilenames.size(); ++i ) 
-		{
-			std::string filename = hot_listener->mHotloadingFilenames[ i ];
-			if( mTimeStamps.find( filename ) == mTimeStamps.end() ) 
-			{
-				std::string timestamp = GetDateForFile( hot_listener->mHotloadingFilenames[ i ] );
-				mTimeStamps[ hot_listener->mHotloadingFilenames[ i ] ] = timestamp;
-			}
-		}
-
+			WatchFile( hot_listener->mHotloadingFilenames[ i ] );
 	}
 }
 
@@ -176,6 +199,15 @@ inline void CHotloader::SetCheckFilesEveryTSeconds( float t )
 	mCheckFilesEveryTSeconds = t;
 }
 
+inline void CHotloader::WatchFile( const std::string& filename )
+{
+	if( mWatcher.HasFile( filename ) || mTimeStamps.find( filename ) != mTimeStamps.end() )
+		return;
+
+	if( mWatcher.AddFile( filename ) == false )
+		mTimeStamps[ filename ] = GetFileModifiedTime( filename );
+}
+
 } // end of namespace ceng
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,125 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2003 - 2011 Petri Purho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+
+#include "../chotloader.h"
+#include "../../debug.h"
+
+#include <cstdio>
+#include <fstream>
+
+#ifdef CENG_TESTER_ENABLED
+
+namespace ceng {
+namespace test {
+
+namespace {
+
+class CHotloaderTest_Listener : public IHotloaderListener
+{
+public:
+	CHotloaderTest_Listener() : count( 0 ) { }
+
+	virtual void OnHotFileChange( const std::string& filename ) 
+	{ 
+		count++;
+		last = filename;
+	}
+
+	int			count;
+	std::string	last;
+};
+
+void CHotloaderTest_Write( const std::string& filename, const std::string& data )
+{
+	std::ofstream file( filename.c_str(), std::ios::out | std::ios::binary );
+	file << data;
+}
+
+} // end of anonymous namespace
+
+int CHotloaderTest()
+{
+	const std::string filename = "chotloader_test.txt";
+	const std::string other = "chotloader_test_other.txt";
+	CHotloaderTest_Write( filename, "1" );
+	CHotloaderTest_Write( other, "1" );
+
+	{
+		CHotloader hotloader;
+		CHotloaderTest_Listener listener;
+		CHotloaderTest_Listener other_listener;
+		other_listener.mHotloadingFilenames.push_back( other );
+
+		hotloader.AddHotFile( filename, &listener );
+		hotloader.AddListener( &other_listener );
+		hotloader.Update( 0 );
+		test_assert( listener.count == 0 );
+		test_assert( other_listener.count == 0 );
+
+		// only the listeners of the file are called
+		hotloader.FileChanged( filename );
+		test_assert( listener.count == 1 );
+		test_assert( other_listener.count == 0 );
+		listener.count = 0;
+
+		// with inotify the changes are there on the next update, and writing 
+		// the same file many times is one change
+		if( hotloader.mWatcher.IsEventDriven() )
+		{
+			test_assert( hotloader.mTimeStamps.empty() );
+
+			CHotloaderTest_Write( filename, "2" );
+			CHotloaderTest_Write( filename, "3" );
+			CHotloaderTest_Write( other, "2" );
+			hotloader.Update( 0 );
+			test_assert( listener.count == 1 );
+			test_assert( listener.last == filename );
+			test_assert( other_listener.count == 1 );
+
+			hotloader.Update( 0 );
+			test_assert( listener.count == 1 );
+			test_assert( other_listener.count == 1 );
+			other_listener.count = 0;
+		}
+
+		// polled files are checked when the time is up
+		hotloader.mTimeStamps[ other ] = 0;
+		hotloader.SetCheckFilesEveryTSeconds( 1.f );
+		hotloader.Update( 0.5f );
+		test_assert( other_listener.count == 0 );
+		hotloader.Update( 0.6f );
+		test_assert( other_listener.count == 1 );
+		test_assert( other_listener.last == other );
+		hotloader.Update( 1.1f );
+		test_assert( other_listener.count == 1 );
+	}
+
+	remove( filename.c_str() );
+	remove( other.c_str() );
+	return 0;
+}
+
+TEST_REGISTER( CHotloaderTest );
+
+} // end of namespace test
+} // end of namespace ceng
+
+#endif
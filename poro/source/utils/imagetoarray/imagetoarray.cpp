@@ -1,37 +1,119 @@
 #include "imagetoarray.h"
 
 #include <poro/external/stb_image.h>
-#include <poro/external/stb_image_write.h>
 
 #include <utils/color/ccolor.h>
+#include <utils/filesystem/filesystem.h>
+#include <utils/pngreader/pngreader.h>
+#include <utils/pngwriter/pngwriter.h>
+
+#include <algorithm>
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#	define CENG_IMAGETOARRAY_SSE2
+#	include <emmintrin.h>
+#endif
+
+namespace imagetoarray {
+namespace {
+
+	// the same layout stbi_load() gives with 4 channels. data is NULL if the
+	// rows couldn't be read
+	TempTexture* ImageToArrayReadRows( ceng::CPngRowReader& reader, const std::string& filename )
+	{
+		TempTexture* result = new TempTexture;
+		result->filename = filename;
+		result->width = reader.GetWidth();
+		result->height = reader.GetHeight();
+		result->bpp = 4;
+		result->data = new unsigned char[ result->width * result->height * 4 ];
+
+		for( int y = 0; y < result->height; ++y )
+		{
+			if( reader.ReadRow( result->data + y * result->width * 4 ) == false )
+			{
+				delete [] result->data;
+				result->data = NULL;
+				break;
+			}
+		}
+
+		return result;
+	}
+
+	// the pngs that can be streamed are read with CPngRowReader, it decodes
+	// straight into the texture
+	TempTexture* ImageToArrayDecode( const std::string& filename )
+	{
+		ceng::CPngRowReader reader;
+		if( reader.Open( filename ) )
+			return ImageToArrayReadRows( reader, filename );
+
+		return GetTexture( filename );
+	}
+
+} // end of anonymous namespace
+} // end of namespace imagetoarray
 
 //-----------------------------------------------------------------------------
-void LoadImage( const std::string& filename, ceng::CArray2D< poro::types::Uint32 >& out_array2d, bool include_alpha )
+bool LoadImage( const std::string& filename, ceng::CArray2D< poro::types::Uint32 >& out_array2d, bool include_alpha )
 {
 	using namespace imagetoarray;
 
-	TempTexture* surface = GetTexture(filename);
+	ImageCache& cache = GetImageCache();
+	const TempTexture* surface = NULL;
 
-	if( surface == NULL || surface->data == NULL )
+	if( cache.Contains( filename ) )
 	{
-		std::cout << "LoadImage() - Failed to load image: " << filename << std::endl;
-		return;		
+		surface = cache.Acquire( filename );
 	}
-	
-	out_array2d.Resize( surface->w, surface->h );
-
-	if( surface )
+	else
 	{
-		for( int y = 0; y < surface->h; ++y )
+		ceng::CPngRowReader reader;
+		if( reader.Open( filename ) )
 		{
-			for( int x = 0; x < surface->w; ++x )
+			const int w = reader.GetWidth();
+			const int h = reader.GetHeight();
+
+			// too big to keep around, the rows go straight into the array
+			// so that there's never two copies of the image
+			if( (std::size_t)w * h * 4 > cache.GetMaxSize() )
 			{
-				out_array2d.Rand( x, y ) = GetPixel( surface, x, y, include_alpha );
+				out_array2d.Resize( w, h );
+				std::vector< unsigned char > row( w * 4 );
+				for( int y = 0; y < h; ++y )
+				{
+					if( reader.ReadRow( &row[ 0 ] ) == false )
+					{
+						std::cout << "LoadImage() - Broken image: " << filename << std::endl;
+						return false;
+					}
+
+					ConvertRow( &row[ 0 ], w, &out_array2d.Rand( 0, y ), include_alpha );
+				}
+				return true;
 			}
+
+			surface = cache.Insert( filename, ImageToArrayReadRows( reader, filename ) );
+		}
+		else
+		{
+			surface = cache.Acquire( filename );
 		}
 	}
 
-	delete surface;
+	if( surface == NULL )
+	{
+		std::cout << "LoadImage() - Failed to load image: " << filename << std::endl;
+		return false;
+	}
+	
+	out_array2d.Resize( surface->w, surface->h );
+	for( int y = 0; y < surface->h; ++y )
+		ConvertRow( surface->data + y * surface->w * 4, surface->w, &out_array2d.Rand( 0, y ), include_alpha );
+
+	cache.Release( surface );
+	return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -61,7 +143,7 @@ void SaveImage( const std::string& filename, const ceng::CArray2D< poro::types::
 		}
 	}
 
-	stbi_write_png( filename.c_str(), w, h, 4, pixels, w * 4 );
+	ceng::WritePng( filename, w, h, 4, pixels, w * 4 );
 	// poro::IPlatform::Instance()->GetGraphics()->ImageSave( filename.c_str(), w, h, 4, pixels, w * 4 );
 
 	delete [] pixels;
@@ -71,6 +153,202 @@ void SaveImage( const std::string& filename, const ceng::CArray2D< poro::types::
 
 namespace imagetoarray {
 
+namespace {
+
+	inline uint32 ImageToArrayReadPixel( const unsigned char* p, bool include_alpha )
+	{
+		uint32 result = p[ 0 ] << 16 | p[ 1 ] << 8 | p[ 2 ];
+		if( include_alpha ) 
+			result |= p[ 3 ] << 24;
+		return result;
+	}
+
+	// open addressing hash set for the colors, GetUniqueColors() only needs
+	// insert
+	class ImageToArrayColorSet
+	{
+	public:
+		ImageToArrayColorSet() : mKeys(), mUsed(), mSize( 0 ) { Rehash( 1024 ); }
+
+		// returns true if the color wasn't in the set
+		bool Insert( uint32 color )
+		{
+			if( 2 * ( mSize + 1 ) > mKeys.size() ) 
+				Rehash( 2 * mKeys.size() );
+
+			if( InsertImpl( color ) == false )
+				return false;
+
+			mSize++;
+			return true;
+		}
+
+	private:
+		bool InsertImpl( uint32 color )
+		{
+			const std::size_t mask = mKeys.size() - 1;
+			uint32 hash = ( color ^ ( color >> 16 ) ) * 0x45d9f3b;
+			hash ^= hash >> 16;
+			std::size_t i = hash & mask;
+			while( mUsed[ i ] )
+			{
+				if( mKeys[ i ] == color ) 
+					return false;
+				i = ( i + 1 ) & mask;
+			}
+
+			mUsed[ i ] = 1;
+			mKeys[ i ] = color;
+			return true;
+		}
+
+		void Rehash( std::size_t size )
+		{
+			std::vector< uint32 > keys( size );
+			std::vector< unsigned char > used( size, 0 );
+			keys.swap( mKeys );
+			used.swap( mUsed );
+
+			for( std::size_t i = 0; i < keys.size(); ++i )
+			{
+				if( used[ i ] ) 
+					InsertImpl( keys[ i ] );
+			}
+		}
+
+		std::vector< uint32 >			mKeys;
+		std::vector< unsigned char >	mUsed;
+		std::size_t						mSize;
+	};
+
+	//.........................................................................
+	// median cut 
+
+	const int QUANTIZE_BITS = 5;
+	const int QUANTIZE_SIDE = 1 << QUANTIZE_BITS;
+
+	inline int QuantizeBin( int r, int g, int b )
+	{
+		return ( r * QUANTIZE_SIDE + g ) * QUANTIZE_SIDE + b;
+	}
+
+	struct QuantizeHistogram
+	{
+		std::vector< unsigned int > count;
+		std::vector< double > sum_r;
+		std::vector< double > sum_g;
+		std::vector< double > sum_b;
+	};
+
+	struct QuantizeBox
+	{
+		// inclusive, in histogram bins
+		int min[ 3 ];
+		int max[ 3 ];
+		double count;
+
+		bool CanSplit() const 
+		{
+			return min[ 0 ] != max[ 0 ] || min[ 1 ] != max[ 1 ] || min[ 2 ] != max[ 2 ];
+		}
+	};
+
+	bool QuantizeBoxCountGreater( const QuantizeBox& a, const QuantizeBox& b )
+	{
+		return a.count > b.count;
+	}
+
+	// shrinks the box to the bins that have pixels in them and counts the 
+	// pixels
+	void QuantizeShrink( const QuantizeHistogram& hist, QuantizeBox& box )
+	{
+		int min[ 3 ] = { QUANTIZE_SIDE, QUANTIZE_SIDE, QUANTIZE_SIDE };
+		int max[ 3 ] = { -1, -1, -1 };
+		double count = 0;
+
+		for( int r = box.min[ 0 ]; r <= box.max[ 0 ]; ++r )
+		for( int g = box.min[ 1 ]; g <= box.max[ 1 ]; ++g )
+		for( int b = box.min[ 2 ]; b <= box.max[ 2 ]; ++b )
+		{
+			const unsigned int c = hist.count[ QuantizeBin( r, g, b ) ];
+			if( c == 0 ) continue;
+
+			count += c;
+			const int v[ 3 ] = { r, g, b };
+			for( int a = 0; a < 3; ++a )
+			{
+				min[ a ] = std::min( min[ a ], v[ a ] );
+				max[ a ] = std::max( max[ a ], v[ a ] );
+			}
+		}
+
+		for( int a = 0; a < 3; ++a )
+		{
+			box.min[ a ] = min[ a ];
+			box.max[ a ] = max[ a ];
+		}
+		box.count = count;
+	}
+
+	// splits the box at the median of its longest side, box becomes the lower
+	// half and the upper half is returned
+	QuantizeBox QuantizeSplit( const QuantizeHistogram& hist, QuantizeBox& box )
+	{
+		int axis = 0;
+		for( int a = 1; a < 3; ++a )
+		{
+			if( box.max[ a ] - box.min[ a ] > box.max[ axis ] - box.min[ axis ] )
+				axis = a;
+		}
+
+		double slices[ QUANTIZE_SIDE ] = { 0 };
+		for( int r = box.min[ 0 ]; r <= box.max[ 0 ]; ++r )
+		for( int g = box.min[ 1 ]; g <= box.max[ 1 ]; ++g )
+		for( int b = box.min[ 2 ]; b <= box.max[ 2 ]; ++b )
+		{
+			const int v[ 3 ] = { r, g, b };
+			slices[ v[ axis ] ] += hist.count[ QuantizeBin( r, g, b ) ];
+		}
+
+		// the last slice always goes to the upper half so neither is empty
+		int split = box.min[ axis ];
+		double total = slices[ split ];
+		while( split + 1 < box.max[ axis ] && total + slices[ split + 1 ] <= box.count * 0.5 )
+		{
+			++split;
+			total += slices[ split ];
+		}
+
+		QuantizeBox upper = box;
+		upper.min[ axis ] = split + 1;
+		box.max[ axis ] = split;
+
+		QuantizeShrink( hist, box );
+		QuantizeShrink( hist, upper );
+		return upper;
+	}
+
+	uint32 QuantizeAverage( const QuantizeHistogram& hist, const QuantizeBox& box )
+	{
+		double r = 0, g = 0, b = 0;
+		for( int br = box.min[ 0 ]; br <= box.max[ 0 ]; ++br )
+		for( int bg = box.min[ 1 ]; bg <= box.max[ 1 ]; ++bg )
+		for( int bb = box.min[ 2 ]; bb <= box.max[ 2 ]; ++bb )
+		{
+			const int i = QuantizeBin( br, bg, bb );
+			r += hist.sum_r[ i ];
+			g += hist.sum_g[ i ];
+			b += hist.sum_b[ i ];
+		}
+
+		const uint32 ir = (uint32)( r / box.count + 0.5 );
+		const uint32 ig = (uint32)( g / box.count + 0.5 );
+		const uint32 ib = (uint32)( b / box.count + 0.5 );
+		return ir << 16 | ig << 8 | ib;
+	}
+
+} // end of anonymous namespace
+
 
 TempTexture* GetTexture( const std::string& filename )
 {
@@ -87,5 +365,269 @@ uint32 GetPixel(TempTexture* surface, int x, int y, bool include_alpha )
 	return surface->GetPixel( x, y, include_alpha );
 }
 
+void ConvertRow( const unsigned char* rgba, int count, uint32* out, bool include_alpha )
+{
+	int i = 0;
+
+#ifdef CENG_IMAGETOARRAY_SSE2
+	// rgba read as a little endian 32 bit value is 0xAABBGGRR, so r and b
+	// swap places
+	const __m128i mask_g = _mm_set1_epi32( 0x0000FF00 );
+	const __m128i mask_low = _mm_set1_epi32( 0x000000FF );
+	const __m128i mask_a = _mm_set1_epi32( include_alpha ? 0xFF000000 : 0 );
+	for( ; i + 4 <= count; i += 4 )
+	{
+		const __m128i p = _mm_loadu_si128( (const __m128i*)( rgba + i * 4 ) );
+		const __m128i r = _mm_slli_epi32( _mm_and_si128( p, mask_low ), 16 );
+		const __m128i b = _mm_and_si128( _mm_srli_epi32( p, 16 ), mask_low );
+		const __m128i ga = _mm_and_si128( p, _mm_or_si128( mask_g, mask_a ) );
+		_mm_storeu_si128( (__m128i*)( out + i ), _mm_or_si128( _mm_or_si128( r, b ), ga ) );
+	}
+#endif
+
+	for( ; i < count; ++i )
+		out[ i ] = ImageToArrayReadPixel( rgba + i * 4, include_alpha );
+}
+
+//-----------------------------------------------------------------------------
+
+ImageCache::ImageCache( std::size_t max_size ) :
+	mEntries(),
+	mSize( 0 ),
+	mMaxSize( max_size ),
+	mClock( 0 )
+{
+}
+
+ImageCache::~ImageCache()
+{
+	for( std::size_t i = 0; i < mEntries.size(); ++i )
+	{
+		delete mEntries[ i ]->texture;
+		delete mEntries[ i ];
+	}
+	mEntries.clear();
+}
+
+const TempTexture* ImageCache::Acquire( const std::string& filename )
+{
+	Entry* entry = Find( filename );
+	if( entry && entry->modified != ceng::GetFileModifiedTime( filename ) )
+	{
+		entry->stale = true;
+		entry = NULL;
+	}
+
+	if( entry == NULL )
+		return Insert( filename, ImageToArrayDecode( filename ) );
+
+	entry->references++;
+	entry->last_used = ++mClock;
+	return entry->texture;
+}
+
+void ImageCache::Release( const TempTexture* texture )
+{
+	if( texture == NULL ) 
+		return;
+
+	for( std::size_t i = 0; i < mEntries.size(); ++i )
+	{
+		if( mEntries[ i ]->texture == texture )
+		{
+			mEntries[ i ]->references--;
+			break;
+		}
+	}
+
+	Trim( mMaxSize );
+}
+
+const TempTexture* ImageCache::Insert( const std::string& filename, TempTexture* texture )
+{
+	if( texture == NULL || texture->data == NULL )
+	{
+		delete texture;
+		return NULL;
+	}
+
+	Entry* old = Find( filename );
+	if( old ) 
+		old->stale = true;
+
+	Entry* entry = new Entry;
+	entry->filename = filename;
+	entry->modified = ceng::GetFileModifiedTime( filename );
+	entry->texture = texture;
+	entry->references = 1;
+	entry->last_used = ++mClock;
+	entry->stale = false;
+	mEntries.push_back( entry );
+	mSize += (std::size_t)texture->width * texture->height * 4;
+
+	Trim( mMaxSize );
+	return texture;
+}
+
+bool ImageCache::Contains( const std::string& filename ) const
+{
+	const Entry* entry = Find( filename );
+	return entry && entry->modified == ceng::GetFileModifiedTime( filename );
+}
+
+void ImageCache::Clear()
+{
+	Trim( 0 );
+}
+
+std::size_t ImageCache::GetSize() const
+{
+	return mSize;
+}
+
+std::size_t ImageCache::GetMaxSize() const
+{
+	return mMaxSize;
+}
+
+void ImageCache::SetMaxSize( std::size_t max_size )
+{
+	mMaxSize = max_size;
+	Trim( mMaxSize );
+}
+
+ImageCache::Entry* ImageCache::Find( const std::string& filename ) const
+{
+	for( std::size_t i = 0; i < mEntries.size(); ++i )
+	{
+		if( mEntries[ i ]->stale == false && mEntries[ i ]->filename == filename )
+			return mEntries[ i ];
+	}
+
+	return NULL;
+}
+
+// drops the stale images and then the least recently used ones until the
+// size is under max_size
+void ImageCache::Trim( std::size_t max_size )
+{
+	for( std::size_t i = 0; i < mEntries.size(); )
+	{
+		if( mEntries[ i ]->stale && mEntries[ i ]->references <= 0 )
+			Erase( i );
+		else
+			++i;
+	}
+
+	while( mSize > max_size )
+	{
+		int oldest = -1;
+		for( int i = 0; i < (int)mEntries.size(); ++i )
+		{
+			if( mEntries[ i ]->references <= 0 && ( oldest < 0 || mEntries[ i ]->last_used < mEntries[ oldest ]->last_used ) )
+				oldest = i;
+		}
+
+		if( oldest < 0 ) 
+			break;
+
+		Erase( oldest );
+	}
+}
+
+void ImageCache::Erase( std::size_t i )
+{
+	Entry* entry = mEntries[ i ];
+	mSize -= (std::size_t)entry->texture->width * entry->texture->height * 4;
+	delete entry->texture;
+	delete entry;
+	mEntries.erase( mEntries.begin() + i );
+}
+
+ImageCache& GetImageCache()
+{
+	static ImageCache cache;
+	return cache;
+}
+
+//-----------------------------------------------------------------------------
+
+void GetUniqueColors( const TempTexture* surface, std::vector< uint32 >& out_colors, bool include_alpha )
+{
+	out_colors.clear();
+	if( surface == NULL || surface->data == NULL ) return;
+
+	ImageToArrayColorSet set;
+	const unsigned char* p = surface->data;
+	const int pixel_count = surface->width * surface->height;
+	for( int i = 0; i < pixel_count; ++i, p += 4 )
+	{
+		const uint32 color = ImageToArrayReadPixel( p, include_alpha );
+		if( set.Insert( color ) )
+			out_colors.push_back( color );
+	}
+}
+
+void QuantizeColors( const TempTexture* surface, int palette_size, std::vector< uint32 >& out_colors )
+{
+	out_colors.clear();
+	if( surface == NULL || surface->data == NULL || palette_size <= 0 ) return;
+
+	const int bin_count = QUANTIZE_SIDE * QUANTIZE_SIDE * QUANTIZE_SIDE;
+	QuantizeHistogram hist;
+	hist.count.resize( bin_count, 0 );
+	hist.sum_r.resize( bin_count, 0 );
+	hist.sum_g.resize( bin_count, 0 );
+	hist.sum_b.resize( bin_count, 0 );
+
+	const int shift = 8 - QUANTIZE_BITS;
+	const unsigned char* p = surface->data;
+	const int pixel_count = surface->width * surface->height;
+	for( int i = 0; i < pixel_count; ++i, p += 4 )
+	{
+		const int bin = QuantizeBin( p[ 0 ] >> shift, p[ 1 ] >> shift, p[ 2 ] >> shift );
+		hist.count[ bin ]++;
+		hist.sum_r[ bin ] += p[ 0 ];
+		hist.sum_g[ bin ] += p[ 1 ];
+		hist.sum_b[ bin ] += p[ 2 ];
+	}
+
+	if( pixel_count <= 0 ) return;
+
+	std::vector< QuantizeBox > boxes;
+	{
+		QuantizeBox box;
+		for( int a = 0; a < 3; ++a )
+		{
+			box.min[ a ] = 0;
+			box.max[ a ] = QUANTIZE_SIDE - 1;
+		}
+		QuantizeShrink( hist, box );
+		boxes.push_back( box );
+	}
+
+	// always split the box with the most pixels in it
+	while( (int)boxes.size() < palette_size )
+	{
+		int best = -1;
+		for( int i = 0; i < (int)boxes.size(); ++i )
+		{
+			if( boxes[ i ].CanSplit() && ( best < 0 || boxes[ i ].count > boxes[ best ].count ) )
+				best = i;
+		}
+
+		if( best < 0 ) break;
+
+		QuantizeBox upper = QuantizeSplit( hist, boxes[ best ] );
+		boxes.push_back( upper );
+	}
+
+	std::stable_sort( boxes.begin(), boxes.end(), QuantizeBoxCountGreater );
+
+	out_colors.reserve( boxes.size() );
+	for( std::size_t i = 0; i < boxes.size(); ++i )
+		out_colors.push_back( QuantizeAverage( hist, boxes[ i ] ) );
+}
+
 
 } // End of namespace imagetoarray
\ No newline at end of file
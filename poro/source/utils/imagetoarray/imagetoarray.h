@@ -1,6 +1,9 @@
 #ifndef INC_IMAGE_TO_ARRAY_H
 #define INC_IMAGE_TO_ARRAY_H
 
+#include <ctime>
+#include <string>
+#include <vector>
 #include <poro/poro_types.h>
 #include <utils/array2d/carray2d.h>
 
@@ -10,7 +13,10 @@
 typedef poro::types::Uint32 uint32;
 
 
-void	LoadImage( const std::string& filename, ceng::CArray2D< poro::types::Uint32 >& out_array2d, bool include_alpha );
+// Goes through the image cache. Pngs that are too big for the cache are
+// streamed into the array a row at a time instead. Returns false if the
+// image couldn't be loaded.
+bool	LoadImage( const std::string& filename, ceng::CArray2D< poro::types::Uint32 >& out_array2d, bool include_alpha );
 void	SaveImage( const std::string& filename, const ceng::CArray2D< poro::types::Uint32 >& image_data );
 
 
@@ -18,7 +24,7 @@ namespace imagetoarray {
 
 struct TempTexture
 {
-	TempTexture() : w( width ), h( height ) { }
+	TempTexture() : width( 0 ), height( 0 ), bpp( 0 ), data( NULL ), filename(), w( width ), h( height ) { }
 	~TempTexture() 
 	{
 		delete [] data;
@@ -33,7 +39,7 @@ struct TempTexture
 	int& w;
 	int& h;
 
-	int ColorClamp( int i, int size )
+	int ColorClamp( int i, int size ) const
 	{
 		if( i < 0 ) 
 			i += size * (int)(((-i) / size) + 1);
@@ -43,14 +49,14 @@ struct TempTexture
 		return i;
 	}
 
-	poro::types::Uint32 GetPixel( int x, int y, bool include_alpha )
+	poro::types::Uint32 GetPixel( int x, int y, bool include_alpha ) const
 	{
 		if( data == NULL ) return 0;
 
-		x = ColorClamp( x, width );
-		y = ColorClamp( y, height );
-		bpp = 4;
-		int co = ( y * width ) * bpp + x * bpp;
+		// the data is always 4 channels, bpp is what the file had
+		if( (unsigned int)x >= (unsigned int)width ) x = ColorClamp( x, width );
+		if( (unsigned int)y >= (unsigned int)height ) y = ColorClamp( y, height );
+		int co = ( y * width + x ) * 4;
 		
 		/*int co0 = data[co];
 		int co1 = data[co + 1];
@@ -79,6 +85,96 @@ struct TempTexture
 TempTexture* GetTexture( const std::string& filename );
 poro::types::Uint32 GetPixel(TempTexture* surface, int x, int y, bool include_alpha = false );
 
+// Converts count rgba pixels into the format GetPixel() returns. Meant for
+// whole rows at a time.
+void ConvertRow( const unsigned char* rgba, int count, poro::types::Uint32* out, bool include_alpha );
+
+//-----------------------------------------------------------------------------
+// Decoded images by filename, so that the same palettes and level images 
+// aren't decoded again every time they're loaded. Once the pixels take more
+// than GetMaxSize() bytes, the images that were used the longest time ago are
+// dropped. Images that are in use are never dropped. A file whose 
+// modification time has changed is loaded again, that costs one stat() per
+// lookup.
+//
+// Only for the main thread.
+//
+//	const TempTexture* t = GetImageCache().Acquire( "data/colors/palette.png" );
+//	if( t ) { ... GetImageCache().Release( t ); }
+
+class ImageCache
+{
+public:
+	enum { DEFAULT_MAX_SIZE = 64 * 1024 * 1024 };
+
+	explicit ImageCache( std::size_t max_size = DEFAULT_MAX_SIZE );
+	~ImageCache();
+
+	// NULL if the image can't be loaded. Every image that is acquired has to
+	// be released.
+	const TempTexture* Acquire( const std::string& filename );
+	void Release( const TempTexture* texture );
+
+	// adds an image that the caller has decoded, the cache takes the 
+	// ownership. The returned image is acquired.
+	const TempTexture* Insert( const std::string& filename, TempTexture* texture );
+
+	// true if there's an up to date copy of the file in the cache
+	bool Contains( const std::string& filename ) const;
+
+	// drops every image that isn't in use
+	void Clear();
+
+	// bytes of pixels in the cache
+	std::size_t GetSize() const;
+	std::size_t GetMaxSize() const;
+	void SetMaxSize( std::size_t max_size );
+
+private:
+	struct Entry
+	{
+		std::string		filename;
+		std::time_t		modified;
+		TempTexture*	texture;
+		int				references;
+		unsigned int	last_used;
+
+		// the file has changed since, dropped once it's not used
+		bool			stale;
+	};
+
+	Entry* Find( const std::string& filename ) const;
+	void Trim( std::size_t max_size );
+	void Erase( std::size_t i );
+
+	std::vector< Entry* >	mEntries;
+	std::size_t				mSize;
+	std::size_t				mMaxSize;
+	unsigned int			mClock;
+
+	// no copying
+	ImageCache( const ImageCache& other );
+	ImageCache& operator= ( const ImageCache& other );
+};
+
+// the cache that LoadImage() uses
+ImageCache& GetImageCache();
+
+//-----------------------------------------------------------------------------
+// Palette extraction. The colors are in the same format GetPixel() returns.
+
+// Every distinct color of the image, in the order they're first seen when
+// going through the image row by row. Same result as calling 
+// VectorAddUnique() for every pixel, but uses a hash set so it stays fast
+// with big images that have a lot of colors.
+void GetUniqueColors( const TempTexture* surface, std::vector< poro::types::Uint32 >& out_colors, bool include_alpha = false );
+
+// Reduces the image to at most palette_size colors with median cut. The 
+// image is read once into a 5 bits per channel histogram and the cut is 
+// done on that, so the time doesn't depend much on the image size. Alpha 
+// is ignored. Colors come out biggest box first.
+void QuantizeColors( const TempTexture* surface, int palette_size, std::vector< poro::types::Uint32 >& out_colors );
+
 //-----------------------------------------------------------------------------
 
 } // End of namespace
@@ -0,0 +1,250 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2003 - 2011 Petri Purho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+
+
+#include "../imagetoarray.h"
+#include "../../random/random.h"
+#include "../../vector_utils/vector_utils.h"
+#include "../../pngwriter/pngwriter.h"
+#include "../../debug.h"
+
+#include <cstdio>
+
+#ifdef CENG_TESTER_ENABLED
+
+namespace ceng {
+namespace test {
+
+namespace {
+
+	imagetoarray::TempTexture* ImageToArrayTestImage( int width, int height )
+	{
+		imagetoarray::TempTexture* result = new imagetoarray::TempTexture;
+		result->width = width;
+		result->height = height;
+		result->bpp = 4;
+		result->data = new unsigned char[ width * height * 4 ];
+		return result;
+	}
+
+	void ImageToArraySetPixel( imagetoarray::TempTexture* t, int x, int y, int r, int g, int b, int a )
+	{
+		unsigned char* p = t->data + ( y * t->width + x ) * 4;
+		p[ 0 ] = (unsigned char)r;
+		p[ 1 ] = (unsigned char)g;
+		p[ 2 ] = (unsigned char)b;
+		p[ 3 ] = (unsigned char)a;
+	}
+
+} // end of anonymous namespace
+
+int ImageToArrayTest()
+{
+	using namespace imagetoarray;
+
+	// the unique colors come out in the same order as with VectorAddUnique
+	{
+		CLGMRandom random;
+		random.SetSeed( 4321 );
+
+		TempTexture* t = ImageToArrayTestImage( 123, 77 );
+		for( int y = 0; y < t->height; ++y )
+		{
+			for( int x = 0; x < t->width; ++x )
+			{
+				// limited values so that there are a lot of repeats
+				ImageToArraySetPixel( t, x, y, random.Random( 0, 15 ) * 17, random.Random( 0, 15 ) * 17, random.Random( 0, 3 ), random.Random( 0, 1 ) * 255 );
+			}
+		}
+
+		for( int alpha = 0; alpha < 2; ++alpha )
+		{
+			std::vector< poro::types::Uint32 > expected;
+			for( int y = 0; y < t->height; ++y )
+			{
+				for( int x = 0; x < t->width; ++x )
+					VectorAddUnique( expected, GetPixel( t, x, y, alpha == 1 ) );
+			}
+
+			std::vector< poro::types::Uint32 > colors;
+			GetUniqueColors( t, colors, alpha == 1 );
+			test_assert( colors == expected );
+		}
+
+		delete t;
+	}
+
+	// quantizing
+	{
+		TempTexture* t = ImageToArrayTestImage( 10, 10 );
+		for( int y = 0; y < t->height; ++y )
+		{
+			for( int x = 0; x < t->width; ++x )
+			{
+				if( x < 6 )			ImageToArraySetPixel( t, x, y, 255, 0, 0, 255 );
+				else if( x < 9 )	ImageToArraySetPixel( t, x, y, 0, 0, 255, 255 );
+				else				ImageToArraySetPixel( t, x, y, 0, 255, 0, 255 );
+			}
+		}
+
+		// fewer colors than asked for, the colors stay as they are and the 
+		// most used one comes first
+		std::vector< poro::types::Uint32 > colors;
+		QuantizeColors( t, 8, colors );
+		test_assert( colors.size() == 3 );
+		test_assert( colors[ 0 ] == 0xFF0000 );
+		test_assert( colors[ 1 ] == 0x0000FF );
+		test_assert( colors[ 2 ] == 0x00FF00 );
+
+		QuantizeColors( t, 2, colors );
+		test_assert( colors.size() == 2 );
+
+		QuantizeColors( t, 1, colors );
+		test_assert( colors.size() == 1 );
+		test_assert( colors[ 0 ] == ( 153u << 16 | 26u << 8 | 77u ) );
+
+		QuantizeColors( t, 0, colors );
+		test_assert( colors.empty() );
+
+		delete t;
+	}
+
+	// a gradient with more colors than the palette size
+	{
+		TempTexture* t = ImageToArrayTestImage( 256, 64 );
+		for( int y = 0; y < t->height; ++y )
+		{
+			for( int x = 0; x < t->width; ++x )
+				ImageToArraySetPixel( t, x, y, x, y * 4, 255 - x, 255 );
+		}
+
+		std::vector< poro::types::Uint32 > colors;
+		QuantizeColors( t, 16, colors );
+		test_assert( colors.size() == 16 );
+
+		delete t;
+	}
+
+	// row conversion gives what GetPixel() does, also for the odd pixels at
+	// the end of a row
+	{
+		CLGMRandom random;
+		random.SetSeed( 99 );
+
+		TempTexture* t = ImageToArrayTestImage( 37, 3 );
+		for( int i = 0; i < t->width * t->height * 4; ++i )
+			t->data[ i ] = (unsigned char)random.Random( 0, 255 );
+
+		std::vector< poro::types::Uint32 > row( t->width );
+		for( int alpha = 0; alpha < 2; ++alpha )
+		{
+			for( int y = 0; y < t->height; ++y )
+			{
+				ConvertRow( t->data + y * t->width * 4, t->width, &row[ 0 ], alpha == 1 );
+				for( int x = 0; x < t->width; ++x )
+					test_assert( row[ x ] == GetPixel( t, x, y, alpha == 1 ) );
+			}
+		}
+
+		// out of range coordinates wrap around
+		test_assert( GetPixel( t, -1, 0 ) == GetPixel( t, t->width - 1, 0 ) );
+		test_assert( GetPixel( t, t->width, t->height + 1 ) == GetPixel( t, 0, 1 ) );
+
+		delete t;
+	}
+
+	// the cache and LoadImage(), the images are written to files first
+	{
+		const char* files[] = { "imagetoarray_test_0.png", "imagetoarray_test_1.png" };
+		TempTexture* t = ImageToArrayTestImage( 40, 30 );
+		for( int y = 0; y < t->height; ++y )
+		{
+			for( int x = 0; x < t->width; ++x )
+				ImageToArraySetPixel( t, x, y, x * 6, y * 8, 100, 200 );
+		}
+
+		test_assert( WritePng( files[ 0 ], t->width, t->height, 4, t->data, t->width * 4 ) );
+		test_assert( WritePng( files[ 1 ], t->width, t->height, 4, t->data, t->width * 4 ) );
+		const std::size_t image_size = t->width * t->height * 4;
+
+		{
+			ImageCache cache( image_size );
+			test_assert( cache.Acquire( "this_file_does_not_exist.png" ) == NULL );
+
+			const TempTexture* a = cache.Acquire( files[ 0 ] );
+			test_assert( a && a->width == t->width && a->height == t->height );
+			test_assert( memcmp( a->data, t->data, image_size ) == 0 );
+			test_assert( cache.Acquire( files[ 0 ] ) == a );
+			test_assert( cache.Contains( files[ 0 ] ) );
+			test_assert( cache.GetSize() == image_size );
+
+			// over the size, but a is in use so it stays
+			const TempTexture* b = cache.Acquire( files[ 1 ] );
+			test_assert( b && b != a );
+			test_assert( cache.Contains( files[ 0 ] ) && cache.Contains( files[ 1 ] ) );
+			cache.Release( b );
+			test_assert( cache.Contains( files[ 1 ] ) == false );
+			test_assert( cache.GetSize() == image_size );
+
+			cache.Release( a );
+			cache.Release( a );
+			test_assert( cache.Contains( files[ 0 ] ) );
+
+			cache.Clear();
+			test_assert( cache.Contains( files[ 0 ] ) == false );
+			test_assert( cache.GetSize() == 0 );
+		}
+
+		// the same result through the cache and streamed
+		ImageCache& cache = GetImageCache();
+		const std::size_t max_size = cache.GetMaxSize();
+		for( int streamed = 0; streamed < 2; ++streamed )
+		{
+			cache.Clear();
+			cache.SetMaxSize( streamed ? image_size - 1 : max_size );
+
+			CArray2D< poro::types::Uint32 > image;
+			test_assert( LoadImage( files[ 0 ], image, true ) );
+			test_assert( cache.Contains( files[ 0 ] ) == ( streamed == 0 ) );
+			test_assert( image.GetWidth() == t->width && image.GetHeight() == t->height );
+			for( int y = 0; y < t->height; ++y )
+			{
+				for( int x = 0; x < t->width; ++x )
+					test_assert( image.Rand( x, y ) == GetPixel( t, x, y, true ) );
+			}
+		}
+		cache.SetMaxSize( max_size );
+		cache.Clear();
+
+		for( int i = 0; i < 2; ++i )
+			remove( files[ i ] );
+		delete t;
+	}
+
+	return 0;
+}
+
+TEST_REGISTER( ImageToArrayTest );
+
+} // end of namespace test
+} // end of namespace ceng
+
+#endif
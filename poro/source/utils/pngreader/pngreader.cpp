@@ -0,0 +1,711 @@
+#include "pngreader.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+namespace ceng {
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+	const int PNG_READER_LENGTH_BASE[ 29 ] = { 3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258 };
+	const int PNG_READER_LENGTH_EXTRA[ 29 ] = { 0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0 };
+	const int PNG_READER_DIST_BASE[ 30 ] = { 1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577 };
+	const int PNG_READER_DIST_EXTRA[ 30 ] = { 0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13 };
+	const int PNG_READER_CODE_LENGTH_ORDER[ 19 ] = { 16,17,18,0,8,7,9,6,10,5,11,4,12,3,13,2,14,1,15 };
+
+	const int PNG_READER_WINDOW_SIZE = 32768;
+	const int PNG_READER_WINDOW_MASK = PNG_READER_WINDOW_SIZE - 1;
+
+	// codes up to this long are decoded with one table lookup
+	const int PNG_READER_FAST_BITS = 9;
+	const int PNG_READER_FAST_MASK = ( 1 << PNG_READER_FAST_BITS ) - 1;
+
+	// canonical huffman code. The short codes are in a lookup table, the long
+	// ones are decoded a bit at a time by counting like puff.c does.
+	struct PngReaderHuffman
+	{
+		// symbol << 4 | length, 0 if the code is longer than PNG_READER_FAST_BITS
+		unsigned short	fast[ 1 << PNG_READER_FAST_BITS ];
+		unsigned short	count[ 16 ];
+		unsigned short	symbols[ 288 ];
+
+		// returns false if the lengths are oversubscribed. Incomplete codes
+		// are fine, the missing codes are errors when they're decoded.
+		bool Build( const unsigned char* lengths, int n )
+		{
+			std::memset( fast, 0, sizeof( fast ) );
+			std::memset( count, 0, sizeof( count ) );
+			for( int i = 0; i < n; ++i )
+				count[ lengths[ i ] ]++;
+			count[ 0 ] = 0;
+
+			int left = 1;
+			for( int len = 1; len < 16; ++len )
+			{
+				left = ( left << 1 ) - count[ len ];
+				if( left < 0 )
+					return false;
+			}
+
+			int offset[ 16 ] = { 0 };
+			for( int len = 1; len < 15; ++len )
+				offset[ len + 1 ] = offset[ len ] + count[ len ];
+
+			int next_code[ 16 ] = { 0 };
+			int code = 0;
+			for( int len = 1; len < 16; ++len )
+			{
+				code = ( code + count[ len - 1 ] ) << 1;
+				next_code[ len ] = code;
+			}
+
+			for( int i = 0; i < n; ++i )
+			{
+				const int len = lengths[ i ];
+				if( len == 0 )
+					continue;
+
+				symbols[ offset[ len ]++ ] = (unsigned short)i;
+
+				int c = next_code[ len ]++;
+				if( len > PNG_READER_FAST_BITS )
+					continue;
+
+				int reversed = 0;
+				for( int k = 0; k < len; ++k )
+				{
+					reversed = ( reversed << 1 ) | ( c & 1 );
+					c >>= 1;
+				}
+
+				for( int k = reversed; k < ( 1 << PNG_READER_FAST_BITS ); k += ( 1 << len ) )
+					fast[ k ] = (unsigned short)( i << 4 | len );
+			}
+
+			return true;
+		}
+	};
+
+	inline unsigned int PngReaderUint32( const unsigned char* p )
+	{
+		return (unsigned int)p[ 0 ] << 24 | (unsigned int)p[ 1 ] << 16 | (unsigned int)p[ 2 ] << 8 | p[ 3 ];
+	}
+
+	inline int PngReaderPaeth( int a, int b, int c )
+	{
+		const int p = a + b - c;
+		const int pa = std::abs( p - a );
+		const int pb = std::abs( p - b );
+		const int pc = std::abs( p - c );
+		if( pa <= pb && pa <= pc ) return a;
+		if( pb <= pc ) return b;
+		return c;
+	}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+
+// inflate that can stop after any byte and continue from there on the next
+// Read(), so the rows can be pulled out one at a time
+class CPngRowReader::Inflater
+{
+public:
+	Inflater( const unsigned char* data, int size ) :
+		mIn( data ),
+		mInSize( size ),
+		mInPos( 0 ),
+		mBits( 0 ),
+		mBitCount( 0 ),
+		mWindow( PNG_READER_WINDOW_SIZE ),
+		mWindowPos( 0 ),
+		mWindowFilled( 0 ),
+		mBlockType( -1 ),
+		mFinal( false ),
+		mError( false ),
+		mStored( 0 ),
+		mMatchLength( 0 ),
+		mMatchDist( 0 ),
+		mLitLen( NULL ),
+		mDist( NULL )
+	{
+		unsigned char lengths[ 288 ];
+		for( int i = 0; i < 288; ++i )
+			lengths[ i ] = (unsigned char)( ( i < 144 ) ? 8 : ( ( i < 256 ) ? 9 : ( ( i < 280 ) ? 7 : 8 ) ) );
+		mFixedLitLen.Build( lengths, 288 );
+
+		std::fill( lengths, lengths + 30, 5 );
+		mFixedDist.Build( lengths, 30 );
+	}
+
+	bool HasError() const { return mError; }
+
+	// returns how many bytes were written, less than size only at the end of
+	// the stream or on errors
+	int Read( unsigned char* out, int size )
+	{
+		int produced = 0;
+		while( produced < size && mError == false )
+		{
+			if( mMatchLength > 0 )
+			{
+				const int n = std::min( mMatchLength, size - produced );
+				for( int i = 0; i < n; ++i )
+					Output( mWindow[ ( mWindowPos - mMatchDist ) & PNG_READER_WINDOW_MASK ], out, produced );
+				mMatchLength -= n;
+				continue;
+			}
+
+			if( mBlockType < 0 )
+			{
+				if( mFinal )
+					break;
+
+				mError = ( ReadBlockHeader() == false );
+				continue;
+			}
+
+			if( mBlockType == 0 )
+			{
+				if( mStored == 0 )
+					mBlockType = -1;
+				else
+				{
+					Output( (unsigned char)GetBits( 8 ), out, produced );
+					mStored--;
+				}
+			}
+			else
+			{
+				const int symbol = Decode( *mLitLen );
+				if( symbol < 0 || symbol > 285 )
+					mError = true;
+				else if( symbol < 256 )
+					Output( (unsigned char)symbol, out, produced );
+				else if( symbol == 256 )
+					mBlockType = -1;
+				else
+				{
+					const int lc = symbol - 257;
+					mMatchLength = PNG_READER_LENGTH_BASE[ lc ] + GetBits( PNG_READER_LENGTH_EXTRA[ lc ] );
+
+					const int dc = Decode( *mDist );
+					if( dc < 0 || dc >= 30 )
+						mError = true;
+					else
+					{
+						mMatchDist = PNG_READER_DIST_BASE[ dc ] + GetBits( PNG_READER_DIST_EXTRA[ dc ] );
+						if( mMatchDist > mWindowFilled )
+							mError = true;
+					}
+				}
+			}
+
+			// the bit buffer reads zeros past the end, using any of them
+			// means that the data was cut short
+			if( (long long)mInPos * 8 - mBitCount > (long long)mInSize * 8 )
+				mError = true;
+		}
+
+		return produced;
+	}
+
+private:
+	void Refill()
+	{
+		while( mBitCount <= 24 )
+		{
+			const unsigned int byte = ( mInPos < mInSize ) ? mIn[ mInPos ] : 0;
+			mInPos++;
+			mBits |= byte << mBitCount;
+			mBitCount += 8;
+		}
+	}
+
+	// n <= 16
+	unsigned int GetBits( int n )
+	{
+		if( mBitCount < n )
+			Refill();
+
+		const unsigned int result = mBits & ( ( 1u << n ) - 1 );
+		mBits >>= n;
+		mBitCount -= n;
+		return result;
+	}
+
+	int Decode( const PngReaderHuffman& huffman )
+	{
+		if( mBitCount < 16 )
+			Refill();
+
+		const int entry = huffman.fast[ mBits & PNG_READER_FAST_MASK ];
+		if( entry )
+		{
+			mBits >>= ( entry & 15 );
+			mBitCount -= ( entry & 15 );
+			return entry >> 4;
+		}
+
+		int code = 0;
+		int first = 0;
+		int index = 0;
+		for( int len = 1; len < 16; ++len )
+		{
+			code |= ( mBits >> ( len - 1 ) ) & 1;
+			const int count = huffman.count[ len ];
+			if( code - first < count )
+			{
+				mBits >>= len;
+				mBitCount -= len;
+				return huffman.symbols[ index + code - first ];
+			}
+
+			index += count;
+			first = ( first + count ) << 1;
+			code <<= 1;
+		}
+
+		return -1;
+	}
+
+	void Output( unsigned char byte, unsigned char* out, int& produced )
+	{
+		out[ produced++ ] = byte;
+		mWindow[ mWindowPos ] = byte;
+		mWindowPos = ( mWindowPos + 1 ) & PNG_READER_WINDOW_MASK;
+		if( mWindowFilled < PNG_READER_WINDOW_SIZE )
+			mWindowFilled++;
+	}
+
+	bool ReadBlockHeader()
+	{
+		mFinal = ( GetBits( 1 ) != 0 );
+		mBlockType = GetBits( 2 );
+
+		if( mBlockType == 0 )
+		{
+			GetBits( mBitCount & 7 );
+			const unsigned int len = GetBits( 16 );
+			const unsigned int nlen = GetBits( 16 );
+			mStored = (int)len;
+			return ( len ^ 0xFFFF ) == nlen;
+		}
+
+		if( mBlockType == 1 )
+		{
+			mLitLen = &mFixedLitLen;
+			mDist = &mFixedDist;
+			return true;
+		}
+
+		if( mBlockType == 2 )
+		{
+			mLitLen = &mDynamicLitLen;
+			mDist = &mDynamicDist;
+			return ReadDynamicTables();
+		}
+
+		return false;
+	}
+
+	bool ReadDynamicTables()
+	{
+		const int hlit = GetBits( 5 ) + 257;
+		const int hdist = GetBits( 5 ) + 1;
+		const int hclen = GetBits( 4 ) + 4;
+		if( hlit > 286 || hdist > 30 )
+			return false;
+
+		unsigned char cl_lengths[ 19 ] = { 0 };
+		for( int i = 0; i < hclen; ++i )
+			cl_lengths[ PNG_READER_CODE_LENGTH_ORDER[ i ] ] = (unsigned char)GetBits( 3 );
+
+		PngReaderHuffman code_lengths;
+		if( code_lengths.Build( cl_lengths, 19 ) == false )
+			return false;
+
+		unsigned char lengths[ 286 + 30 ];
+		const int total = hlit + hdist;
+		for( int i = 0; i < total; )
+		{
+			const int symbol = Decode( code_lengths );
+			if( symbol < 0 )
+				return false;
+
+			if( symbol < 16 )
+			{
+				lengths[ i++ ] = (unsigned char)symbol;
+				continue;
+			}
+
+			int repeat = 0;
+			unsigned char value = 0;
+			if( symbol == 16 )
+			{
+				if( i == 0 )
+					return false;
+				value = lengths[ i - 1 ];
+				repeat = 3 + GetBits( 2 );
+			}
+			else if( symbol == 17 )
+				repeat = 3 + GetBits( 3 );
+			else
+				repeat = 11 + GetBits( 7 );
+
+			if( i + repeat > total )
+				return false;
+
+			std::fill( lengths + i, lengths + i + repeat, value );
+			i += repeat;
+		}
+
+		// there has to be an end of block
+		if( lengths[ 256 ] == 0 )
+			return false;
+
+		return mDynamicLitLen.Build( lengths, hlit ) && mDynamicDist.Build( lengths + hlit, hdist );
+	}
+
+	const unsigned char*	mIn;
+	int						mInSize;
+	int						mInPos;
+	unsigned int			mBits;
+	int						mBitCount;
+
+	std::vector< unsigned char >	mWindow;
+	int								mWindowPos;
+	int								mWindowFilled;
+
+	// -1 means the next thing is a block header
+	int		mBlockType;
+	bool	mFinal;
+	bool	mError;
+
+	// bytes left in a stored block, and the match that is being copied
+	int		mStored;
+	int		mMatchLength;
+	int		mMatchDist;
+
+	const PngReaderHuffman*	mLitLen;
+	const PngReaderHuffman*	mDist;
+	PngReaderHuffman		mFixedLitLen;
+	PngReaderHuffman		mFixedDist;
+	PngReaderHuffman		mDynamicLitLen;
+	PngReaderHuffman		mDynamicDist;
+};
+
+//-----------------------------------------------------------------------------
+
+CPngRowReader::CPngRowReader() :
+	mInflater( NULL ),
+	mCompressed(),
+	mPalette(),
+	mWidth( 0 ),
+	mHeight( 0 ),
+	mColorType( 0 ),
+	mComponents( 0 ),
+	mBpp( 0 ),
+	mRowSize( 0 ),
+	mRowsRead( 0 ),
+	mRows(),
+	mCur( NULL ),
+	mPrior( NULL )
+{
+}
+
+CPngRowReader::~CPngRowReader()
+{
+	Close();
+}
+
+void CPngRowReader::Close()
+{
+	delete mInflater;
+	mInflater = NULL;
+
+	std::vector< unsigned char >().swap( mCompressed );
+	std::vector< unsigned char >().swap( mRows );
+	mPalette.clear();
+	mWidth = 0;
+	mHeight = 0;
+	mColorType = 0;
+	mComponents = 0;
+	mBpp = 0;
+	mRowSize = 0;
+	mRowsRead = 0;
+	mCur = NULL;
+	mPrior = NULL;
+}
+
+//-----------------------------------------------------------------------------
+
+bool CPngRowReader::Open( const std::string& filename )
+{
+	Close();
+
+	FILE* file = fopen( filename.c_str(), "rb" );
+	if( file == NULL )
+		return false;
+
+	fseek( file, 0, SEEK_END );
+	const long size = ftell( file );
+	fseek( file, 0, SEEK_SET );
+
+	std::vector< unsigned char > data( size > 0 ? size : 1 );
+	const bool read_ok = ( size > 0 && fread( &data[ 0 ], 1, size, file ) == (std::size_t)size );
+	fclose( file );
+
+	return read_ok && OpenMemory( &data[ 0 ], (int)size );
+}
+
+bool CPngRowReader::OpenMemory( const unsigned char* data, int size )
+{
+	Close();
+
+	if( data == NULL || ReadChunks( data, size ) == false )
+	{
+		Close();
+		return false;
+	}
+
+	const int pad = 8;
+	mRows.resize( 2 * ( pad + mRowSize ), 0 );
+	mCur = &mRows[ pad ];
+	mPrior = &mRows[ 2 * pad + mRowSize ];
+
+	// skips the zlib header, the adler32 at the end isn't checked
+	mInflater = new Inflater( &mCompressed[ 2 ], (int)mCompressed.size() - 2 );
+	return true;
+}
+
+bool CPngRowReader::ReadChunks( const unsigned char* data, int size )
+{
+	const unsigned char signature[ 8 ] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+	if( size < 8 || std::memcmp( data, signature, 8 ) != 0 )
+		return false;
+
+	bool header = false;
+	bool transparency = false;
+	for( int pos = 8; pos + 8 <= size; )
+	{
+		unsigned int length = PngReaderUint32( data + pos );
+		const unsigned char* type = data + pos + 4;
+		const unsigned char* body = data + pos + 8;
+
+		// a file that is cut short in the middle of the image data gives the
+		// rows that are there
+		const bool cut_short = ( length > (unsigned int)( size - pos - 8 ) );
+		if( cut_short )
+		{
+			if( std::memcmp( type, "IDAT", 4 ) != 0 )
+				return false;
+			length = (unsigned int)( size - pos - 8 );
+		}
+
+		if( std::memcmp( type, "IHDR", 4 ) == 0 )
+		{
+			if( length < 13 )
+				return false;
+
+			const unsigned int width = PngReaderUint32( body );
+			const unsigned int height = PngReaderUint32( body + 4 );
+			const int bit_depth = body[ 8 ];
+			mColorType = body[ 9 ];
+
+			// compression, filter method and interlacing
+			if( body[ 10 ] != 0 || body[ 11 ] != 0 || body[ 12 ] != 0 || bit_depth != 8 )
+				return false;
+
+			switch( mColorType )
+			{
+			case 0: mBpp = 1; break;
+			case 2: mBpp = 3; break;
+			case 3: mBpp = 1; break;
+			case 4: mBpp = 2; break;
+			case 6: mBpp = 4; break;
+			default: return false;
+			}
+
+			if( width == 0 || height == 0 || width > ( 1 << 24 ) / 4 || height > ( 1 << 24 ) )
+				return false;
+
+			mWidth = (int)width;
+			mHeight = (int)height;
+			mRowSize = mWidth * mBpp;
+			header = true;
+		}
+		else if( std::memcmp( type, "PLTE", 4 ) == 0 )
+		{
+			// missing entries are opaque black
+			mPalette.assign( 256 * 4, 0 );
+			for( int i = 0; i < 256; ++i )
+				mPalette[ i * 4 + 3 ] = 255;
+
+			const int count = std::min( (int)length / 3, 256 );
+			for( int i = 0; i < count; ++i )
+			{
+				mPalette[ i * 4 + 0 ] = body[ i * 3 + 0 ];
+				mPalette[ i * 4 + 1 ] = body[ i * 3 + 1 ];
+				mPalette[ i * 4 + 2 ] = body[ i * 3 + 2 ];
+			}
+		}
+		else if( std::memcmp( type, "tRNS", 4 ) == 0 )
+		{
+			// the color key transparency of gray and rgb images is left to
+			// stb_image
+			if( mColorType != 3 || mPalette.empty() )
+				return false;
+
+			const int count = std::min( (int)length, 256 );
+			for( int i = 0; i < count; ++i )
+				mPalette[ i * 4 + 3 ] = body[ i ];
+			transparency = true;
+		}
+		else if( std::memcmp( type, "IDAT", 4 ) == 0 )
+		{
+			mCompressed.insert( mCompressed.end(), body, body + length );
+		}
+		else if( std::memcmp( type, "IEND", 4 ) == 0 )
+		{
+			break;
+		}
+		else if( ( type[ 0 ] & 32 ) == 0 )
+		{
+			// an unknown critical chunk
+			return false;
+		}
+
+		if( cut_short )
+			break;
+
+		pos += 12 + (int)length;
+	}
+
+	if( header == false || mCompressed.size() < 2 || ( mColorType == 3 && mPalette.empty() ) )
+		return false;
+
+	switch( mColorType )
+	{
+	case 0: mComponents = 1; break;
+	case 4: mComponents = 2; break;
+	case 2: mComponents = 3; break;
+	case 3: mComponents = transparency ? 4 : 3; break;
+	case 6: mComponents = 4; break;
+	}
+
+	// zlib header: deflate, no preset dictionary
+	const int cmf = mCompressed[ 0 ];
+	const int flg = mCompressed[ 1 ];
+	return ( cmf & 15 ) == 8 && ( cmf * 256 + flg ) % 31 == 0 && ( flg & 32 ) == 0;
+}
+
+//-----------------------------------------------------------------------------
+
+bool CPngRowReader::FillRow()
+{
+	unsigned char filter = 0;
+	if( mInflater->Read( &filter, 1 ) != 1 || mInflater->Read( mCur, mRowSize ) != mRowSize )
+		return false;
+
+	unsigned char* cur = mCur;
+	const unsigned char* prior = mPrior;
+	const int bpp = mBpp;
+
+	// the bytes in front of the rows are zeros, so the left edge doesn't
+	// need its own loop
+	switch( filter )
+	{
+	case 0:
+		break;
+
+	case 1:
+		for( int i = 0; i < mRowSize; ++i )
+			cur[ i ] = (unsigned char)( cur[ i ] + cur[ i - bpp ] );
+		break;
+
+	case 2:
+		for( int i = 0; i < mRowSize; ++i )
+			cur[ i ] = (unsigned char)( cur[ i ] + prior[ i ] );
+		break;
+
+	case 3:
+		for( int i = 0; i < mRowSize; ++i )
+			cur[ i ] = (unsigned char)( cur[ i ] + ( ( cur[ i - bpp ] + prior[ i ] ) >> 1 ) );
+		break;
+
+	case 4:
+		for( int i = 0; i < mRowSize; ++i )
+			cur[ i ] = (unsigned char)( cur[ i ] + PngReaderPaeth( cur[ i - bpp ], prior[ i ], prior[ i - bpp ] ) );
+		break;
+
+	default:
+		return false;
+	}
+
+	return true;
+}
+
+bool CPngRowReader::ReadRow( unsigned char* rgba )
+{
+	if( mInflater == NULL || mRowsRead >= mHeight )
+		return false;
+
+	if( FillRow() == false )
+	{
+		// a broken row ends the image
+		mRowsRead = mHeight;
+		return false;
+	}
+
+	const unsigned char* p = mCur;
+	switch( mColorType )
+	{
+	case 0:
+		for( int x = 0; x < mWidth; ++x, rgba += 4 )
+		{
+			rgba[ 0 ] = rgba[ 1 ] = rgba[ 2 ] = p[ x ];
+			rgba[ 3 ] = 255;
+		}
+		break;
+
+	case 4:
+		for( int x = 0; x < mWidth; ++x, rgba += 4, p += 2 )
+		{
+			rgba[ 0 ] = rgba[ 1 ] = rgba[ 2 ] = p[ 0 ];
+			rgba[ 3 ] = p[ 1 ];
+		}
+		break;
+
+	case 2:
+		for( int x = 0; x < mWidth; ++x, rgba += 4, p += 3 )
+		{
+			rgba[ 0 ] = p[ 0 ];
+			rgba[ 1 ] = p[ 1 ];
+			rgba[ 2 ] = p[ 2 ];
+			rgba[ 3 ] = 255;
+		}
+		break;
+
+	case 6:
+		std::memcpy( rgba, p, mRowSize );
+		break;
+
+	default:
+		for( int x = 0; x < mWidth; ++x, rgba += 4 )
+			std::memcpy( rgba, &mPalette[ p[ x ] * 4 ], 4 );
+		break;
+	}
+
+	std::swap( mCur, mPrior );
+	mRowsRead++;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+
+} // end of namespace ceng
@@ -0,0 +1,127 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2003 - 2011 Petri Purho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// CPngRowReader
+// =============
+//
+// Decodes a png one row at a time, for images that are too big to have in
+// memory twice. Only the compressed data, the 32k deflate window and two
+// rows are kept around, so a caller can convert each row straight into its
+// own buffer.
+//
+// Handles the 8 bit, non-interlaced pngs, which is what everything here
+// writes: gray, gray + alpha, rgb, rgba and palette images (with tRNS for
+// palettes). Open() returns false for anything else, use stb_image for 
+// those.
+//
+//.............................................................................
+//
+// Usage:
+//
+//	ceng::CPngRowReader reader;
+//	if( reader.Open( "big.png" ) ) {
+//		std::vector< unsigned char > row( reader.GetWidth() * 4 );
+//		for( int y = 0; y < reader.GetHeight(); ++y ) {
+//			if( reader.ReadRow( &row[ 0 ] ) == false ) break;
+//			...
+//		}
+//	}
+//
+//=============================================================================
+#ifndef INC_PNGREADER_H
+#define INC_PNGREADER_H
+
+#include <string>
+#include <vector>
+
+namespace ceng {
+
+//-----------------------------------------------------------------------------
+
+class CPngRowReader
+{
+public:
+	CPngRowReader();
+	~CPngRowReader();
+
+	// reads the file and the header. Returns false if it's not a png or it's
+	// a kind of png that can't be streamed
+	bool Open( const std::string& filename );
+	bool OpenMemory( const unsigned char* data, int size );
+	void Close();
+
+	bool IsOpen() const;
+	int GetWidth() const;
+	int GetHeight() const;
+
+	// channels in the file, 1 - 4 like stbi_load() returns them. Palette 
+	// images are 3, or 4 with tRNS
+	int GetComponents() const;
+
+	// decodes the next row into rgba, GetWidth() * 4 bytes. Returns false
+	// once all the rows have been read or if the data is broken.
+	bool ReadRow( unsigned char* rgba );
+
+private:
+	class Inflater;
+
+	bool ReadChunks( const unsigned char* data, int size );
+	bool FillRow();
+
+	Inflater*						mInflater;
+	std::vector< unsigned char >	mCompressed;
+
+	// rgba, 256 entries
+	std::vector< unsigned char >	mPalette;
+
+	int		mWidth;
+	int		mHeight;
+	int		mColorType;
+	int		mComponents;
+	int		mBpp;
+	int		mRowSize;
+	int		mRowsRead;
+
+	// the current row and the one above it, with mBpp zeros in front
+	std::vector< unsigned char >	mRows;
+	unsigned char*					mCur;
+	unsigned char*					mPrior;
+
+	// no copying
+	CPngRowReader( const CPngRowReader& other );
+	CPngRowReader& operator= ( const CPngRowReader& other );
+};
+
+//-----------------------------------------------------------------------------
+
+inline bool CPngRowReader::IsOpen() const	{ return mInflater != NULL; }
+inline int CPngRowReader::GetWidth() const	{ return mWidth; }
+inline int CPngRowReader::GetHeight() const	{ return mHeight; }
+inline int CPngRowReader::GetComponents() const	{ return mComponents; }
+
+//-----------------------------------------------------------------------------
+
+} // end of namespace ceng
+
+#endif
@@ -0,0 +1,147 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2003 - 2011 Petri Purho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+
+
+#include "../pngreader.h"
+#include "../../pngwriter/pngwriter.h"
+#include "../../random/random.h"
+#include "../../debug.h"
+#include "../../../poro/external/stb_image.h"
+
+#include <cstring>
+
+#ifdef CENG_TESTER_ENABLED
+
+namespace ceng {
+namespace test {
+
+namespace {
+
+// the rows have to match what stb_image gives for the same file
+bool PngReaderTest_SameAsStb( const std::vector< unsigned char >& png )
+{
+	// with 4 channels asked for stbi_load doesn't tell the channels in the 
+	// file, so it's loaded twice
+	int w = 0, h = 0, comp = 0;
+	unsigned char* original = stbi_load_from_memory( &png[ 0 ], (int)png.size(), &w, &h, &comp, 0 );
+	if( original == NULL )
+		return false;
+	stbi_image_free( original );
+
+	unsigned char* expected = stbi_load_from_memory( &png[ 0 ], (int)png.size(), &w, &h, NULL, 4 );
+	if( expected == NULL )
+		return false;
+
+	CPngRowReader reader;
+	bool ok = reader.OpenMemory( &png[ 0 ], (int)png.size() ) && reader.GetWidth() == w && reader.GetHeight() == h && reader.GetComponents() == comp;
+
+	std::vector< unsigned char > row( w * 4 );
+	for( int y = 0; ok && y < h; ++y )
+		ok = reader.ReadRow( &row[ 0 ] ) && memcmp( &row[ 0 ], expected + y * w * 4, w * 4 ) == 0;
+
+	// nothing after the last row
+	ok = ok && reader.ReadRow( &row[ 0 ] ) == false;
+
+	stbi_image_free( expected );
+	return ok;
+}
+
+} // end of anonymous namespace
+
+int PngReaderTest()
+{
+	CLGMRandom random;
+	random.SetSeed( 4321 );
+
+	// not pngs
+	{
+		CPngRowReader reader;
+		const unsigned char junk[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+		test_assert( reader.OpenMemory( junk, sizeof( junk ) ) == false );
+		test_assert( reader.IsOpen() == false );
+		test_assert( reader.Open( "this_file_does_not_exist.png" ) == false );
+	}
+
+	// every channel count and compression level, so that stored, fixed and
+	// dynamic blocks all get read
+	{
+		const int sizes[][ 2 ] = { { 1, 1 }, { 5, 3 }, { 64, 33 }, { 301, 150 } };
+		for( int s = 0; s < (int)( sizeof( sizes ) / sizeof( sizes[ 0 ] ) ); ++s )
+		{
+			for( int comp = 1; comp <= 4; ++comp )
+			{
+				const int width = sizes[ s ][ 0 ];
+				const int height = sizes[ s ][ 1 ];
+				std::vector< unsigned char > pixels( width * height * comp );
+				for( int i = 0; i < (int)pixels.size(); ++i )
+					pixels[ i ] = (unsigned char)( ( i / 7 ) % 3 == 0 ? random.Random( 0, 255 ) : ( i / ( width * comp ) ) * 3 );
+
+				for( int level = 0; level <= 9; level += 3 )
+				{
+					PngWriterSettings settings;
+					settings.compression = level;
+					settings.thread_count = 1;
+
+					std::vector< unsigned char > png;
+					test_assert( WritePngToMemory( png, width, height, comp, &pixels[ 0 ], width * comp, settings ) );
+					test_assert( PngReaderTest_SameAsStb( png ) );
+				}
+			}
+		}
+	}
+
+	// cut short, the rows that can be read are still right and then it
+	// stops
+	{
+		const int width = 200;
+		const int height = 100;
+		std::vector< unsigned char > pixels( width * height * 3 );
+		for( int i = 0; i < (int)pixels.size(); ++i )
+			pixels[ i ] = (unsigned char)random.Random( 0, 255 );
+
+		std::vector< unsigned char > png;
+		test_assert( WritePngToMemory( png, width, height, 3, &pixels[ 0 ], width * 3 ) );
+		png.resize( png.size() / 2 );
+
+		CPngRowReader reader;
+		test_assert( reader.OpenMemory( &png[ 0 ], (int)png.size() ) );
+
+		std::vector< unsigned char > row( width * 4 );
+		int rows = 0;
+		while( reader.ReadRow( &row[ 0 ] ) )
+		{
+			for( int x = 0; x < width; ++x )
+				test_assert( memcmp( &row[ x * 4 ], &pixels[ ( rows * width + x ) * 3 ], 3 ) == 0 );
+			++rows;
+		}
+
+		test_assert( rows > 0 && rows < height );
+	}
+
+	return 0;
+}
+
+TEST_REGISTER( PngReaderTest );
+
+} // end of namespace test
+} // end of namespace ceng
+
+#endif
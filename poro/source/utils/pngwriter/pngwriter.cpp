@@ -0,0 +1,1050 @@
+#include "pngwriter.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include "../threadpool/cthreadpool.h"
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#	define CENG_PNGWRITER_SSE2
+#	include <emmintrin.h>
+#endif
+
+namespace ceng {
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+	typedef unsigned int	png_uint32;
+	typedef unsigned short	png_uint16;
+	typedef unsigned char	png_byte;
+
+	// a stripe is about this many bytes of filtered data
+	const int PNG_STRIPE_SIZE = 512 * 1024;
+
+	// symbols per deflate block
+	const int PNG_BLOCK_SYMBOLS = 32 * 1024;
+
+	const int PNG_WINDOW_SIZE = 32768;
+	const int PNG_WINDOW_MASK = PNG_WINDOW_SIZE - 1;
+	const int PNG_HASH_SIZE = 32768;
+	const int PNG_MIN_MATCH = 3;
+	const int PNG_MAX_MATCH = 258;
+
+	// 3 byte matches further than this cost more than the literals do
+	const int PNG_TOO_FAR = 4096;
+
+	const int PNG_LENGTH_BASE[ 29 ] = { 3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258 };
+	const int PNG_LENGTH_EXTRA[ 29 ] = { 0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0 };
+	const int PNG_DIST_BASE[ 30 ] = { 1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577 };
+	const int PNG_DIST_EXTRA[ 30 ] = { 0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13 };
+
+	// order in which the code length code lengths are written
+	const int PNG_CODE_LENGTH_ORDER[ 19 ] = { 16,17,18,0,8,7,9,6,10,5,11,4,12,3,13,2,14,1,15 };
+
+	//-------------------------------------------------------------------------
+
+	// built once before main(), only read after that so it's safe to use
+	// from any thread
+	struct PngWriterTables
+	{
+		PngWriterTables()
+		{
+			for( png_uint32 i = 0; i < 256; ++i )
+			{
+				png_uint32 c = i;
+				for( int k = 0; k < 8; ++k )
+					c = ( c & 1 ) ? ( 0xEDB88320u ^ ( c >> 1 ) ) : ( c >> 1 );
+				crc[ i ] = c;
+			}
+
+			// code 28 (258) comes last so it overwrites the end of code 27
+			for( int c = 0; c < 29; ++c )
+			{
+				for( int len = PNG_LENGTH_BASE[ c ]; len < PNG_LENGTH_BASE[ c ] + ( 1 << PNG_LENGTH_EXTRA[ c ] ) && len <= PNG_MAX_MATCH; ++len )
+					length_code[ len ] = (png_byte)c;
+			}
+
+			for( int c = 0; c < 30; ++c )
+			{
+				for( int d = PNG_DIST_BASE[ c ]; d < PNG_DIST_BASE[ c ] + ( 1 << PNG_DIST_EXTRA[ c ] ); ++d )
+				{
+					if( d <= 256 )	dist_code_small[ d - 1 ] = (png_byte)c;
+					else			dist_code_big[ ( d - 1 ) >> 7 ] = (png_byte)c;
+				}
+			}
+
+			// fixed huffman codes
+			for( int i = 0; i < 288; ++i )
+				fixed_litlen_lengths[ i ] = (png_byte)( ( i < 144 ) ? 8 : ( ( i < 256 ) ? 9 : ( ( i < 280 ) ? 7 : 8 ) ) );
+			for( int i = 0; i < 30; ++i )
+				fixed_dist_lengths[ i ] = 5;
+		}
+
+		int DistCode( int dist ) const
+		{
+			return ( dist <= 256 ) ? dist_code_small[ dist - 1 ] : dist_code_big[ ( dist - 1 ) >> 7 ];
+		}
+
+		png_uint32	crc[ 256 ];
+		png_byte	length_code[ PNG_MAX_MATCH + 1 ];	// length -> code - 257
+		png_byte	dist_code_small[ 256 ];
+		png_byte	dist_code_big[ 256 ];
+		png_byte	fixed_litlen_lengths[ 288 ];
+		png_byte	fixed_dist_lengths[ 30 ];
+	};
+
+	const PngWriterTables gPngWriterTables;
+
+	//-------------------------------------------------------------------------
+
+	png_uint32 PngCrc32( png_uint32 crc, const png_byte* data, std::size_t size )
+	{
+		crc = ~crc;
+		for( std::size_t i = 0; i < size; ++i )
+			crc = gPngWriterTables.crc[ ( crc ^ data[ i ] ) & 0xFF ] ^ ( crc >> 8 );
+		return ~crc;
+	}
+
+	const png_uint32 PNG_ADLER_MOD = 65521;
+
+	png_uint32 PngAdler32( const png_byte* data, std::size_t size )
+	{
+		png_uint32 a = 1;
+		png_uint32 b = 0;
+		while( size > 0 )
+		{
+			// 5552 is the most that can be summed before b can overflow
+			const std::size_t n = std::min( size, (std::size_t)5552 );
+			for( std::size_t i = 0; i < n; ++i )
+			{
+				a += data[ i ];
+				b += a;
+			}
+			a %= PNG_ADLER_MOD;
+			b %= PNG_ADLER_MOD;
+			data += n;
+			size -= n;
+		}
+		return ( b << 16 ) | a;
+	}
+
+	// adler32 of two buffers joined together, len2 is the size of the second
+	// one. Same math as zlib's adler32_combine()
+	png_uint32 PngAdler32Combine( png_uint32 adler1, png_uint32 adler2, std::size_t len2 )
+	{
+		const png_uint32 rem = (png_uint32)( len2 % PNG_ADLER_MOD );
+		png_uint32 sum1 = adler1 & 0xFFFF;
+		png_uint32 sum2 = (png_uint32)( ( (unsigned long long)rem * sum1 ) % PNG_ADLER_MOD );
+		sum1 += ( adler2 & 0xFFFF ) + PNG_ADLER_MOD - 1;
+		sum2 += ( ( adler1 >> 16 ) & 0xFFFF ) + ( ( adler2 >> 16 ) & 0xFFFF ) + PNG_ADLER_MOD - rem;
+		if( sum1 >= PNG_ADLER_MOD ) sum1 -= PNG_ADLER_MOD;
+		if( sum1 >= PNG_ADLER_MOD ) sum1 -= PNG_ADLER_MOD;
+		if( sum2 >= ( PNG_ADLER_MOD << 1 ) ) sum2 -= ( PNG_ADLER_MOD << 1 );
+		if( sum2 >= PNG_ADLER_MOD ) sum2 -= PNG_ADLER_MOD;
+		return ( sum2 << 16 ) | sum1;
+	}
+
+	void PngPutUint32( std::vector< png_byte >& out, png_uint32 value )
+	{
+		out.push_back( (png_byte)( value >> 24 ) );
+		out.push_back( (png_byte)( value >> 16 ) );
+		out.push_back( (png_byte)( value >> 8 ) );
+		out.push_back( (png_byte)( value ) );
+	}
+
+	//-------------------------------------------------------------------------
+	// filters
+
+	inline png_byte PngPaeth( int a, int b, int c )
+	{
+		const int p = a + b - c;
+		const int pa = std::abs( p - a );
+		const int pb = std::abs( p - b );
+		const int pc = std::abs( p - c );
+		if( pa <= pb && pa <= pc ) return (png_byte)a;
+		if( pb <= pc ) return (png_byte)b;
+		return (png_byte)c;
+	}
+
+	inline int PngAbs( png_byte value )
+	{
+		return std::abs( (int)(signed char)value );
+	}
+
+	// cur and prior point to rows that have bpp readable zero bytes in front
+	// of them. Writes all the 5 filtered versions of the row into out and
+	// returns the one to use, the smallest sum of absolute values wins.
+	int PngFilterRow( const png_byte* cur, const png_byte* prior, int size, int bpp, png_byte* out[ 5 ] )
+	{
+		int sums[ 5 ] = { 0, 0, 0, 0, 0 };
+		int i = 0;
+
+	#ifdef CENG_PNGWRITER_SSE2
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i one = _mm_set1_epi8( 1 );
+		__m128i sum[ 5 ] = { zero, zero, zero, zero, zero };
+
+		for( ; i + 16 <= size; i += 16 )
+		{
+			const __m128i x = _mm_loadu_si128( (const __m128i*)( cur + i ) );
+			const __m128i a = _mm_loadu_si128( (const __m128i*)( cur + i - bpp ) );
+			const __m128i b = _mm_loadu_si128( (const __m128i*)( prior + i ) );
+			const __m128i c = _mm_loadu_si128( (const __m128i*)( prior + i - bpp ) );
+
+			// avg_epu8 rounds up, the filter rounds down
+			const __m128i avg = _mm_sub_epi8( _mm_avg_epu8( a, b ), _mm_and_si128( _mm_xor_si128( a, b ), one ) );
+
+			// paeth in 16 bit lanes. pa = |b - c|, pb = |a - c|, pc = |a + b - 2c|
+			__m128i paeth[ 2 ];
+			for( int half = 0; half < 2; ++half )
+			{
+				const __m128i a16 = half ? _mm_unpackhi_epi8( a, zero ) : _mm_unpacklo_epi8( a, zero );
+				const __m128i b16 = half ? _mm_unpackhi_epi8( b, zero ) : _mm_unpacklo_epi8( b, zero );
+				const __m128i c16 = half ? _mm_unpackhi_epi8( c, zero ) : _mm_unpacklo_epi8( c, zero );
+
+				const __m128i pa_s = _mm_sub_epi16( b16, c16 );
+				const __m128i pb_s = _mm_sub_epi16( a16, c16 );
+				const __m128i pc_s = _mm_add_epi16( pa_s, pb_s );
+				const __m128i pa = _mm_max_epi16( pa_s, _mm_sub_epi16( zero, pa_s ) );
+				const __m128i pb = _mm_max_epi16( pb_s, _mm_sub_epi16( zero, pb_s ) );
+				const __m128i pc = _mm_max_epi16( pc_s, _mm_sub_epi16( zero, pc_s ) );
+
+				const __m128i not_a = _mm_or_si128( _mm_cmpgt_epi16( pa, pb ), _mm_cmpgt_epi16( pa, pc ) );
+				const __m128i not_b = _mm_cmpgt_epi16( pb, pc );
+				const __m128i bc = _mm_or_si128( _mm_andnot_si128( not_b, b16 ), _mm_and_si128( not_b, c16 ) );
+				paeth[ half ] = _mm_or_si128( _mm_andnot_si128( not_a, a16 ), _mm_and_si128( not_a, bc ) );
+			}
+
+			__m128i f[ 5 ];
+			f[ 0 ] = x;
+			f[ 1 ] = _mm_sub_epi8( x, a );
+			f[ 2 ] = _mm_sub_epi8( x, b );
+			f[ 3 ] = _mm_sub_epi8( x, avg );
+			f[ 4 ] = _mm_sub_epi8( x, _mm_packus_epi16( paeth[ 0 ], paeth[ 1 ] ) );
+
+			for( int t = 0; t < 5; ++t )
+			{
+				_mm_storeu_si128( (__m128i*)( out[ t ] + i ), f[ t ] );
+				const __m128i abs8 = _mm_min_epu8( f[ t ], _mm_sub_epi8( zero, f[ t ] ) );
+				sum[ t ] = _mm_add_epi64( sum[ t ], _mm_sad_epu8( abs8, zero ) );
+			}
+		}
+
+		for( int t = 0; t < 5; ++t )
+			sums[ t ] = _mm_cvtsi128_si32( sum[ t ] ) + _mm_cvtsi128_si32( _mm_srli_si128( sum[ t ], 8 ) );
+	#endif
+
+		for( ; i < size; ++i )
+		{
+			const int x = cur[ i ];
+			const int a = cur[ i - bpp ];
+			const int b = prior[ i ];
+			const int c = prior[ i - bpp ];
+
+			out[ 0 ][ i ] = (png_byte)x;
+			out[ 1 ][ i ] = (png_byte)( x - a );
+			out[ 2 ][ i ] = (png_byte)( x - b );
+			out[ 3 ][ i ] = (png_byte)( x - ( ( a + b ) >> 1 ) );
+			out[ 4 ][ i ] = (png_byte)( x - PngPaeth( a, b, c ) );
+
+			for( int t = 0; t < 5; ++t )
+				sums[ t ] += PngAbs( out[ t ][ i ] );
+		}
+
+		int best = 0;
+		for( int t = 1; t < 5; ++t )
+		{
+			if( sums[ t ] < sums[ best ] )
+				best = t;
+		}
+		return best;
+	}
+
+	//-------------------------------------------------------------------------
+	// deflate
+
+	class PngBitWriter
+	{
+	public:
+		explicit PngBitWriter( std::vector< png_byte >& out ) : mOut( out ), mBits( 0 ), mCount( 0 ) { }
+
+		// count <= 16
+		void Put( png_uint32 bits, int count )
+		{
+			mBits |= bits << mCount;
+			mCount += count;
+			while( mCount >= 8 )
+			{
+				mOut.push_back( (png_byte)mBits );
+				mBits >>= 8;
+				mCount -= 8;
+			}
+		}
+
+		void AlignToByte()
+		{
+			if( mCount > 0 )
+				Put( 0, 8 - mCount );
+		}
+
+		// has to be byte aligned
+		void PutBytes( const png_byte* data, int size )
+		{
+			mOut.insert( mOut.end(), data, data + size );
+		}
+
+	private:
+		std::vector< png_byte >&	mOut;
+		png_uint32					mBits;
+		int							mCount;
+	};
+
+	// literal if dist is 0, otherwise a match of litlen bytes
+	struct PngSymbol
+	{
+		png_uint16 litlen;
+		png_uint16 dist;
+	};
+
+	struct PngSortByFreq
+	{
+		explicit PngSortByFreq( const png_uint32* freq ) : freq( freq ) { }
+
+		bool operator()( int a, int b ) const
+		{
+			return ( freq[ a ] != freq[ b ] ) ? ( freq[ a ] < freq[ b ] ) : ( a < b );
+		}
+
+		const png_uint32* freq;
+	};
+
+	// huffman code lengths of at most max_bits. Always makes a complete code
+	// of at least two symbols, deflate decoders don't all like anything else.
+	void PngBuildLengths( const png_uint32* freq, int count, int max_bits, png_byte* lengths )
+	{
+		std::fill( lengths, lengths + count, 0 );
+
+		std::vector< int > symbols;
+		for( int i = 0; i < count; ++i )
+		{
+			if( freq[ i ] )
+				symbols.push_back( i );
+		}
+
+		if( symbols.size() < 2 )
+		{
+			const int used = symbols.empty() ? 0 : symbols[ 0 ];
+			lengths[ used ] = 1;
+			lengths[ used == 0 ? 1 : 0 ] = 1;
+			return;
+		}
+
+		std::sort( symbols.begin(), symbols.end(), PngSortByFreq( freq ) );
+
+		// two queues, the leaves are sorted and the inner nodes are created
+		// in order of weight
+		const int n = (int)symbols.size();
+		std::vector< png_uint32 > weight( 2 * n - 1 );
+		std::vector< int > parent( 2 * n - 1, 0 );
+		for( int i = 0; i < n; ++i )
+			weight[ i ] = freq[ symbols[ i ] ];
+
+		int leaf = 0;
+		int node = n;
+		for( int next = n; next < 2 * n - 1; ++next )
+		{
+			int pick[ 2 ];
+			for( int k = 0; k < 2; ++k )
+			{
+				if( leaf < n && ( node >= next || weight[ leaf ] <= weight[ node ] ) )
+					pick[ k ] = leaf++;
+				else
+					pick[ k ] = node++;
+			}
+
+			weight[ next ] = weight[ pick[ 0 ] ] + weight[ pick[ 1 ] ];
+			parent[ pick[ 0 ] ] = next;
+			parent[ pick[ 1 ] ] = next;
+		}
+
+		std::vector< int > depth( 2 * n - 1, 0 );
+		for( int i = 2 * n - 3; i >= 0; --i )
+			depth[ i ] = depth[ parent[ i ] ] + 1;
+
+		int length_count[ 16 ] = { 0 };
+		for( int i = 0; i < n; ++i )
+			length_count[ std::min( depth[ i ], max_bits ) ]++;
+
+		// clamping to max_bits overfills the code, move leaves down from the
+		// shorter lengths until it fits again
+		png_uint32 total = 0;
+		for( int i = max_bits; i > 0; --i )
+			total += (png_uint32)length_count[ i ] << ( max_bits - i );
+
+		while( total != ( 1u << max_bits ) )
+		{
+			length_count[ max_bits ]--;
+			for( int i = max_bits - 1; i > 0; --i )
+			{
+				if( length_count[ i ] )
+				{
+					length_count[ i ]--;
+					length_count[ i + 1 ] += 2;
+					break;
+				}
+			}
+			total--;
+		}
+
+		// the least frequent symbols get the longest codes
+		int s = 0;
+		for( int len = max_bits; len > 0; --len )
+		{
+			for( int k = 0; k < length_count[ len ]; ++k )
+				lengths[ symbols[ s++ ] ] = (png_byte)len;
+		}
+	}
+
+	// canonical codes, bit reversed since deflate writes them from the top bit
+	void PngBuildCodes( const png_byte* lengths, int count, png_uint16* codes )
+	{
+		int length_count[ 16 ] = { 0 };
+		for( int i = 0; i < count; ++i )
+			length_count[ lengths[ i ] ]++;
+		length_count[ 0 ] = 0;
+
+		int next_code[ 16 ] = { 0 };
+		int code = 0;
+		for( int bits = 1; bits < 16; ++bits )
+		{
+			code = ( code + length_count[ bits - 1 ] ) << 1;
+			next_code[ bits ] = code;
+		}
+
+		for( int i = 0; i < count; ++i )
+		{
+			const int len = lengths[ i ];
+			codes[ i ] = 0;
+			if( len == 0 )
+				continue;
+
+			int c = next_code[ len ]++;
+			int reversed = 0;
+			for( int k = 0; k < len; ++k )
+			{
+				reversed = ( reversed << 1 ) | ( c & 1 );
+				c >>= 1;
+			}
+			codes[ i ] = (png_uint16)reversed;
+		}
+	}
+
+	void PngWriteStored( PngBitWriter& out, const png_byte* data, int size )
+	{
+		do
+		{
+			const int n = std::min( size, 65535 );
+			out.Put( 0, 1 );
+			out.Put( 0, 2 );
+			out.AlignToByte();
+			out.Put( n, 16 );
+			out.Put( ~n & 0xFFFF, 16 );
+			out.PutBytes( data, n );
+			data += n;
+			size -= n;
+		}
+		while( size > 0 );
+	}
+
+	void PngWriteSymbols( PngBitWriter& out, const std::vector< PngSymbol >& symbols,
+		const png_byte* litlen_lengths, const png_uint16* litlen_codes, const png_byte* dist_lengths, const png_uint16* dist_codes )
+	{
+		for( std::size_t i = 0; i < symbols.size(); ++i )
+		{
+			const PngSymbol& s = symbols[ i ];
+			if( s.dist == 0 )
+			{
+				out.Put( litlen_codes[ s.litlen ], litlen_lengths[ s.litlen ] );
+				continue;
+			}
+
+			const int lc = gPngWriterTables.length_code[ s.litlen ];
+			out.Put( litlen_codes[ 257 + lc ], litlen_lengths[ 257 + lc ] );
+			if( PNG_LENGTH_EXTRA[ lc ] )
+				out.Put( s.litlen - PNG_LENGTH_BASE[ lc ], PNG_LENGTH_EXTRA[ lc ] );
+
+			const int dc = gPngWriterTables.DistCode( s.dist );
+			out.Put( dist_codes[ dc ], dist_lengths[ dc ] );
+			if( PNG_DIST_EXTRA[ dc ] )
+				out.Put( s.dist - PNG_DIST_BASE[ dc ], PNG_DIST_EXTRA[ dc ] );
+		}
+
+		out.Put( litlen_codes[ 256 ], litlen_lengths[ 256 ] );
+	}
+
+	// writes symbols as one block, whichever of dynamic, fixed or stored is
+	// the smallest. raw is the data the symbols decode to.
+	void PngWriteBlock( PngBitWriter& out, const std::vector< PngSymbol >& symbols, const png_byte* raw, int raw_size )
+	{
+		png_uint32 litlen_freq[ 286 ] = { 0 };
+		png_uint32 dist_freq[ 30 ] = { 0 };
+		png_uint32 extra_bits = 0;
+
+		for( std::size_t i = 0; i < symbols.size(); ++i )
+		{
+			const PngSymbol& s = symbols[ i ];
+			if( s.dist == 0 )
+			{
+				litlen_freq[ s.litlen ]++;
+				continue;
+			}
+
+			const int lc = gPngWriterTables.length_code[ s.litlen ];
+			const int dc = gPngWriterTables.DistCode( s.dist );
+			litlen_freq[ 257 + lc ]++;
+			dist_freq[ dc ]++;
+			extra_bits += PNG_LENGTH_EXTRA[ lc ] + PNG_DIST_EXTRA[ dc ];
+		}
+		litlen_freq[ 256 ] = 1;
+
+		png_byte litlen_lengths[ 286 ];
+		png_byte dist_lengths[ 30 ];
+		PngBuildLengths( litlen_freq, 286, 15, litlen_lengths );
+		PngBuildLengths( dist_freq, 30, 15, dist_lengths );
+
+		int hlit = 286;
+		while( hlit > 257 && litlen_lengths[ hlit - 1 ] == 0 ) --hlit;
+		int hdist = 30;
+		while( hdist > 1 && dist_lengths[ hdist - 1 ] == 0 ) --hdist;
+
+		// the code lengths, run length encoded with 16, 17 and 18
+		png_byte all_lengths[ 286 + 30 ];
+		std::copy( litlen_lengths, litlen_lengths + hlit, all_lengths );
+		std::copy( dist_lengths, dist_lengths + hdist, all_lengths + hlit );
+		const int all_count = hlit + hdist;
+
+		png_byte rle_symbols[ 286 + 30 ];
+		png_byte rle_extra[ 286 + 30 ];
+		int rle_count = 0;
+		png_uint32 cl_freq[ 19 ] = { 0 };
+
+		for( int i = 0; i < all_count; )
+		{
+			const int len = all_lengths[ i ];
+			int run = 1;
+			while( i + run < all_count && all_lengths[ i + run ] == len )
+				++run;
+
+			if( len == 0 && run >= 3 )
+			{
+				const int n = std::min( run, 138 );
+				rle_symbols[ rle_count ] = (png_byte)( n >= 11 ? 18 : 17 );
+				rle_extra[ rle_count ] = (png_byte)( n >= 11 ? n - 11 : n - 3 );
+				cl_freq[ rle_symbols[ rle_count++ ] ]++;
+				i += n;
+				continue;
+			}
+
+			// the length itself and then repeats of it
+			rle_symbols[ rle_count ] = (png_byte)len;
+			rle_extra[ rle_count ] = 0;
+			cl_freq[ rle_symbols[ rle_count++ ] ]++;
+			++i;
+			--run;
+
+			while( len != 0 && run >= 3 )
+			{
+				const int n = std::min( run, 6 );
+				rle_symbols[ rle_count ] = 16;
+				rle_extra[ rle_count ] = (png_byte)( n - 3 );
+				cl_freq[ rle_symbols[ rle_count++ ] ]++;
+				i += n;
+				run -= n;
+			}
+		}
+
+		png_byte cl_lengths[ 19 ];
+		PngBuildLengths( cl_freq, 19, 7, cl_lengths );
+
+		int hclen = 19;
+		while( hclen > 4 && cl_lengths[ PNG_CODE_LENGTH_ORDER[ hclen - 1 ] ] == 0 ) --hclen;
+
+		// sizes in bits
+		png_uint32 dynamic_size = 3 + 5 + 5 + 4 + 3 * hclen + extra_bits;
+		for( int i = 0; i < rle_count; ++i )
+		{
+			const int s = rle_symbols[ i ];
+			dynamic_size += cl_lengths[ s ] + ( s == 16 ? 2 : ( s == 17 ? 3 : ( s == 18 ? 7 : 0 ) ) );
+		}
+
+		png_uint32 fixed_size = 3 + extra_bits;
+		for( int i = 0; i < 286; ++i )
+		{
+			dynamic_size += litlen_freq[ i ] * litlen_lengths[ i ];
+			fixed_size += litlen_freq[ i ] * gPngWriterTables.fixed_litlen_lengths[ i ];
+		}
+		for( int i = 0; i < 30; ++i )
+		{
+			dynamic_size += dist_freq[ i ] * dist_lengths[ i ];
+			fixed_size += dist_freq[ i ] * gPngWriterTables.fixed_dist_lengths[ i ];
+		}
+
+		const png_uint32 stored_size = ( raw_size / 65535 + 1 ) * ( 3 + 7 + 32 ) + 8 * (png_uint32)raw_size;
+
+		if( stored_size <= dynamic_size && stored_size <= fixed_size )
+		{
+			PngWriteStored( out, raw, raw_size );
+		}
+		else if( fixed_size <= dynamic_size )
+		{
+			png_uint16 litlen_codes[ 288 ];
+			png_uint16 dist_codes[ 30 ];
+			PngBuildCodes( gPngWriterTables.fixed_litlen_lengths, 288, litlen_codes );
+			PngBuildCodes( gPngWriterTables.fixed_dist_lengths, 30, dist_codes );
+
+			out.Put( 0, 1 );
+			out.Put( 1, 2 );
+			PngWriteSymbols( out, symbols, gPngWriterTables.fixed_litlen_lengths, litlen_codes, gPngWriterTables.fixed_dist_lengths, dist_codes );
+		}
+		else
+		{
+			png_uint16 litlen_codes[ 286 ];
+			png_uint16 dist_codes[ 30 ];
+			png_uint16 cl_codes[ 19 ];
+			PngBuildCodes( litlen_lengths, 286, litlen_codes );
+			PngBuildCodes( dist_lengths, 30, dist_codes );
+			PngBuildCodes( cl_lengths, 19, cl_codes );
+
+			out.Put( 0, 1 );
+			out.Put( 2, 2 );
+			out.Put( hlit - 257, 5 );
+			out.Put( hdist - 1, 5 );
+			out.Put( hclen - 4, 4 );
+			for( int i = 0; i < hclen; ++i )
+				out.Put( cl_lengths[ PNG_CODE_LENGTH_ORDER[ i ] ], 3 );
+
+			for( int i = 0; i < rle_count; ++i )
+			{
+				const int s = rle_symbols[ i ];
+				out.Put( cl_codes[ s ], cl_lengths[ s ] );
+				if( s == 16 ) out.Put( rle_extra[ i ], 2 );
+				else if( s == 17 ) out.Put( rle_extra[ i ], 3 );
+				else if( s == 18 ) out.Put( rle_extra[ i ], 7 );
+			}
+
+			PngWriteSymbols( out, symbols, litlen_lengths, litlen_codes, dist_lengths, dist_codes );
+		}
+	}
+
+	//-------------------------------------------------------------------------
+
+	struct PngLevel
+	{
+		int		max_chain;
+		int		nice_length;
+		bool	lazy;
+	};
+
+	const PngLevel PNG_LEVELS[ 10 ] = {
+		{ 0, 0, false },
+		{ 4, 8, false },
+		{ 8, 16, false },
+		{ 32, 32, false },
+		{ 16, 32, true },
+		{ 32, 64, true },
+		{ 128, 128, true },
+		{ 256, 258, true },
+		{ 1024, 258, true },
+		{ 4096, 258, true },
+	};
+
+	// lz77 over data[ begin, end ). Matches can reach back to dict_begin, but
+	// never past end since the next stripe writes that data.
+	class PngMatcher
+	{
+	public:
+		PngMatcher( const png_byte* data, int dict_begin, int end, const PngLevel& level ) :
+			mData( data ),
+			mEnd( end ),
+			mNextInsert( dict_begin ),
+			mLevel( level ),
+			mHead( PNG_HASH_SIZE, -1 ),
+			mPrev( PNG_WINDOW_SIZE, -1 )
+		{
+		}
+
+		// inserts every position up to and including pos into the hash chains
+		void InsertUpTo( int pos )
+		{
+			for( ; mNextInsert <= pos; ++mNextInsert )
+			{
+				if( mNextInsert + PNG_MIN_MATCH > mEnd )
+					continue;
+
+				const int h = Hash( mNextInsert );
+				mPrev[ mNextInsert & PNG_WINDOW_MASK ] = mHead[ h ];
+				mHead[ h ] = mNextInsert;
+			}
+		}
+
+		// longest match at pos that is longer than prev_length, 0 if there
+		// isn't one. pos must not be inserted yet.
+		int FindMatch( int pos, int prev_length, int& dist ) const
+		{
+			const int limit = std::min( PNG_MAX_MATCH, mEnd - pos );
+			if( limit < PNG_MIN_MATCH || prev_length >= limit )
+				return 0;
+
+			const png_byte* s = mData + pos;
+			int best = std::max( prev_length, PNG_MIN_MATCH - 1 );
+			int best_dist = 0;
+			int chain = mLevel.max_chain;
+			int cand = mHead[ Hash( pos ) ];
+
+			while( cand >= 0 && cand < pos && pos - cand <= PNG_WINDOW_SIZE && chain-- > 0 )
+			{
+				const png_byte* c = mData + cand;
+				if( c[ best ] == s[ best ] && c[ 0 ] == s[ 0 ] && c[ 1 ] == s[ 1 ] )
+				{
+					int len = 2;
+					while( len < limit && c[ len ] == s[ len ] )
+						++len;
+
+					if( len > best )
+					{
+						best = len;
+						best_dist = pos - cand;
+						if( len >= mLevel.nice_length || len == limit )
+							break;
+					}
+				}
+
+				// the chains only go backwards, anything else is a slot that
+				// has been reused
+				const int next = mPrev[ cand & PNG_WINDOW_MASK ];
+				if( next >= cand )
+					break;
+				cand = next;
+			}
+
+			if( best_dist == 0 || ( best == PNG_MIN_MATCH && best_dist > PNG_TOO_FAR ) )
+				return 0;
+
+			dist = best_dist;
+			return best;
+		}
+
+	private:
+		int Hash( int pos ) const
+		{
+			const png_byte* p = mData + pos;
+			return ( ( p[ 0 ] << 10 ) ^ ( p[ 1 ] << 5 ) ^ p[ 2 ] ) & ( PNG_HASH_SIZE - 1 );
+		}
+
+		const png_byte*		mData;
+		int					mEnd;
+		int					mNextInsert;
+		PngLevel			mLevel;
+		std::vector< int >	mHead;
+		std::vector< int >	mPrev;
+	};
+
+	// deflates data[ begin, end ) into out, ending with a sync flush so that
+	// the stripes can be joined. Not the final block.
+	void PngDeflateStripe( const png_byte* data, int dict_begin, int begin, int end, int compression, std::vector< png_byte >& out )
+	{
+		PngBitWriter bits( out );
+
+		if( compression <= 0 )
+		{
+			if( end > begin )
+				PngWriteStored( bits, data + begin, end - begin );
+		}
+		else
+		{
+			const PngLevel& level = PNG_LEVELS[ std::min( compression, 9 ) ];
+			PngMatcher matcher( data, dict_begin, end, level );
+			matcher.InsertUpTo( begin - 1 );
+
+			std::vector< PngSymbol > symbols;
+			symbols.reserve( PNG_BLOCK_SYMBOLS + 1 );
+
+			int block_begin = begin;
+			int pos = begin;
+			int length = 0;
+			int dist = 0;
+			bool have_match = false;
+
+			while( pos < end )
+			{
+				if( have_match == false )
+					length = matcher.FindMatch( pos, 0, dist );
+				have_match = false;
+
+				PngSymbol symbol;
+				if( length >= PNG_MIN_MATCH )
+				{
+					if( level.lazy && length < level.nice_length )
+					{
+						// if the next position has a longer match, this one
+						// goes out as a literal
+						matcher.InsertUpTo( pos );
+						int next_dist = 0;
+						const int next_length = matcher.FindMatch( pos + 1, length, next_dist );
+						if( next_length > length )
+						{
+							symbol.litlen = data[ pos ];
+							symbol.dist = 0;
+							symbols.push_back( symbol );
+							++pos;
+							length = next_length;
+							dist = next_dist;
+							have_match = true;
+							continue;
+						}
+					}
+
+					symbol.litlen = (png_uint16)length;
+					symbol.dist = (png_uint16)dist;
+					symbols.push_back( symbol );
+					matcher.InsertUpTo( pos + length - 1 );
+					pos += length;
+				}
+				else
+				{
+					symbol.litlen = data[ pos ];
+					symbol.dist = 0;
+					symbols.push_back( symbol );
+					matcher.InsertUpTo( pos );
+					++pos;
+				}
+
+				if( (int)symbols.size() >= PNG_BLOCK_SYMBOLS )
+				{
+					PngWriteBlock( bits, symbols, data + block_begin, pos - block_begin );
+					symbols.clear();
+					block_begin = pos;
+				}
+			}
+
+			if( symbols.empty() == false )
+				PngWriteBlock( bits, symbols, data + block_begin, pos - block_begin );
+		}
+
+		// sync flush: an empty stored block
+		bits.Put( 0, 1 );
+		bits.Put( 0, 2 );
+		bits.AlignToByte();
+		bits.Put( 0, 16 );
+		bits.Put( 0xFFFF, 16 );
+	}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+	struct PngFilterBody
+	{
+		const png_byte*	pixels;
+		std::size_t		stride;
+		int				row_size;
+		int				bpp;
+		int				height;
+		int				rows_per_stripe;
+		png_byte*		filtered;
+
+		void operator()( int stripe )
+		{
+			const int row_begin = stripe * rows_per_stripe;
+			const int row_end = std::min( height, row_begin + rows_per_stripe );
+
+			// the rows are copied so that there's always zeros to the left of
+			// them, and the row above the first row is zeros too
+			const int pad = 16;
+			std::vector< png_byte > rows( 2 * ( pad + row_size ), 0 );
+			std::vector< png_byte > lines( 5 * row_size );
+			png_byte* cur = &rows[ pad ];
+			png_byte* prior = &rows[ 2 * pad + row_size ];
+			png_byte* out[ 5 ];
+			for( int t = 0; t < 5; ++t )
+				out[ t ] = &lines[ t * row_size ];
+
+			if( row_begin > 0 )
+				std::memcpy( prior, pixels + ( row_begin - 1 ) * stride, row_size );
+
+			for( int y = row_begin; y < row_end; ++y )
+			{
+				std::memcpy( cur, pixels + y * stride, row_size );
+				const int best = PngFilterRow( cur, prior, row_size, bpp, out );
+
+				png_byte* dest = filtered + (std::size_t)y * ( row_size + 1 );
+				dest[ 0 ] = (png_byte)best;
+				std::memcpy( dest + 1, out[ best ], row_size );
+
+				std::swap( cur, prior );
+			}
+		}
+	};
+
+	struct PngDeflateBody
+	{
+		const png_byte*							filtered;
+		int										size;
+		int										stripe_size;
+		int										compression;
+		std::vector< std::vector< png_byte > >*	stripes;
+		std::vector< png_uint32 >*				adlers;
+
+		void operator()( int stripe )
+		{
+			const int begin = stripe * stripe_size;
+			const int end = std::min( size, begin + stripe_size );
+			const int dict_begin = std::max( 0, begin - PNG_WINDOW_SIZE );
+
+			(*adlers)[ stripe ] = PngAdler32( filtered + begin, end - begin );
+
+			std::vector< png_byte >& out = (*stripes)[ stripe ];
+			out.reserve( ( compression > 0 ) ? ( end - begin ) / 4 + 64 : ( end - begin ) + ( end - begin ) / 65535 * 5 + 64 );
+			PngDeflateStripe( filtered, dict_begin, begin, end, compression, out );
+		}
+	};
+
+	// returns the position of the chunk, PngEndChunk() fills in the length
+	std::size_t PngBeginChunk( std::vector< png_byte >& out, const char* type )
+	{
+		const std::size_t result = out.size();
+		PngPutUint32( out, 0 );
+		out.insert( out.end(), type, type + 4 );
+		return result;
+	}
+
+	void PngEndChunk( std::vector< png_byte >& out, std::size_t chunk )
+	{
+		const png_uint32 length = (png_uint32)( out.size() - chunk - 8 );
+		out[ chunk + 0 ] = (png_byte)( length >> 24 );
+		out[ chunk + 1 ] = (png_byte)( length >> 16 );
+		out[ chunk + 2 ] = (png_byte)( length >> 8 );
+		out[ chunk + 3 ] = (png_byte)( length );
+		PngPutUint32( out, PngCrc32( 0, &out[ chunk + 4 ], length + 4 ) );
+	}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+
+bool WritePngToMemory( std::vector< unsigned char >& out, int width, int height, int comp, const void* data, int stride_bytes, const PngWriterSettings& settings )
+{
+	out.clear();
+	if( width <= 0 || height <= 0 || comp < 1 || comp > 4 || data == NULL )
+		return false;
+
+	if( stride_bytes == 0 )
+		stride_bytes = width * comp;
+
+	const int row_size = width * comp;
+	const int rows_per_stripe = std::max( 1, PNG_STRIPE_SIZE / ( row_size + 1 ) );
+	const int stripe_count = ( height + rows_per_stripe - 1 ) / rows_per_stripe;
+	const int filtered_size = ( row_size + 1 ) * height;
+	const int compression = std::max( 0, std::min( settings.compression, 9 ) );
+
+	std::vector< png_byte > filtered( filtered_size );
+	std::vector< std::vector< png_byte > > stripes( stripe_count );
+	std::vector< png_uint32 > adlers( stripe_count );
+
+	{
+		const int threads = ( settings.thread_count > 0 ) ? settings.thread_count : CThreadPool::GetCoreCount();
+		CThreadPool own_pool( settings.pool ? 1 : std::min( threads, stripe_count ) );
+		CThreadPool& pool = settings.pool ? *settings.pool : own_pool;
+
+		PngFilterBody filter;
+		filter.pixels = (const png_byte*)data;
+		filter.stride = stride_bytes;
+		filter.row_size = row_size;
+		filter.bpp = comp;
+		filter.height = height;
+		filter.rows_per_stripe = rows_per_stripe;
+		filter.filtered = &filtered[ 0 ];
+		ParallelFor( pool, stripe_count, filter );
+
+		// every stripe needs the filtered data before it, so this can only
+		// start once all of them have been filtered
+		PngDeflateBody deflate;
+		deflate.filtered = &filtered[ 0 ];
+		deflate.size = filtered_size;
+		deflate.stripe_size = rows_per_stripe * ( row_size + 1 );
+		deflate.compression = compression;
+		deflate.stripes = &stripes;
+		deflate.adlers = &adlers;
+		ParallelFor( pool, stripe_count, deflate );
+	}
+
+	std::size_t compressed_size = 0;
+	for( int i = 0; i < stripe_count; ++i )
+		compressed_size += stripes[ i ].size();
+	out.reserve( compressed_size + 128 );
+
+	const png_byte signature[] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+	out.insert( out.end(), signature, signature + 8 );
+
+	const png_byte color_types[] = { 0, 0, 4, 2, 6 };
+	std::size_t chunk = PngBeginChunk( out, "IHDR" );
+	PngPutUint32( out, width );
+	PngPutUint32( out, height );
+	out.push_back( 8 );
+	out.push_back( color_types[ comp ] );
+	out.push_back( 0 );
+	out.push_back( 0 );
+	out.push_back( 0 );
+	PngEndChunk( out, chunk );
+
+	chunk = PngBeginChunk( out, "IDAT" );
+	out.push_back( 0x78 );
+	out.push_back( ( compression < 2 ) ? 0x01 : ( ( compression < 6 ) ? 0x5E : ( ( compression == 6 ) ? 0x9C : 0xDA ) ) );
+
+	png_uint32 adler = 1;
+	for( int i = 0; i < stripe_count; ++i )
+	{
+		out.insert( out.end(), stripes[ i ].begin(), stripes[ i ].end() );
+		std::vector< png_byte >().swap( stripes[ i ] );
+
+		const int stripe_begin = i * rows_per_stripe * ( row_size + 1 );
+		const int stripe_end = std::min( filtered_size, stripe_begin + rows_per_stripe * ( row_size + 1 ) );
+		adler = PngAdler32Combine( adler, adlers[ i ], stripe_end - stripe_begin );
+	}
+
+	// an empty final block with the fixed codes
+	out.push_back( 0x03 );
+	out.push_back( 0x00 );
+	PngPutUint32( out, adler );
+	PngEndChunk( out, chunk );
+
+	chunk = PngBeginChunk( out, "IEND" );
+	PngEndChunk( out, chunk );
+
+	return true;
+}
+
+bool WritePng( const std::string& filename, int width, int height, int comp, const void* data, int stride_bytes, const PngWriterSettings& settings )
+{
+	std::vector< unsigned char > png;
+	if( WritePngToMemory( png, width, height, comp, data, stride_bytes, settings ) == false )
+		return false;
+
+	FILE* file = fopen( filename.c_str(), "wb" );
+	if( file == NULL )
+		return false;
+
+	const bool result = ( fwrite( &png[ 0 ], 1, png.size(), file ) == png.size() );
+	fclose( file );
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+
+} // end of namespace ceng
@@ -0,0 +1,93 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2003 - 2011 Petri Purho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// PNG writer
+// ==========
+//
+// A png encoder for the big exports, a replacement for stbi_write_png() with
+// the same arguments. The image is cut into stripes of rows that are 
+// filtered and deflated in parallel on a CThreadPool. The stripes are
+// joined with deflate sync flushes, and every stripe can match against the
+// 32k of data before it, so the output is close to what one thread would
+// make.
+//
+// Filters are picked per row the same way stb does it (smallest sum of 
+// absolute values), with SSE2 when it's available. Blocks are written with 
+// dynamic huffman codes, or fixed / stored if that comes out smaller.
+//
+// compression goes from 0 (stored, fastest) to 9 (smallest). 1 - 3 don't
+// do lazy matching and 4 and up do.
+//
+//.............................................................................
+//
+// Usage:
+//
+//	ceng::PngWriterSettings settings;
+//	settings.compression = 2;
+//	ceng::WritePng( "out.png", w, h, 4, pixels, w * 4, settings );
+//
+//=============================================================================
+#ifndef INC_PNGWRITER_H
+#define INC_PNGWRITER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace ceng {
+
+class CThreadPool;
+
+//-----------------------------------------------------------------------------
+
+struct PngWriterSettings
+{
+	PngWriterSettings() : compression( 4 ), thread_count( 0 ), pool( NULL ) { }
+
+	// 0 - 9, speed vs. size
+	int compression;
+
+	// thread_count <= 0 uses one thread per core
+	int thread_count;
+
+	// if set, the stripes are done on this pool and thread_count is ignored.
+	// Saves starting threads for every image when there are a lot of them.
+	// Must not be a pool that the caller is running a task on.
+	CThreadPool* pool;
+};
+
+//-----------------------------------------------------------------------------
+
+// comp is the number of 8 bit channels: 1 = Y, 2 = YA, 3 = RGB, 4 = RGBA.
+// Rows are top row first, stride_bytes apart (0 means width * comp).
+// Returns false if the image can't be written.
+bool WritePng( const std::string& filename, int width, int height, int comp, const void* data, int stride_bytes, const PngWriterSettings& settings = PngWriterSettings() );
+
+bool WritePngToMemory( std::vector< unsigned char >& out, int width, int height, int comp, const void* data, int stride_bytes, const PngWriterSettings& settings = PngWriterSettings() );
+
+//-----------------------------------------------------------------------------
+
+} // end of namespace ceng
+
+#endif
@@ -0,0 +1,107 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2003 - 2011 Petri Purho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+
+
+// Compares ceng::WritePng() against stbi_write_png() on a print sized card
+// back. Takes several seconds, so it's only built when
+// CENG_PNGWRITER_BENCHMARK is defined.
+
+#include "../pngwriter.h"
+#include "../../timer/ctimer.h"
+#include "../../debug.h"
+#include "../../../poro/external/stb_image_write.h"
+
+#include <cstdio>
+#include <iostream>
+
+#if defined( CENG_TESTER_ENABLED ) && defined( CENG_PNGWRITER_BENCHMARK )
+
+namespace ceng {
+namespace test {
+
+namespace {
+
+long PngWriterBenchmark_FileSize( const char* filename )
+{
+	FILE* file = fopen( filename, "rb" );
+	if( file == NULL )
+		return 0;
+
+	fseek( file, 0, SEEK_END );
+	const long result = ftell( file );
+	fclose( file );
+	return result;
+}
+
+} // end of anonymous namespace
+
+int PngWriterBenchmark()
+{
+	// 300 dpi card back: flat triangles with a gradient over them
+	const int width = 2700;
+	const int height = 3800;
+	std::vector< unsigned char > pixels( width * height * 4 );
+	for( int y = 0; y < height; ++y )
+	{
+		for( int x = 0; x < width; ++x )
+		{
+			const int cell = ( ( x / 150 ) * 7 + ( y / 150 ) * 13 + ( ( x % 150 ) > ( y % 150 ) ) ) % 9;
+			unsigned char* p = &pixels[ ( y * width + x ) * 4 ];
+			p[ 0 ] = (unsigned char)( cell * 25 );
+			p[ 1 ] = (unsigned char)( cell * 53 );
+			p[ 2 ] = (unsigned char)( ( x + y ) / 30 );
+			p[ 3 ] = 255;
+		}
+	}
+
+	const char* filename = "pngwriter_benchmark.png";
+
+	CTimer timer;
+	test_assert( stbi_write_png( filename, width, height, 4, &pixels[ 0 ], width * 4 ) != 0 );
+	std::cout << "stbi_write_png: " << timer.GetTime() << " ms, " << PngWriterBenchmark_FileSize( filename ) << " bytes" << std::endl;
+
+	const int levels[] = { 1, 2, 4, 6, 9 };
+	const int threads[] = { 1, 0 };
+	for( int t = 0; t < 2; ++t )
+	{
+		for( int l = 0; l < (int)( sizeof( levels ) / sizeof( levels[ 0 ] ) ); ++l )
+		{
+			PngWriterSettings settings;
+			settings.compression = levels[ l ];
+			settings.thread_count = threads[ t ];
+
+			timer.Reset();
+			test_assert( WritePng( filename, width, height, 4, &pixels[ 0 ], width * 4, settings ) );
+			std::cout << "WritePng( compression " << levels[ l ] << ", " << ( threads[ t ] ? "1 thread" : "all cores" ) << " ): " 
+				<< timer.GetTime() << " ms, " << PngWriterBenchmark_FileSize( filename ) << " bytes" << std::endl;
+		}
+	}
+
+	remove( filename );
+	return 0;
+}
+
+TEST_REGISTER( PngWriterBenchmark );
+
+} // end of namespace test
+} // end of namespace ceng
+
+#endif
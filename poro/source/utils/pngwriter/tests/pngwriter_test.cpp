@@ -0,0 +1,154 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2003 - 2011 Petri Purho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+
+
+#include "../pngwriter.h"
+#include "../../threadpool/cthreadpool.h"
+#include "../../random/random.h"
+#include "../../debug.h"
+#include "../../../poro/external/stb_image.h"
+
+#include <cstdlib>
+
+#ifdef CENG_TESTER_ENABLED
+
+namespace ceng {
+namespace test {
+
+namespace {
+
+// writes the image and reads it back with stb_image
+bool PngWriterTest_RoundTrip( int width, int height, int comp, const std::vector< unsigned char >& pixels, int stride, const PngWriterSettings& settings )
+{
+	std::vector< unsigned char > png;
+	if( WritePngToMemory( png, width, height, comp, &pixels[ 0 ], stride, settings ) == false )
+		return false;
+
+	int w = 0, h = 0, c = 0;
+	unsigned char* result = stbi_load_from_memory( &png[ 0 ], (int)png.size(), &w, &h, &c, 0 );
+	if( result == NULL )
+		return false;
+
+	bool ok = ( w == width && h == height && c == comp );
+	for( int y = 0; ok && y < height; ++y )
+	{
+		if( memcmp( result + y * width * comp, &pixels[ y * stride ], width * comp ) != 0 )
+			ok = false;
+	}
+
+	stbi_image_free( result );
+	return ok;
+}
+
+} // end of anonymous namespace
+
+int PngWriterTest()
+{
+	CLGMRandom random;
+	random.SetSeed( 1234 );
+
+	// bad arguments
+	{
+		std::vector< unsigned char > png;
+		unsigned char pixel[ 4 ] = { 0 };
+		test_assert( WritePngToMemory( png, 0, 1, 4, pixel, 4 ) == false );
+		test_assert( WritePngToMemory( png, 1, 1, 5, pixel, 4 ) == false );
+		test_assert( WritePngToMemory( png, 1, 1, 4, NULL, 4 ) == false );
+		test_assert( WritePngToMemory( png, 1, 1, 4, pixel, 4 ) );
+	}
+
+	// every channel count, odd sizes, padded rows, all the compression
+	// levels and several threads. The images are a mix of flat areas,
+	// gradients and noise so that all the filters and block types get used.
+	{
+		const int sizes[][ 2 ] = { { 1, 1 }, { 3, 7 }, { 17, 5 }, { 133, 97 }, { 600, 450 } };
+		for( int s = 0; s < (int)( sizeof( sizes ) / sizeof( sizes[ 0 ] ) ); ++s )
+		{
+			for( int comp = 1; comp <= 4; ++comp )
+			{
+				const int width = sizes[ s ][ 0 ];
+				const int height = sizes[ s ][ 1 ];
+				const int stride = width * comp + ( s % 2 ) * 3;
+
+				std::vector< unsigned char > pixels( stride * height );
+				for( int y = 0; y < height; ++y )
+				{
+					for( int x = 0; x < width * comp; ++x )
+					{
+						unsigned char& p = pixels[ y * stride + x ];
+						if( y < height / 3 )			p = (unsigned char)( ( x / 8 ) * 16 );
+						else if( y < 2 * height / 3 )	p = (unsigned char)( x + y );
+						else							p = (unsigned char)random.Random( 0, 255 );
+					}
+				}
+
+				for( int level = 0; level <= 9; level += ( s < 4 ? 1 : 3 ) )
+				{
+					PngWriterSettings settings;
+					settings.compression = level;
+					settings.thread_count = 1 + level % 3;
+					test_assert( PngWriterTest_RoundTrip( width, height, comp, pixels, stride, settings ) );
+				}
+			}
+		}
+	}
+
+	// long runs of the same value, matches are 258 long and reach across
+	// stripes
+	{
+		const int width = 1500;
+		const int height = 400;
+		std::vector< unsigned char > pixels( width * height * 3, 200 );
+		for( int i = 0; i < (int)pixels.size(); i += 997 )
+			pixels[ i ] = (unsigned char)random.Random( 0, 255 );
+
+		PngWriterSettings settings;
+		settings.thread_count = 3;
+		test_assert( PngWriterTest_RoundTrip( width, height, 3, pixels, width * 3, settings ) );
+
+		// the stripes don't depend on the thread count, so neither does the output
+		std::vector< unsigned char > one, many;
+		settings.thread_count = 1;
+		test_assert( WritePngToMemory( one, width, height, 3, &pixels[ 0 ], width * 3, settings ) );
+		settings.thread_count = 4;
+		test_assert( WritePngToMemory( many, width, height, 3, &pixels[ 0 ], width * 3, settings ) );
+		test_assert( one == many );
+
+		// a pool from the caller can be used for more than one image
+		CThreadPool pool( 3 );
+		settings.pool = &pool;
+		for( int i = 0; i < 2; ++i )
+		{
+			std::vector< unsigned char > pooled;
+			test_assert( WritePngToMemory( pooled, width, height, 3, &pixels[ 0 ], width * 3, settings ) );
+			test_assert( one == pooled );
+		}
+	}
+
+	return 0;
+}
+
+TEST_REGISTER( PngWriterTest );
+
+} // end of namespace test
+} // end of namespace ceng
+
+#endif
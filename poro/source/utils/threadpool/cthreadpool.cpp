@@ -0,0 +1,190 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2003 - 2011 Petri Purho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+
+#include "cthreadpool.h"
+
+#include <SDL.h>
+
+#include "../../poro/platform_defs.h"
+#include "../debug.h"
+
+#ifdef PORO_PLAT_WINDOWS
+#	include "../../poro/external/poro_windows.h"
+#else
+#	include <unistd.h>
+#endif
+
+namespace ceng {
+
+//-----------------------------------------------------------------------------
+
+int CThreadPool::GetCoreCount()
+{
+	int result = 1;
+
+#ifdef PORO_PLAT_WINDOWS
+	SYSTEM_INFO info;
+	GetSystemInfo( &info );
+	result = (int)info.dwNumberOfProcessors;
+#else
+	result = (int)sysconf( _SC_NPROCESSORS_ONLN );
+#endif
+
+	return ( result > 0 ) ? result : 1;
+}
+
+//-----------------------------------------------------------------------------
+
+CThreadPool::CThreadPool( int thread_count ) :
+	mThreads(),
+	mTasks(),
+	mTasksRunning( 0 ),
+	mQuit( false ),
+	mMutex( NULL ),
+	mTaskAdded( NULL ),
+	mTaskDone( NULL )
+{
+	if( thread_count <= 0 )
+		thread_count = GetCoreCount();
+
+	mMutex = SDL_CreateMutex();
+	mTaskAdded = SDL_CreateCond();
+	mTaskDone = SDL_CreateCond();
+
+	cassert( mMutex && mTaskAdded && mTaskDone );
+
+	for( int i = 1; i < thread_count; ++i )
+	{
+		SDL_Thread* thread = SDL_CreateThread( CThreadPool::WorkerThread, this );
+		if( thread == NULL )
+		{
+			logger << "Warning - CThreadPool couldn't create a thread, using " << mThreads.size() + 1 << " threads" << std::endl;
+			break;
+		}
+
+		mThreads.push_back( thread );
+	}
+}
+
+CThreadPool::~CThreadPool()
+{
+	SDL_mutexP( mMutex );
+	mQuit = true;
+	SDL_CondBroadcast( mTaskAdded );
+	SDL_mutexV( mMutex );
+
+	for( std::size_t i = 0; i < mThreads.size(); ++i )
+		SDL_WaitThread( mThreads[ i ], NULL );
+
+	mThreads.clear();
+
+	SDL_DestroyCond( mTaskDone );
+	SDL_DestroyCond( mTaskAdded );
+	SDL_DestroyMutex( mMutex );
+}
+
+//-----------------------------------------------------------------------------
+
+void CThreadPool::AddTask( IThreadPoolTask* task )
+{
+	cassert( task );
+	if( task == NULL )
+		return;
+
+	SDL_mutexP( mMutex );
+	mTasks.push_back( task );
+	SDL_CondSignal( mTaskAdded );
+	SDL_mutexV( mMutex );
+}
+
+void CThreadPool::WaitAll()
+{
+	SDL_mutexP( mMutex );
+
+	while( mTasks.empty() == false || mTasksRunning > 0 )
+	{
+		IThreadPoolTask* task = PopTask();
+		if( task )
+		{
+			RunTask( task );
+		}
+		else
+		{
+			SDL_CondWait( mTaskDone, mMutex );
+		}
+	}
+
+	SDL_mutexV( mMutex );
+}
+
+//-----------------------------------------------------------------------------
+
+IThreadPoolTask* CThreadPool::PopTask()
+{
+	if( mTasks.empty() )
+		return NULL;
+
+	IThreadPoolTask* result = mTasks.front();
+	mTasks.pop_front();
+	return result;
+}
+
+// called with mMutex locked, unlocks it for the duration of the task
+void CThreadPool::RunTask( IThreadPoolTask* task )
+{
+	mTasksRunning++;
+	SDL_mutexV( mMutex );
+
+	task->Run();
+
+	SDL_mutexP( mMutex );
+	mTasksRunning--;
+	if( mTasks.empty() && mTasksRunning == 0 )
+		SDL_CondBroadcast( mTaskDone );
+}
+
+int CThreadPool::WorkerThread( void* data )
+{
+	CThreadPool* pool = static_cast< CThreadPool* >( data );
+	cassert( pool );
+
+	SDL_mutexP( pool->mMutex );
+
+	while( pool->mQuit == false )
+	{
+		IThreadPoolTask* task = pool->PopTask();
+		if( task )
+		{
+			pool->RunTask( task );
+		}
+		else
+		{
+			SDL_CondWait( pool->mTaskAdded, pool->mMutex );
+		}
+	}
+
+	SDL_mutexV( pool->mMutex );
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+} // end of namespace ceng
@@ -0,0 +1,162 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2003 - 2011 Petri Purho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// CThreadPool
+// ===========
+//
+// A simple pool of SDL threads that runs IThreadPoolTasks.
+//
+// The thread count includes the calling thread: CThreadPool( 4 ) creates
+// three worker threads and the fourth one is the thread that calls
+// WaitAll(), which runs tasks too while it waits. So CThreadPool( 1 ) doesn't
+// create any threads and just runs everything inside WaitAll().
+//
+// The pool doesn't own the tasks. They have to stay alive until WaitAll()
+// has returned.
+//
+// ParallelFor() is a helper that calls body( i ) for i in [0, count) over the
+// pool and returns once all of them are done.
+//
+//.............................................................................
+//
+// Usage:
+//
+//	struct Job : public ceng::IThreadPoolTask { void Run() { ... } };
+//
+//	ceng::CThreadPool pool;		// one thread per core
+//	std::vector< Job > jobs( 100 );
+//	for( std::size_t i = 0; i < jobs.size(); ++i )
+//		pool.AddTask( &jobs[ i ] );
+//
+//	pool.WaitAll();
+//
+//=============================================================================
+#ifndef INC_CTHREADPOOL_H
+#define INC_CTHREADPOOL_H
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+struct SDL_Thread;
+struct SDL_mutex;
+struct SDL_cond;
+
+namespace ceng {
+
+//-----------------------------------------------------------------------------
+
+class IThreadPoolTask
+{
+public:
+	virtual ~IThreadPoolTask() { }
+
+	virtual void Run() = 0;
+};
+
+//-----------------------------------------------------------------------------
+
+class CThreadPool
+{
+public:
+	// thread_count <= 0 uses one thread per core
+	explicit CThreadPool( int thread_count = 0 );
+	~CThreadPool();
+
+	// includes the thread that calls WaitAll()
+	int GetThreadCount() const;
+
+	void AddTask( IThreadPoolTask* task );
+
+	// blocks until every task that has been added has finished
+	void WaitAll();
+
+	// number of logical processors on this machine, always at least 1
+	static int GetCoreCount();
+
+private:
+	static int WorkerThread( void* data );
+
+	// returns NULL if there's nothing in the queue, mMutex has to be locked
+	IThreadPoolTask* PopTask();
+
+	void RunTask( IThreadPoolTask* task );
+
+	std::vector< SDL_Thread* >		mThreads;
+	std::deque< IThreadPoolTask* >	mTasks;
+	int								mTasksRunning;
+	bool							mQuit;
+
+	SDL_mutex*	mMutex;
+	SDL_cond*	mTaskAdded;
+	SDL_cond*	mTaskDone;
+
+	// no copying
+	CThreadPool( const CThreadPool& other );
+	CThreadPool& operator= ( const CThreadPool& other );
+};
+
+//-----------------------------------------------------------------------------
+
+namespace impl {
+
+template< class T >
+class CParallelForTask : public IThreadPoolTask
+{
+public:
+	CParallelForTask() : body( NULL ), index( 0 ) { }
+
+	void Run() { (*body)( index ); }
+
+	T*	body;
+	int index;
+};
+
+} // end of namespace impl
+
+// body( int i ) gets called from several threads at the same time, so it
+// must only write to things that belong to i
+template< class T >
+void ParallelFor( CThreadPool& pool, int count, T& body )
+{
+	if( count <= 0 )
+		return;
+
+	std::vector< impl::CParallelForTask< T > > tasks( count );
+	for( int i = 0; i < count; ++i )
+	{
+		tasks[ i ].body = &body;
+		tasks[ i ].index = i;
+		pool.AddTask( &tasks[ i ] );
+	}
+
+	pool.WaitAll();
+}
+
+//-----------------------------------------------------------------------------
+
+inline int CThreadPool::GetThreadCount() const { return (int)mThreads.size() + 1; }
+
+} // end of namespace ceng
+
+#endif
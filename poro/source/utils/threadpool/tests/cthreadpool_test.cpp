@@ -0,0 +1,112 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2003 - 2011 Petri Purho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+
+#include "../cthreadpool.h"
+#include "../../debug.h"
+
+#ifdef CENG_TESTER_ENABLED
+
+namespace ceng {
+namespace test {
+
+namespace {
+
+struct CThreadPoolTest_Square
+{
+	std::vector< int >* results;
+
+	void operator()( int i ) { (*results)[ i ] = i * i; }
+};
+
+struct CThreadPoolTest_Task : public IThreadPoolTask
+{
+	CThreadPoolTest_Task() : value( 0 ) { }
+
+	void Run() { value++; }
+
+	int value;
+};
+
+} // end of anonymous namespace
+
+int CThreadPoolTest()
+{
+	test_assert( CThreadPool::GetCoreCount() >= 1 );
+
+	// the calling thread is counted as one
+	{
+		CThreadPool pool( 1 );
+		test_assert( pool.GetThreadCount() == 1 );
+
+		CThreadPoolTest_Task task;
+		pool.AddTask( &task );
+		pool.WaitAll();
+		test_assert( task.value == 1 );
+	}
+
+	// every task is run exactly once
+	{
+		CThreadPool pool( 4 );
+		test_assert( pool.GetThreadCount() >= 1 );
+		test_assert( pool.GetThreadCount() <= 4 );
+
+		std::vector< CThreadPoolTest_Task > tasks( 200 );
+		for( std::size_t i = 0; i < tasks.size(); ++i )
+			pool.AddTask( &tasks[ i ] );
+
+		pool.WaitAll();
+		for( std::size_t i = 0; i < tasks.size(); ++i )
+			test_assert( tasks[ i ].value == 1 );
+
+		// the pool can be reused after WaitAll()
+		for( std::size_t i = 0; i < tasks.size(); ++i )
+			pool.AddTask( &tasks[ i ] );
+
+		pool.WaitAll();
+		for( std::size_t i = 0; i < tasks.size(); ++i )
+			test_assert( tasks[ i ].value == 2 );
+	}
+
+	// ParallelFor
+	{
+		CThreadPool pool;
+		std::vector< int > results( 1000, -1 );
+
+		CThreadPoolTest_Square body;
+		body.results = &results;
+		ParallelFor( pool, (int)results.size(), body );
+
+		for( int i = 0; i < (int)results.size(); ++i )
+			test_assert( results[ i ] == i * i );
+
+		// nothing to do
+		ParallelFor( pool, 0, body );
+	}
+
+	return 0;
+}
+
+TEST_REGISTER( CThreadPoolTest );
+
+} // end of namespace test
+} // end of namespace ceng
+
+#endif
@@ -88,6 +88,8 @@ public:
 		myData.push_back( data );
 	}
 
+	void Reserve( unsigned int size ) { myData.reserve( size ); }
+
 	///////////////////////////////////////////////////////////////////////////
 
 	std::vector< Key > GetKeys() const
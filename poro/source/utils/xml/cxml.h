@@ -51,6 +51,8 @@
 //
 //	XmlSaveToFile( ... )	saves a mesh to a give file
 //  XmlLoadFromFile( ... )	loads a mesh from the given file
+//  XmlSaveToBinaryFile( ... ) saves a mesh to a binary file, which loads
+//							a lot faster with the same XmlLoadFromFile( ... )
 //
 //  Whats the catch you ask? The catch is kinky.
 //
@@ -134,6 +136,7 @@
 #include <string>
 #include <fstream>
 
+#include "cxmlbinary.h"
 #include "cxmlhandler.h"
 #include "cxmlcast.h"
 #include "cxmlfilesys.h"
@@ -212,6 +215,8 @@ namespace ceng {
 	Calls the meshs Serialize( CXmlFileSys* file ) method to serialize the
 	mesh. You should use the same rootnodenae for saving and loading the
 	meshs.
+	The file can be either xml or binary ( see XmlSaveToBinaryFile() ), 
+	the format is detected from the first bytes of the file.
 	.
 */
 
@@ -222,17 +227,30 @@ namespace ceng {
 	template< class T >
 	inline void XmlLoadFromFile( T& mesh, const std::string& file, const std::string& rootnodename)
 	{
-		CXmlParser	parser;
-		CXmlHandler handler;
+		CXmlNode* node = XmlLoadNodeFromFile( file );
 
-		parser.SetHandler( &handler );
-		parser.ParseFile( file.c_str() );
-
-		XmlConvertTo( handler.GetRootElement(), mesh );
+		XmlConvertTo( node, mesh );
 
-		CXmlNode::FreeNode( handler.GetRootElement() );
+		CXmlNode::FreeNode( node );
 	}
 #endif
+
+//! Saves the mesh to a binary file.
+/*!
+	Same as XmlSaveToFile(), but writes the compact binary format described
+	in cxmlbinary.h. XmlLoadFromFile() reads both formats.
+*/
+	template< class T >
+	inline bool XmlSaveToBinaryFile( T& mesh, const std::string& file, const std::string& rootnodename = "rootelement" )
+	{
+		CXmlNode* node = XmlConvertFrom( mesh, rootnodename );
+
+		const bool result = XmlSaveNodeToBinaryFile( node, file );
+
+		CXmlNode::FreeNode( node );
+		return result;
+	}
+
 /*	void XmlLoadFromFile2( const std::string& mesh, const std::string& file, const std::string& rootnodename = "rootelement" )
 	{
 		ceng::CXmlParser	parser;
@@ -0,0 +1,314 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2003 - 2011 Petri Purho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+
+#include "cxmlbinary.h"
+
+#include <cstring>
+#include <fstream>
+#include <map>
+
+#include "cxmlnode.h"
+#include "cxmlparser.h"
+#include "cxmlhandler.h"
+#include "../filesystem/filesystem.h"
+
+namespace ceng {
+
+namespace {
+
+	const char			XML_BINARY_MAGIC[] = { 'C', 'X', 'B', '1' };
+	const unsigned int	XML_BINARY_VERSION = 1;
+
+	// there's no sane xml file this deep, but a broken file could be
+	const int			XML_BINARY_MAX_DEPTH = 1024;
+
+	void XmlBinaryWriteU32( std::vector< char >& output, unsigned int value )
+	{
+		output.push_back( (char)( value & 0xFF ) );
+		output.push_back( (char)( ( value >> 8 ) & 0xFF ) );
+		output.push_back( (char)( ( value >> 16 ) & 0xFF ) );
+		output.push_back( (char)( ( value >> 24 ) & 0xFF ) );
+	}
+
+	class CXmlBinaryWriter
+	{
+	public:
+		void WriteNode( const CXmlNode* node )
+		{
+			WriteString( node->GetName() );
+			WriteString( node->GetContent() );
+
+			XmlBinaryWriteU32( myNodes, (unsigned int)node->GetAttributeCount() );
+			for( int i = 0; i < node->GetAttributeCount(); ++i )
+			{
+				WriteString( node->GetAttributeName( i ) );
+				WriteString( CAnyContainerCast< std::string >( node->GetAttributeValue( i ) ) );
+			}
+
+			XmlBinaryWriteU32( myNodes, (unsigned int)node->GetChildCount() );
+			for( int i = 0; i < node->GetChildCount(); ++i )
+				WriteNode( node->GetChild( i ) );
+		}
+
+		void GetResult( std::vector< char >& output ) const
+		{
+			output.insert( output.end(), XML_BINARY_MAGIC, XML_BINARY_MAGIC + sizeof( XML_BINARY_MAGIC ) );
+			XmlBinaryWriteU32( output, XML_BINARY_VERSION );
+
+			XmlBinaryWriteU32( output, (unsigned int)myStrings.size() );
+			for( std::size_t i = 0; i < myStrings.size(); ++i )
+			{
+				XmlBinaryWriteU32( output, (unsigned int)myStrings[ i ]->size() );
+				output.insert( output.end(), myStrings[ i ]->begin(), myStrings[ i ]->end() );
+			}
+
+			output.insert( output.end(), myNodes.begin(), myNodes.end() );
+		}
+
+	private:
+		void WriteString( const std::string& str )
+		{
+			std::map< std::string, unsigned int >::iterator i = myStringTable.find( str );
+			if( i == myStringTable.end() )
+			{
+				i = myStringTable.insert( std::make_pair( str, (unsigned int)myStrings.size() ) ).first;
+				myStrings.push_back( &i->first );
+			}
+
+			XmlBinaryWriteU32( myNodes, i->second );
+		}
+
+		std::map< std::string, unsigned int >	myStringTable;
+		std::vector< const std::string* >		myStrings;
+		std::vector< char >						myNodes;
+	};
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+
+// friend of CXmlNode, so that the contents can be set without running them
+// through the escape character replacement a second time
+class CXmlBinaryReader
+{
+public:
+	CXmlBinaryReader( const char* data, long size ) : 
+		myPos( data ), 
+		myEnd( data + size ) 
+	{ 
+	}
+
+	CXmlNode* Read()
+	{
+		if( XmlIsBinary( myPos, (long)( myEnd - myPos ) ) == false )
+			return NULL;
+
+		myPos += sizeof( XML_BINARY_MAGIC );
+
+		unsigned int version = 0;
+		if( ReadU32( version ) == false || version != XML_BINARY_VERSION )
+			return NULL;
+
+		unsigned int string_count = 0;
+		if( ReadU32( string_count ) == false || string_count > BytesLeft() / 4 )
+			return NULL;
+
+		myStrings.resize( string_count );
+		for( unsigned int i = 0; i < string_count; ++i )
+		{
+			unsigned int length = 0;
+			if( ReadU32( length ) == false || length > BytesLeft() )
+				return NULL;
+
+			myStrings[ i ].assign( myPos, length );
+			myPos += length;
+		}
+
+		return ReadNode( 0 );
+	}
+
+private:
+	unsigned int BytesLeft() const { return (unsigned int)( myEnd - myPos ); }
+
+	bool ReadU32( unsigned int& value )
+	{
+		if( BytesLeft() < 4 )
+			return false;
+
+		const unsigned char* p = (const unsigned char*)myPos;
+		value = p[ 0 ] | ( p[ 1 ] << 8 ) | ( p[ 2 ] << 16 ) | ( (unsigned int)p[ 3 ] << 24 );
+		myPos += 4;
+		return true;
+	}
+
+	const std::string* ReadString()
+	{
+		unsigned int index = 0;
+		if( ReadU32( index ) == false || index >= myStrings.size() )
+			return NULL;
+
+		return &myStrings[ index ];
+	}
+
+	CXmlNode* ReadNode( int depth )
+	{
+		if( depth > XML_BINARY_MAX_DEPTH )
+			return NULL;
+
+		const std::string* name = ReadString();
+		const std::string* content = ReadString();
+		unsigned int attribute_count = 0;
+		if( name == NULL || content == NULL || ReadU32( attribute_count ) == false || attribute_count > BytesLeft() / 8 )
+			return NULL;
+
+		CXmlNode* node = CXmlNode::CreateNewNode();
+		node->myName = *name;
+		node->myContent = *content;
+		node->myAttributes.Reserve( attribute_count );
+
+		for( unsigned int i = 0; i < attribute_count; ++i )
+		{
+			const std::string* attribute_name = ReadString();
+			const std::string* attribute_value = ReadString();
+			if( attribute_name == NULL || attribute_value == NULL )
+			{
+				CXmlNode::FreeNode( node );
+				return NULL;
+			}
+
+			node->AddAttribute( *attribute_name, CAnyContainer( *attribute_value ) );
+		}
+
+		unsigned int child_count = 0;
+		if( ReadU32( child_count ) == false || child_count > BytesLeft() / 16 )
+		{
+			CXmlNode::FreeNode( node );
+			return NULL;
+		}
+
+		node->myXmlNodes.reserve( child_count );
+		for( unsigned int i = 0; i < child_count; ++i )
+		{
+			CXmlNode* child = ReadNode( depth + 1 );
+			if( child == NULL )
+			{
+				CXmlNode::FreeNode( node );
+				return NULL;
+			}
+
+			node->AddChild( child );
+		}
+
+		return node;
+	}
+
+	const char*					myPos;
+	const char*					myEnd;
+	std::vector< std::string >	myStrings;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool XmlIsBinary( const char* data, long size )
+{
+	return data != NULL && 
+		size >= (long)sizeof( XML_BINARY_MAGIC ) && 
+		memcmp( data, XML_BINARY_MAGIC, sizeof( XML_BINARY_MAGIC ) ) == 0;
+}
+
+CXmlNode* XmlBinaryToNode( const char* data, long size )
+{
+	CXmlBinaryReader reader( data, size );
+	return reader.Read();
+}
+
+void XmlNodeToBinary( const CXmlNode* node, std::vector< char >& output )
+{
+	cassert( node );
+
+	CXmlBinaryWriter writer;
+	writer.WriteNode( node );
+	writer.GetResult( output );
+}
+
+bool XmlSaveNodeToBinaryFile( const CXmlNode* node, const std::string& file )
+{
+	if( node == NULL )
+		return false;
+
+	std::vector< char > data;
+	XmlNodeToBinary( node, data );
+
+	std::ofstream file_output( file.c_str(), std::ios::out | std::ios::binary );
+	if( file_output.is_open() == false )
+	{
+		logger << "Unable to write binary xml-file: " << file.c_str() << "\n";
+		return false;
+	}
+
+	file_output.write( &data[ 0 ], (std::streamsize)data.size() );
+	file_output.close();
+
+	return true;
+}
+
+CXmlNode* XmlLoadNodeFromFile( const std::string& file )
+{
+	CMappedFile input;
+	if( file.empty() || input.Open( file ) == false )
+	{
+		logger << "Unable to open xml-file: " << file.c_str() << "\n";
+		return NULL;
+	}
+
+	if( XmlIsBinary( input.GetData(), input.GetSize() ) )
+	{
+		CXmlNode* result = XmlBinaryToNode( input.GetData(), input.GetSize() );
+		if( result == NULL )
+			logger << "Broken binary xml-file: " << file.c_str() << "\n";
+
+		return result;
+	}
+
+	CXmlParser	parser;
+	CXmlHandler handler;
+
+	parser.SetHandler( &handler );
+	parser.ParseData( input.GetData(), input.GetSize() );
+
+	return handler.GetRootElement();
+}
+
+bool XmlConvertFileToBinary( const std::string& xml_file, const std::string& binary_file )
+{
+	CXmlNode* node = XmlLoadNodeFromFile( xml_file );
+	if( node == NULL )
+		return false;
+
+	const bool result = XmlSaveNodeToBinaryFile( node, binary_file );
+	CXmlNode::FreeNode( node );
+
+	return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // end of namespace ceng
@@ -0,0 +1,84 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2003 - 2011 Petri Purho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+//  CXmlBinary
+//  ==========
+//
+//	Compact binary version of the CXmlNode tree. XmlLoadFromFile() checks the
+//	first bytes of the file and reads either this or xml, so the Serialize()
+//	methods don't have to know which one they're dealing with. 
+//
+//	The format is (all integers are 32 bit little-endian):
+//
+//		"CXB1" version
+//		string_count { length bytes } * string_count
+//		node
+//
+//	and each node is
+//
+//		name content attribute_count { name value } * attribute_count
+//		child_count node * child_count
+//
+//	where the names, contents and values are indices to the string table, so
+//	every tag and attribute name is stored (and allocated on loading) once.
+//
+//.............................................................................
+//
+//=============================================================================
+#ifdef _MSC_VER
+#pragma warning(disable:4786)
+#endif
+
+#ifndef INC_CXMLBINARY_H
+#define INC_CXMLBINARY_H
+
+#include <string>
+#include <vector>
+
+namespace ceng {
+
+class CXmlNode;
+
+//! Returns true if the data starts with the binary header
+bool		XmlIsBinary( const char* data, long size );
+
+//! Creates a CXmlNode tree from the binary data. Returns NULL if the data is 
+//! broken or of an unknown version. The caller should FreeNode() the result.
+CXmlNode*	XmlBinaryToNode( const char* data, long size );
+
+//! Writes the node and its children to the output in the binary format
+void		XmlNodeToBinary( const CXmlNode* node, std::vector< char >& output );
+
+//! Saves the node to a binary file, returns false if the file couldn't be written
+bool		XmlSaveNodeToBinaryFile( const CXmlNode* node, const std::string& file );
+
+//! Loads a file either in the binary or in the xml format. Returns NULL if the
+//! file couldn't be read. The caller should FreeNode() the result.
+CXmlNode*	XmlLoadNodeFromFile( const std::string& file );
+
+//! Converts a xml file to a binary one, returns false on failure
+bool		XmlConvertFileToBinary( const std::string& xml_file, const std::string& binary_file );
+
+} // end of namespace ceng
+
+#endif
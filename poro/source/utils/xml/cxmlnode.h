@@ -136,6 +136,7 @@ private:
 
 	static CXmlNodeManager							myManager;
 	friend class CXmlNodeManager;
+	friend class CXmlBinaryReader;
 };
 
 }
@@ -21,10 +21,11 @@
 
 #include "cxmlparser.h"
 
-#include <fstream>
+#include <cstring>
 #include <iostream>
 
 #include "cxmlhandler.h"
+#include "../filesystem/filesystem.h"
 
 
 // #include "../basepath/basepath.h"
@@ -33,195 +34,333 @@
 
 namespace ceng {
 
-void CXmlParser::ParseFile( const std::string& file )
-{
-	myHandler->StartDocument();
+namespace {
 
-	std::fstream file_input;
-    
-	std::string line;
+	inline bool XmlIsSpace( char c )
+	{
+		return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+	}
 
-	if( file.empty() == false )
+	inline void XmlTrim( const char*& begin, const char*& end )
+	{
+		while( begin < end && XmlIsSpace( *begin ) ) ++begin;
+		while( end > begin && XmlIsSpace( *( end - 1 ) ) ) --end;
+	}
+
+	inline bool XmlStartsWith( const char* begin, const char* end, const char* what )
 	{
-		std::string t = ADD_BASE_PATH(file.c_str());
-		file_input.open(t.c_str() , std::ios::in );
+		const std::size_t size = strlen( what );
+		return (std::size_t)( end - begin ) >= size && memcmp( begin, what, size ) == 0;
+	}
 
-		if(!file_input.good())
+	// returns end if not found
+	const char* XmlFind( const char* begin, const char* end, const char* what )
+	{
+		const std::size_t size = strlen( what );
+		for( const char* p = begin; p + size <= end; ++p )
 		{
-			logger << "Unable to open xml-file: " << file.c_str() << "\n";
+			p = (const char*)memchr( p, what[ 0 ], end - p );
+			if( p == NULL || p + size > end )
+				break;
+			if( memcmp( p, what, size ) == 0 )
+				return p;
 		}
-		while ( file_input.good() ) 
+		return end;
+	}
+
+	// the '>' that ends the tag, skipping the ones in quoted attribute values
+	const char* XmlFindTagEnd( const char* begin, const char* end )
+	{
+		char quote = 0;
+		for( const char* p = begin; p < end; ++p )
 		{
-			std::getline( file_input, line );
-			
-			if( line.size() > 256 )
+			if( quote )
+			{
+				if( *p == quote ) quote = 0;
+			}
+			else if( *p == '"' || *p == '\'' )
 			{
-				std::vector< std::string > lines = ceng::Split( ">", line );
-				for( unsigned int i = 0; i < lines.size(); ++i )
-				{
-					ParseLine( lines[ i ] + ">" );    
-				}
+				quote = *p;
 			}
-			else
+			else if( *p == '>' )
 			{
-				ParseLine( line );    
+				return p;
 			}
 		}
+		return end;
+	}
 
-		file_input.close();
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+
+void CXmlParser::ParseFile( const std::string& file )
+{
+	myHandler->StartDocument();
+
+	if( file.empty() == false )
+	{
+		CMappedFile input;
+		if( input.Open( ADD_BASE_PATH( file ) ) == false )
+		{
+			logger << "Unable to open xml-file: " << file.c_str() << "\n";
+		}
+		else if( input.GetSize() > 0 )
+		{
+			ParseBuffer( input.GetData(), input.GetData() + input.GetSize() );
+		}
 	}
 
 	myHandler->EndDocument();
 }
 
 void CXmlParser::ParseStringData( const std::string& stringdata )
+{
+	ParseData( stringdata.data(), (long)stringdata.size() );
+}
+
+void CXmlParser::ParseData( const char* data, long size )
 {
 	myHandler->StartDocument();
 
-	std::vector< std::string > lines = ceng::Split( ">", stringdata + " " );
-	for( unsigned int i = 0; i < lines.size(); ++i )
-	{
-		if( i < lines.size() - 1 ) 
-			ParseLine( lines[ i ] + ">" );    
-		else
-			ParseLine( lines[ i ] );    
-	}
+	if( data && size > 0 )
+		ParseBuffer( data, data + size );
+
 	myHandler->EndDocument();
 }
 
-void CXmlParser::ParseLine( const std::string& in_line )
+//-----------------------------------------------------------------------------
+
+void CXmlParser::ParseBuffer( const char* begin, const char* end )
 {
-	std::string line = in_line;
-	
-	// added " " to fix the white space bug in attribute parsing
-	if ( myRemoveWhiteSpace ) 
-		line = RemoveWhiteSpace( line ) + " ";
-	
-	size_t i;
-
-	if ( myStatus == content )
+	const char* p = begin;
+	while( p < end )
 	{
-		i = line.find_first_of("<");
-           
-        if ( i == line.npos ) 
-		{
-			myContentBuffer += line;
-			return;
-		} else {
-			myContentBuffer += line.substr( 0, i );
-			myStatus = tag;
-			ParseContentBuffer();
-			ParseLine( line.substr( i + 1 ) );
+		const char* tag = (const char*)memchr( p, '<', end - p );
+
+		// the text after the last tag isn't inside of anything
+		if( tag == NULL )
 			return;
+
+		ParseContent( p, tag );
+		++tag;
+
+		// comments and cdata sections can have '>' in them
+		const char* skip_end = NULL;
+		const char* skip_begin = tag;
+		if( XmlStartsWith( tag, end, "!--" ) )
+		{
+			skip_begin = tag + 3;
+			skip_end = "-->";
 		}
-	} else if ( myStatus == tag )
-	{
-		i = line.find_first_of(">");
-		
-		if ( i == line.npos )
+		else if( XmlStartsWith( tag, end, "![CDATA[" ) )
 		{
-			myTagBuffer += line;
-			return;
-		} else {
-			myTagBuffer += line.substr( 0, i );
-			myStatus = content;
-			ParseTagBuffer();
-			ParseLine( line.substr( i + 1 ) );
-			return;
+			skip_begin = tag + 8;
+			skip_end = "]]>";
+		}
+
+		if( skip_end )
+		{
+			p = XmlFind( skip_begin, end, skip_end );
+			if( p == end )
+				return;
+			p += 3;
+			continue;
 		}
+
+		const char* tag_end = XmlFindTagEnd( tag, end );
+		if( tag_end == end )
+			return;
+
+		// <!DOCTYPE ...> and <?xml ...?>
+		if( *tag != '!' && *tag != '?' )
+			ParseTag( tag, tag_end );
+
+		p = tag_end + 1;
 	}
 }
 
-void CXmlParser::ParseContentBuffer()
+//-----------------------------------------------------------------------------
+
+void CXmlParser::ParseContent( const char* begin, const char* end )
 {
-	
-	while ( myRemoveWhiteSpace && myContentBuffer.size() > 1 && myContentBuffer[ myContentBuffer.size() - 1 ] == '\n' ) 
-		myContentBuffer = myContentBuffer.substr( 0, myContentBuffer.size() - 1 );
-	
-	if ( myContentBuffer.empty() ) return;
-
-	if( myRemoveWhiteSpace ) 
-		myContentBuffer = RemoveWhiteSpace( myContentBuffer );	
-	
-	myHandler->Characters( myContentBuffer );
-	myContentBuffer = "";
+	if( myRemoveWhiteSpace )
+	{
+		XmlTrim( begin, end );
+		if( begin == end ) 
+			return;
+
+		// every line is trimmed and the lines are joined with a space
+		myContentBuffer.clear();
+		const char* line = begin;
+		while( true )
+		{
+			const char* line_end = (const char*)memchr( line, '\n', end - line );
+			if( line_end == NULL ) 
+				line_end = end;
+
+			const char* b = line;
+			const char* e = line_end;
+			XmlTrim( b, e );
 
+			if( line != begin ) 
+				myContentBuffer += ' ';
+			myContentBuffer.append( b, e - b );
+
+			if( line_end == end )
+				break;
+			line = line_end + 1;
+		}
+	}
+	else
+	{
+		if( begin == end ) 
+			return;
+
+		myContentBuffer.assign( begin, end - begin );
+	}
+
+	myHandler->Characters( myContentBuffer );
 }
 
-void CXmlParser::ParseTagBuffer()
-{
-	if ( myRemoveWhiteSpace ) myTagBuffer = RemoveWhiteSpace( myTagBuffer );
-	while ( myRemoveWhiteSpace && myTagBuffer.size() > 1 && myTagBuffer[ myTagBuffer.size() - 1 ] == '\n' ) myTagBuffer = myTagBuffer.substr( 0, myTagBuffer.size() - 1 );
-	
-	if ( myTagBuffer.empty() ) return;
+//-----------------------------------------------------------------------------
 
-	
-	
-	std::string line = myTagBuffer;
-	myTagBuffer = "";
+void CXmlParser::ParseTag( const char* begin, const char* end )
+{
+	XmlTrim( begin, end );
+	if( begin == end ) 
+		return;
 
-	if ( line[0] == '/' ) 
+	if( *begin == '/' )
 	{
-		myHandler->EndElement( line.substr( 1 ) );
+		++begin;
+		XmlTrim( begin, end );
+		myTagBuffer.assign( begin, end - begin );
+		myHandler->EndElement( myTagBuffer );
 		return;
 	}
 
-	if ( line[0] == '!' )
+	bool self_closing = false;
+	if( *( end - 1 ) == '/' )
 	{
-		return;
+		self_closing = true;
+		--end;
+		XmlTrim( begin, end );
+		if( begin == end ) 
+			return;
 	}
 
-	size_t i = line.find_first_of( "=" );
-	if ( i != line.npos ) line = ParseAttributes( line );
-	
-	if ( line.empty() ) return;
+	const char* p = begin;
+	while( p < end && XmlIsSpace( *p ) == false ) ++p;
+	myTagBuffer.assign( begin, p - begin );
+
+	// names are only forgotten between tags
+	if( myAttributeNames.size() > 256 )
+		myAttributeNames.clear();
 
-	if ( line[ line.size() - 1 ] == '/' )
-	{	
-		line = line.substr( 0, line.size() - 1 );
-		line = RemoveWhiteSpace( line );
-		myHandler->StartElement( line, myAttributeBuffer );
+	myAttributes.clear();
+	while( p < end )
+	{
+		while( p < end && XmlIsSpace( *p ) ) ++p;
+		if( p == end ) 
+			break;
+
+		const char* name = p;
+		while( p < end && XmlIsSpace( *p ) == false && *p != '=' ) ++p;
+		const char* name_end = p;
+		if( name == name_end ) 
+		{
+			++p;
+			continue;
+		}
+
+		while( p < end && XmlIsSpace( *p ) ) ++p;
+
+		// an attribute without a value is ignored
+		if( p == end || *p != '=' )
+			continue;
+
+		++p;
+		while( p < end && XmlIsSpace( *p ) ) ++p;
+
+		const char* value = p;
+		const char* value_end = p;
+		if( p < end && ( *p == '"' || *p == '\'' ) )
+		{
+			const char quote = *p;
+			++p;
+			value = p;
+			while( p < end && *p != quote ) ++p;
+			value_end = p;
+			if( p < end ) ++p;
+		}
+		else
+		{
+			while( p < end && XmlIsSpace( *p ) == false ) ++p;
+			value_end = p;
+		}
+
+		AddAttribute( name, name_end, value, value_end );
+	}
+
+	// tags next to each other usually have the same attributes, in which 
+	// case only the values in the map are replaced
+	bool same_names = myAttributeBuffer.size() == myAttributes.size();
+	for( std::size_t i = 0; same_names && i < myAttributes.size(); ++i )
+		same_names = myAttributeBuffer.find( myAttributeNames[ myAttributes[ i ].name ] ) != myAttributeBuffer.end();
+
+	if( same_names == false )
 		myAttributeBuffer.clear();
-		myHandler->EndElement( line );
 
-		return;
+	for( std::size_t i = 0; i < myAttributes.size(); ++i )
+	{
+		const std::string& name = myAttributeNames[ myAttributes[ i ].name ];
+		myValueBuffer.assign( myAttributes[ i ].value, myAttributes[ i ].value_size );
+
+		if( same_names )
+			myAttributeBuffer.find( name )->second = myValueBuffer;
+		else
+			myAttributeBuffer.insert( std::pair< std::string, CAnyContainer >( name, myValueBuffer ) );
 	}
 
-	myHandler->StartElement( line, myAttributeBuffer );
-	myAttributeBuffer.clear();
+	myHandler->StartElement( myTagBuffer, myAttributeBuffer );
 
+	if( self_closing )
+		myHandler->EndElement( myTagBuffer );
 }
 
-std::string CXmlParser::ParseAttributes( const std::string& line )
+//-----------------------------------------------------------------------------
+
+void CXmlParser::AddAttribute( const char* name, const char* name_end, const char* value, const char* value_end )
 {
-	std::string tmp = line;
-	size_t i = tmp.find_first_of( "=" );
-	if ( i == tmp.npos ) return tmp;
-	
-	std::string key_part	= RemoveWhiteSpace( tmp.substr( 0, i ) );
-	std::string value_part  = RemoveWhiteSpace( tmp.substr( i + 1 ) );
-
-	i = key_part.find_last_of(" \t");
-	if ( i != key_part.npos ) 
+	AttributeView attribute;
+	attribute.name = InternAttributeName( name, name_end );
+	attribute.value = value;
+	attribute.value_size = (int)( value_end - value );
+
+	// the first one wins if the same attribute is there twice
+	for( std::size_t i = 0; i < myAttributes.size(); ++i )
 	{
-		tmp = key_part.substr( 0, i );
-		key_part = key_part.substr( i + 1 );
+		if( myAttributes[ i ].name == attribute.name )
+			return;
 	}
 
-	i = StringFindFirstOf( " \t/", value_part );
-	if ( i != value_part.npos )
+	myAttributes.push_back( attribute );
+}
+
+int CXmlParser::InternAttributeName( const char* begin, const char* end )
+{
+	const std::size_t size = end - begin;
+	for( std::size_t i = 0; i < myAttributeNames.size(); ++i )
 	{
-		tmp += value_part.substr( i );
-		value_part = value_part.substr( 0, i);
+		if( myAttributeNames[ i ].size() == size && memcmp( myAttributeNames[ i ].data(), begin, size ) == 0 )
+			return (int)i;
 	}
 
-	value_part = RemoveWhiteSpace( value_part );
-	value_part = RemoveQuotes( value_part );
-	// value_part = value_part.substr( 1, value_part.size() - 2 );
-	
-	myAttributeBuffer.insert( std::pair< std::string, CAnyContainer >( key_part, value_part ) );
-
-	return ParseAttributes( tmp );	
+	myAttributeNames.push_back( std::string( begin, end ) );
+	return (int)myAttributeNames.size() - 1;
 }
 
-}
\ No newline at end of file
+//-----------------------------------------------------------------------------
+
+}
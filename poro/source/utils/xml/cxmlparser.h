@@ -28,6 +28,12 @@
 //  proprietary methods to the given handler. The handler is of type
 //  CXmlHandler
 //
+//  The whole file is mapped to memory and parsed in one pass. Tag names,
+//  contents and attribute values point to the buffer until they're handed 
+//  to the handler, and the strings and the attribute map given to the 
+//  handler are reused from tag to tag. Comments, <!DOCTYPE ...> and 
+//  <?xml ...?> are skipped.
+//
 //
 // Created 01.10.2004 by Pete
 //.............................................................................
@@ -51,6 +57,7 @@
 #ifndef INC_CXMLTESTPARSER_H
 #define INC_CXMLTESTPARSER_H
 
+#include <vector>
 #include "canycontainer.h"
 
 namespace ceng {
@@ -61,17 +68,8 @@ class CXmlHandler;
 class CXmlParser
 {
 public:
-	enum ParserStatus
-	{
-		content = 0,
-		tag = 1
-	};
-
-	//-------------------------------------------------------------------------
-
 	CXmlParser() :
 	  myRemoveWhiteSpace( true ),
-	  myStatus( content ),
 	  myHandler( NULL )
     { }
 
@@ -83,27 +81,40 @@ public:
 
 	void ParseFile( const std::string& file );
 	void ParseStringData( const std::string& stringdata );
+	void ParseData( const char* data, long size );
 
 	//-------------------------------------------------------------------------
 
 private:
-	void ParseLine( const std::string& in_line );
+	void		ParseBuffer( const char* begin, const char* end );
 
-	void		ParseContentBuffer();
-	void		ParseTagBuffer();
-
-	std::string	ParseAttributes( const std::string& line );
+	void		ParseContent( const char* begin, const char* end );
+	void		ParseTag( const char* begin, const char* end );
 
+	void		AddAttribute( const char* name, const char* name_end, const char* value, const char* value_end );
+	int			InternAttributeName( const char* begin, const char* end );
 
 	//-------------------------------------------------------------------------
 
+	struct AttributeView
+	{
+		int			name;
+		const char*	value;
+		int			value_size;
+	};
+
 	bool			myRemoveWhiteSpace;
-	ParserStatus	myStatus;
 
 	CXmlHandler*	myHandler;
 
 	std::string		myContentBuffer;
 	std::string		myTagBuffer;
+	std::string		myValueBuffer;
+
+	// attribute names seen so far, so that the names of the attributes 
+	// don't have to be copied for every tag
+	std::vector< std::string >		myAttributeNames;
+	std::vector< AttributeView >	myAttributes;
 
 	std::map< std::string, CAnyContainer > myAttributeBuffer;
 
@@ -114,4 +125,3 @@ private:
 }
 
 #endif
-
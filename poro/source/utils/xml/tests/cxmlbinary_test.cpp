@@ -0,0 +1,165 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2003 - 2011 Petri Purho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+
+#include "../cxml.h"
+#include "../cxmlbinary.h"
+#include "../../debug.h"
+
+#include <cstdio>
+
+#ifdef PORO_TESTER_ENABLED
+
+namespace ceng {
+namespace test {
+
+namespace {
+
+	bool CXmlBinaryTest_Equal( const CXmlNode* a, const CXmlNode* b )
+	{
+		if( a->GetName() != b->GetName() || 
+			a->GetContent() != b->GetContent() ||
+			a->GetAttributeCount() != b->GetAttributeCount() ||
+			a->GetChildCount() != b->GetChildCount() )
+			return false;
+
+		for( int i = 0; i < a->GetAttributeCount(); ++i )
+		{
+			if( a->GetAttributeName( i ) != b->GetAttributeName( i ) ||
+				a->GetAttributeValue( i ).GetValue() != b->GetAttributeValue( i ).GetValue() )
+				return false;
+		}
+
+		for( int i = 0; i < a->GetChildCount(); ++i )
+		{
+			if( CXmlBinaryTest_Equal( a->GetChild( i ), b->GetChild( i ) ) == false )
+				return false;
+		}
+
+		return true;
+	}
+
+	CXmlNode* CXmlBinaryTest_Parse( const std::string& data )
+	{
+		CXmlHandler handler;
+		CXmlParser parser;
+		parser.SetHandler( &handler );
+		parser.ParseStringData( data );
+		return handler.GetRootElement();
+	}
+
+	struct CXmlBinaryTestMesh
+	{
+		CXmlBinaryTestMesh() : id( 0 ), scale( 0 ) { }
+
+		void Serialize( CXmlFileSys* filesys )
+		{
+			XML_BindAttribute( filesys, id );
+			XML_BindAttribute( filesys, scale );
+			XML_Bind( filesys, name );
+		}
+
+		int			id;
+		float		scale;
+		std::string	name;
+	};
+
+} // end of anonymous namespace
+
+int CXmlBinaryTest()
+{
+	// the tree is the same after a round trip, escaped characters included
+	{
+		CXmlNode* root = CXmlBinaryTest_Parse( 
+			"<Font name=\"test\" size=\"10\">"
+			"<Texture>data/fonts/font.png</Texture>"
+			"<QuadChar id=\"32\" width=\"2.6\"/><QuadChar id=\"33\" width=\"2.6\"/>"
+			"<Text>&amp;lt; &quot;quoted&quot;</Text>"
+			"<Empty/>"
+			"</Font>" );
+		test_assert( root );
+		test_assert( root->GetChild( 3 )->GetContent() == "&lt; \"quoted\"" );
+
+		std::vector< char > data;
+		XmlNodeToBinary( root, data );
+		test_assert( XmlIsBinary( &data[ 0 ], (long)data.size() ) );
+
+		CXmlNode* loaded = XmlBinaryToNode( &data[ 0 ], (long)data.size() );
+		test_assert( loaded );
+		test_assert( CXmlBinaryTest_Equal( root, loaded ) );
+		test_assert( loaded->GetChild( 1 )->GetFather() == loaded );
+
+		// broken and truncated data isn't loaded
+		for( long i = 0; i < (long)data.size(); ++i )
+			test_assert( XmlBinaryToNode( &data[ 0 ], i ) == NULL );
+
+		data[ 4 ] = 2;
+		test_assert( XmlBinaryToNode( &data[ 0 ], (long)data.size() ) == NULL );
+
+		CXmlNode::FreeNode( loaded );
+		CXmlNode::FreeNode( root );
+	}
+
+	// xml isn't mistaken for binary
+	{
+		const std::string xml = "<a></a>";
+		test_assert( XmlIsBinary( xml.data(), (long)xml.size() ) == false );
+		test_assert( XmlIsBinary( NULL, 0 ) == false );
+	}
+
+	// meshes load the same from both formats
+	{
+		CXmlBinaryTestMesh mesh;
+		mesh.id = 12;
+		mesh.scale = 0.5f;
+		mesh.name = "two words";
+
+		const char* xml_file = "cxmlbinary_test.xml";
+		const char* binary_file = "cxmlbinary_test.bin";
+		const char* converted_file = "cxmlbinary_test_converted.bin";
+
+		XmlSaveToFile( mesh, xml_file, "Mesh" );
+		test_assert( XmlSaveToBinaryFile( mesh, binary_file, "Mesh" ) );
+		test_assert( XmlConvertFileToBinary( xml_file, converted_file ) );
+
+		const char* files[] = { xml_file, binary_file, converted_file };
+		for( int i = 0; i < 3; ++i )
+		{
+			CXmlBinaryTestMesh loaded;
+			XmlLoadFromFile( loaded, files[ i ], "Mesh" );
+			test_assert( loaded.id == 12 );
+			test_assert( loaded.scale == 0.5f );
+			test_assert( loaded.name == "two words" );
+		}
+
+		remove( xml_file );
+		remove( binary_file );
+		remove( converted_file );
+	}
+
+	return 0;
+}
+
+TEST_REGISTER( CXmlBinaryTest );
+
+} // end of namespace test
+} // end of namespace ceng
+
+#endif
@@ -0,0 +1,145 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2003 - 2011 Petri Purho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+
+// Times CXmlParser on the font files and on a big generated preset file,
+// both with and without building the CXmlNode tree, and compares that to 
+// loading the same tree from the binary format. Run from the WorkDir
+// of back_designs so that the fonts are found. Only built when 
+// CENG_XMLPARSER_BENCHMARK is defined.
+
+#include "../cxmlparser.h"
+#include "../cxmlhandler.h"
+#include "../cxmlbinary.h"
+#include "../../timer/ctimer.h"
+#include "../../debug.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#if defined( PORO_TESTER_ENABLED ) && defined( CENG_XMLPARSER_BENCHMARK )
+
+namespace ceng {
+namespace test {
+
+namespace {
+
+	// only counts, so that the time is all parsing
+	class CXmlParserBenchmarkHandler : public CXmlHandler
+	{
+	public:
+		CXmlParserBenchmarkHandler() : count( 0 ) { }
+
+		virtual void Characters( const std::string& chars ) { ++count; }
+		virtual void StartElement( const std::string& name, const attributes& attr ) { count += 1 + (int)attr.size(); }
+		virtual void EndElement( const std::string& name ) { ++count; }
+
+		int count;
+	};
+
+	void CXmlParserBenchmark_Run( const std::string& filename, int times )
+	{
+		std::fstream file( filename.c_str(), std::ios::in | std::ios::binary );
+		file.seekg( 0, std::ios::end );
+		const double megabytes = (double)file.tellg() / ( 1024.0 * 1024.0 ) * times;
+		file.close();
+
+		CTimer timer;
+		CXmlParserBenchmarkHandler counter;
+		for( int i = 0; i < times; ++i )
+		{
+			CXmlParser parser;
+			parser.SetHandler( &counter );
+			parser.ParseFile( filename );
+		}
+		const double parse_time = timer.GetTime();
+		test_assert( counter.count > 0 );
+
+		timer.Reset();
+		for( int i = 0; i < times; ++i )
+		{
+			CXmlParser parser;
+			CXmlHandler handler;
+			parser.SetHandler( &handler );
+			parser.ParseFile( filename );
+			test_assert( handler.GetRootElement() );
+			CXmlNode::FreeNode( handler.GetRootElement() );
+		}
+		const double tree_time = timer.GetTime();
+
+		const std::string binary_filename = "cxmlparser_benchmark.bin";
+		test_assert( XmlConvertFileToBinary( filename, binary_filename ) );
+
+		timer.Reset();
+		for( int i = 0; i < times; ++i )
+		{
+			CXmlNode* node = XmlLoadNodeFromFile( binary_filename );
+			test_assert( node );
+			CXmlNode::FreeNode( node );
+		}
+		const double binary_time = timer.GetTime();
+		remove( binary_filename.c_str() );
+
+		std::cout << filename << " x " << times << ": " 
+			<< parse_time << " ms parsing (" << ( megabytes / ( parse_time / 1000.0 ) ) << " MB/s), "
+			<< tree_time << " ms with the CXmlNode tree, "
+			<< binary_time << " ms from binary" << std::endl;
+	}
+
+} // end of anonymous namespace
+
+int CXmlParserBenchmark()
+{
+	const char* fonts[] = { 
+		"data/fonts/ubuntu_condensed_10.xml",
+		"data/fonts/ubuntu_condensed_18.xml",
+		"data/fonts/UbuntuCondensed-Regular_128.xml",
+		"data/fonts/font_arial.xml" };
+
+	for( int i = 0; i < (int)( sizeof( fonts ) / sizeof( fonts[ 0 ] ) ); ++i )
+		CXmlParserBenchmark_Run( fonts[ i ], 200 );
+
+	// a config preset with a lot of entries
+	const char* filename = "cxmlparser_benchmark.xml";
+	{
+		std::ofstream file( filename, std::ios::out | std::ios::binary );
+		file << "<Presets>\n";
+		for( int i = 0; i < 20000; ++i )
+		{
+			file << "  <Preset name=\"preset_" << i << "\" value=\"" << i * 0.5f << "\" min=\"0\" max=\"1\" color=\"0xFF00FF\" >\n"
+				<< "    some content " << i << "\n"
+				<< "  </Preset>\n";
+		}
+		file << "</Presets>\n";
+	}
+
+	CXmlParserBenchmark_Run( filename, 3 );
+
+	remove( filename );
+	return 0;
+}
+
+TEST_REGISTER( CXmlParserBenchmark );
+
+} // end of namespace test
+} // end of namespace ceng
+
+#endif
@@ -0,0 +1,140 @@
+/***************************************************************************
+ *
+ * Copyright (c) 2003 - 2011 Petri Purho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ***************************************************************************/
+
+
+#include "../cxmlparser.h"
+#include "../cxmlhandler.h"
+#include "../../debug.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#ifdef PORO_TESTER_ENABLED
+
+namespace ceng {
+namespace test {
+
+namespace {
+
+	// writes down everything the parser calls
+	class CXmlParserTestHandler : public CXmlHandler
+	{
+	public:
+		virtual void Characters( const std::string& chars ) 
+		{ 
+			events << "C[" << chars << "]"; 
+		}
+
+		virtual void StartElement( const std::string& name, const attributes& attr )
+		{
+			events << "S[" << name << "]";
+			for( attributes_const_iterator i = attr.begin(); i != attr.end(); ++i )
+				events << i->first << "=[" << i->second.GetValue() << "]";
+		}
+
+		virtual void EndElement( const std::string& name ) 
+		{ 
+			events << "E[" << name << "]"; 
+		}
+
+		std::stringstream events;
+	};
+
+	std::string CXmlParserTest_Parse( const std::string& data )
+	{
+		CXmlParserTestHandler handler;
+		CXmlParser parser;
+		parser.SetHandler( &handler );
+		parser.ParseStringData( data );
+		return handler.events.str();
+	}
+
+} // end of anonymous namespace
+
+int CXmlParserTest()
+{
+	// the basics
+	test_assert( CXmlParserTest_Parse( "" ) == "" );
+	test_assert( CXmlParserTest_Parse( "<a></a>" ) == "S[a]E[a]" );
+	test_assert( CXmlParserTest_Parse( "<a/>" ) == "S[a]E[a]" );
+	test_assert( CXmlParserTest_Parse( "<a x=\"1\" y=\"2\" />" ) == "S[a]x=[1]y=[2]E[a]" );
+	test_assert( CXmlParserTest_Parse( "<a>\n  <b>\n    text\n  </b>\n</a>\n" ) == "S[a]S[b]C[text]E[b]E[a]" );
+
+	// contents on many lines are joined with spaces
+	test_assert( CXmlParserTest_Parse( "<a>\n  one\n\ttwo  \r\n</a>" ) == "S[a]C[one two]E[a]" );
+
+	// attributes: spaces, single quotes, duplicates, on many lines and '>' in the values
+	test_assert( CXmlParserTest_Parse( "<a b = \"two words\" c='x' b=\"dup\">" ) == "S[a]b=[two words]c=[x]" );
+	test_assert( CXmlParserTest_Parse( "<a\n  first=\"1\"\r\n  second=\"2\">" ) == "S[a]first=[1]second=[2]" );
+	test_assert( CXmlParserTest_Parse( "<a v=\"x>y\" file=\"data/a.png\"/>" ) == "S[a]file=[data/a.png]v=[x>y]E[a]" );
+
+	// the same attributes on the next tag, and then different ones
+	test_assert( CXmlParserTest_Parse( "<a x=\"1\"/><a x=\"2\"/><a y=\"3\"/><a/>" ) == "S[a]x=[1]E[a]S[a]x=[2]E[a]S[a]y=[3]E[a]S[a]E[a]" );
+
+	// comments, prologs and doctypes are skipped
+	test_assert( CXmlParserTest_Parse( "<?xml version=\"1.0\"?>\n<!-- <b> -->\n<!DOCTYPE a>\n<a><!--x-->t</a>" ) == "S[a]C[t]E[a]" );
+
+	// files parse the same way as strings
+	{
+		const std::string data = "<Font>\n  <Texture>\n    data/fonts/font.png\n  </Texture>\n  <QuadChar id=\"32\" width=\"2.6\" >\n  </QuadChar>\n</Font>\n";
+		const char* filename = "cxmlparser_test.xml";
+		{
+			std::ofstream file( filename, std::ios::out | std::ios::binary );
+			file << data;
+		}
+
+		CXmlParserTestHandler handler;
+		CXmlParser parser;
+		parser.SetHandler( &handler );
+		parser.ParseFile( filename );
+		remove( filename );
+
+		test_assert( handler.events.str() == CXmlParserTest_Parse( data ) );
+		test_assert( handler.events.str() == "S[Font]S[Texture]C[data/fonts/font.png]E[Texture]S[QuadChar]id=[32]width=[2.6]E[QuadChar]E[Font]" );
+	}
+
+	// and the tree is built the same way as before
+	{
+		CXmlHandler handler;
+		CXmlParser parser;
+		parser.SetHandler( &handler );
+		parser.ParseStringData( "<a><b x=\"1\">text</b><c/></a>" );
+
+		CXmlNode* root = handler.GetRootElement();
+		test_assert( root && root->GetName() == "a" );
+		test_assert( root->GetChildCount() == 2 );
+		test_assert( root->GetChild( 0 )->GetName() == "b" );
+		test_assert( root->GetChild( 0 )->GetContent() == "text" );
+		test_assert( root->GetChild( 0 )->GetAttributeCount() == 1 );
+		test_assert( root->GetChild( 0 )->GetAttributeValue( "x" ).GetValue() == "1" );
+		test_assert( root->GetChild( 1 )->GetName() == "c" );
+		CXmlNode::FreeNode( root );
+	}
+
+	return 0;
+}
+
+TEST_REGISTER( CXmlParserTest );
+
+} // end of namespace test
+} // end of namespace ceng
+
+#endif